@@ -97,6 +97,8 @@ class AMFPlacer
             delete globalPlacer;
         if (initialPacker)
             delete initialPacker;
+        if (budgetManager)
+            delete budgetManager;
     }
 
     void clearSomeAttributesCannotRecord()
@@ -141,14 +143,25 @@ class AMFPlacer
         // go through several glable placement iterations to get initial placement
         globalPlacer = new GlobalPlacer(placementInfo, JSON);
 
+        // the iterations of the global placement stages below, the unused iterations of a stage can be handed to the
+        // later strict stages by the budget manager (the final stage is not strict and runs until convergence)
+        int globalPlacementIteration = std::stoi(JSON["GlobalPlacementIteration"]);
+        budgetManager = new GlobalPlacementBudgetManager(JSON);
+        budgetManager->planStages({globalPlacementIteration / 3, globalPlacementIteration * 2 / 9,
+                                   globalPlacementIteration * 2 / 9, globalPlacementIteration * 2 / 9,
+                                   globalPlacementIteration / 2},
+                                  {true, true, true, true, false});
+        globalPlacer->setBudgetManager(budgetManager);
+
         // enable the timing optimization, start initial placement and global placement.
 
         globalPlacer->clusterPlacement();
         timingOptimizer->clusterLongPathInOneClockRegion(longPathThr, 0.5);
         globalPlacer->GlobalPlacement_fixedCLB(1, 0.0002);
 
-        globalPlacer->GlobalPlacement_CLBElements(std::stoi(JSON["GlobalPlacementIteration"]) / 3, false, 5, true, true,
-                                                  200, timingOptimizer);
+        globalPlacer->GlobalPlacement_CLBElements(budgetManager->beginStage(), false, 5, true, true, 200,
+                                                  timingOptimizer);
+        budgetManager->endStage();
         timingOptimizer->clusterLongPathInOneClockRegion(longPathThr, 0.5);
         globalPlacer->setPseudoNetWeight(globalPlacer->getPseudoNetWeight() * 0.85);
         globalPlacer->setMacroLegalizationParameters(globalPlacer->getMacroPseudoNetEnhanceCnt() * 0.8,
@@ -156,8 +169,9 @@ class AMFPlacer
         placementInfo->createGridBins(2.0, 2.0);
         placementInfo->adjustLUTFFUtilization(-10, true);
         // globalPlacer->spreading(-1);
-        globalPlacer->GlobalPlacement_CLBElements(std::stoi(JSON["GlobalPlacementIteration"]) * 2 / 9, true, 5, true,
-                                                  true, 200, timingOptimizer);
+        globalPlacer->GlobalPlacement_CLBElements(budgetManager->beginStage(), true, 5, true, true, 200,
+                                                  timingOptimizer);
+        budgetManager->endStage();
         placementInfo->getPU2ClockRegionCenters().clear();
         print_info("Current Total HPWL = " + std::to_string(placementInfo->updateB2BAndGetTotalHPWL()));
 
@@ -175,8 +189,9 @@ class AMFPlacer
                                                      globalPlacer->getMacroLegalizationWeight() * 0.8);
         globalPlacer->setNeighborDisplacementUpperbound(3.0);
 
-        globalPlacer->GlobalPlacement_CLBElements(std::stoi(JSON["GlobalPlacementIteration"]) * 2 / 9, true, 5, true,
-                                                  true, 25, timingOptimizer);
+        globalPlacer->GlobalPlacement_CLBElements(budgetManager->beginStage(), true, 5, true, true, 25,
+                                                  timingOptimizer);
+        budgetManager->endStage();
         // placementInfo->getPU2ClockRegionCenters().clear();
 
         // placementInfo->getDesignInfo()->resetNetEnhanceRatio();
@@ -184,11 +199,13 @@ class AMFPlacer
         globalPlacer->setNeighborDisplacementUpperbound(2.0);
 
         // timingOptimizer->moveDriverIntoBetterClockRegion(longPathThr, 0.75);
-        globalPlacer->GlobalPlacement_CLBElements(std::stoi(JSON["GlobalPlacementIteration"]) * 2 / 9, true, 5, true,
-                                                  true, 25, timingOptimizer);
+        globalPlacer->GlobalPlacement_CLBElements(budgetManager->beginStage(), true, 5, true, true, 25,
+                                                  timingOptimizer);
+        budgetManager->endStage();
         // placementInfo->getPU2ClockRegionCenters().clear();
-        globalPlacer->GlobalPlacement_CLBElements(std::stoi(JSON["GlobalPlacementIteration"]) / 2, true, 5, true, false,
-                                                  25, timingOptimizer);
+        globalPlacer->GlobalPlacement_CLBElements(budgetManager->beginStage(), true, 5, true, false, 25,
+                                                  timingOptimizer);
+        budgetManager->endStage();
 
         // currently, some fixed/packed flag cannot be stored in the check-point (TODO)
         clearSomeAttributesCannotRecord();
@@ -266,6 +283,12 @@ class AMFPlacer
      */
     GlobalPlacer *globalPlacer = nullptr;
 
+    /**
+     * @brief distributing the wall-clock/iteration budget across the global placement stages
+     *
+     */
+    GlobalPlacementBudgetManager *budgetManager = nullptr;
+
     /**
      * @brief final packing of instances into CLB sites
      *
@@ -0,0 +1,201 @@
+/**
+ * @file main.cc
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief LegalizationReplay loads a legalization instance dumped by the legalizers ("DumpLegalizationInstance") and
+ * re-solves its recorded bipartite matching problems and column DP problems, so the solvers can be evaluated without
+ * running the whole placement flow. Only the solver calls are replayed: the candidate search, the column mapping and
+ * spreading, and the iterations of the rough legalization are not, since their inputs are not recorded.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ */
+
+#include "BandedColumnDP.h"
+#include "LegalizationInstance.h"
+#include "MinCostBipartiteMatcher.h"
+#include "strPrint.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+
+/**
+ * @brief replay a bipartite matching problem with the given min-cost flow engine and report the result
+ *
+ * @param problem the recorded matching problem
+ * @param engine the min-cost flow engine
+ * @param engineName the name of the engine for the report
+ * @param nJobs the number of threads
+ */
+void replayMatchingProblem(LegalizationInstance::MatchingProblem &problem,
+                           MinCostBipartiteMatcher::MinCostFlowEngine engine, const std::string &engineName, int nJobs)
+{
+    auto startTime = std::chrono::steady_clock::now();
+    MinCostBipartiteMatcher matcher(problem.numLeftNodes, problem.numRightNodes, problem.numLeftNodes,
+                                    problem.adjList, nJobs, false, engine);
+    matcher.solve();
+    double elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    int numMatched = 0;
+    double totalCost = 0.0, totalDisplacement = 0.0, maxDisplacement = 0.0;
+    for (int leftId = 0; leftId < problem.numLeftNodes; leftId++)
+    {
+        int rightId = matcher.getMatchedRightNode(leftId);
+        if (rightId < 0)
+            continue;
+        auto &curEdges = problem.adjList[leftId];
+        for (unsigned int edgeId = 0; edgeId < curEdges.size(); edgeId++)
+        {
+            if (curEdges[edgeId].first != rightId)
+                continue;
+            float displacement = problem.displacements[leftId][edgeId];
+            numMatched++;
+            totalCost += curEdges[edgeId].second;
+            totalDisplacement += displacement;
+            maxDisplacement = std::max(maxDisplacement, (double)displacement);
+            break;
+        }
+    }
+
+    std::stringstream outputStream;
+    outputStream << "  [" << engineName << "] #matched=" << numMatched << "/" << problem.numLeftNodes
+                 << " cost=" << totalCost << " avgDisp=" << (numMatched ? totalDisplacement / numMatched : 0.0)
+                 << " maxDisp=" << maxDisplacement << " time=" << elapsedSeconds << "s";
+    print_info(outputStream.str());
+}
+
+/**
+ * @brief replay a column DP problem with BandedColumnDP in its recorded band and report the result
+ *
+ * Only the costs within the recorded band are available, so the band cannot be changed in the replay. If the DP
+ * cannot be solved within the band, it is solved again for the whole column (with the recorded costs).
+ *
+ * @param problem the recorded column DP problem
+ * @param totalCost the accumulated cost of the replayed problems
+ * @param totalDisplacement the accumulated displacement of the replayed problems
+ * @param maxDisplacement the maximum displacement of the replayed problems
+ * @param numPlacedPUs the accumulated number of PlacementUnits of the replayed problems
+ * @return true if the DP is solved within the band
+ */
+bool replayColumnDPProblem(LegalizationInstance::ColumnDPProblem &problem, double &totalCost,
+                           double &totalDisplacement, double &maxDisplacement, int &numPlacedPUs)
+{
+    int bandWidth = problem.bandWidth;
+    int numPUs = problem.PUHeights.size();
+    BandedColumnDP columnDP;
+    std::vector<int> PUBottomSiteIds;
+    bool solved = false, solvedInBand = false;
+    for (int curBandWidth : {bandWidth, -1})
+    {
+        columnDP.setColumn(problem.numSites, problem.PUHeights, problem.PUTargetSiteIds, curBandWidth);
+        for (int i = 0; i < numPUs; i++)
+        {
+            for (auto &topSiteAndCost : problem.PUCosts[i])
+            {
+                if (topSiteAndCost.first >= columnDP.getBandLow(i) && topSiteAndCost.first <= columnDP.getBandHigh(i))
+                    columnDP.setCost(i, topSiteAndCost.first, topSiteAndCost.second);
+            }
+        }
+        solved = columnDP.solve(PUBottomSiteIds);
+        if (solved && curBandWidth == bandWidth)
+            solvedInBand = true;
+        if (solved || curBandWidth < 0)
+            break;
+    }
+    if (!solved)
+        return false;
+
+    for (int i = 0; i < numPUs; i++)
+    {
+        int bottomSiteId = PUBottomSiteIds[i];
+        int topSiteId = bottomSiteId + problem.PUHeights[i] - 1;
+        for (auto &topSiteAndCost : problem.PUCosts[i])
+        {
+            if (topSiteAndCost.first == topSiteId)
+            {
+                totalCost += topSiteAndCost.second;
+                break;
+            }
+        }
+        double displacement = std::fabs(problem.PUXs[i] - problem.siteXs[bottomSiteId]) +
+                              std::fabs(problem.PUYs[i] - problem.siteYs[bottomSiteId]);
+        totalDisplacement += displacement;
+        maxDisplacement = std::max(maxDisplacement, displacement);
+        numPlacedPUs++;
+    }
+    return solvedInBand;
+}
+
+int main(int argc, const char **argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " <legalization instance file> [SPFA|Dijkstra|both] [number of threads]" << std::endl;
+        return 1;
+    }
+
+    std::string engineOption = argc > 2 ? argv[2] : "both";
+    int nJobs = argc > 3 ? std::stoi(argv[3]) : 1;
+
+    std::vector<std::pair<MinCostBipartiteMatcher::MinCostFlowEngine, std::string>> engines;
+    if (engineOption == "SPFA" || engineOption == "both")
+        engines.emplace_back(MinCostBipartiteMatcher::MinCostFlowEngine_SPFA, "SPFA");
+    if (engineOption == "Dijkstra" || engineOption == "both")
+        engines.emplace_back(MinCostBipartiteMatcher::MinCostFlowEngine_Dijkstra, "Dijkstra");
+    if (!engines.size())
+    {
+        print_error("undefined min-cost flow engine: " + engineOption);
+        return 1;
+    }
+
+    LegalizationInstance instance("");
+    if (!instance.load(argv[1]))
+        return 1;
+    print_status("LegalizationReplay: loaded the instance of " + instance.getLegalizerName() + " with " +
+                 std::to_string(instance.getMatchingProblems().size()) + " matching problems and " +
+                 std::to_string(instance.getColumnDPProblems().size()) + " column DP problems");
+
+    for (unsigned int problemId = 0; problemId < instance.getMatchingProblems().size(); problemId++)
+    {
+        auto &curProblem = instance.getMatchingProblems()[problemId];
+        print_status("matching#" + std::to_string(problemId) + " phase=" + curProblem.phase +
+                     " #left=" + std::to_string(curProblem.numLeftNodes) +
+                     " #right=" + std::to_string(curProblem.numRightNodes));
+        for (auto &engineAndName : engines)
+            replayMatchingProblem(curProblem, engineAndName.first, engineAndName.second, nJobs);
+    }
+
+    auto &columnDPProblems = instance.getColumnDPProblems();
+    if (columnDPProblems.size())
+    {
+        double totalCost = 0.0, totalDisplacement = 0.0, maxDisplacement = 0.0;
+        int numPlacedPUs = 0, numFallbacks = 0, numFailures = 0;
+        auto startTime = std::chrono::steady_clock::now();
+        for (auto &curProblem : columnDPProblems)
+        {
+            int numPlacedPUsBefore = numPlacedPUs;
+            bool solvedInBand =
+                replayColumnDPProblem(curProblem, totalCost, totalDisplacement, maxDisplacement, numPlacedPUs);
+            if (numPlacedPUs == numPlacedPUsBefore)
+                numFailures++;
+            else if (!solvedInBand && curProblem.bandWidth >= 0)
+                numFallbacks++;
+        }
+        double elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+        std::stringstream outputStream;
+        outputStream << "columnDP #columns=" << columnDPProblems.size() << " #PUs=" << numPlacedPUs
+                     << " cost=" << totalCost << " avgDisp=" << (numPlacedPUs ? totalDisplacement / numPlacedPUs : 0.0)
+                     << " maxDisp=" << maxDisplacement << " #fallbacks=" << numFallbacks
+                     << " #failures=" << numFailures << " time=" << elapsedSeconds << "s";
+        print_status(outputStream.str());
+    }
+
+    return 0;
+}
@@ -16,6 +16,7 @@
 #include "stringCheck.h"
 #include <algorithm>
 #include <assert.h>
+#include <cmath>
 
 bool siteSortCmp(DeviceInfo::DeviceSite *a, DeviceInfo::DeviceSite *b)
 {
@@ -147,6 +148,8 @@ DeviceInfo::DeviceInfo(std::map<std::string, std::string> &JSONCfg, std::string
         std::sort(tmpIt->second.begin(), tmpIt->second.end(), siteSortCmp);
     }
 
+    buildSiteOccupancyColumns();
+
     loadPCIEPinOffset(specialPinOffsetFileName);
 
     print_info("There are " + std::to_string(clockRegionNumY) + "x" + std::to_string(clockRegionNumX) +
@@ -247,6 +250,124 @@ void DeviceInfo::mapClockRegionToArray()
     }
 }
 
+void DeviceInfo::buildSiteOccupancyColumns()
+{
+    std::map<std::string, std::vector<DeviceSite *>> siteGrid2Sites;
+    for (auto curSite : sites)
+    {
+        auto &siteName = curSite->getName();
+        if (siteName.find('_') == std::string::npos)
+            continue;
+        std::string XYStr = siteName.substr(siteName.rfind('_') + 1);
+        if (XYStr.find('X') == std::string::npos || XYStr.find('Y') == std::string::npos)
+            continue;
+        siteGrid2Sites[siteName.substr(0, siteName.rfind('_'))].push_back(curSite);
+    }
+
+    for (auto &gridSites : siteGrid2Sites)
+    {
+        int numColumns = 0;
+        for (auto curSite : gridSites.second)
+            numColumns = std::max(numColumns, curSite->getSiteX() + 1);
+        std::vector<std::vector<DeviceSite *>> column2Sites(numColumns);
+        for (auto curSite : gridSites.second)
+            column2Sites[curSite->getSiteX()].push_back(curSite);
+
+        auto &occupancyColumns = siteGrid2OccupancyColumns[gridSites.first];
+        occupancyColumns.assign(numColumns, nullptr);
+        for (int siteX = 0; siteX < numColumns; siteX++)
+        {
+            if (column2Sites[siteX].empty())
+                continue;
+            int numRows = 0;
+            for (auto curSite : column2Sites[siteX])
+                numRows = std::max(numRows, curSite->getSiteY() + 1);
+            std::vector<bool> rowExists(numRows, false);
+            std::vector<float> rowYs(numRows, 0.0);
+            std::vector<DeviceSite *> rowSites(numRows, nullptr);
+            for (auto curSite : column2Sites[siteX])
+            {
+                // only the first site of a row is tracked if multiple sites have the same name prefix and SiteX/SiteY
+                if (rowExists[curSite->getSiteY()])
+                    continue;
+                rowExists[curSite->getSiteY()] = true;
+                rowYs[curSite->getSiteY()] = curSite->Y();
+                rowSites[curSite->getSiteY()] = curSite;
+            }
+            occupancyColumns[siteX] = new SiteColumnOccupancy(rowExists, rowYs);
+            for (auto curSite : rowSites)
+            {
+                if (curSite)
+                    curSite->setOccupancyColumn(occupancyColumns[siteX]);
+            }
+        }
+    }
+}
+
+DeviceInfo::SiteColumnOccupancy::SiteColumnOccupancy(std::vector<bool> &rowExists, std::vector<float> &rowYs)
+{
+    assert(rowExists.size() == rowYs.size());
+    int numRows = rowExists.size();
+    // the rows with sites are initially available and the sites update them once they are occupied or mapped
+    rowAvailable.assign(numRows, 0);
+    availableCountTree.assign(numRows + 1, 0);
+    for (int row = 0; row < numRows; row++)
+    {
+        rowAvailable[row] = rowExists[row];
+        // build the Fenwick tree in linear time by passing each node's count to its parent
+        int i = row + 1;
+        availableCountTree[i] += rowAvailable[row];
+        int parent = i + (i & (-i));
+        if (parent <= numRows)
+            availableCountTree[parent] += availableCountTree[i];
+    }
+
+    std::vector<std::pair<float, int>> YAndRows;
+    for (int row = 0; row < numRows; row++)
+    {
+        if (rowExists[row])
+            YAndRows.emplace_back(rowYs[row], row);
+    }
+    std::sort(YAndRows.begin(), YAndRows.end());
+    for (auto &YAndRow : YAndRows)
+    {
+        if (sortedRows.size() && sortedRows.back() > YAndRow.second)
+            rowsInYOrder = false;
+        sortedYs.push_back(YAndRow.first);
+        sortedRows.push_back(YAndRow.second);
+    }
+}
+
+void DeviceInfo::SiteColumnOccupancy::setRowAvailable(int row, bool available)
+{
+    assert(row >= 0 && row < (int)rowAvailable.size());
+    if ((bool)rowAvailable[row] == available)
+        return;
+    rowAvailable[row] = available;
+    int delta = available ? 1 : -1;
+    for (int i = row + 1; i < (int)availableCountTree.size(); i += i & (-i))
+        availableCountTree[i] += delta;
+}
+
+bool DeviceInfo::SiteColumnOccupancy::isSpanAvailable(float bottomY, float topY, float tolerance)
+{
+    if (sortedYs.empty() || bottomY < sortedYs.front() - tolerance || topY > sortedYs.back() + tolerance)
+        return false;
+    int lowId = std::lower_bound(sortedYs.begin(), sortedYs.end(), bottomY - tolerance) - sortedYs.begin();
+    int highId = std::upper_bound(sortedYs.begin(), sortedYs.end(), topY + tolerance) - sortedYs.begin() - 1;
+    if (lowId > highId)
+        return true;
+    // the sites in the span must be consecutive rows, so a row without site in the span makes it unavailable
+    if (rowsInYOrder)
+        return isRangeAvailable(sortedRows[lowId], sortedRows[highId] - sortedRows[lowId] + 1);
+    for (int i = lowId; i <= highId; i++)
+    {
+        if (!rowAvailable[sortedRows[i]])
+            return false;
+    }
+    return true;
+}
+
 void DeviceInfo::ClockRegion::mapSiteToClockColumns()
 {
     assert(sites.size() > 0);
@@ -93,6 +93,109 @@ class DeviceInfo
     class ClockRegion;
     class ClockColumn;
 
+    /**
+     * @brief the occupancy of the sites in a column of a site grid
+     *
+     * A site grid is the set of sites sharing the same name prefix (e.g., RAMB18 for RAMB18_X7Y89), i.e., the sites
+     * whose SiteX/SiteY are in the same coordinate system. A row of the column corresponds to a SiteY and a site is
+     * available when it exists and it is neither occupied by fixed element nor mapped. The numbers of available rows
+     * are kept in a Fenwick tree, so both the update of a row and the check whether a macro can start at a row with a
+     * given height take O(log(#rows)). The counts are updated by the sites when their flags change (serially), while
+     * the queries can be made by multiple threads concurrently.
+     *
+     */
+    class SiteColumnOccupancy
+    {
+      public:
+        /**
+         * @brief Construct a new SiteColumnOccupancy object
+         *
+         * @param rowExists whether there is a site in each row (indexed by SiteY)
+         * @param rowYs the Y locations of the rows
+         */
+        SiteColumnOccupancy(std::vector<bool> &rowExists, std::vector<float> &rowYs);
+        ~SiteColumnOccupancy()
+        {
+        }
+
+        /**
+         * @brief update the availability of a row
+         *
+         * @param row the SiteY of the site
+         * @param available
+         */
+        void setRowAvailable(int row, bool available);
+
+        inline int getNumRows()
+        {
+            return rowAvailable.size();
+        }
+
+        /**
+         * @brief check whether all the rows from bottomRow to bottomRow+height-1 are available
+         *
+         * @param bottomRow
+         * @param height
+         * @return true if all of them are available
+         */
+        inline bool isRangeAvailable(int bottomRow, int height)
+        {
+            if (bottomRow < 0 || height <= 0 || bottomRow + height > (int)rowAvailable.size())
+                return false;
+            if (height == 1)
+                return rowAvailable[bottomRow];
+            return getAvailablePrefixCount(bottomRow + height) - getAvailablePrefixCount(bottomRow) == height;
+        }
+
+        /**
+         * @brief check whether a span in Y (e.g., the cells of a macro in the column) is within the column and all the
+         * sites located in it are available
+         *
+         * @param bottomY
+         * @param topY
+         * @param tolerance the Y difference allowed between the ends of the span and the sites
+         * @return true if the span is within the column and all the sites in it are available
+         */
+        bool isSpanAvailable(float bottomY, float topY, float tolerance = 0.01);
+
+      private:
+        std::vector<unsigned char> rowAvailable;
+
+        /**
+         * @brief the Fenwick tree of the available rows, where availableCountTree[i] (1-indexed) is the number of
+         * available rows in (i - lowbit(i), i]
+         *
+         */
+        std::vector<int> availableCountTree;
+
+        /**
+         * @brief the rows with sites and their Y locations, sorted by Y, for the lookup by location
+         *
+         */
+        std::vector<float> sortedYs;
+        std::vector<int> sortedRows;
+
+        /**
+         * @brief whether the rows are in the order of Y so the sites in a span of Y are a range of rows
+         *
+         */
+        bool rowsInYOrder = true;
+
+        /**
+         * @brief get the number of available rows below a row
+         *
+         * @param row
+         * @return int
+         */
+        inline int getAvailablePrefixCount(int row)
+        {
+            int count = 0;
+            for (int i = row; i > 0; i -= i & (-i))
+                count += availableCountTree[i];
+            return count;
+        }
+    };
+
     /**
      * @brief BEL(Basic Element of Logic), the smallest undividable element
      *
@@ -302,6 +405,7 @@ class DeviceInfo
         inline void setOccupied()
         {
             occupied = true;
+            updateOccupancy();
         }
 
         /**
@@ -317,10 +421,44 @@ class DeviceInfo
         inline void setMapped()
         {
             mapped = true;
+            updateOccupancy();
         }
         inline void resetMapped()
         {
             mapped = false;
+            updateOccupancy();
+        }
+
+        /**
+         * @brief check whether this site is neither occupied by fixed element nor mapped
+         *
+         * @return true
+         * @return false
+         */
+        inline bool isAvailable()
+        {
+            return !occupied && !mapped;
+        }
+
+        /**
+         * @brief set the column of the site grid containing this site, which tracks the availability of the site
+         *
+         * @param _occupancyColumn
+         */
+        inline void setOccupancyColumn(SiteColumnOccupancy *_occupancyColumn)
+        {
+            occupancyColumn = _occupancyColumn;
+            updateOccupancy();
+        }
+
+        /**
+         * @brief get the column of the site grid containing this site, where the row of this site is its SiteY
+         *
+         * @return SiteColumnOccupancy*
+         */
+        inline SiteColumnOccupancy *getOccupancyColumn()
+        {
+            return occupancyColumn;
         }
 
         inline int getSiteY()
@@ -393,6 +531,14 @@ class DeviceInfo
          *
          */
         bool mapped = false;
+
+        SiteColumnOccupancy *occupancyColumn = nullptr;
+
+        inline void updateOccupancy()
+        {
+            if (occupancyColumn)
+                occupancyColumn->setRowAvailable(siteY, isAvailable());
+        }
     };
 
     /**
@@ -806,6 +952,9 @@ class DeviceInfo
             delete site;
         for (auto tile : tiles)
             delete tile;
+        for (auto &gridColumns : siteGrid2OccupancyColumns)
+            for (auto occupancyColumn : gridColumns.second)
+                delete occupancyColumn;
     }
 
     void printStat(bool verbose = false);
@@ -1053,6 +1202,15 @@ class DeviceInfo
      */
     void mapClockRegionToArray();
 
+    /**
+     * @brief build the occupancy columns of the site grids and attach the sites to them
+     *
+     * The sites are grouped by the prefix of their names (e.g., RAMB18 for RAMB18_X7Y89) and then by their SiteX, so
+     * the availability of the sites can be queried by column and row without walking the site list.
+     *
+     */
+    void buildSiteOccupancyColumns();
+
     inline float getBoundaryTolerance()
     {
         return boundaryTolerance;
@@ -1159,6 +1317,12 @@ class DeviceInfo
     std::map<std::string, std::vector<DeviceSite *>> siteType2Sites;
     std::vector<DeviceSite *> sites;
 
+    /**
+     * @brief the occupancy columns of each site grid, indexed by SiteX (nullptr for the SiteX without site)
+     *
+     */
+    std::map<std::string, std::vector<SiteColumnOccupancy *>> siteGrid2OccupancyColumns;
+
     std::set<std::string> tileTypes;
     std::map<std::string, std::vector<DeviceTile *>> tileType2Tiles;
     std::vector<DeviceTile *> tiles;
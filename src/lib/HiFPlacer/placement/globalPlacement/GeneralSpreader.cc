@@ -14,10 +14,10 @@
 
 #include "GeneralSpreader.h"
 
+#include <algorithm>
 #include <cmath>
 #include <omp.h>
 #include <queue>
-#include <thread>
 
 GeneralSpreader::GeneralSpreader(PlacementInfo *placementInfo, std::map<std::string, std::string> &JSONCfg,
                                  std::string &sharedCellType, int currentIteration, float capacityShrinkRatio,
@@ -35,14 +35,49 @@ GeneralSpreader::GeneralSpreader(PlacementInfo *placementInfo, std::map<std::str
     {
         useSimpleExpland = JSONCfg["SpreaderSimpleExpland"] == "true";
     }
+    if (JSONCfg.find("SpreaderParallelRegionExpansion") != JSONCfg.end())
+    {
+        useParallelRegionExpansion = JSONCfg["SpreaderParallelRegionExpansion"] == "true";
+    }
+    if (JSONCfg.find("SpreaderHierarchicalBinGrid") != JSONCfg.end())
+    {
+        useHierarchicalBinGrid = JSONCfg["SpreaderHierarchicalBinGrid"] == "true";
+    }
+}
+
+void GeneralSpreader::setCoupledCellType(std::string &_coupledCellType)
+{
+    assert(!coupledBinGrid && "the coupled cell type should be set only once.");
+    coupledCellType = _coupledCellType;
+    coupledBinGrid = &placementInfo->getBinGrid(placementInfo->getSharedBELTypeId(coupledCellType));
+    assert(coupledBinGrid->size() == binGrid.size() && (*coupledBinGrid)[0].size() == binGrid[0].size());
+
+    cellId2HybridBinSlot.assign(placementInfo->getCellId2location().size(), -1);
+    hybridBinGrid.resize(binGrid.size());
+    for (unsigned int binY = 0; binY < binGrid.size(); binY++)
+    {
+        hybridBinGrid[binY].resize(binGrid[binY].size());
+        for (unsigned int binX = 0; binX < binGrid[binY].size(); binX++)
+        {
+            auto hybridBin = new PlacementInfo::PlacementHybridBinInfo(binGrid[binY][binX]);
+            hybridBin->setCellSlotTable(&cellId2HybridBinSlot);
+            hybridBin->mergeBin((*coupledBinGrid)[binY][binX]);
+            hybridBinGrid[binY][binX] = hybridBin;
+        }
+    }
+
+    // the bins of the coupled type are found by the flat sweep over the hybrid bins
+    useHierarchicalBinGrid = false;
 }
 
 void GeneralSpreader::spreadPlacementUnits(float forgetRatio, unsigned int spreadRegionBinSizeLimit)
 {
+    std::string spreadTypeStr = coupledBinGrid ? sharedCellType + "+" + coupledCellType : sharedCellType;
     if (verbose) // usually commented for debug
-        print_status("GeneralSpreader: starts to spreadPlacementUnits for type: [" + sharedCellType + "]");
+        print_status("GeneralSpreader: starts to spreadPlacementUnits for type: [" + spreadTypeStr + "]");
 
     std::deque<int> overflowBinNumQ;
+    std::vector<PlacementInfo::PlacementBinInfo *> touchedBins;
 
     int loopCnt = 0;
     // int nthreads = omp_get_num_threads();
@@ -51,15 +86,33 @@ void GeneralSpreader::spreadPlacementUnits(float forgetRatio, unsigned int sprea
     std::vector<int> historyTotalCellNum(0);
     while (true)
     {
-        if (loopCnt % 5 == 0)
+        if (loopCnt % 5 == 0 && useHierarchicalBinGrid)
+        {
+            // the statistics of the bins are reset by PlacementInfo::updateElementBinGrid(), so only the bins marked in
+            // the pyramid by findOverflowBins() since then can have their counters and shrink ratios changed
+            placementInfo->getBinPyramid(placementInfo->getSharedBELTypeId(sharedCellType))
+                ->collectAndClearTouchedBins(touchedBins);
+            for (auto curBin : touchedBins)
+            {
+                curBin->resetBinShrinkRatio();
+                curBin->resetNoOverflowCounter();
+                curBin->resetOverflowCounter();
+            }
+        }
+        else if (loopCnt % 5 == 0)
         {
-            for (auto &row : binGrid)
+            for (auto curGrid : {&binGrid, coupledBinGrid})
             {
-                for (auto curBin : row)
+                if (!curGrid)
+                    continue;
+                for (auto &row : *curGrid)
                 {
-                    curBin->resetBinShrinkRatio();
-                    curBin->resetNoOverflowCounter();
-                    curBin->resetOverflowCounter();
+                    for (auto curBin : row)
+                    {
+                        curBin->resetBinShrinkRatio();
+                        curBin->resetNoOverflowCounter();
+                        curBin->resetOverflowCounter();
+                    }
                 }
             }
         }
@@ -78,7 +131,11 @@ void GeneralSpreader::spreadPlacementUnits(float forgetRatio, unsigned int sprea
             break;
         int totalCellNum = 0;
         for (auto curBin : overflowBins)
+        {
             totalCellNum += curBin->getCells().size();
+            if (coupledBinGrid)
+                totalCellNum += (*coupledBinGrid)[curBin->Y()][curBin->X()]->getCells().size();
+        }
 
         if (verbose) // usually commented for debug
         {
@@ -86,137 +143,133 @@ void GeneralSpreader::spreadPlacementUnits(float forgetRatio, unsigned int sprea
             print_info("found " + std::to_string(totalCellNum) + " cells in them");
             print_info("spread for " + std::to_string(loopCnt) + " iterations");
         }
-        coveredBinSet.clear();
+        coveredBinMap.reset(binGrid.size(), binGrid[0].size());
         expandedRegions.clear();
-        std::set<PlacementInfo::PlacementUnit *> involvedPUs;
-        std::set<DesignInfo::DesignCell *> involvedCells;
-        std::vector<PlacementInfo::PlacementUnit *> involvedPUVec;
-        involvedPUVec.clear();
-        involvedPUs.clear();
-        involvedCells.clear();
-        for (auto curBin : overflowBins)
+        startNewInvolvementEpoch();
+        if (useParallelRegionExpansion)
         {
-            if (coveredBinSet.find(curBin) != coveredBinSet.end())
-                continue;
-            GeneralSpreader::SpreadRegion *newRegion =
-                expandFromABin(curBin, capacityShrinkRatio, spreadRegionBinSizeLimit);
-            coveredBinSet.insert(curBin);
-            bool overlappedWithPreviousRegion = false;
-            for (auto curRegion : expandedRegions)
+            expandRegionsConcurrently(spreadRegionBinSizeLimit);
+        }
+        else
+        {
+            for (auto curBin : overflowBins)
             {
-                if (curRegion->isRegionOverlap(newRegion))
+                if (coveredBinMap.isCovered(curBin->Y(), curBin->X()))
+                    continue;
+                GeneralSpreader::SpreadRegion *newRegion =
+                    expandFromABin(curBin, capacityShrinkRatio, spreadRegionBinSizeLimit);
+                coveredBinMap.cover(curBin->Y(), curBin->X());
+                bool overlappedWithPreviousRegion = false;
+                for (auto curRegion : expandedRegions)
                 {
-                    overlappedWithPreviousRegion = true;
-                    std::cout << "newRegion: "
-                              << " left:" << newRegion->left() << " right:" << newRegion->right()
-                              << " top:" << newRegion->top() << " bottom:" << newRegion->bottom() << "\n";
-                    std::cout << "====================================================\n";
-                    for (auto curbin0 : newRegion->getBinsInRegion())
+                    if (curRegion->isRegionOverlap(newRegion))
                     {
-                        std::cout << "-----------------\n";
-                        std::cout << curbin0 << " sharedBELStr:" << curbin0->getSharedCellType()
-                                  << " X: " << curbin0->X() << " Y: " << curbin0->Y() << " left:" << curbin0->left()
-                                  << " right:" << curbin0->right() << " top:" << curbin0->top()
-                                  << " bottom:" << curbin0->bottom() << "\n";
-                    }
-                    std::cout << "\n\n\nexistingRegion: "
-                              << " left:" << curRegion->left() << " right:" << curRegion->right()
-                              << " top:" << curRegion->top() << " bottom:" << curRegion->bottom() << "\n";
-                    std::cout << "====================================================\n";
-                    for (auto curbin0 : curRegion->getBinsInRegion())
-                    {
-                        std::cout << "-----------------\n";
-                        std::cout << curbin0 << " sharedBELStr:" << curbin0->getSharedCellType()
-                                  << " X: " << curbin0->X() << " Y: " << curbin0->Y() << " left:" << curbin0->left()
-                                  << " right:" << curbin0->right() << " top:" << curbin0->top()
-                                  << " bottom:" << curbin0->bottom() << "\n";
+                        overlappedWithPreviousRegion = true;
+                        std::cout << "newRegion: "
+                                  << " left:" << newRegion->left() << " right:" << newRegion->right()
+                                  << " top:" << newRegion->top() << " bottom:" << newRegion->bottom() << "\n";
+                        std::cout << "====================================================\n";
+                        for (auto curbin0 : newRegion->getBinsInRegion())
+                        {
+                            std::cout << "-----------------\n";
+                            std::cout << curbin0 << " sharedBELStr:" << curbin0->getSharedCellType()
+                                      << " X: " << curbin0->X() << " Y: " << curbin0->Y() << " left:" << curbin0->left()
+                                      << " right:" << curbin0->right() << " top:" << curbin0->top()
+                                      << " bottom:" << curbin0->bottom() << "\n";
+                        }
+                        std::cout << "\n\n\nexistingRegion: "
+                                  << " left:" << curRegion->left() << " right:" << curRegion->right()
+                                  << " top:" << curRegion->top() << " bottom:" << curRegion->bottom() << "\n";
+                        std::cout << "====================================================\n";
+                        for (auto curbin0 : curRegion->getBinsInRegion())
+                        {
+                            std::cout << "-----------------\n";
+                            std::cout << curbin0 << " sharedBELStr:" << curbin0->getSharedCellType()
+                                      << " X: " << curbin0->X() << " Y: " << curbin0->Y() << " left:" << curbin0->left()
+                                      << " right:" << curbin0->right() << " top:" << curbin0->top()
+                                      << " bottom:" << curbin0->bottom() << "\n";
+                        }
+                        break;
                     }
-                    break;
                 }
-            }
-            if (!overlappedWithPreviousRegion)
-            {
-                coveredBinSet.insert(curBin);
-                expandedRegions.push_back(newRegion);
-            }
-            else
-            {
-                assert(false && "should not overlap");
-                delete newRegion;
+                if (!overlappedWithPreviousRegion)
+                {
+                    expandedRegions.push_back(newRegion);
+                }
+                else
+                {
+                    assert(false && "should not overlap");
+                    delete newRegion;
+                }
             }
         }
 
-        if (nJobs > 4)
-            omp_set_num_threads(
-                4); // we don't need that high parallelism here since regionNum will be small in later iterations
-#pragma omp parallel sections
+        if (verbose) // usually commented for debug
+            print_status("involved regions cover " + std::to_string(coveredBinMap.size()) + " bins.");
+        if (verbose)
         {
-#pragma omp section
-            {
-
-                if (verbose) // usually commented for debug
-                    print_status("involved regions cover " + std::to_string(coveredBinSet.size()) + " bins.");
-                if (verbose)
-                {
-                    print_status("GeneralSpreader: spreading cells in the regions");
-                }
+            print_status("GeneralSpreader: spreading cells in the regions");
+        }
 
-                int regionNum = expandedRegions.size();
-                if (coveredBinSet.size() > 256 && regionNum > 32)
+        // estimate the cost of each region by the cell sorting and the partitioning of the cell orders in its recursive
+        // bi-partitioning and start the expensive regions first to balance the load of the threads
+        int regionNum = expandedRegions.size();
+        std::vector<float> regionCosts(regionNum);
+        std::vector<int> sortedRegionIds(regionNum);
+        int totalRegionCellNum = 0;
+        for (int regionId = 0; regionId < regionNum; regionId++)
+        {
+            int cellNum =
+                expandedRegions[regionId]->getCells().size() + expandedRegions[regionId]->getCoupledCells().size();
+            regionCosts[regionId] = cellNum * std::log2(cellNum + 1.0);
+            sortedRegionIds[regionId] = regionId;
+            totalRegionCellNum += cellNum;
+        }
+        std::stable_sort(sortedRegionIds.begin(), sortedRegionIds.end(),
+                         [&regionCosts](int a, int b) -> bool { return regionCosts[a] > regionCosts[b]; });
+        if (cellPartitionMarks.size() != placementInfo->getCellId2location().size())
+            cellPartitionMarks.assign(placementInfo->getCellId2location().size(), 0);
+
+        bool parallelSubBoxes = nJobs > 1 && totalRegionCellNum >= SpreadRegion::SubBox::minCellNumForParallelBox;
+#pragma omp parallel num_threads(nJobs) if (parallelSubBoxes)
+#pragma omp single
+        {
+            // the SubBox(s) of regions are spread by tasks and the independent halves of a bi-partitioning will be
+            // further spread by new tasks if they are large enough (see SubBox::spreadAndPartition())
+            for (int regionId : sortedRegionIds)
+            {
+#pragma omp task firstprivate(regionId)
                 {
-#pragma omp parallel for schedule(dynamic, 4)
-                    for (int regionId = 0; regionId < regionNum; regionId++)
+                    GeneralSpreader::SpreadRegion *curRegion = expandedRegions[regionId];
+                    assert(curRegion);
+                    assert(curRegion->getCells().size() + curRegion->getCoupledCells().size() > 0);
+                    if (curRegion->getCells().size())
                     {
-                        GeneralSpreader::SpreadRegion *curRegion = expandedRegions[regionId];
-                        assert(curRegion);
-                        assert(curRegion->getCells().size() > 0);
                         SpreadRegion::SubBox *newBox =
-                            new SpreadRegion::SubBox(placementInfo, curRegion, binGrid, capacityShrinkRatio, 100, true);
+                            new SpreadRegion::SubBox(placementInfo, curRegion, curRegion->getCells(), binGrid,
+                                                     cellPartitionMarks, capacityShrinkRatio, 100, true);
                         newBox->spreadAndPartition();
                         delete newBox;
                     }
-                }
-                else
-                {
-                    for (int regionId = 0; regionId < regionNum; regionId++)
+                    // the cells of the coupled type are spread in the same region according to their own bin grid
+                    if (curRegion->getCoupledCells().size())
                     {
-                        GeneralSpreader::SpreadRegion *curRegion = expandedRegions[regionId];
-                        assert(curRegion);
-                        assert(curRegion->getCells().size() > 0);
                         SpreadRegion::SubBox *newBox =
-                            new SpreadRegion::SubBox(placementInfo, curRegion, binGrid, capacityShrinkRatio, 100, true);
+                            new SpreadRegion::SubBox(placementInfo, curRegion, curRegion->getCoupledCells(),
+                                                     *coupledBinGrid, cellPartitionMarks, capacityShrinkRatio, 100, true);
                         newBox->spreadAndPartition();
                         delete newBox;
                     }
                 }
             }
-#pragma omp section
-            {
-                if (verbose)
-                    print_status("GeneralSpreader: loading involved placement units");
 
-                for (auto curRegion : expandedRegions)
-                {
-                    assert(curRegion);
-                    assert(curRegion->getCells().size() > 0);
-                    for (auto curCell : curRegion->getCells())
-                    {
-                        if (involvedCells.find(curCell) == involvedCells.end())
-                        {
-                            auto tmpPU = placementInfo->getPlacementUnitByCell(curCell);
-                            if (involvedPUs.find(tmpPU) == involvedPUs.end())
-                            {
-                                involvedPUs.insert(tmpPU);
-                                involvedPUVec.push_back(tmpPU);
-                            }
-                            involvedCells.insert(curCell);
-                        }
-                    }
-                }
-            }
-        }
+            // the involved placement units are loaded while the cells are being spread
+            if (verbose)
+                print_status("GeneralSpreader: loading involved placement units");
 
-        omp_set_num_threads(nJobs);
+            collectInvolvedPlacementUnits();
+#pragma omp taskwait
+        }
 
         for (auto curRegion : expandedRegions)
         {
@@ -225,7 +278,7 @@ void GeneralSpreader::spreadPlacementUnits(float forgetRatio, unsigned int sprea
 
         if (verbose)
             print_status("GeneralSpreader: updating Placement Units With Spreaded Cell Locations");
-        updatePlacementUnitsWithSpreadedCellLocations(involvedPUs, involvedCells, involvedPUVec, forgetRatio);
+        updatePlacementUnitsWithSpreadedCellLocations(forgetRatio);
         if (verbose)
             print_status("GeneralSpreader: updated Placement Units With Spreaded Cell Locations");
         dumpLUTFFCoordinate();
@@ -234,7 +287,8 @@ void GeneralSpreader::spreadPlacementUnits(float forgetRatio, unsigned int sprea
     if (verbose)
         print_status("GeneralSpreader: processed all overflow regions");
 
-    recordSpreadedCellLocations();
+    if (recordSpreadedLocations)
+        recordSpreadedCellLocations();
 
     if (JSONCfg.find("Dump Cell Density") != JSONCfg.end())
     {
@@ -242,298 +296,316 @@ void GeneralSpreader::spreadPlacementUnits(float forgetRatio, unsigned int sprea
     }
     dumpLUTFFCoordinate();
 
-    print_status("GeneralSpreader: accomplished spreadPlacementUnits for type: [" + sharedCellType + "]");
+    print_status("GeneralSpreader: accomplished spreadPlacementUnits for type: [" + spreadTypeStr + "]");
 }
 
-bool siteSortCmp(PlacementInfo::PlacementBinInfo *a, PlacementInfo::PlacementBinInfo *b)
+void GeneralSpreader::shrinkMemoryPools(int nJobs)
 {
-    return (a->getUtilizationRate() > b->getUtilizationRate());
+    SpreaderObjectPool<SpreadRegion>::requestShrink();
+    SpreaderObjectPool<SpreadRegion::SubBox>::requestShrink();
+    SpreaderVectorPool<PlacementInfo::PlacementBinInfo *>::requestShrink();
+    SpreaderVectorPool<DesignInfo::DesignCell *>::requestShrink();
+    SpreaderVectorPool<int>::requestShrink();
+    SpreaderVectorPool<float>::requestShrink();
+
+    // the pools are thread-local, so each thread of the team drops its own idle memory
+#pragma omp parallel num_threads(nJobs)
+    {
+        SpreaderObjectPool<SpreadRegion>::applyPendingShrink();
+        SpreaderObjectPool<SpreadRegion::SubBox>::applyPendingShrink();
+        SpreaderVectorPool<PlacementInfo::PlacementBinInfo *>::applyPendingShrink();
+        SpreaderVectorPool<DesignInfo::DesignCell *>::applyPendingShrink();
+        SpreaderVectorPool<int>::applyPendingShrink();
+        SpreaderVectorPool<float>::applyPendingShrink();
+    }
 }
 
-void GeneralSpreader::findOverflowBins(float overflowThreshold)
+void GeneralSpreader::updateOverflowCounters(PlacementInfo::PlacementBinInfo *curBin, bool overflow)
 {
-    overflowBins.clear();
-    overflowBinSet.clear();
-    for (auto &row : binGrid)
+    if (overflow)
     {
-        for (auto curBin : row)
+        curBin->countOverflow();
+        if (curBin->getOverflowCounter() > 5)
         {
-            if (curBin->isOverflow(overflowThreshold))
+            if (curBin->getBinShrinkRatio() > 0.8)
             {
-                overflowBins.push_back(curBin);
-                overflowBinSet.insert(curBin);
-                curBin->countOverflow();
-                if (curBin->getOverflowCounter() > 5)
-                {
-                    if (curBin->getBinShrinkRatio() > 0.8)
-                    {
-                        curBin->shrinkBinBy(0.015);
-                    }
-                    else
-                    {
-                        curBin->resetBinShrinkRatio();
-                    }
-                    curBin->resetOverflowCounter();
-                }
+                curBin->shrinkBinBy(0.015);
             }
             else
             {
-                curBin->countNoOverflow();
-                curBin->resetOverflowCounter();
-                if (curBin->getNoOverflowCounter() > 5)
-                {
-                    curBin->resetBinShrinkRatio();
-                }
+                curBin->resetBinShrinkRatio();
             }
+            curBin->resetOverflowCounter();
+        }
+    }
+    else
+    {
+        curBin->countNoOverflow();
+        curBin->resetOverflowCounter();
+        if (curBin->getNoOverflowCounter() > 5)
+        {
+            curBin->resetBinShrinkRatio();
         }
     }
-    sort(overflowBins.begin(), overflowBins.end(), siteSortCmp);
 }
 
-void GeneralSpreader::updatePlacementUnitsWithSpreadedCellLocationsWorker(
-    PlacementInfo *placementInfo, std::set<PlacementInfo::PlacementUnit *> &involvedPUs,
-    std::set<DesignInfo::DesignCell *> &involvedCells, std::vector<PlacementInfo::PlacementUnit *> &involvedPUVec,
-    float forgetRatio, int startId, int endId)
+void GeneralSpreader::findOverflowBins(float overflowThreshold)
 {
-    std::vector<PlacementInfo::Location> &cellLoc = placementInfo->getCellId2location();
-    for (int curPUID = startId; curPUID < endId; curPUID++)
+    int binNumY = binGrid.size();
+    int binNumX = binGrid[0].size();
+    int binNum = binNumY * binNumX;
+    binUtilizationRates.resize(binNum);
+    binOverflowFlags.resize(binNum);
+    overflowBinIds.clear();
+
+    if (useHierarchicalBinGrid)
     {
-        assert((unsigned int)curPUID < involvedPUVec.size());
-        auto curPU = involvedPUVec[curPUID];
-        if (auto curUnpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU))
+        // only the nodes of the bin pyramid containing overflow bins are refined down to the bins, so the work scales
+        // with the congested area. The counters of the bins in the clean area are left as they are, and the bins
+        // whose counters are updated are marked in the pyramid so they can be reset periodically in
+        // spreadPlacementUnits().
+        auto binPyramid = placementInfo->getBinPyramid(placementInfo->getSharedBELTypeId(sharedCellType));
+        binPyramid->collectOverflowBins(overflowThreshold, overflowBins);
+        for (auto curBin : overflowBins)
         {
-            float cellX = curUnpackedCell->X();
-            float cellY = curUnpackedCell->Y();
-            DesignInfo::DesignCell *curCell = curUnpackedCell->getCell();
-            if (curPU->isFixed() || curPU->isLocked())
-            {
-                cellLoc[curCell->getCellId()].X = cellX;
-                cellLoc[curCell->getCellId()].Y = cellY;
-            }
-            else
-            {
-                makeCellInLegalArea(placementInfo, cellLoc[curCell->getCellId()].X, cellLoc[curCell->getCellId()].Y);
-                curPU->setSpreadLocation(cellLoc[curCell->getCellId()].X, cellLoc[curCell->getCellId()].Y, forgetRatio);
-                placementInfo->transferCellBinInfo(curCell->getCellId(), curPU->X(), curPU->Y());
-                cellLoc[curCell->getCellId()].X = curPU->X();
-                cellLoc[curCell->getCellId()].Y = curPU->Y();
-            }
+            int binId = curBin->Y() * binNumX + curBin->X();
+            binPyramid->markBinTouched(curBin->X(), curBin->Y());
+            updateOverflowCounters(curBin, true);
+            binUtilizationRates[binId] = curBin->getUtilizationRate();
+            overflowBinIds.push_back(binId);
         }
-        else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curPU))
+    }
+    else if (coupledBinGrid)
+    {
+        // a hybrid bin is overflowed if any of the types sharing its sites is overflowed, while the counters and the
+        // shrink ratios are maintained for the bins of each type
+#pragma omp parallel for schedule(static) num_threads(nJobs) if (nJobs > 1 && binNum >= minBinNumForParallelSweep)
+        for (int binId = 0; binId < binNum; binId++)
         {
-            if (curPU->isFixed() || curPU->isLocked())
+            auto hybridBin = hybridBinGrid[binId / binNumX][binId % binNumX];
+            bool overflow = false;
+            for (auto curBin : hybridBin->getMergedBins())
             {
-                for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
-                {
-                    float offsetX_InMacro, offsetY_InMacro;
-                    DesignInfo::DesignCellType cellType;
-                    curMacro->getVirtualCellInfo(vId, offsetX_InMacro, offsetY_InMacro, cellType);
-
-                    float cellX = curMacro->X() + offsetX_InMacro;
-                    float cellY = curMacro->Y() + offsetY_InMacro;
+                bool binOverflow = curBin->isOverflow(overflowThreshold);
+                updateOverflowCounters(curBin, binOverflow);
+                overflow |= binOverflow;
+            }
+            if (overflow)
+                binUtilizationRates[binId] = hybridBin->getCoupledUtilizationRate();
+            binOverflowFlags[binId] = overflow;
+        }
 
-                    DesignInfo::DesignCell *curCell = curMacro->getCell(vId);
+        for (int binId = 0; binId < binNum; binId++)
+        {
+            if (binOverflowFlags[binId])
+                overflowBinIds.push_back(binId);
+        }
+    }
+    else
+    {
+        // the bins are independent so their overflow states and counters are updated in a single (parallel) sweep over
+        // the row-major bin ids and the results are kept in flat arrays
+#pragma omp parallel for schedule(static) num_threads(nJobs) if (nJobs > 1 && binNum >= minBinNumForParallelSweep)
+        for (int binId = 0; binId < binNum; binId++)
+        {
+            auto curBin = binGrid[binId / binNumX][binId % binNumX];
+            bool overflow = curBin->isOverflow(overflowThreshold);
+            updateOverflowCounters(curBin, overflow);
+            if (overflow)
+                binUtilizationRates[binId] = curBin->getUtilizationRate();
+            binOverflowFlags[binId] = overflow;
+        }
 
-                    cellLoc[curCell->getCellId()].X = cellX;
-                    cellLoc[curCell->getCellId()].Y = cellY;
-                }
-            }
-            else
-            {
-                double tmpTotalX = 0.0;
-                double tmpTotalY = 0.0;
+        for (int binId = 0; binId < binNum; binId++)
+        {
+            if (binOverflowFlags[binId])
+                overflowBinIds.push_back(binId);
+        }
+    }
 
-                int numCellsInvolvedInSpreading = 0;
-                for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
-                {
-                    DesignInfo::DesignCell *curCell = curMacro->getCell(vId);
-                    if (involvedCells.find(curCell) != involvedCells.end())
-                    {
-                        float offsetX_InMacro, offsetY_InMacro;
-                        DesignInfo::DesignCellType cellType;
-                        curMacro->getVirtualCellInfo(vId, offsetX_InMacro, offsetY_InMacro, cellType);
-                        makeCellInLegalArea(placementInfo, cellLoc[curCell->getCellId()].X,
-                                            cellLoc[curCell->getCellId()].Y);
-                        tmpTotalX += cellLoc[curCell->getCellId()].X - offsetX_InMacro;
-                        tmpTotalY += cellLoc[curCell->getCellId()].Y - offsetY_InMacro;
-                        numCellsInvolvedInSpreading++;
-                    }
-                }
-                tmpTotalX /= (double)numCellsInvolvedInSpreading;
-                tmpTotalY /= (double)numCellsInvolvedInSpreading;
-
-                float curNewPUX = tmpTotalX;
-                float curNewPUY = tmpTotalY;
-                placementInfo->legalizeXYInArea(curPU, curNewPUX, curNewPUY);
-                curPU->setSpreadLocation(curNewPUX, curNewPUY, forgetRatio);
-                placementInfo->enforceLegalizeXYInArea(curPU);
-                for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
-                {
-                    float offsetX_InMacro, offsetY_InMacro;
-                    DesignInfo::DesignCellType cellType;
-                    curMacro->getVirtualCellInfo(vId, offsetX_InMacro, offsetY_InMacro, cellType);
+    // the most congested bins are handled first and the ties are broken by the bin ids so the order is deterministic
+    std::sort(overflowBinIds.begin(), overflowBinIds.end(), [this](int a, int b) -> bool {
+        return binUtilizationRates[a] > binUtilizationRates[b] ||
+               (binUtilizationRates[a] == binUtilizationRates[b] && a < b);
+    });
 
-                    float cellX = curMacro->X() + offsetX_InMacro;
-                    float cellY = curMacro->Y() + offsetY_InMacro;
+    overflowBins.clear();
+    for (auto binId : overflowBinIds)
+        overflowBins.push_back(binGrid[binId / binNumX][binId % binNumX]);
+}
 
-                    DesignInfo::DesignCell *curCell = curMacro->getCell(vId);
-                    placementInfo->transferCellBinInfo(curCell->getCellId(), cellX, cellY);
-                    cellLoc[curCell->getCellId()].X = cellX;
-                    cellLoc[curCell->getCellId()].Y = cellY;
-                }
-            }
-        }
+void GeneralSpreader::startNewInvolvementEpoch()
+{
+    involvedPUVec.clear();
+    if (PUId2InvolvedEpoch.size() != placementInfo->getPlacementUnits().size())
+        PUId2InvolvedEpoch.assign(placementInfo->getPlacementUnits().size(), involvedEpoch);
+    if (cellId2InvolvedEpoch.size() != placementInfo->getCellId2location().size())
+        cellId2InvolvedEpoch.assign(placementInfo->getCellId2location().size(), involvedEpoch);
+    involvedEpoch++;
+    if (involvedEpoch == 0)
+    {
+        // the stamps wrap around so the stale stamps should be cleared
+        std::fill(PUId2InvolvedEpoch.begin(), PUId2InvolvedEpoch.end(), 0);
+        std::fill(cellId2InvolvedEpoch.begin(), cellId2InvolvedEpoch.end(), 0);
+        involvedEpoch = 1;
     }
 }
 
-void GeneralSpreader::updatePlacementUnitsWithSpreadedCellLocations(
-    std::set<PlacementInfo::PlacementUnit *> &involvedPUs, std::set<DesignInfo::DesignCell *> &involvedCells,
-    std::vector<PlacementInfo::PlacementUnit *> &involvedPUVec, float forgetRatio)
+void GeneralSpreader::collectInvolvedPlacementUnits()
 {
-    if (involvedPUs.size() > 100)
+    for (auto curRegion : expandedRegions)
     {
-        std::vector<std::thread *> threadsVec;
-        threadsVec.clear();
-        int eachThreadPUNum = involvedPUVec.size() / nJobs;
-        std::vector<std::pair<int, int>> startEndPairs;
-        startEndPairs.clear();
-
-        for (int threadId = 0, startId = 0, endId = eachThreadPUNum; threadId < nJobs;
-             threadId++, startId += eachThreadPUNum, endId += eachThreadPUNum)
+        assert(curRegion);
+        assert(curRegion->getCells().size() + curRegion->getCoupledCells().size() > 0);
+        for (auto cellsInRegion : {&curRegion->getCells(), &curRegion->getCoupledCells()})
         {
-            if (threadId == nJobs - 1)
+            for (auto curCell : *cellsInRegion)
             {
-                endId = involvedPUVec.size();
+                if (cellId2InvolvedEpoch[curCell->getCellId()] == involvedEpoch)
+                    continue;
+                cellId2InvolvedEpoch[curCell->getCellId()] = involvedEpoch;
+                auto tmpPU = placementInfo->getPlacementUnitByCell(curCell);
+                assert(tmpPU->getId() < PUId2InvolvedEpoch.size());
+                if (PUId2InvolvedEpoch[tmpPU->getId()] != involvedEpoch)
+                {
+                    PUId2InvolvedEpoch[tmpPU->getId()] = involvedEpoch;
+                    involvedPUVec.push_back(tmpPU);
+                }
             }
-            startEndPairs.emplace_back(startId, endId);
         }
-        for (int threadId = 0; threadId < nJobs; threadId++)
+    }
+}
+
+void GeneralSpreader::updatePlacementUnitWithSpreadedCellLocations(PlacementInfo::PlacementUnit *curPU,
+                                                                   float forgetRatio)
+{
+    std::vector<PlacementInfo::Location> &cellLoc = placementInfo->getCellId2location();
+    if (curPU->getType() == PlacementInfo::PlacementUnitType_UnpackedCell)
+    {
+        auto curUnpackedCell = static_cast<PlacementInfo::PlacementUnpackedCell *>(curPU);
+        float cellX = curUnpackedCell->X();
+        float cellY = curUnpackedCell->Y();
+        DesignInfo::DesignCell *curCell = curUnpackedCell->getCell();
+        if (curPU->isFixed() || curPU->isLocked())
         {
-            std::thread *newThread = new std::thread(
-                GeneralSpreader::updatePlacementUnitsWithSpreadedCellLocationsWorker, placementInfo,
-                std::ref(involvedPUs), std::ref(involvedCells), std::ref(involvedPUVec), std::ref(forgetRatio),
-                std::ref(startEndPairs[threadId].first), std::ref(startEndPairs[threadId].second));
-            threadsVec.push_back(newThread);
+            cellLoc[curCell->getCellId()].X = cellX;
+            cellLoc[curCell->getCellId()].Y = cellY;
         }
-        for (int threadId = 0; threadId < nJobs; threadId++)
+        else
         {
-            threadsVec[threadId]->join();
-            delete threadsVec[threadId];
+            makeCellInLegalArea(placementInfo, cellLoc[curCell->getCellId()].X, cellLoc[curCell->getCellId()].Y);
+            curPU->setSpreadLocation(cellLoc[curCell->getCellId()].X, cellLoc[curCell->getCellId()].Y, forgetRatio);
+            cellLoc[curCell->getCellId()].X = curPU->X();
+            cellLoc[curCell->getCellId()].Y = curPU->Y();
         }
     }
     else
     {
-        std::vector<PlacementInfo::Location> &cellLoc = placementInfo->getCellId2location();
-        for (auto curPU : involvedPUVec)
+        assert(curPU->getType() == PlacementInfo::PlacementUnitType_Macro);
+        auto curMacro = static_cast<PlacementInfo::PlacementMacro *>(curPU);
+        if (!(curPU->isFixed() || curPU->isLocked()))
         {
-            if (auto curUnpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU))
+            double tmpTotalX = 0.0;
+            double tmpTotalY = 0.0;
+
+            int numCellsInvolvedInSpreading = 0;
+            for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
             {
-                float cellX = curUnpackedCell->X();
-                float cellY = curUnpackedCell->Y();
-                DesignInfo::DesignCell *curCell = curUnpackedCell->getCell();
-                if (curPU->isFixed() || curPU->isLocked())
-                {
-                    cellLoc[curCell->getCellId()].X = cellX;
-                    cellLoc[curCell->getCellId()].Y = cellY;
-                }
-                else
+                DesignInfo::DesignCell *curCell = curMacro->getCell(vId);
+                if (isCellInvolved(curCell))
                 {
+                    float offsetX_InMacro, offsetY_InMacro;
+                    DesignInfo::DesignCellType cellType;
+                    curMacro->getVirtualCellInfo(vId, offsetX_InMacro, offsetY_InMacro, cellType);
                     makeCellInLegalArea(placementInfo, cellLoc[curCell->getCellId()].X,
                                         cellLoc[curCell->getCellId()].Y);
-                    curPU->setSpreadLocation(cellLoc[curCell->getCellId()].X, cellLoc[curCell->getCellId()].Y,
-                                             forgetRatio);
-                    placementInfo->transferCellBinInfo(curCell->getCellId(), curPU->X(), curPU->Y());
-                    cellLoc[curCell->getCellId()].X = curPU->X();
-                    cellLoc[curCell->getCellId()].Y = curPU->Y();
+                    tmpTotalX += cellLoc[curCell->getCellId()].X - offsetX_InMacro;
+                    tmpTotalY += cellLoc[curCell->getCellId()].Y - offsetY_InMacro;
+                    numCellsInvolvedInSpreading++;
                 }
             }
-            else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curPU))
-            {
-                if (curPU->isFixed() || curPU->isLocked())
-                {
-                    for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
-                    {
-                        float offsetX_InMacro, offsetY_InMacro;
-                        DesignInfo::DesignCellType cellType;
-                        curMacro->getVirtualCellInfo(vId, offsetX_InMacro, offsetY_InMacro, cellType);
-
-                        float cellX = curMacro->X() + offsetX_InMacro;
-                        float cellY = curMacro->Y() + offsetY_InMacro;
-
-                        DesignInfo::DesignCell *curCell = curMacro->getCell(vId);
-
-                        cellLoc[curCell->getCellId()].X = cellX;
-                        cellLoc[curCell->getCellId()].Y = cellY;
-                    }
-                }
-                else
-                {
-                    double tmpTotalX = 0.0;
-                    double tmpTotalY = 0.0;
+            tmpTotalX /= (double)numCellsInvolvedInSpreading;
+            tmpTotalY /= (double)numCellsInvolvedInSpreading;
+
+            float curNewPUX = tmpTotalX;
+            float curNewPUY = tmpTotalY;
+            placementInfo->legalizeXYInArea(curPU, curNewPUX, curNewPUY);
+            curPU->setSpreadLocation(curNewPUX, curNewPUY, forgetRatio);
+            placementInfo->enforceLegalizeXYInArea(curPU);
+        }
+        for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
+        {
+            float offsetX_InMacro, offsetY_InMacro;
+            DesignInfo::DesignCellType cellType;
+            curMacro->getVirtualCellInfo(vId, offsetX_InMacro, offsetY_InMacro, cellType);
 
-                    int numCellsInvolvedInSpreading = 0;
-                    for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
-                    {
-                        DesignInfo::DesignCell *curCell = curMacro->getCell(vId);
-                        if (involvedCells.find(curCell) != involvedCells.end())
-                        {
-                            float offsetX_InMacro, offsetY_InMacro;
-                            DesignInfo::DesignCellType cellType;
-                            curMacro->getVirtualCellInfo(vId, offsetX_InMacro, offsetY_InMacro, cellType);
-                            makeCellInLegalArea(placementInfo, cellLoc[curCell->getCellId()].X,
-                                                cellLoc[curCell->getCellId()].Y);
-                            tmpTotalX += cellLoc[curCell->getCellId()].X - offsetX_InMacro;
-                            tmpTotalY += cellLoc[curCell->getCellId()].Y - offsetY_InMacro;
-                            numCellsInvolvedInSpreading++;
-                        }
-                    }
-                    tmpTotalX /= (double)numCellsInvolvedInSpreading;
-                    tmpTotalY /= (double)numCellsInvolvedInSpreading;
-                    float curNewPUX = tmpTotalX;
-                    float curNewPUY = tmpTotalY;
-                    placementInfo->legalizeXYInArea(curPU, curNewPUX, curNewPUY);
-                    curPU->setSpreadLocation(curNewPUX, curNewPUY, forgetRatio);
-                    placementInfo->enforceLegalizeXYInArea(curPU);
-                    for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
-                    {
-                        float offsetX_InMacro, offsetY_InMacro;
-                        DesignInfo::DesignCellType cellType;
-                        curMacro->getVirtualCellInfo(vId, offsetX_InMacro, offsetY_InMacro, cellType);
+            DesignInfo::DesignCell *curCell = curMacro->getCell(vId);
+            cellLoc[curCell->getCellId()].X = curMacro->X() + offsetX_InMacro;
+            cellLoc[curCell->getCellId()].Y = curMacro->Y() + offsetY_InMacro;
+        }
+    }
+}
 
-                        float cellX = curMacro->X() + offsetX_InMacro;
-                        float cellY = curMacro->Y() + offsetY_InMacro;
+void GeneralSpreader::updatePlacementUnitsWithSpreadedCellLocations(float forgetRatio)
+{
+    int involvedPUNum = involvedPUVec.size();
+#pragma omp parallel for schedule(dynamic, 64) num_threads(nJobs) if (nJobs > 1 && involvedPUNum > 100)
+    for (int PUId = 0; PUId < involvedPUNum; PUId++)
+    {
+        updatePlacementUnitWithSpreadedCellLocations(involvedPUVec[PUId], forgetRatio);
+    }
 
-                        DesignInfo::DesignCell *curCell = curMacro->getCell(vId);
-                        placementInfo->transferCellBinInfo(curCell->getCellId(), cellX, cellY);
-                        cellLoc[curCell->getCellId()].X = cellX;
-                        cellLoc[curCell->getCellId()].Y = cellY;
-                    }
-                }
+    // the bins are shared by the PlacementUnit(s) so the cells are transferred sequentially to keep the order of cells
+    // in bins deterministic
+    std::vector<PlacementInfo::Location> &cellLoc = placementInfo->getCellId2location();
+    for (auto curPU : involvedPUVec)
+    {
+        if (curPU->isFixed() || curPU->isLocked())
+            continue;
+        if (curPU->getType() == PlacementInfo::PlacementUnitType_UnpackedCell)
+        {
+            int cellId = static_cast<PlacementInfo::PlacementUnpackedCell *>(curPU)->getCell()->getCellId();
+            placementInfo->transferCellBinInfo(cellId, cellLoc[cellId].X, cellLoc[cellId].Y);
+        }
+        else
+        {
+            auto curMacro = static_cast<PlacementInfo::PlacementMacro *>(curPU);
+            for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
+            {
+                int cellId = curMacro->getCell(vId)->getCellId();
+                placementInfo->transferCellBinInfo(cellId, cellLoc[cellId].X, cellLoc[cellId].Y);
             }
         }
     }
 }
 
 GeneralSpreader::SpreadRegion *GeneralSpreader::expandFromABin(PlacementInfo::PlacementBinInfo *curBin,
-                                                               float capacityShrinkRatio, unsigned int numBinThr)
+                                                               float capacityShrinkRatio, unsigned int numBinThr,
+                                                               bool speculative)
 { // Our Region Expanding (1.4x faster)
     GeneralSpreader::SpreadRegion *resRegion =
-        new GeneralSpreader::SpreadRegion(curBin, placementInfo, binGrid, capacityShrinkRatio);
+        new GeneralSpreader::SpreadRegion(curBin, placementInfo, binGrid, capacityShrinkRatio, getHybridBinGridOrNull());
+    if (useParallelRegionExpansion)
+    {
+        // the expansion should not depend on which thread expands the region and when
+        resRegion->setRandomSeed((coveredBinMap.getBinIndex(curBin->Y(), curBin->X()) + 1) * 2654435761u);
+    }
+    resRegion->setSpeculative(speculative);
 
     if (!useSimpleExpland)
     {
         while (resRegion->getOverflowRatio() > capacityShrinkRatio &&
-               resRegion->smartFindExpandDirection(coveredBinSet) && resRegion->getBinsInRegion().size() < numBinThr)
+               resRegion->smartFindExpandDirection(coveredBinMap) && resRegion->getBinsInRegion().size() < numBinThr)
         {
-            resRegion->smartExpand(coveredBinSet);
+            resRegion->smartExpand(coveredBinMap);
         }
     }
     else
     {
         while (resRegion->getOverflowRatio() > capacityShrinkRatio &&
-               resRegion->simpleFindExpandDirection(coveredBinSet) && resRegion->getBinsInRegion().size() < numBinThr)
+               resRegion->simpleFindExpandDirection(coveredBinMap) && resRegion->getBinsInRegion().size() < numBinThr)
         {
-            resRegion->simpleExpand(coveredBinSet);
+            resRegion->simpleExpand(coveredBinMap);
         }
     }
 
@@ -541,6 +613,66 @@ GeneralSpreader::SpreadRegion *GeneralSpreader::expandFromABin(PlacementInfo::Pl
     return resRegion;
 }
 
+void GeneralSpreader::expandRegionsConcurrently(unsigned int spreadRegionBinSizeLimit)
+{
+    unsigned int batchSize = 4 * nJobs;
+    unsigned int nextOverflowBinId = 0;
+    int conflictCnt = 0;
+    std::vector<PlacementInfo::PlacementBinInfo *> seedBins;
+    std::vector<GeneralSpreader::SpreadRegion *> speculativeRegions;
+
+    while (nextOverflowBinId < overflowBins.size())
+    {
+        // pick the next batch of overflow bins which are not covered by the committed regions
+        seedBins.clear();
+        while (nextOverflowBinId < overflowBins.size() && seedBins.size() < batchSize)
+        {
+            auto curBin = overflowBins[nextOverflowBinId];
+            nextOverflowBinId++;
+            if (!coveredBinMap.isCovered(curBin->Y(), curBin->X()))
+                seedBins.push_back(curBin);
+        }
+
+        int seedNum = seedBins.size();
+        speculativeRegions.assign(seedNum, nullptr);
+#pragma omp parallel for schedule(dynamic, 1) num_threads(nJobs)
+        for (int seedId = 0; seedId < seedNum; seedId++)
+        {
+            speculativeRegions[seedId] =
+                expandFromABin(seedBins[seedId], capacityShrinkRatio, spreadRegionBinSizeLimit, true);
+        }
+
+        // validate and commit the regions in the order of overflow bins
+        for (int seedId = 0; seedId < seedNum; seedId++)
+        {
+            auto curBin = seedBins[seedId];
+            auto curRegion = speculativeRegions[seedId];
+            if (coveredBinMap.isCovered(curBin->Y(), curBin->X()))
+            {
+                // covered by a region committed earlier in this batch
+                delete curRegion;
+                continue;
+            }
+            if (curRegion->isSpeculationValid(coveredBinMap))
+            {
+                curRegion->commit(coveredBinMap);
+            }
+            else
+            {
+                delete curRegion;
+                conflictCnt++;
+                curRegion = expandFromABin(curBin, capacityShrinkRatio, spreadRegionBinSizeLimit);
+                coveredBinMap.cover(curBin->Y(), curBin->X());
+            }
+            expandedRegions.push_back(curRegion);
+        }
+    }
+
+    if (verbose)
+        print_info("GeneralSpreader: expanded " + std::to_string(expandedRegions.size()) +
+                   " regions concurrently with " + std::to_string(conflictCnt) + " conflicts");
+}
+
 // GeneralSpreader::SpreadRegion *GeneralSpreader::expandFromABin(PlacementInfo::PlacementBinInfo *curBin,
 //                                                                float capacityShrinkRatio)
 // { // RippleFPGA Region Expanding
@@ -548,9 +680,9 @@ GeneralSpreader::SpreadRegion *GeneralSpreader::expandFromABin(PlacementInfo::Pl
 //         new GeneralSpreader::SpreadRegion(curBin, placementInfo, binGrid, capacityShrinkRatio);
 
 //     while (resRegion->getOverflowRatio() > capacityShrinkRatio &&
-//     resRegion->simpleFindExpandDirection(coveredBinSet))
+//     resRegion->simpleFindExpandDirection(coveredBinMap))
 //     {
-//         resRegion->simpleExpand(coveredBinSet);
+//         resRegion->simpleExpand(coveredBinMap);
 //     }
 //     // assert(!resRegion->isOverflow() && "TODO: how to handle the situation that the resource is not enough.");
 //     return resRegion;
@@ -558,7 +690,7 @@ GeneralSpreader::SpreadRegion *GeneralSpreader::expandFromABin(PlacementInfo::Pl
 
 void GeneralSpreader::SpreadRegion::addBinRegion(int newRegionTopBinY, int newRegionBottomBinY, int newRegionLeftBinX,
                                                  int newRegionRightBinX,
-                                                 std::set<PlacementInfo::PlacementBinInfo *> &coveredBinSet)
+                                                 CoveredBinMap &coveredBinMap)
 {
     assert(!isRegionOverlap(newRegionTopBinY, newRegionBottomBinY, newRegionLeftBinX, newRegionRightBinX));
     if (newRegionTopBinY > topBinY)
@@ -581,19 +713,13 @@ void GeneralSpreader::SpreadRegion::addBinRegion(int newRegionTopBinY, int newRe
     for (int i = newRegionBottomBinY; i <= newRegionTopBinY; i++)
         for (int j = newRegionLeftBinX; j <= newRegionRightBinX; j++)
         {
-            assert(binSetInRegion.find(binGrid[i][j]) == binSetInRegion.end());
             assert(binGrid[i][j]->X() == j && binGrid[i][j]->Y() == i);
             binsInRegion.push_back(binGrid[i][j]);
-            binSetInRegion.insert(binGrid[i][j]);
-            assert(coveredBinSet.find(binGrid[i][j]) == coveredBinSet.end());
-            coveredBinSet.insert(binGrid[i][j]);
-            for (auto curCell : binGrid[i][j]->getCells())
-            {
-                cellsInRegion.insert(curCell);
-                cellsInRegionVec.push_back(curCell);
-            }
-            totalCapacity += binGrid[i][j]->getCapacity();
-            totalUtilization += binGrid[i][j]->getUtilization();
+            assert(!coveredBinMap.isCovered(i, j));
+            if (!speculative)
+                coveredBinMap.cover(i, j);
+            collectCellsInBin(i, j);
+            addBinCapacityAndUtilization(i, j, totalUtilization, totalCapacity);
         }
     overflowRatio = totalUtilization / totalCapacity;
 }
@@ -638,13 +764,24 @@ void GeneralSpreader::SpreadRegion::SubBox::spreadAndPartition()
             spreadCellsH(&boxA, &boxB);
         }
     }
-    if (boxA)
+    if (boxA && boxB && boxA->cellIdsX.size() + boxB->cellIdsX.size() >= (unsigned int)minCellNumForParallelBox)
     {
+        // the two halves are independent since their cells are disjoint
+#pragma omp task firstprivate(boxA)
         boxA->spreadAndPartition();
+        boxB->spreadAndPartition();
+#pragma omp taskwait
     }
-    if (boxB)
+    else
     {
-        boxB->spreadAndPartition();
+        if (boxA)
+        {
+            boxA->spreadAndPartition();
+        }
+        if (boxB)
+        {
+            boxB->spreadAndPartition();
+        }
     }
     if (boxA)
         delete boxA;
@@ -652,16 +789,54 @@ void GeneralSpreader::SpreadRegion::SubBox::spreadAndPartition()
         delete boxB;
 }
 
+void GeneralSpreader::SpreadRegion::SubBox::assignCellsToChildren(SubBox *boxA, SubBox *boxB, int cutLineId,
+                                                                   bool splitByX)
+{
+    std::vector<int> &splitOrder = splitByX ? cellIdsX : cellIdsY;
+    std::vector<int> &otherOrder = splitByX ? cellIdsY : cellIdsX;
+    std::vector<int> &boxASplitOrder = splitByX ? boxA->cellIdsX : boxA->cellIdsY;
+    std::vector<int> &boxAOtherOrder = splitByX ? boxA->cellIdsY : boxA->cellIdsX;
+    std::vector<int> &boxBSplitOrder = splitByX ? boxB->cellIdsX : boxB->cellIdsY;
+    std::vector<int> &boxBOtherOrder = splitByX ? boxB->cellIdsY : boxB->cellIdsX;
+
+    boxASplitOrder.assign(splitOrder.begin(), splitOrder.begin() + cutLineId + 1);
+    boxBSplitOrder.assign(splitOrder.begin() + cutLineId + 1, splitOrder.end());
+
+    // mark the cells of boxA so the other order can be partitioned stably even if many cells share the same location
+    for (auto cellId : boxASplitOrder)
+        cellPartitionMarks[cellId] = 1;
+    boxAOtherOrder.reserve(boxASplitOrder.size());
+    boxBOtherOrder.reserve(boxBSplitOrder.size());
+    for (auto cellId : otherOrder)
+    {
+        if (cellPartitionMarks[cellId])
+        {
+            boxAOtherOrder.push_back(cellId);
+            cellPartitionMarks[cellId] = 0;
+        }
+        else
+        {
+            boxBOtherOrder.push_back(cellId);
+        }
+    }
+    assert(boxAOtherOrder.size() == boxASplitOrder.size());
+
+    SpreaderVectorPool<int>::release(cellIdsX);
+    SpreaderVectorPool<int>::release(cellIdsY);
+}
+
 void GeneralSpreader::SpreadRegion::SubBox::spreadCellsH(SubBox **boxA, SubBox **boxB)
 {
     // refer to paper of POLAR and RippleFPGA
 
+    // the cells are maintained in the order of X location
+    std::vector<int> &cellIds = cellIdsX;
     if (cellIds.size() == 0)
         return;
-    if (cellIds.size() > 1)
-        quick_sort(cellIds, 0, cellIds.size() - 1, true);
 
-    std::vector<float> colCapacity(rightBinX - leftBinX + 1, 0.0);
+    PooledVector<float> colCapacityBuffer;
+    std::vector<float> &colCapacity = colCapacityBuffer.vec;
+    colCapacity.assign(rightBinX - leftBinX + 1, 0.0);
     float totalCapacity = 0;
 
     assert(leftBinX >= 0);
@@ -744,15 +919,16 @@ void GeneralSpreader::SpreadRegion::SubBox::spreadCellsH(SubBox **boxA, SubBox *
     }
 
     // assign cells into two subbox A and B
-    *boxA = new SubBox(this, topBinY, bottomBinY, boxALeft, boxARight, 0, cutLineIdX);
-    *boxB = new SubBox(this, topBinY, bottomBinY, boxBLeft, boxBRight, cutLineIdX + 1, cellIds.size() - 1);
+    *boxA = new SubBox(this, topBinY, bottomBinY, boxALeft, boxARight);
+    *boxB = new SubBox(this, topBinY, bottomBinY, boxBLeft, boxBRight);
+    assignCellsToChildren(*boxA, *boxB, cutLineIdX, true);
     std::vector<PlacementInfo::Location> &cellLoc = placementInfo->getCellId2location();
 
     float overallOverflowRatio = totalUtilization / totalCapacity;
     if (overallOverflowRatio < 1)
         overallOverflowRatio = 1;
 
-    std::vector<int> &boxACellIds = (*boxA)->cellIds;
+    std::vector<int> &boxACellIds = (*boxA)->cellIdsX;
     if (boxACellIds.size() > 0)
     {
         int cellInBinHead = boxACellIds.size() - 1;
@@ -816,7 +992,7 @@ void GeneralSpreader::SpreadRegion::SubBox::spreadCellsH(SubBox **boxA, SubBox *
         *boxA = nullptr;
     }
 
-    std::vector<int> &boxBCellIds = (*boxB)->cellIds;
+    std::vector<int> &boxBCellIds = (*boxB)->cellIdsX;
 
     if (boxBCellIds.size() > 0)
     {
@@ -889,13 +1065,14 @@ void GeneralSpreader::SpreadRegion::SubBox::spreadCellsH(SubBox **boxA, SubBox *
 void GeneralSpreader::SpreadRegion::SubBox::spreadCellsV(SubBox **boxA, SubBox **boxB)
 {
     // refer to paper of POLAR and RippleFPGA
+    // the cells are maintained in the order of Y location
+    std::vector<int> &cellIds = cellIdsY;
     if (cellIds.size() == 0)
         return;
 
-    if (cellIds.size() > 1)
-        quick_sort(cellIds, 0, cellIds.size() - 1, false);
-
-    std::vector<float> colCapacity(topBinY - bottomBinY + 1, 0.0);
+    PooledVector<float> colCapacityBuffer;
+    std::vector<float> &colCapacity = colCapacityBuffer.vec;
+    colCapacity.assign(topBinY - bottomBinY + 1, 0.0);
     float totalCapacity = 0;
 
     assert(leftBinX >= 0);
@@ -1004,14 +1181,15 @@ void GeneralSpreader::SpreadRegion::SubBox::spreadCellsV(SubBox **boxA, SubBox *
     }
 
     // assign cells into two subbox A and B
-    *boxA = new SubBox(this, boxATop, boxABottom, leftBinX, rightBinX, 0, cutLineIdX);
-    *boxB = new SubBox(this, boxBTop, boxBBottom, leftBinX, rightBinX, cutLineIdX + 1, cellIds.size() - 1);
+    *boxA = new SubBox(this, boxATop, boxABottom, leftBinX, rightBinX);
+    *boxB = new SubBox(this, boxBTop, boxBBottom, leftBinX, rightBinX);
+    assignCellsToChildren(*boxA, *boxB, cutLineIdX, false);
     std::vector<PlacementInfo::Location> &cellLoc = placementInfo->getCellId2location();
 
     float overallOverflowRatio = totalUtilization / totalCapacity;
     if (overallOverflowRatio < 1)
         overallOverflowRatio = 1;
-    std::vector<int> &boxACellIds = (*boxA)->cellIds;
+    std::vector<int> &boxACellIds = (*boxA)->cellIdsY;
 
     if (boxACellIds.size() > 0)
     {
@@ -1075,7 +1253,7 @@ void GeneralSpreader::SpreadRegion::SubBox::spreadCellsV(SubBox **boxA, SubBox *
         *boxA = nullptr;
     }
 
-    std::vector<int> &boxBCellIds = (*boxB)->cellIds;
+    std::vector<int> &boxBCellIds = (*boxB)->cellIdsY;
 
     if (boxBCellIds.size() > 0)
     {
@@ -1192,7 +1370,7 @@ void GeneralSpreader::dumpLUTFFCoordinate()
             std::stringstream outfile0;
             for (auto curPU : placementInfo->getPlacementUnits())
             {
-                if (auto curUnpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU))
+                if (auto curUnpackedCell = PlacementInfo::asUnpackedCell(curPU))
                 {
                     float cellX = curUnpackedCell->X();
                     float cellY = curUnpackedCell->Y();
@@ -1202,7 +1380,7 @@ void GeneralSpreader::dumpLUTFFCoordinate()
                         outfile0 << cellX << " " << cellY << " " << curCell->getName() << "\n";
                     }
                 }
-                else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curPU))
+                else if (auto curMacro = PlacementInfo::asMacro(curPU))
                 {
                     for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
                     {
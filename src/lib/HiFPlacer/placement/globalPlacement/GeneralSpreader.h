@@ -19,7 +19,9 @@
 #include "DesignInfo.h"
 #include "DeviceInfo.h"
 #include "PlacementInfo.h"
+#include "SpreaderMemoryPool.h"
 #include "dumpZip.h"
+#include <algorithm>
 #include <assert.h>
 #include <fstream>
 #include <iostream>
@@ -51,8 +53,24 @@ class GeneralSpreader
                     std::string &sharedCellType, int currentIteration, float capacityShrinkRatio, bool verbose = true);
     ~GeneralSpreader()
     {
+        for (auto &row : hybridBinGrid)
+            for (auto hybridBin : row)
+                delete hybridBin;
     }
 
+    /**
+     * @brief spread the cells of another shared cell type (e.g., SLICEL_FF for SLICEL_LUT) jointly with the cells
+     * of the spreader's type
+     *
+     * The bins of the two types at the same location are merged into a PlacementHybridBinInfo, so the overflow bins
+     * and the SpreadRegion(s) are determined by the coupled capacity of the shared sites. The cells of each type are
+     * then spread in the common SpreadRegion(s) according to the capacity of their own bin grid, and the
+     * PlacementUnit(s) are updated once for both types. It should be called before spreadPlacementUnits().
+     *
+     * @param _coupledCellType the shared cell type spread jointly
+     */
+    void setCoupledCellType(std::string &_coupledCellType);
+
     /**
      * @brief spread cells with a given forgetting ratio
      *
@@ -63,6 +81,84 @@ class GeneralSpreader
     void spreadPlacementUnits(float forgetRatio, unsigned int spreadRegionBinSizeLimit = 1000000);
     void dumpLUTFFCoordinate();
 
+    /**
+     * @brief CoveredBinMap is a dense bitmap over the bin grid, recording the bins which have been included in the
+     * SpreadRegion(s)
+     *
+     * It replaces a std::set of bins for the frequent coverage checks during the expansion of SpreadRegion(s).
+     *
+     */
+    class CoveredBinMap
+    {
+      public:
+        /**
+         * @brief clear the map and resize it to the given bin grid
+         *
+         * @param _numRows the number of rows in the bin grid
+         * @param _numCols the number of columns in the bin grid
+         */
+        inline void reset(int _numRows, int _numCols)
+        {
+            numRows = _numRows;
+            numCols = _numCols;
+            covered.assign(numRows * numCols, 0);
+            numCoveredBins = 0;
+        }
+
+        inline int getBinIndex(int binY, int binX) const
+        {
+            assert(binY >= 0 && binY < numRows && binX >= 0 && binX < numCols);
+            return binY * numCols + binX;
+        }
+
+        inline bool isCovered(int binIndex) const
+        {
+            return covered[binIndex];
+        }
+
+        inline bool isCovered(int binY, int binX) const
+        {
+            return covered[getBinIndex(binY, binX)];
+        }
+
+        inline void cover(int binY, int binX)
+        {
+            int binIndex = getBinIndex(binY, binX);
+            assert(!covered[binIndex]);
+            covered[binIndex] = 1;
+            numCoveredBins++;
+        }
+
+        /**
+         * @brief get the number of covered bins
+         *
+         * @return int
+         */
+        inline int size() const
+        {
+            return numCoveredBins;
+        }
+
+      private:
+        int numRows = 0;
+        int numCols = 0;
+        int numCoveredBins = 0;
+        std::vector<unsigned char> covered;
+    };
+
+    /**
+     * @brief Set whether the spreader should record the spreaded locations of ALL the PlacementUnits when it finishes
+     *
+     * The recording touches all the PlacementUnits in the design. When several spreaders run concurrently, the caller
+     * should disable it and record the spreaded locations once all the concurrent spreaders finish.
+     *
+     * @param _recordSpreadedLocations true to record the spreaded locations at the end of spreadPlacementUnits()
+     */
+    inline void setRecordSpreadedLocations(bool _recordSpreadedLocations)
+    {
+        recordSpreadedLocations = _recordSpreadedLocations;
+    }
+
     /**
      * @brief SpreadRegion is an object that record cell spreading region information, including boundaries, cells,
      * bins, and spreading boxes.
@@ -79,30 +175,90 @@ class GeneralSpreader
          * @param binGrid the reference of the binGrid for cell spreading. A bin grid is used to record the density of
          * cells on the device
          * @param capacityShrinkRatio shrink the area supply to a specific ratio
+         * @param hybridBinGrid the hybrid bins merging the bins of binGrid with the bins of a coupled type (nullptr if
+         * the cells of a single type are spread)
          */
         SpreadRegion(PlacementInfo::PlacementBinInfo *curBin, PlacementInfo *placementInfo,
-                     std::vector<std::vector<PlacementInfo::PlacementBinInfo *>> &binGrid, float capacityShrinkRatio)
-            : placementInfo(placementInfo), binGrid(binGrid), capacityShrinkRatio(capacityShrinkRatio)
+                     std::vector<std::vector<PlacementInfo::PlacementBinInfo *>> &binGrid, float capacityShrinkRatio,
+                     std::vector<std::vector<PlacementInfo::PlacementHybridBinInfo *>> *hybridBinGrid = nullptr)
+            : placementInfo(placementInfo), binGrid(binGrid), hybridBinGrid(hybridBinGrid),
+              capacityShrinkRatio(capacityShrinkRatio)
         {
             topBinY = bottomBinY = curBin->Y();
             leftBinX = rightBinX = curBin->X();
-            cellsInRegion.clear();
-            binsInRegion.clear();
-            cellsInRegionVec.clear();
-            binSetInRegion.clear();
+            SpreaderVectorPool<PlacementInfo::PlacementBinInfo *>::acquire(binsInRegion);
+            SpreaderVectorPool<DesignInfo::DesignCell *>::acquire(cellsInRegionVec);
+            SpreaderVectorPool<DesignInfo::DesignCell *>::acquire(coupledCellsInRegionVec);
+            SpreaderVectorPool<int>::acquire(speculativelyUncoveredBins);
             binsInRegion.push_back(curBin);
-            binSetInRegion.insert(curBin);
-            for (auto curCell : curBin->getCells())
+            collectCellsInBin(curBin->Y(), curBin->X());
+            totalCapacity = 0;
+            totalUtilization = 0;
+            addBinCapacityAndUtilization(curBin->Y(), curBin->X(), totalUtilization, totalCapacity);
+            overflowRatio = totalUtilization / totalCapacity;
+        }
+        ~SpreadRegion()
+        {
+            SpreaderVectorPool<PlacementInfo::PlacementBinInfo *>::release(binsInRegion);
+            SpreaderVectorPool<DesignInfo::DesignCell *>::release(cellsInRegionVec);
+            SpreaderVectorPool<DesignInfo::DesignCell *>::release(coupledCellsInRegionVec);
+            SpreaderVectorPool<int>::release(speculativelyUncoveredBins);
+        }
+
+        /**
+         * @brief accumulate the capacity and the utilization of a bin (the coupled ones for a hybrid bin grid)
+         *
+         * @param binY the row of the bin
+         * @param binX the column of the bin
+         * @param utilization the accumulated utilization
+         * @param capacity the accumulated capacity
+         */
+        inline void addBinCapacityAndUtilization(int binY, int binX, float &utilization, float &capacity)
+        {
+            if (hybridBinGrid)
+            {
+                auto hybridBin = (*hybridBinGrid)[binY][binX];
+                capacity += hybridBin->getCoupledCapacity();
+                utilization += hybridBin->getCoupledUtilization();
+            }
+            else
             {
-                cellsInRegion.insert(curCell);
+                capacity += binGrid[binY][binX]->getCapacity();
+                utilization += binGrid[binY][binX]->getUtilization();
+            }
+        }
+
+        /**
+         * @brief add the cells in a bin (and in the coupled bins at the same location) to the SpreadRegion
+         *
+         * @param binY the row of the bin
+         * @param binX the column of the bin
+         */
+        inline void collectCellsInBin(int binY, int binX)
+        {
+            for (auto curCell : binGrid[binY][binX]->getCells())
                 cellsInRegionVec.push_back(curCell);
+            if (hybridBinGrid)
+            {
+                auto &mergedBins = (*hybridBinGrid)[binY][binX]->getMergedBins();
+                for (unsigned int binId = 1; binId < mergedBins.size(); binId++)
+                    for (auto curCell : mergedBins[binId]->getCells())
+                        coupledCellsInRegionVec.push_back(curCell);
             }
-            totalCapacity = curBin->getCapacity();
-            totalUtilization = curBin->getUtilization();
-            overflowRatio = totalUtilization / totalCapacity;
         }
-        ~SpreadRegion()
+
+        /**
+         * @brief SpreadRegion(s) are created and deleted in every spreading loop so their memory blocks are recycled
+         * by a thread-local pool
+         *
+         */
+        static void *operator new(std::size_t size)
         {
+            return SpreaderObjectPool<SpreadRegion>::allocate(size);
+        }
+        static void operator delete(void *block, std::size_t size)
+        {
+            SpreaderObjectPool<SpreadRegion>::deallocate(block, size);
         }
 
         /**
@@ -149,10 +305,10 @@ class GeneralSpreader
          * @param newRegionBottomBinY
          * @param newRegionLeftBinX
          * @param newRegionRightBinX
-         * @param coveredBinSet
+         * @param coveredBinMap the map of bins which have been included in other SpreadRegion
          */
         void addBinRegion(int newRegionTopBinY, int newRegionBottomBinY, int newRegionLeftBinX, int newRegionRightBinX,
-                          std::set<PlacementInfo::PlacementBinInfo *> &coveredBinSet);
+                          CoveredBinMap &coveredBinMap);
 
         /**
          * @brief Get the bins in the SpreadRegion
@@ -248,18 +404,18 @@ class GeneralSpreader
          * @param newLeftBinX the left boundary after expansion
          * @param newRightBinX the right boundary after expansion
          * @param tmpDir a given direction
-         * @param coveredBinSet a set of bins which have been included in other SpreadRegion
+         * @param coveredBinMap the map of bins which have been included in other SpreadRegion
          * @return true when the expansion will be overlapped with some bins in another SpreadRegion
          * @return false when the expansion will NOT be overlapped with some bins in another SpreadRegion
          */
         inline bool isCovered(int newTopBinY, int newBottomBinY, int newLeftBinX, int newRightBinX, dirType tmpDir,
-                              std::set<PlacementInfo::PlacementBinInfo *> &coveredBinSet)
+                              CoveredBinMap &coveredBinMap)
         {
             if (tmpDir == expandUp)
             {
                 for (int binX = newLeftBinX; binX <= newRightBinX; binX++)
                 {
-                    if (coveredBinSet.find(binGrid[newTopBinY][binX]) != coveredBinSet.end())
+                    if (checkCovered(coveredBinMap, newTopBinY, binX))
                         return true;
                 }
             }
@@ -267,7 +423,7 @@ class GeneralSpreader
             {
                 for (int binX = newLeftBinX; binX <= newRightBinX; binX++)
                 {
-                    if (coveredBinSet.find(binGrid[newBottomBinY][binX]) != coveredBinSet.end())
+                    if (checkCovered(coveredBinMap, newBottomBinY, binX))
                         return true;
                 }
             }
@@ -275,7 +431,7 @@ class GeneralSpreader
             {
                 for (int binY = newBottomBinY; binY <= newTopBinY; binY++)
                 {
-                    if (coveredBinSet.find(binGrid[binY][newLeftBinX]) != coveredBinSet.end())
+                    if (checkCovered(coveredBinMap, binY, newLeftBinX))
                         return true;
                 }
             }
@@ -283,7 +439,7 @@ class GeneralSpreader
             {
                 for (int binY = newBottomBinY; binY <= newTopBinY; binY++)
                 {
-                    if (coveredBinSet.find(binGrid[binY][newRightBinX]) != coveredBinSet.end())
+                    if (checkCovered(coveredBinMap, binY, newRightBinX))
                         return true;
                 }
             }
@@ -309,39 +465,23 @@ class GeneralSpreader
             // tmpUtilization = 0.0;
             if (tmpDir == expandUp)
             {
-                //  for (int binY = newBottomBinY; binY <= newTopBinY; binY++)
                 for (int binX = newLeftBinX; binX <= newRightBinX; binX++)
-                {
-                    tmpCapacity += binGrid[newTopBinY][binX]->getCapacity();
-                    tmpUtilization += binGrid[newTopBinY][binX]->getUtilization();
-                }
+                    addBinCapacityAndUtilization(newTopBinY, binX, tmpUtilization, tmpCapacity);
             }
             else if (tmpDir == expandDown)
             {
-                //  for (int binY = newBottomBinY; binY <= newTopBinY; binY++)
                 for (int binX = newLeftBinX; binX <= newRightBinX; binX++)
-                {
-                    tmpCapacity += binGrid[newBottomBinY][binX]->getCapacity();
-                    tmpUtilization += binGrid[newBottomBinY][binX]->getUtilization();
-                }
+                    addBinCapacityAndUtilization(newBottomBinY, binX, tmpUtilization, tmpCapacity);
             }
             else if (tmpDir == expandLeft)
             {
                 for (int binY = newBottomBinY; binY <= newTopBinY; binY++)
-                //       for (int binX = newLeftBinX; binX <= newRightBinX; binX++)
-                {
-                    tmpCapacity += binGrid[binY][newLeftBinX]->getCapacity();
-                    tmpUtilization += binGrid[binY][newLeftBinX]->getUtilization();
-                }
+                    addBinCapacityAndUtilization(binY, newLeftBinX, tmpUtilization, tmpCapacity);
             }
             else if (tmpDir == expandRight)
             {
                 for (int binY = newBottomBinY; binY <= newTopBinY; binY++)
-                //         for (int binX = newLeftBinX; binX <= newRightBinX; binX++)
-                {
-                    tmpCapacity += binGrid[binY][newRightBinX]->getCapacity();
-                    tmpUtilization += binGrid[binY][newRightBinX]->getUtilization();
-                }
+                    addBinCapacityAndUtilization(binY, newRightBinX, tmpUtilization, tmpCapacity);
             }
             if (tmpCapacity < 1e-5)
                 tmpCapacity = 1e-5;
@@ -354,11 +494,11 @@ class GeneralSpreader
          *
          * evaluate the utilization/capacity of 4 legal directions
          *
-         * @param coveredBinSet a set of bins which have been included in other SpreadRegion
+         * @param coveredBinMap the map of bins which have been included in other SpreadRegion
          * @return true when there is legal direction to expand the SpreadRegion
          * @return false when there is NO legal direction to expand the SpreadRegion
          */
-        inline bool smartFindExpandDirection(std::set<PlacementInfo::PlacementBinInfo *> &coveredBinSet)
+        inline bool smartFindExpandDirection(CoveredBinMap &coveredBinMap)
         {
             int possibleCnt = 0;
 
@@ -379,7 +519,7 @@ class GeneralSpreader
                     {
                         // don't include the bins in other existing SpreadRegion
                         if (!isCovered(newTopBinY, newBottomBinY, newLeftBinX, newRightBinX,
-                                       static_cast<dirType>(tmpDir), coveredBinSet))
+                                       static_cast<dirType>(tmpDir), coveredBinMap))
                         {
                             // evaluate the utilization and capacity
                             getDirCapacityAndUtilization(newTopBinY, newBottomBinY, newLeftBinX, newRightBinX,
@@ -407,7 +547,7 @@ class GeneralSpreader
                                     if (newRightBinX < binGrid[newTopBinY].size() && newLeftBinX >= 0)
                                     {
                                         if (!isCovered(newTopBinY, newBottomBinY, newLeftBinX, newRightBinX,
-                                                       static_cast<dirType>(tmpDir), coveredBinSet))
+                                                       static_cast<dirType>(tmpDir), coveredBinMap))
                                         {
                                             getDirCapacityAndUtilization(newTopBinY, newBottomBinY, newLeftBinX,
                                                                          newRightBinX, static_cast<dirType>(tmpDir),
@@ -435,7 +575,7 @@ class GeneralSpreader
                                                     {
                                                         if (!isCovered(newTopBinY, newBottomBinY, newLeftBinX,
                                                                        newRightBinX, static_cast<dirType>(tmpDir),
-                                                                       coveredBinSet))
+                                                                       coveredBinMap))
                                                         {
                                                             getDirCapacityAndUtilization(
                                                                 newTopBinY, newBottomBinY, newLeftBinX, newRightBinX,
@@ -472,9 +612,9 @@ class GeneralSpreader
          * evaluate the 4 potential directions and select the direction, which can significantly reduce the overflow, to
          * conduct expansion
          *
-         * @param coveredBinSet a set of bins which have been included in other SpreadRegion
+         * @param coveredBinMap the map of bins which have been included in other SpreadRegion
          */
-        inline void smartExpand(std::set<PlacementInfo::PlacementBinInfo *> &coveredBinSet)
+        inline void smartExpand(CoveredBinMap &coveredBinMap)
         {
             float hCapacity = dir2capacity[0] + dir2capacity[1];
             float vCapacity = dir2capacity[2] + dir2capacity[3];
@@ -488,7 +628,7 @@ class GeneralSpreader
                 ((hUtilization / hCapacity < 0.9 * vUtilization / vCapacity) ||
                  (std::fabs(hUtilization + vUtilization) < 1e-4 && hCapacity > vCapacity)))
             {
-                if (random() % 2)
+                if (getRandom() % 2)
                 {
                     if (expandable(0))
                     {
@@ -499,7 +639,7 @@ class GeneralSpreader
                             unsigned int newTopBinY = topBinY + actualExpandOps[0].topYOp;
                             int newBottomBinY = bottomBinY + actualExpandOps[0].bottomYOp;
                             int newLeftBinX = leftBinX + actualExpandOps[0].leftXOp;
-                            addBinRegion(newTopBinY, newBottomBinY, newLeftBinX, leftBinX - 1, coveredBinSet);
+                            addBinRegion(newTopBinY, newBottomBinY, newLeftBinX, leftBinX - 1, coveredBinMap);
                             return;
                         }
                     }
@@ -512,7 +652,7 @@ class GeneralSpreader
                             unsigned int newTopBinY = topBinY + actualExpandOps[1].topYOp;
                             int newBottomBinY = bottomBinY + actualExpandOps[1].bottomYOp;
                             unsigned int newRightBinX = rightBinX + actualExpandOps[1].rightXOp;
-                            addBinRegion(newTopBinY, newBottomBinY, rightBinX + 1, newRightBinX, coveredBinSet);
+                            addBinRegion(newTopBinY, newBottomBinY, rightBinX + 1, newRightBinX, coveredBinMap);
                             return;
                         }
                     }
@@ -528,7 +668,7 @@ class GeneralSpreader
                             unsigned int newTopBinY = topBinY + actualExpandOps[1].topYOp;
                             int newBottomBinY = bottomBinY + actualExpandOps[1].bottomYOp;
                             unsigned int newRightBinX = rightBinX + actualExpandOps[1].rightXOp;
-                            addBinRegion(newTopBinY, newBottomBinY, rightBinX + 1, newRightBinX, coveredBinSet);
+                            addBinRegion(newTopBinY, newBottomBinY, rightBinX + 1, newRightBinX, coveredBinMap);
                             return;
                         }
                     }
@@ -541,7 +681,7 @@ class GeneralSpreader
                             unsigned int newTopBinY = topBinY + actualExpandOps[0].topYOp;
                             int newBottomBinY = bottomBinY + actualExpandOps[0].bottomYOp;
                             int newLeftBinX = leftBinX + actualExpandOps[0].leftXOp;
-                            addBinRegion(newTopBinY, newBottomBinY, newLeftBinX, leftBinX - 1, coveredBinSet);
+                            addBinRegion(newTopBinY, newBottomBinY, newLeftBinX, leftBinX - 1, coveredBinMap);
                             return;
                         }
                     }
@@ -554,7 +694,7 @@ class GeneralSpreader
                 unsigned int newRightBinX = rightBinX + actualExpandOps[0].rightXOp;
                 if (expandable(0))
                 {
-                    addBinRegion(newTopBinY, newBottomBinY, newLeftBinX, leftBinX - 1, coveredBinSet);
+                    addBinRegion(newTopBinY, newBottomBinY, newLeftBinX, leftBinX - 1, coveredBinMap);
                     expanded = true;
                 }
                 newTopBinY = topBinY + actualExpandOps[1].topYOp;
@@ -563,13 +703,13 @@ class GeneralSpreader
                 newRightBinX = rightBinX + actualExpandOps[1].rightXOp;
                 if (expandable(1))
                 {
-                    addBinRegion(newTopBinY, newBottomBinY, rightBinX + 1, newRightBinX, coveredBinSet);
+                    addBinRegion(newTopBinY, newBottomBinY, rightBinX + 1, newRightBinX, coveredBinMap);
                     expanded = true;
                 }
             }
             else
             {
-                if (random() % 2)
+                if (getRandom() % 2)
                 {
                     if (expandable(2))
                     {
@@ -580,7 +720,7 @@ class GeneralSpreader
                             unsigned int newTopBinY = topBinY + actualExpandOps[2].topYOp;
                             int newLeftBinX = leftBinX + actualExpandOps[2].leftXOp;
                             unsigned int newRightBinX = rightBinX + actualExpandOps[2].rightXOp;
-                            addBinRegion(newTopBinY, topBinY + 1, newLeftBinX, newRightBinX, coveredBinSet);
+                            addBinRegion(newTopBinY, topBinY + 1, newLeftBinX, newRightBinX, coveredBinMap);
                             return;
                         }
                     }
@@ -593,7 +733,7 @@ class GeneralSpreader
                             int newBottomBinY = bottomBinY + actualExpandOps[3].bottomYOp;
                             int newLeftBinX = leftBinX + actualExpandOps[3].leftXOp;
                             unsigned int newRightBinX = rightBinX + actualExpandOps[3].rightXOp;
-                            addBinRegion(bottomBinY - 1, newBottomBinY, newLeftBinX, newRightBinX, coveredBinSet);
+                            addBinRegion(bottomBinY - 1, newBottomBinY, newLeftBinX, newRightBinX, coveredBinMap);
                             return;
                         }
                     }
@@ -609,7 +749,7 @@ class GeneralSpreader
                             int newBottomBinY = bottomBinY + actualExpandOps[3].bottomYOp;
                             int newLeftBinX = leftBinX + actualExpandOps[3].leftXOp;
                             unsigned int newRightBinX = rightBinX + actualExpandOps[3].rightXOp;
-                            addBinRegion(bottomBinY - 1, newBottomBinY, newLeftBinX, newRightBinX, coveredBinSet);
+                            addBinRegion(bottomBinY - 1, newBottomBinY, newLeftBinX, newRightBinX, coveredBinMap);
                             return;
                         }
                     }
@@ -622,7 +762,7 @@ class GeneralSpreader
                             unsigned int newTopBinY = topBinY + actualExpandOps[2].topYOp;
                             int newLeftBinX = leftBinX + actualExpandOps[2].leftXOp;
                             unsigned int newRightBinX = rightBinX + actualExpandOps[2].rightXOp;
-                            addBinRegion(newTopBinY, topBinY + 1, newLeftBinX, newRightBinX, coveredBinSet);
+                            addBinRegion(newTopBinY, topBinY + 1, newLeftBinX, newRightBinX, coveredBinMap);
                             return;
                         }
                     }
@@ -635,7 +775,7 @@ class GeneralSpreader
                 unsigned int newRightBinX = rightBinX + actualExpandOps[2].rightXOp;
                 if (expandable(2))
                 {
-                    addBinRegion(newTopBinY, topBinY + 1, newLeftBinX, newRightBinX, coveredBinSet);
+                    addBinRegion(newTopBinY, topBinY + 1, newLeftBinX, newRightBinX, coveredBinMap);
                     expanded = true;
                 }
                 newTopBinY = topBinY + actualExpandOps[3].topYOp;
@@ -644,7 +784,7 @@ class GeneralSpreader
                 newRightBinX = rightBinX + actualExpandOps[3].rightXOp;
                 if (expandable(3))
                 {
-                    addBinRegion(bottomBinY - 1, newBottomBinY, newLeftBinX, newRightBinX, coveredBinSet);
+                    addBinRegion(bottomBinY - 1, newBottomBinY, newLeftBinX, newRightBinX, coveredBinMap);
                     expanded = true;
                 }
             }
@@ -668,14 +808,14 @@ class GeneralSpreader
         /**
          * @brief find the expansion direction iteratively in pre-defined order
          *
-         * @param coveredBinSet a set of bins which have been included in other SpreadRegion
+         * @param coveredBinMap the map of bins which have been included in other SpreadRegion
          * @return true when there is legal direction to expand the SpreadRegion
          * @return false when there is NO legal direction to expand the SpreadRegion
          */
-        inline bool simpleFindExpandDirection(std::set<PlacementInfo::PlacementBinInfo *> &coveredBinSet)
+        inline bool simpleFindExpandDirection(CoveredBinMap &coveredBinMap)
         {
             char failureCnt = 0;
-            curDirectionIndex = random() % 4;
+            curDirectionIndex = getRandom() % 4;
             while (failureCnt < 4)
             {
 
@@ -688,7 +828,7 @@ class GeneralSpreader
                     if (newRightBinX < binGrid[newTopBinY].size() && newLeftBinX >= 0)
                     {
                         if (!isCovered(newTopBinY, newBottomBinY, newLeftBinX, newRightBinX,
-                                       static_cast<dirType>(curDirectionIndex), coveredBinSet))
+                                       static_cast<dirType>(curDirectionIndex), coveredBinMap))
                         {
                             curDirection = static_cast<dirType>(curDirectionIndex);
                             curDirectionIndex = (curDirectionIndex + 1) % 4;
@@ -705,22 +845,22 @@ class GeneralSpreader
         /**
          * @brief select the the expansion direction which is found in a pre-defined order
          *
-         * @param coveredBinSet a set of bins which have been included in other SpreadRegion
+         * @param coveredBinMap the map of bins which have been included in other SpreadRegion
          */
-        inline void simpleExpand(std::set<PlacementInfo::PlacementBinInfo *> &coveredBinSet)
+        inline void simpleExpand(CoveredBinMap &coveredBinMap)
         {
             unsigned int newTopBinY = topBinY + expandOps[curDirection].topYOp;
             int newBottomBinY = bottomBinY + expandOps[curDirection].bottomYOp;
             int newLeftBinX = leftBinX + expandOps[curDirection].leftXOp;
             unsigned int newRightBinX = rightBinX + expandOps[curDirection].rightXOp;
             if (curDirection == expandUp)
-                addBinRegion(newTopBinY, newTopBinY, newLeftBinX, newRightBinX, coveredBinSet);
+                addBinRegion(newTopBinY, newTopBinY, newLeftBinX, newRightBinX, coveredBinMap);
             else if (curDirection == expandDown)
-                addBinRegion(newBottomBinY, newBottomBinY, newLeftBinX, newRightBinX, coveredBinSet);
+                addBinRegion(newBottomBinY, newBottomBinY, newLeftBinX, newRightBinX, coveredBinMap);
             else if (curDirection == expandLeft)
-                addBinRegion(newTopBinY, newBottomBinY, newLeftBinX, newLeftBinX, coveredBinSet);
+                addBinRegion(newTopBinY, newBottomBinY, newLeftBinX, newLeftBinX, coveredBinMap);
             else if (curDirection == expandRight)
-                addBinRegion(newTopBinY, newBottomBinY, newRightBinX, newRightBinX, coveredBinSet);
+                addBinRegion(newTopBinY, newBottomBinY, newRightBinX, newRightBinX, coveredBinMap);
         }
 
         /**
@@ -732,7 +872,75 @@ class GeneralSpreader
          */
         inline bool contains(PlacementInfo::PlacementBinInfo *curBin)
         {
-            return binSetInRegion.find(curBin) != binSetInRegion.end();
+            // a SpreadRegion is always a rectangle in the bin grid
+            return curBin->Y() >= bottomBinY && curBin->Y() <= topBinY && curBin->X() >= leftBinX &&
+                   curBin->X() <= rightBinX && binGrid[curBin->Y()][curBin->X()] == curBin;
+        }
+
+        /**
+         * @brief use a region-local random number generator (instead of the global random()) to select expansion
+         * directions, so the expansion result does not depend on the order of the regions expanded by threads.
+         *
+         * @param seed the seed of the generator
+         */
+        inline void setRandomSeed(unsigned int seed)
+        {
+            useLocalRandom = true;
+            randomState = seed ? seed : 1;
+        }
+
+        /**
+         * @brief set whether the SpreadRegion is expanded speculatively
+         *
+         * A speculative SpreadRegion does not mark its bins in the CoveredBinMap and records the bins which are
+         * found uncovered during its expansion, so later it can be validated against the SpreadRegion(s) committed
+         * concurrently. (see isSpeculationValid())
+         *
+         * @param _speculative true to expand the SpreadRegion speculatively
+         */
+        inline void setSpeculative(bool _speculative)
+        {
+            speculative = _speculative;
+            speculativelyUncoveredBins.clear();
+        }
+
+        /**
+         * @brief check whether the speculative expansion is still valid, i.e., the bins found uncovered during the
+         * expansion (including the bins in this SpreadRegion) are still uncovered.
+         *
+         * If it is valid, the SpreadRegion is exactly the one obtained by a sequential expansion with the current
+         * CoveredBinMap.
+         *
+         * @param coveredBinMap the map of bins which have been included in other SpreadRegion
+         * @return true if the speculation is valid
+         */
+        inline bool isSpeculationValid(CoveredBinMap &coveredBinMap)
+        {
+            assert(speculative);
+            for (auto binIndex : speculativelyUncoveredBins)
+            {
+                if (coveredBinMap.isCovered(binIndex))
+                    return false;
+            }
+            for (auto curBin : binsInRegion)
+            {
+                if (coveredBinMap.isCovered(curBin->Y(), curBin->X()))
+                    return false;
+            }
+            return true;
+        }
+
+        /**
+         * @brief mark the bins of a speculative SpreadRegion in the CoveredBinMap after it is validated
+         *
+         * @param coveredBinMap the map of bins which have been included in other SpreadRegion
+         */
+        inline void commit(CoveredBinMap &coveredBinMap)
+        {
+            for (auto curBin : binsInRegion)
+                coveredBinMap.cover(curBin->Y(), curBin->X());
+            speculative = false;
+            speculativelyUncoveredBins.clear();
         }
 
         /**
@@ -747,6 +955,16 @@ class GeneralSpreader
             return cellsInRegionVec;
         }
 
+        /**
+         * @brief Get the cells of the coupled type in the SpreadRegion (empty if there is no hybrid bin grid)
+         *
+         * @return std::vector<DesignInfo::DesignCell *>&
+         */
+        inline std::vector<DesignInfo::DesignCell *> &getCoupledCells()
+        {
+            return coupledCellsInRegionVec;
+        }
+
         /**
          * @brief get the top bin coordinate Y of the SpreadRegion in bin grid
          *
@@ -812,168 +1030,89 @@ class GeneralSpreader
              *
              * @param placementInfo PlacementInfo so this object can access the corresponding placement database
              * @param curRegion the parent SpreadRegion of this SubBox which guides the boundary setting of the subox
+             * @param cellsInBox the cells to be spread in the SubBox (the cells of curRegion in binGrid)
              * @param binGrid the bin grid which record the cell density distribution
+             * @param cellPartitionMarks the per-cell marks shared by the SubBoxes to stably partition the cell orders
+             * (all the marks should be 0 and they will be restored to 0 after each partitioning)
              * @param capacityShrinkRatio shrink the area supply to a specific ratio
              * @param level current recursion level
              * @param dirIsH split vertically or horizontally (it is a priority setting instead of enforcement)
              */
             SubBox(PlacementInfo *placementInfo, SpreadRegion *curRegion,
+                   std::vector<DesignInfo::DesignCell *> &cellsInBox,
                    std::vector<std::vector<PlacementInfo::PlacementBinInfo *>> &binGrid,
-                   float capacityShrinkRatio = 1.0, int level = 100, bool dirIsH = true)
-                : placementInfo(placementInfo), binGrid(binGrid), capacityShrinkRatio(capacityShrinkRatio),
-                  topBinY(curRegion->top()), bottomBinY(curRegion->bottom()), leftBinX(curRegion->left()),
-                  rightBinX(curRegion->right()), level(level), dirIsH(dirIsH)
+                   std::vector<unsigned char> &cellPartitionMarks, float capacityShrinkRatio = 1.0, int level = 100,
+                   bool dirIsH = true)
+                : placementInfo(placementInfo), binGrid(binGrid), cellPartitionMarks(cellPartitionMarks),
+                  capacityShrinkRatio(capacityShrinkRatio), topBinY(curRegion->top()), bottomBinY(curRegion->bottom()),
+                  leftBinX(curRegion->left()), rightBinX(curRegion->right()), level(level), dirIsH(dirIsH)
             {
-                cellIds.clear();
-                std::vector<DesignInfo::DesignCell *> tmpCells;
-                tmpCells.clear();
-                for (auto curCell : curRegion->getCells())
-                {
-                    tmpCells.push_back(curCell);
-                }
-                std::sort(tmpCells.begin(), tmpCells.end(),
-                          [](DesignInfo::DesignCell *a, DesignInfo::DesignCell *b) -> bool {
-                              return a->getCellId() > b->getCellId();
-                          });
-                for (auto curCell : tmpCells)
+                SpreaderVectorPool<int>::acquire(cellIdsX);
+                SpreaderVectorPool<int>::acquire(cellIdsY);
+                for (auto curCell : cellsInBox)
                 {
-                    cellIds.push_back(curCell->getCellId());
+                    cellIdsX.push_back(curCell->getCellId());
                 }
+                cellIdsY = cellIdsX;
+                // ties of locations are broken by the cell ids so the orders are deterministic
+                std::vector<PlacementInfo::Location> &cellLoc = placementInfo->getCellId2location();
+                std::sort(cellIdsX.begin(), cellIdsX.end(), [&cellLoc](int a, int b) -> bool {
+                    return cellLoc[a].X < cellLoc[b].X || (cellLoc[a].X == cellLoc[b].X && a > b);
+                });
+                std::sort(cellIdsY.begin(), cellIdsY.end(), [&cellLoc](int a, int b) -> bool {
+                    return cellLoc[a].Y < cellLoc[b].Y || (cellLoc[a].Y == cellLoc[b].Y && a > b);
+                });
             }
 
             /**
-             * @brief Construct a new Sub Box object
+             * @brief Construct a new Sub Box object without cells, which will be assigned by the parent SubBox
              *
              * @param parentBox inheret information from a parent SubBox
              * @param topBinY the top bin index
              * @param bottomBinY  the bottom bin index
              * @param leftBinX the left bin index
              * @param rightBinX the right bin index
-             * @param cellRangeBegin the range begin for copying the cell ids to this child SubBox
-             * @param cellRangeEnd the range end for copying the cell ids to this child SubBox
              */
-            SubBox(SubBox *parentBox, int topBinY, int bottomBinY, int leftBinX, int rightBinX, int cellRangeBegin,
-                   int cellRangeEnd)
+            SubBox(SubBox *parentBox, int topBinY, int bottomBinY, int leftBinX, int rightBinX)
                 : placementInfo(parentBox->placementInfo), binGrid(parentBox->binGrid),
+                  cellPartitionMarks(parentBox->cellPartitionMarks),
                   capacityShrinkRatio(parentBox->capacityShrinkRatio), topBinY(topBinY), bottomBinY(bottomBinY),
                   leftBinX(leftBinX), rightBinX(rightBinX), level(parentBox->getLevel() - 1), dirIsH(!parentBox->dirIsH)
             {
-                if (cellRangeBegin <= cellRangeEnd)
-                    cellIds = std::vector<int>(
-                        {parentBox->cellIds.begin() + cellRangeBegin, parentBox->cellIds.begin() + cellRangeEnd + 1});
-                else
-                    cellIds.clear();
+                SpreaderVectorPool<int>::acquire(cellIdsX);
+                SpreaderVectorPool<int>::acquire(cellIdsY);
             }
 
             ~SubBox()
             {
+                SpreaderVectorPool<int>::release(cellIdsX);
+                SpreaderVectorPool<int>::release(cellIdsY);
             }
 
-            PlacementInfo *placementInfo;
-            std::vector<std::vector<PlacementInfo::PlacementBinInfo *>> &binGrid;
-            float capacityShrinkRatio = 1.0;
-
-            inline void addCellId(int cellId)
-            {
-                cellIds.push_back(cellId);
-            }
-
-            /**
-             * @brief spread cells and partition the SubBox into smaller SubBoxes
-             *
-             */
-            void spreadAndPartition();
-
             /**
-             * @brief the partition/sort function for quick sorting by cell location (X or Y)
+             * @brief a SubBox is created for each node of the recursive bi-partitioning so the memory blocks of
+             * SubBox(s) are recycled by a thread-local pool
              *
-             * @param cellIds the cell ids for location sorting
-             * @param low lower bound of sorting range
-             * @param high upper bound of sorting range
-             * @param Xsort sort by X loction or Y location
-             * @return int
              */
-            inline int Partition(std::vector<int> &cellIds, int low, int high, bool Xsort)
+            static void *operator new(std::size_t size)
             {
-                if (Xsort)
-                {
-                    int pivot, index, i;
-                    index = low;
-                    pivot = high;
-                    for (i = low; i < high; i++)
-                    {
-                        // finding index of pivot.
-                        // if (a[i] < a[pivot])
-                        if (placementInfo->getCellId2location()[cellIds[i]].X <
-                            placementInfo->getCellId2location()[cellIds[pivot]].X)
-                        {
-                            std::swap(cellIds[i], cellIds[index]);
-                            index++;
-                        }
-                    }
-                    std::swap(cellIds[pivot], cellIds[index]);
-                    return index;
-                }
-                else
-                {
-                    int pivot, index, i;
-                    index = low;
-                    pivot = high;
-                    for (i = low; i < high; i++)
-                    {
-                        // finding index of pivot.
-                        // if (a[i] < a[pivot])
-                        if (placementInfo->getCellId2location()[cellIds[i]].Y <
-                            placementInfo->getCellId2location()[cellIds[pivot]].Y)
-                        {
-                            std::swap(cellIds[i], cellIds[index]);
-                            index++;
-                        }
-                    }
-                    std::swap(cellIds[pivot], cellIds[index]);
-                    return index;
-                }
+                return SpreaderObjectPool<SubBox>::allocate(size);
             }
-
-            /**
-             * @brief the partition/sort function for quick sorting by cell location (X or Y)
-             *
-             * @param cellIds the cell ids for location sorting
-             * @param low lower bound of sorting range
-             * @param high upper bound of sorting range
-             * @param Xsort sort by X loction or Y location
-             * @return int
-             */
-            inline int RandomPivotPartition(std::vector<int> &cellIds, int low, int high, bool Xsort)
+            static void operator delete(void *block, std::size_t size)
             {
-                // Random selection of pivot.
-                int pvt, n;
-                n = HiFPlacer_hashprimes[low & 0xff];
-                pvt = low + n % (high - low + 1); // Randomizing the pivot value from sub-array.
-                std::swap(cellIds[high], cellIds[pvt]);
-                return Partition(cellIds, low, high, Xsort);
+                SpreaderObjectPool<SubBox>::deallocate(block, size);
             }
 
+            PlacementInfo *placementInfo;
+            std::vector<std::vector<PlacementInfo::PlacementBinInfo *>> &binGrid;
+            std::vector<unsigned char> &cellPartitionMarks;
+            float capacityShrinkRatio = 1.0;
+
             /**
-             * @brief recursive implementation of quick sort for cell ids by X/Y location
+             * @brief spread cells and partition the SubBox into smaller SubBoxes
              *
-             * @param cellIds the cell ids for location sorting
-             * @param p lower bound of sorting range
-             * @param q upper bound of sorting range
-             * @param Xsort sort by X loction or Y location
              */
-            void quick_sort(std::vector<int> &cellIds, int p, int q, bool Xsort)
-            {
-                // recursively sort the list
-                int pindex;
-                if (p < q)
-                {
-                    pindex = RandomPivotPartition(cellIds, p, q, Xsort); // randomly choose pivot
-                    // Recursively implementing QuickSort.
-                    quick_sort(cellIds, p, pindex - 1, Xsort);
-                    quick_sort(cellIds, pindex + 1, q, Xsort);
-                }
-            }
+            void spreadAndPartition();
 
             inline int getLevel()
             {
@@ -996,6 +1135,20 @@ class GeneralSpreader
              */
             void spreadCellsV(SubBox **boxA, SubBox **boxB);
 
+            /**
+             * @brief assign the cells of this SubBox to its two child SubBoxes according to a cut in the split order
+             *
+             * The cut slices the order of the split dimension directly and the order of the other dimension is
+             * partitioned stably, so the children get both of their orders in linear time without sorting. The orders
+             * of this SubBox are released afterwards.
+             *
+             * @param boxA the child SubBox getting the cells before the cut
+             * @param boxB the child SubBox getting the cells after the cut
+             * @param cutLineId the index of the last cell of boxA in the split order
+             * @param splitByX whether the SubBox is split according to the X order or the Y order
+             */
+            void assignCellsToChildren(SubBox *boxA, SubBox *boxB, int cutLineId, bool splitByX);
+
             /**
              * @brief get the top bin coordinate Y of the SubBox in bin grid
              *
@@ -1040,10 +1193,19 @@ class GeneralSpreader
             int topBinY, bottomBinY, leftBinX, rightBinX;
 
             /**
-             * @brief the cells in this SubBox
+             * @brief the cells in this SubBox sorted by X location
+             *
+             * The orders are sorted once for the root SubBox of a region and maintained down the recursion since the
+             * spreading in a SubBox moves the cells monotonically in a single dimension.
              *
              */
-            std::vector<int> cellIds;
+            std::vector<int> cellIdsX;
+
+            /**
+             * @brief the cells in this SubBox sorted by Y location
+             *
+             */
+            std::vector<int> cellIdsY;
             int level;
 
           public:
@@ -1054,6 +1216,12 @@ class GeneralSpreader
              *
              */
             int minExpandSize = 2;
+
+            /**
+             * @brief the minimum number of cells in a SubBox to spread its two partitions by parallel tasks
+             *
+             */
+            static constexpr int minCellNumForParallelBox = 256;
         };
 
         static constexpr float eps = 1e-4;
@@ -1084,6 +1252,12 @@ class GeneralSpreader
          */
         std::vector<std::vector<PlacementInfo::PlacementBinInfo *>> &binGrid;
 
+        /**
+         * @brief the hybrid bins merging binGrid with the bin grid of a coupled type (nullptr if not fused)
+         *
+         */
+        std::vector<std::vector<PlacementInfo::PlacementHybridBinInfo *>> *hybridBinGrid = nullptr;
+
         /**
          * @brief the utilization of the four directions (absolute value)
          *
@@ -1106,17 +1280,17 @@ class GeneralSpreader
         float capacityShrinkRatio = 1.0;
 
         /**
-         * @brief a set of cells in the SpreadRegion
+         * @brief a vector of cells in the SpreadRegion
          *
+         * vector can ensure the iteration order to get rid of random factors in multi-threading
          */
-        std::set<DesignInfo::DesignCell *> cellsInRegion;
+        std::vector<DesignInfo::DesignCell *> cellsInRegionVec;
 
         /**
-         * @brief a vector of cells in the SpreadRegion
+         * @brief a vector of the cells of the coupled type in the SpreadRegion
          *
-         * vector can ensure the iteration order to get rid of random factors in multi-threading
          */
-        std::vector<DesignInfo::DesignCell *> cellsInRegionVec;
+        std::vector<DesignInfo::DesignCell *> coupledCellsInRegionVec;
 
         /**
          * @brief a vector of bins in the SpreadRegion
@@ -1125,11 +1299,51 @@ class GeneralSpreader
          */
         std::vector<PlacementInfo::PlacementBinInfo *> binsInRegion;
 
+        bool useLocalRandom = false;
+        unsigned int randomState = 1;
+
         /**
-         * @brief a set of bins in the SpreadRegion
+         * @brief get a random number from the global random() or the region-local generator (see setRandomSeed())
          *
+         * @return long
          */
-        std::set<PlacementInfo::PlacementBinInfo *> binSetInRegion;
+        inline long getRandom()
+        {
+            if (!useLocalRandom)
+                return random();
+            // xorshift32
+            randomState ^= randomState << 13;
+            randomState ^= randomState >> 17;
+            randomState ^= randomState << 5;
+            return randomState & 0x7fffffff;
+        }
+
+        bool speculative = false;
+
+        /**
+         * @brief the indexes of the bins which are found uncovered during the speculative expansion
+         *
+         */
+        std::vector<int> speculativelyUncoveredBins;
+
+        /**
+         * @brief check whether a bin is covered by other SpreadRegion(s) and record the bin if it is found uncovered
+         * during a speculative expansion
+         *
+         * @param coveredBinMap the map of bins which have been included in other SpreadRegion
+         * @param binY the row of the bin
+         * @param binX the column of the bin
+         * @return true if the bin is covered
+         */
+        inline bool checkCovered(CoveredBinMap &coveredBinMap, int binY, int binX)
+        {
+            int binIndex = coveredBinMap.getBinIndex(binY, binX);
+            if (coveredBinMap.isCovered(binIndex))
+                return true;
+            if (speculative)
+                speculativelyUncoveredBins.push_back(binIndex);
+            return false;
+        }
     };
 
     /**
@@ -1138,33 +1352,39 @@ class GeneralSpreader
      * The inforation including cell location and the related bins should be updated.
      * Only the involved elements will lead to information update, which can reduce the runtime.
      *
-     * @param involvedPUs a set of PlacementUnit which are involved in the cell spreading procedure
-     * @param involvedCells a set of DesignCell which are involved in the cell spreading procedure
-     * @param involvedPUVec a vector of PlacementUnit which are involved in the cell spreading procedure(ensure the
-     * iteration order)
+     * The locations of the PlacementUnit(s) are updated in parallel by the OpenMP worker threads since they are
+     * independent, and then the cells are transferred between bins sequentially in the order of involvedPUVec, so the
+     * result does not depend on the number of threads.
+     *
      * @param forgetRatio the forget ratio for the original location in last iteration
      */
-    void updatePlacementUnitsWithSpreadedCellLocations(std::set<PlacementInfo::PlacementUnit *> &involvedPUs,
-                                                       std::set<DesignInfo::DesignCell *> &involvedCells,
-                                                       std::vector<PlacementInfo::PlacementUnit *> &involvedPUVec,
-                                                       float forgetRatio);
+    void updatePlacementUnitsWithSpreadedCellLocations(float forgetRatio);
 
     /**
-     * @brief multi-threading workers for updating the information of the involved PlacementUnit(s)
+     * @brief update the location of an involved PlacementUnit and its cells according to the spreaded cell locations
      *
-     * @param placementInfo PlacementInfo so this object can access the corresponding placement database
-     * @param involvedPUs a set of PlacementUnit which are involved in the cell spreading procedure
-     * @param involvedCells a set of DesignCell which are involved in the cell spreading procedure
-     * @param involvedPUVec a vector of PlacementUnit which are involved in the cell spreading procedure(ensure the
-     * iteration order)
+     * @param curPU the involved PlacementUnit
      * @param forgetRatio the forget ratio for the original location in last iteration
-     * @param startId the PlacementUnit range begin for this worker
-     * @param endId  the PlacementUnit range end for this worker
      */
-    static void updatePlacementUnitsWithSpreadedCellLocationsWorker(
-        PlacementInfo *placementInfo, std::set<PlacementInfo::PlacementUnit *> &involvedPUs,
-        std::set<DesignInfo::DesignCell *> &involvedCells, std::vector<PlacementInfo::PlacementUnit *> &involvedPUVec,
-        float forgetRatio, int startId, int endId);
+    void updatePlacementUnitWithSpreadedCellLocations(PlacementInfo::PlacementUnit *curPU, float forgetRatio);
+
+    /**
+     * @brief start a new epoch of involvement stamps for a spreading loop, which clears the involved
+     * PlacementUnit(s)/cells in O(1)
+     *
+     */
+    void startNewInvolvementEpoch();
+
+    /**
+     * @brief collect the PlacementUnit(s) and cells involved in the expanded SpreadRegion(s)
+     *
+     */
+    void collectInvolvedPlacementUnits();
+
+    inline bool isCellInvolved(DesignInfo::DesignCell *curCell)
+    {
+        return cellId2InvolvedEpoch[curCell->getCellId()] == involvedEpoch;
+    }
 
     /**
      * @brief ensure the X/Y is in the legal range of the target device
@@ -1200,6 +1420,29 @@ class GeneralSpreader
      */
     void recordSpreadedCellLocations();
 
+    /**
+     * @brief set the number of threads of this spreader, overriding the "jobs" option (e.g., when several spreaders
+     * run concurrently and share the threads)
+     *
+     * @param _nJobs the number of threads
+     */
+    inline void setNumThreads(int _nJobs)
+    {
+        assert(_nJobs >= 1);
+        nJobs = _nJobs;
+    }
+
+    /**
+     * @brief drop the idle objects and buffers kept by the memory pools of the spreaders (SpreaderMemoryPool.h)
+     *
+     * It should be called when the spreading of an iteration is finished, so the memory grown for the largest regions
+     * is not held between the iterations. The pools of the given threads are shrunk immediately, and those of the
+     * other threads (e.g., of nested parallel regions) are shrunk when they are used again.
+     *
+     * @param nJobs the number of threads used by the spreaders
+     */
+    static void shrinkMemoryPools(int nJobs);
+
     void DumpCellsCoordinate(std::string dumpFileName, GeneralSpreader::SpreadRegion *curRegion);
     void DumpPUCoordinate(std::string dumpFileName, std::vector<PlacementInfo::PlacementUnit *> &involvedPUVec);
 
@@ -1217,6 +1460,41 @@ class GeneralSpreader
      */
     std::vector<std::vector<PlacementInfo::PlacementBinInfo *>> &binGrid;
 
+    /**
+     * @brief the shared cell type spread jointly with sharedCellType (empty if not fused)
+     *
+     */
+    std::string coupledCellType = "";
+
+    /**
+     * @brief the bin grid of the coupled shared cell type (nullptr if not fused)
+     *
+     */
+    std::vector<std::vector<PlacementInfo::PlacementBinInfo *>> *coupledBinGrid = nullptr;
+
+    /**
+     * @brief the hybrid bins merging the bins of binGrid and coupledBinGrid at the same locations
+     *
+     */
+    std::vector<std::vector<PlacementInfo::PlacementHybridBinInfo *>> hybridBinGrid;
+
+    /**
+     * @brief the slot of each cell in the cell vector of its hybrid bin (see
+     * PlacementInfo::PlacementHybridBinInfo::setCellSlotTable())
+     *
+     */
+    std::vector<int> cellId2HybridBinSlot;
+
+    /**
+     * @brief get the hybrid bin grid for the SpreadRegion(s) (nullptr if not fused)
+     *
+     * @return std::vector<std::vector<PlacementInfo::PlacementHybridBinInfo *>>*
+     */
+    inline std::vector<std::vector<PlacementInfo::PlacementHybridBinInfo *>> *getHybridBinGridOrNull()
+    {
+        return coupledBinGrid ? &hybridBinGrid : nullptr;
+    }
+
     int dumpSiteGridDensityCnt = 0;
     int LUTFFCoordinateDumpCnt = 0;
     int nJobs = 1;
@@ -1229,6 +1507,12 @@ class GeneralSpreader
      */
     bool useSimpleExpland = false;
     bool enforceSimpleExpland = false;
+
+    /**
+     * @brief whether recordSpreadedCellLocations() is called at the end of spreadPlacementUnits()
+     *
+     */
+    bool recordSpreadedLocations = true;
     int dumpCnt = 0;
 
     /**
@@ -1238,16 +1522,53 @@ class GeneralSpreader
     std::vector<PlacementInfo::PlacementBinInfo *> overflowBins;
 
     /**
-     * @brief a set of the found overflow bins in the current placement
+     * @brief the row-major ids of the found overflow bins sorted by their utilization rates
+     *
+     */
+    std::vector<int> overflowBinIds;
+
+    /**
+     * @brief the utilization rate of each bin (indexed by row-major bin id) obtained when finding the overflow bins
+     *
+     */
+    std::vector<float> binUtilizationRates;
+
+    /**
+     * @brief whether each bin (indexed by row-major bin id) is overflowed
+     *
+     */
+    std::vector<unsigned char> binOverflowFlags;
+
+    /**
+     * @brief the minimum number of bins to sweep them in parallel when finding the overflow bins
      *
      */
-    std::set<PlacementInfo::PlacementBinInfo *> overflowBinSet;
+    static constexpr int minBinNumForParallelSweep = 4096;
 
     /**
-     * @brief a set of the bins covered by existing SpreadRegion(s)
+     * @brief a bitmap of the bins covered by existing SpreadRegion(s)
      *
      */
-    std::set<PlacementInfo::PlacementBinInfo *> coveredBinSet;
+    CoveredBinMap coveredBinMap;
+
+    /**
+     * @brief expand the SpreadRegion(s) of multiple overflow bins concurrently
+     *
+     * The overflow bins are handled in batches. The SpreadRegion(s) of a batch are expanded speculatively in parallel
+     * with the CoveredBinMap before the batch, and then validated and committed in the order of the overflow bins. A
+     * SpreadRegion whose expansion conflicts with the regions committed before it is re-expanded sequentially, so
+     * the result is the same as the sequential expansion with region-local random number generators.
+     *
+     * @param spreadRegionBinSizeLimit the maximum size of the spread region for a overflow bin
+     */
+    void expandRegionsConcurrently(unsigned int spreadRegionBinSizeLimit);
+
+    /**
+     * @brief expand the SpreadRegion(s) of multiple overflow bins concurrently with speculative expansion and
+     * conflict detection
+     *
+     */
+    bool useParallelRegionExpansion = false;
 
     void dumpSiteGridDensity(std::string dumpFileName);
 
@@ -1258,22 +1579,71 @@ class GeneralSpreader
      */
     void findOverflowBins(float overflowThreshold);
 
+    /**
+     * @brief update the overflow/non-overflow counters and the shrink ratio of a bin after its overflow check
+     *
+     * @param curBin the checked bin
+     * @param overflow whether the bin is overflowed
+     */
+    void updateOverflowCounters(PlacementInfo::PlacementBinInfo *curBin, bool overflow);
+
+    /**
+     * @brief find the overflow bins by refining the bin pyramid (PlacementInfo::PlacementBinPyramid) only around the
+     * overflow instead of scanning the whole bin grid, and reset the counters of the bins touched by the overflow
+     * checks (marked in the pyramid) instead of those of all the bins
+     *
+     */
+    bool useHierarchicalBinGrid = false;
+
     /**
      * @brief obtain a SpreadRegion by expanding a cell spreading window from an overflow bin
      *
      * @param curBin the initial bin for the SpreadRegion construction
      * @param capacityShrinkRatio shrink the area supply to a specific ratio
      * @param numBinThr the maximum number of bin in one
+     * @param speculative expand the SpreadRegion speculatively without marking its bins in the CoveredBinMap
      * @return GeneralSpreader::SpreadRegion*
      */
     GeneralSpreader::SpreadRegion *expandFromABin(PlacementInfo::PlacementBinInfo *curBin, float capacityShrinkRatio,
-                                                  unsigned int numBinThr = 1000000);
+                                                  unsigned int numBinThr = 1000000, bool speculative = false);
 
     /**
      * @brief the obtained SpreadRegion s which can be processed in parallel.
      *
      */
     std::vector<GeneralSpreader::SpreadRegion *> expandedRegions;
+
+    /**
+     * @brief the per-cell marks shared by the SubBox(s) to partition their cell orders (the cells of concurrent
+     * SubBox(s) are disjoint)
+     *
+     */
+    std::vector<unsigned char> cellPartitionMarks;
+
+    /**
+     * @brief the current epoch of the involvement stamps. A PlacementUnit/cell is involved in the current spreading
+     * loop if its stamp equals to the epoch.
+     *
+     */
+    unsigned int involvedEpoch = 0;
+
+    /**
+     * @brief the involvement stamp of each PlacementUnit (indexed by PlacementUnit id)
+     *
+     */
+    std::vector<unsigned int> PUId2InvolvedEpoch;
+
+    /**
+     * @brief the involvement stamp of each cell (indexed by cell id)
+     *
+     */
+    std::vector<unsigned int> cellId2InvolvedEpoch;
+
+    /**
+     * @brief the PlacementUnit(s) involved in the current spreading loop in a deterministic order
+     *
+     */
+    std::vector<PlacementInfo::PlacementUnit *> involvedPUVec;
 };
 
 std::ostream &operator<<(std::ostream &os, GeneralSpreader::SpreadRegion::SubBox *curBox);
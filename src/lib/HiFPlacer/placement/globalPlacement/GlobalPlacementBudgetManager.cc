@@ -0,0 +1,201 @@
+/**
+ * @file GlobalPlacementBudgetManager.cc
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This implementation file contains APIs' implementation of the GlobalPlacementBudgetManager which distributes
+ * the wall-clock/iteration budget across the stages of global placement.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ */
+
+#include "GlobalPlacementBudgetManager.h"
+
+#include <algorithm>
+#include <cmath>
+
+GlobalPlacementBudgetManager::GlobalPlacementBudgetManager(std::map<std::string, std::string> &JSONCfg)
+{
+    if (JSONCfg.find("GlobalPlacementTimeBudget") != JSONCfg.end())
+        timeBudget = std::stod(JSONCfg["GlobalPlacementTimeBudget"]);
+    if (JSONCfg.find("GlobalPlacementMinGainPerSecond") != JSONCfg.end())
+        minGainPerSecond = std::stof(JSONCfg["GlobalPlacementMinGainPerSecond"]);
+    if (JSONCfg.find("GlobalPlacementTrajectoryWindow") != JSONCfg.end())
+        trajectoryWindow = std::max(2, std::stoi(JSONCfg["GlobalPlacementTrajectoryWindow"]));
+
+    enabled = timeBudget > 0 || minGainPerSecond > 0;
+    if (enabled)
+        print_warning("GlobalPlacementBudgetManager is enabled: timeBudget=" + std::to_string(timeBudget) +
+                      "s minGainPerSecond=" + std::to_string(minGainPerSecond));
+}
+
+void GlobalPlacementBudgetManager::planStages(const std::vector<int> &_plannedIterationNums,
+                                              const std::vector<bool> &_strictStages)
+{
+    assert(_plannedIterationNums.size() == _strictStages.size());
+    plannedIterationNums = _plannedIterationNums;
+    strictStages = _strictStages;
+    curStageId = -1;
+    leftoverIterations = 0;
+    consumedTime = 0;
+}
+
+int GlobalPlacementBudgetManager::beginStage()
+{
+    curStageId++;
+    assert(curStageId < (int)plannedIterationNums.size() && "the stage should be planned in advance.");
+
+    stageIterCnt = 0;
+    recentUpperBoundHPWLs.clear();
+    recentRelativeGaps.clear();
+    recentIterationSeconds.clear();
+    stageBeginTime = std::chrono::steady_clock::now();
+    lastIterationTime = stageBeginTime;
+
+    if (!enabled)
+    {
+        stageIterationBudget = plannedIterationNums[curStageId];
+        return stageIterationBudget;
+    }
+
+    // a non-strict stage runs until convergence regardless of its iteration number, so the leftover iterations are
+    // kept for the later strict stages
+    stageIterationBudget = plannedIterationNums[curStageId];
+    if (strictStages[curStageId])
+    {
+        stageIterationBudget += leftoverIterations;
+        leftoverIterations = 0;
+    }
+
+    // the remaining time is shared by the remaining stages according to their nominal iteration numbers
+    stageTimeBudget = -1;
+    if (timeBudget > 0)
+    {
+        int remainingPlannedIterations = 0;
+        for (unsigned int stageId = curStageId; stageId < plannedIterationNums.size(); stageId++)
+            remainingPlannedIterations += plannedIterationNums[stageId];
+        double remainingTime = std::max(0.0, timeBudget - consumedTime);
+        stageTimeBudget = (remainingPlannedIterations > 0)
+                              ? remainingTime * plannedIterationNums[curStageId] / remainingPlannedIterations
+                              : remainingTime;
+    }
+
+    print_info("GlobalPlacementBudgetManager stage#" + std::to_string(curStageId) +
+               " iterationBudget=" + std::to_string(stageIterationBudget) +
+               " timeBudget=" + std::to_string(stageTimeBudget) + "s");
+    return stageIterationBudget;
+}
+
+void GlobalPlacementBudgetManager::recordIteration(float upperBoundHPWL, float lowerBoundHPWL)
+{
+    stageIterCnt++;
+    recentIterationSeconds.push_back(getSecondsSince(lastIterationTime));
+    lastIterationTime = std::chrono::steady_clock::now();
+    float relativeGap = (upperBoundHPWL > 0) ? (upperBoundHPWL - lowerBoundHPWL) / upperBoundHPWL : 0;
+    recentUpperBoundHPWLs.push_back(upperBoundHPWL);
+    recentRelativeGaps.push_back(std::max(0.0f, std::min(1.0f, relativeGap)));
+    while ((int)recentUpperBoundHPWLs.size() > trajectoryWindow)
+        recentUpperBoundHPWLs.pop_front();
+    while ((int)recentRelativeGaps.size() > trajectoryWindow)
+        recentRelativeGaps.pop_front();
+    while ((int)recentIterationSeconds.size() > trajectoryWindow)
+        recentIterationSeconds.pop_front();
+}
+
+float GlobalPlacementBudgetManager::getLastRelativeGap()
+{
+    if (recentRelativeGaps.empty())
+        return 1.0;
+    return recentRelativeGaps.back();
+}
+
+float GlobalPlacementBudgetManager::fitGapDecayRatio()
+{
+    int n = recentRelativeGaps.size();
+    if (n < 2)
+        return 1.0;
+
+    // least-squares fitting of log(gap) = a + b * i
+    double sumI = 0, sumL = 0, sumII = 0, sumIL = 0;
+    for (int i = 0; i < n; i++)
+    {
+        double l = std::log(std::max(recentRelativeGaps[i], 1e-6f));
+        sumI += i;
+        sumL += l;
+        sumII += i * i;
+        sumIL += i * l;
+    }
+    double denominator = n * sumII - sumI * sumI;
+    if (std::fabs(denominator) < 1e-9)
+        return 1.0;
+    double slope = (n * sumIL - sumI * sumL) / denominator;
+    return std::max((double)minGapDecayRatio, std::min(1.0, std::exp(slope)));
+}
+
+float GlobalPlacementBudgetManager::predictRemainingHPWLImprovement(int iterNum)
+{
+    if (recentUpperBoundHPWLs.empty() || iterNum <= 0)
+        return 0;
+    float gap = getLastRelativeGap();
+    float decayRatio = fitGapDecayRatio();
+    if (decayRatio >= 1.0)
+        return recentUpperBoundHPWLs.back() * gap;
+    return recentUpperBoundHPWLs.back() * gap * (1.0 - std::pow(decayRatio, iterNum));
+}
+
+float GlobalPlacementBudgetManager::predictRelativeGainPerSecond()
+{
+    if (recentIterationSeconds.empty())
+        return 0;
+    double avgIterationSeconds = 0;
+    for (auto seconds : recentIterationSeconds)
+        avgIterationSeconds += seconds;
+    avgIterationSeconds /= recentIterationSeconds.size();
+    avgIterationSeconds = std::max(avgIterationSeconds, 1e-6);
+    float gap = getLastRelativeGap();
+    float decayRatio = fitGapDecayRatio();
+    if (decayRatio >= 1.0)
+        return gap / trajectoryWindow / avgIterationSeconds;
+    return gap * (1.0 - decayRatio) / avgIterationSeconds;
+}
+
+bool GlobalPlacementBudgetManager::shouldStopStage(bool allowEarlyStop)
+{
+    if (!enabled || !allowEarlyStop || stageIterCnt < minIterationsPerStage)
+        return false;
+
+    if (stageTimeBudget >= 0 && getSecondsSince(stageBeginTime) >= stageTimeBudget)
+    {
+        print_warning("GlobalPlacementBudgetManager: the time budget of stage#" + std::to_string(curStageId) +
+                      " is used up.");
+        return true;
+    }
+
+    if (minGainPerSecond > 0)
+    {
+        float gainPerSecond = predictRelativeGainPerSecond();
+        if (gainPerSecond < minGainPerSecond)
+        {
+            int remainingIterations = std::max(0, stageIterationBudget - stageIterCnt);
+            print_warning("GlobalPlacementBudgetManager: stage#" + std::to_string(curStageId) +
+                          " is stopped since the expected gain per second (" + std::to_string(gainPerSecond) +
+                          ") is below the threshold. predicted remaining HPWL improvement=" +
+                          std::to_string(predictRemainingHPWLImprovement(remainingIterations)));
+            return true;
+        }
+    }
+    return false;
+}
+
+void GlobalPlacementBudgetManager::endStage()
+{
+    double stageTime = getSecondsSince(stageBeginTime);
+    consumedTime += stageTime;
+    if (enabled)
+        leftoverIterations = std::max(0, stageIterationBudget - stageIterCnt);
+    print_info("GlobalPlacementBudgetManager stage#" + std::to_string(curStageId) +
+               " iterations=" + std::to_string(stageIterCnt) + " time=" + std::to_string(stageTime) +
+               "s leftoverIterations=" + std::to_string(leftoverIterations));
+}
@@ -0,0 +1,201 @@
+/**
+ * @file GlobalPlacementBudgetManager.h
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This header file contains the definitions of GlobalPlacementBudgetManager class which distributes the
+ * wall-clock/iteration budget across the stages of global placement and decides convergence-aware early termination.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ */
+
+#ifndef _GLOBALPLACEMENTBUDGETMANAGER
+#define _GLOBALPLACEMENTBUDGETMANAGER
+
+#include "strPrint.h"
+#include <assert.h>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @brief GlobalPlacementBudgetManager distributes the wall-clock/iteration budget across the stages of global
+ * placement.
+ *
+ * The stages (calls of GlobalPlacer::GlobalPlacement_CLBElements) are planned with their nominal iteration numbers.
+ * During a stage, the manager tracks the relative gap between the upper bound HPWL (after spreading) and the lower
+ * bound HPWL (after the wirelength optimization), which closes when global placement converges, and stops the stage
+ * when the expected relative gain per second falls below a configurable threshold or when the time share of the
+ * stage is used up. The upper bound HPWL alone is not a convergence signal, since it stays flat or rises while the
+ * cells are spread apart.
+ *
+ * The unused iterations of a stage are handed to the later strict stages only: a non-strict stage
+ * (stopStrictly=false in GlobalPlacement_CLBElements) runs until the B2B convergence regardless of its iteration
+ * number and cannot be stopped before its macros are fixed, so it cannot use more iterations. The unused time of a
+ * stage is shared by all the later stages.
+ *
+ * The manager is only enabled when "GlobalPlacementTimeBudget" or "GlobalPlacementMinGainPerSecond" is set in the
+ * placement configuration. Otherwise, it returns the nominal iteration numbers and never stops a stage.
+ *
+ */
+class GlobalPlacementBudgetManager
+{
+  public:
+    /**
+     * @brief Construct a new GlobalPlacementBudgetManager object
+     *
+     * @param JSONCfg the user-defined placement configuration
+     */
+    GlobalPlacementBudgetManager(std::map<std::string, std::string> &JSONCfg);
+    ~GlobalPlacementBudgetManager()
+    {
+    }
+
+    /**
+     * @brief plan the stages of global placement with their nominal iteration numbers
+     *
+     * @param _plannedIterationNums the nominal iteration number of each stage (in order)
+     * @param _strictStages whether each stage is bounded by its iteration number (stopStrictly), only such stages
+     * receive the iterations left by the previous stages
+     */
+    void planStages(const std::vector<int> &_plannedIterationNums, const std::vector<bool> &_strictStages);
+
+    /**
+     * @brief start the next planned stage
+     *
+     * @return int the iteration budget of the stage (nominal iterations + iterations left by previous stages if the
+     * stage is strict)
+     */
+    int beginStage();
+
+    /**
+     * @brief record the HPWL bounds obtained at the end of a global placement iteration of the current stage
+     *
+     * @param upperBoundHPWL the HPWL after spreading/legalization
+     * @param lowerBoundHPWL the HPWL after the wirelength optimization
+     */
+    void recordIteration(float upperBoundHPWL, float lowerBoundHPWL);
+
+    /**
+     * @brief check whether the current stage should be terminated according to the budget and the convergence trend
+     *
+     * @param allowEarlyStop whether the caller can safely end the stage now (e.g., the final stage can stop only
+     * after the macros are fixed)
+     * @return true if the stage should be terminated
+     */
+    bool shouldStopStage(bool allowEarlyStop);
+
+    /**
+     * @brief finish the current stage and hand its unused budget to the later (strict) stages
+     *
+     */
+    void endStage();
+
+    /**
+     * @brief predict the HPWL improvement of the given number of further iterations based on the recent trajectory
+     *
+     * We fit the log of the relative gap between the HPWL bounds of the recent iterations linearly and extrapolate its
+     * geometric decay. The upper bound HPWL is expected to approach the lower bound by the closed part of the gap. If
+     * the gap is not closing yet, the whole gap is regarded as the remaining improvement.
+     *
+     * @param iterNum the number of further iterations
+     * @return float the predicted HPWL improvement (non-negative)
+     */
+    float predictRemainingHPWLImprovement(int iterNum);
+
+    /**
+     * @brief predict the relative HPWL gain per second of the next iteration
+     *
+     * If the gap between the HPWL bounds is closing, the gain of an iteration is the part of the gap closed by it. If
+     * the gap is flat or rising (e.g., while the cells are spread apart), the stage has not converged and the gap is
+     * expected to be closed within the trajectory window, so the stage is only stopped when the gap itself is small.
+     *
+     * @return float the predicted gain ratio per second
+     */
+    float predictRelativeGainPerSecond();
+
+    inline bool isEnabled()
+    {
+        return enabled;
+    }
+
+  private:
+    /**
+     * @brief fit the per-iteration decay ratio of the relative HPWL gap from the recent trajectory
+     *
+     * @return float the ratio gap[i+1]/gap[i], clamped to [minGapDecayRatio, 1] (1 means the gap is not closing)
+     */
+    float fitGapDecayRatio();
+
+    /**
+     * @brief get the relative gap between the HPWL bounds of the last iteration
+     *
+     * @return float (upperBoundHPWL - lowerBoundHPWL) / upperBoundHPWL, clamped to [0, 1]
+     */
+    float getLastRelativeGap();
+
+    inline double getSecondsSince(std::chrono::time_point<std::chrono::steady_clock> &timePoint)
+    {
+        return std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::steady_clock::now() -
+                                                                           timePoint)
+            .count();
+    }
+
+    /**
+     * @brief whether the budget manager is involved in global placement
+     *
+     */
+    bool enabled = false;
+
+    /**
+     * @brief the wall-clock budget (in seconds) for all the global placement stages (<=0 means no time limit)
+     *
+     */
+    double timeBudget = -1;
+
+    /**
+     * @brief the threshold of the expected relative HPWL gain per second to continue a stage (<=0 means disabled)
+     *
+     */
+    float minGainPerSecond = -1;
+
+    /**
+     * @brief the number of recent iterations used to predict the HPWL trajectory
+     *
+     */
+    int trajectoryWindow = 5;
+
+    /**
+     * @brief a stage will not be terminated early before it conducts such a number of iterations
+     *
+     */
+    int minIterationsPerStage = 3;
+
+    /**
+     * @brief the lower bound of the fitted gap decay ratio, to avoid over-predicting the gain from a sudden drop
+     *
+     */
+    const float minGapDecayRatio = 0.5;
+
+    std::vector<int> plannedIterationNums;
+    std::vector<bool> strictStages;
+    int curStageId = -1;
+    int leftoverIterations = 0;
+    double consumedTime = 0;
+
+    int stageIterationBudget = 0;
+    int stageIterCnt = 0;
+    double stageTimeBudget = -1;
+    std::chrono::time_point<std::chrono::steady_clock> stageBeginTime;
+    std::chrono::time_point<std::chrono::steady_clock> lastIterationTime;
+
+    std::deque<float> recentUpperBoundHPWLs;
+    std::deque<float> recentRelativeGaps;
+    std::deque<double> recentIterationSeconds;
+};
+
+#endif
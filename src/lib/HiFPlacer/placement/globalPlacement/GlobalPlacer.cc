@@ -15,6 +15,7 @@
 
 #include <cmath>
 #include <codecvt>
+#include <omp.h>
 
 GlobalPlacer::GlobalPlacer(PlacementInfo *placementInfo, std::map<std::string, std::string> &JSONCfg,
                            bool resetLegalizationInfo)
@@ -49,6 +50,18 @@ GlobalPlacer::GlobalPlacer(PlacementInfo *placementInfo, std::map<std::string, s
 
     if (JSONCfg.find("GlobalPlacerPrintHPWL") != JSONCfg.end())
         printHPWL = JSONCfg["GlobalPlacerPrintHPWL"] == "true";
+    if (JSONCfg.find("SpreaderConcurrentTypes") != JSONCfg.end())
+        concurrentSpreading = JSONCfg["SpreaderConcurrentTypes"] == "true";
+    if (JSONCfg.find("SpreaderCongestionAware") != JSONCfg.end())
+        congestionAwareSpreading = JSONCfg["SpreaderCongestionAware"] == "true";
+    if (JSONCfg.find("SpreaderCongestionDemandThreshold") != JSONCfg.end())
+        congestionDemandThreshold = std::stof(JSONCfg["SpreaderCongestionDemandThreshold"]);
+    if (JSONCfg.find("SpreaderCongestionMinCapacityRatio") != JSONCfg.end())
+        congestionMinCapacityRatio = std::stof(JSONCfg["SpreaderCongestionMinCapacityRatio"]);
+    if (JSONCfg.find("SpreaderFusedLUTFF") != JSONCfg.end())
+        fusedLUTFFSpreading = JSONCfg["SpreaderFusedLUTFF"] == "true";
+    if (JSONCfg.find("jobs") != JSONCfg.end())
+        nJobs = std::stoi(JSONCfg["jobs"]);
 
     hasUserDefinedClusterInfo = JSONCfg.find("designCluster") != JSONCfg.end();
 
@@ -147,6 +160,7 @@ void GlobalPlacer::GlobalPlacement_CLBElements(int iterNum, bool continuePreviou
     lowerBoundHPWL = 1;
 
     int iterCntAfterMacrosFixed = 0;
+    bool B2BConverged = false;
 
     // global placement iterations
     for (int i = 0; i < iterNum || (!stopStrictly); i++)
@@ -246,6 +260,9 @@ void GlobalPlacer::GlobalPlacement_CLBElements(int iterNum, bool continuePreviou
         print_info("upperBoundHPWL=" + std::to_string(upperBoundHPWL));
         print_info("minHPWL=" + std::to_string(minHPWL));
 
+        if (budgetManager)
+            budgetManager->recordIteration(upperBoundHPWL, lowerBoundHPWL);
+
         // converge criteria
         bool criteria0 = upperBoundHPWL / lowerBoundHPWL < 1.02 &&
                          ((averageMacroLegalDisplacement < 1 && macroCloseToSite) || macroLegalizationFixed) &&
@@ -261,9 +278,7 @@ void GlobalPlacer::GlobalPlacement_CLBElements(int iterNum, bool continuePreviou
         if (criteria0 || criteria1 || criteria2 || criteria3 || criteria4)
         {
             print_status("Global Placer: B2B converge");
-            BRAMDSPLegalizer->dumpMatching(true, true);
-            CARRYMacroLegalizer->dumpMatching(true, true);
-            mCLBLegalizer->dumpMatching(true, true);
+            B2BConverged = true;
             break;
         }
 
@@ -272,6 +287,24 @@ void GlobalPlacer::GlobalPlacement_CLBElements(int iterNum, bool continuePreviou
             print_status("Global Placer: Should do packing now before further optimization");
             break;
         }
+
+        if (budgetManager)
+        {
+            // the non-strict stage should not end before the macros are fixed to their legal locations
+            if (budgetManager->shouldStopStage(stopStrictly || macroLegalizationFixed))
+            {
+                print_status("Global Placer: stopped by budget manager");
+                B2BConverged = true;
+                break;
+            }
+        }
+    }
+    // a stage stopped by the budget manager ends in the same way as a converged one
+    if (B2BConverged)
+    {
+        BRAMDSPLegalizer->dumpMatching(true, true);
+        CARRYMacroLegalizer->dumpMatching(true, true);
+        mCLBLegalizer->dumpMatching(true, true);
     }
     dumpCoord();
     dumpLUTFFCoordinate(true);
@@ -297,7 +330,7 @@ void GlobalPlacer::GlobalPlacement_fixedCLB(int iterNum, float pseudoNetWeight)
         if (!curCell->isLUT() && !curCell->isFF())
             continue;
 
-        auto curPU = placementInfo->getCellId2PlacementUnit()[curCell->getCellId()];
+        auto curPU = placementInfo->getPlacementUnitByCell(curCell);
 
         if (curPU->isLocked())
             continue;
@@ -326,7 +359,7 @@ void GlobalPlacer::GlobalPlacement_fixedCLB(int iterNum, float pseudoNetWeight)
         if (!curCell->isLUT() && !curCell->isFF())
             continue;
 
-        auto curPU = placementInfo->getCellId2PlacementUnit()[curCell->getCellId()];
+        auto curPU = placementInfo->getPlacementUnitByCell(curCell);
 
         if (curPU->isLocked())
             continue;
@@ -373,7 +406,7 @@ void GlobalPlacer::dumpLUTCoordinate()
             std::stringstream outfile0;
             for (auto curPU : placementInfo->getPlacementUnits())
             {
-                if (auto curUnpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU))
+                if (auto curUnpackedCell = PlacementInfo::asUnpackedCell(curPU))
                 {
                     float cellX = curUnpackedCell->X();
                     float cellY = curUnpackedCell->Y();
@@ -383,7 +416,7 @@ void GlobalPlacer::dumpLUTCoordinate()
                         outfile0 << cellX << " " << cellY << " " << curCell->getName() << "\n";
                     }
                 }
-                else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curPU))
+                else if (auto curMacro = PlacementInfo::asMacro(curPU))
                 {
                     for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
                     {
@@ -434,6 +467,8 @@ void GlobalPlacer::macroLegalize(int curIteration)
         print_info("DSPBRAM Average Displacement Of Rough Legalization =" +
                    std::to_string(averageMacroLegalDisplacement));
         print_info("MCLB Average Displacement Of Rough Legalization =" + std::to_string(averageMCLBLegalDisplacement));
+        print_info("MCLB Max Displacement Of Rough Legalization =" +
+                   std::to_string(mCLBLegalizer->getMaxDisplacementOfRoughLegalization()));
 
         placementInfo->getDeviceInfo()->resetAllSiteMapping();
         mCLBLegalizer->legalize();
@@ -450,6 +485,8 @@ void GlobalPlacer::macroLegalize(int curIteration)
         print_info("DSPBRAM Average Displacement Of Exact Legalization =" +
                    std::to_string(averageMacroLegalDisplacement));
         print_info("MCLB Average Displacement Of Exact Legalization =" + std::to_string(averageMCLBLegalDisplacement));
+        print_info("MCLB Max Displacement Of Exact Legalization =" +
+                   std::to_string(mCLBLegalizer->getMaxDisplacementOfExactLegalization()));
         print_info("CARRY Average Displacement Of Exact Legalization =" +
                    std::to_string(averageCarryLegalDisplacement));
         // gradually reduce the size of initial legalization window
@@ -566,6 +603,44 @@ void GlobalPlacer::spreading(int currentIteration, int spreadRegionSizeLimit)
 {
     placementInfo->updateElementBinGrid();
     float supplyRatio = (placementInfo->getBinGridW() < 2.5) ? 0.95 : (0.80 + 0.1 * progressRatio);
+
+    // the congested LUT/FF bins are regarded as smaller ones by the spreaders in this iteration
+    bool applyCongestion = congestionAwareSpreading && progressRatio > 0.4;
+    if (applyCongestion)
+    {
+        placementInfo->updateRoutingDemandMap();
+        placementInfo->applyRoutingDemandToBinCapacity(congestionDemandThreshold, congestionMinCapacityRatio);
+    }
+
+    if (concurrentSpreading && nJobs > 1)
+    {
+        // we gradually increase the shrinkRatio since the area adjustion of LUT/FF will be more accurate.
+        std::vector<std::pair<std::string, float>> typeAndSupplyRatios;
+        if (!macroLegalizationFixed)
+            typeAndSupplyRatios.emplace_back("SLICEL_CARRY8", supplyRatio);
+        typeAndSupplyRatios.emplace_back("SLICEL_MUXF8", 0.75);
+        typeAndSupplyRatios.emplace_back("SLICEL_MUXF7", 0.75);
+        if (!fusedLUTFFSpreading)
+        {
+            typeAndSupplyRatios.emplace_back("SLICEL_LUT", supplyRatio);
+            typeAndSupplyRatios.emplace_back("SLICEL_FF", supplyRatio);
+        }
+        spreadResourceTypesConcurrently(currentIteration, typeAndSupplyRatios);
+        if (fusedLUTFFSpreading)
+            spreadLUTFFJointly(currentIteration, supplyRatio);
+        if (applyCongestion)
+            placementInfo->resetCongestionCapacityRatios();
+        GeneralSpreader::shrinkMemoryPools(nJobs);
+
+        // the bin grid and the cell locations are rebuilt from the final PU anchors
+        placementInfo->updateElementBinGrid();
+        if (progressRatio > 0.4)
+        {
+            placementInfo->adjustLUTFFUtilization(neighborDisplacementUpperbound);
+        }
+        return;
+    }
+
     if (!macroLegalizationFixed)
     {
         std::string sharedCellType_SLICEL_CARRY8 = "SLICEL_CARRY8";
@@ -590,25 +665,148 @@ void GlobalPlacer::spreading(int currentIteration, int spreadRegionSizeLimit)
     // we gradually increase the shrinkRatio since the area adjustion of LUT/FF will be more accurate.
     // we provide less area so the LUTs/FFs will not be too dense. Too dense placement might be seriously disturbed when
     // some cells are inflatten.
+    if (fusedLUTFFSpreading)
+    {
+        spreadLUTFFJointly(currentIteration, supplyRatio);
+    }
+    else
+    {
+        std::string sharedCellType_SLICEL_LUT = "SLICEL_LUT";
+        generalSpreader = new GeneralSpreader(placementInfo, JSONCfg, sharedCellType_SLICEL_LUT, currentIteration,
+                                              supplyRatio, verbose);
+        generalSpreader->spreadPlacementUnits(spreadingForgetRatio);
+        delete generalSpreader;
+
+        std::string sharedCellType_SLICEL_FF = "SLICEL_FF";
+        generalSpreader = new GeneralSpreader(placementInfo, JSONCfg, sharedCellType_SLICEL_FF, currentIteration,
+                                              supplyRatio, verbose);
+        generalSpreader->spreadPlacementUnits(spreadingForgetRatio);
+        delete generalSpreader;
+    }
+
+    generalSpreader = nullptr;
+    if (applyCongestion)
+        placementInfo->resetCongestionCapacityRatios();
+    GeneralSpreader::shrinkMemoryPools(nJobs);
+
+    placementInfo->updateElementBinGrid();
+    if (progressRatio > 0.4)
+    {
+        placementInfo->adjustLUTFFUtilization(neighborDisplacementUpperbound);
+    }
+}
+
+void GlobalPlacer::spreadLUTFFJointly(int currentIteration, float supplyRatio)
+{
     std::string sharedCellType_SLICEL_LUT = "SLICEL_LUT";
+    std::string sharedCellType_SLICEL_FF = "SLICEL_FF";
     generalSpreader =
         new GeneralSpreader(placementInfo, JSONCfg, sharedCellType_SLICEL_LUT, currentIteration, supplyRatio, verbose);
+    generalSpreader->setCoupledCellType(sharedCellType_SLICEL_FF);
     generalSpreader->spreadPlacementUnits(spreadingForgetRatio);
     delete generalSpreader;
+    generalSpreader = nullptr;
+}
 
-    std::string sharedCellType_SLICEL_FF = "SLICEL_FF";
-    generalSpreader =
-        new GeneralSpreader(placementInfo, JSONCfg, sharedCellType_SLICEL_FF, currentIteration, supplyRatio, verbose);
-    generalSpreader->spreadPlacementUnits(spreadingForgetRatio);
-    delete generalSpreader;
+void GlobalPlacer::spreadResourceTypesConcurrently(int currentIteration,
+                                                   std::vector<std::pair<std::string, float>> &typeAndSupplyRatios)
+{
+    int numTypes = typeAndSupplyRatios.size();
+    std::vector<int> sharedTypeIds(numTypes);
+    for (int typeId = 0; typeId < numTypes; typeId++)
+        sharedTypeIds[typeId] = placementInfo->getSharedBELTypeId(typeAndSupplyRatios[typeId].first);
+
+    // two types interact when a macro has cells in both of their bin grids
+    std::vector<std::vector<bool>> interacted(numTypes, std::vector<bool>(numTypes, false));
+    auto &cellId2CellBinInfo = placementInfo->getCellId2CellBinInfo();
+    std::vector<bool> typeInMacro(numTypes, false);
+    for (auto curMacro : placementInfo->getPlacementMacros())
+    {
+        std::fill(typeInMacro.begin(), typeInMacro.end(), false);
+        for (auto curCell : curMacro->getCells())
+        {
+            int cellSharedTypeId = cellId2CellBinInfo[curCell->getCellId()].sharedTypeId;
+            for (int typeId = 0; typeId < numTypes; typeId++)
+            {
+                if (sharedTypeIds[typeId] == cellSharedTypeId)
+                    typeInMacro[typeId] = true;
+            }
+        }
+        for (int typeA = 0; typeA < numTypes; typeA++)
+            for (int typeB = typeA + 1; typeB < numTypes; typeB++)
+                if (typeInMacro[typeA] && typeInMacro[typeB])
+                    interacted[typeA][typeB] = interacted[typeB][typeA] = true;
+    }
 
-    generalSpreader = nullptr;
+    // each type is scheduled after all the earlier types it interacts with
+    std::vector<std::vector<int>> waves;
+    std::vector<int> type2Wave(numTypes, 0);
+    for (int typeId = 0; typeId < numTypes; typeId++)
+    {
+        for (int prevTypeId = 0; prevTypeId < typeId; prevTypeId++)
+        {
+            if (interacted[typeId][prevTypeId])
+                type2Wave[typeId] = std::max(type2Wave[typeId], type2Wave[prevTypeId] + 1);
+        }
+        if ((int)waves.size() <= type2Wave[typeId])
+            waves.resize(type2Wave[typeId] + 1);
+        waves[type2Wave[typeId]].push_back(typeId);
+    }
 
-    placementInfo->updateElementBinGrid();
-    if (progressRatio > 0.4)
+    // the threads of a wave are split among its types according to their numbers of cells
+    std::vector<int> typeCellNums(numTypes, 0);
+    for (auto &curCellBinInfo : cellId2CellBinInfo)
     {
-        placementInfo->adjustLUTFFUtilization(neighborDisplacementUpperbound);
+        for (int typeId = 0; typeId < numTypes; typeId++)
+        {
+            if (sharedTypeIds[typeId] == curCellBinInfo.sharedTypeId)
+                typeCellNums[typeId]++;
+        }
+    }
+
+    // the spreaders run their parallel loops in nested parallel regions with their shares of the threads
+    int prevMaxActiveLevels = omp_get_max_active_levels();
+    omp_set_max_active_levels(std::max(prevMaxActiveLevels, 2));
+    for (auto &wave : waves)
+    {
+        int waveSize = wave.size();
+        int waveCellNum = 0;
+        for (auto typeId : wave)
+            waveCellNum += typeCellNums[typeId];
+        std::vector<int> typeThreadNums(waveSize, 1);
+        for (int i = 0; i < waveSize; i++)
+        {
+            if (waveCellNum > 0)
+                typeThreadNums[i] = std::max(1, (int)((long long)nJobs * typeCellNums[wave[i]] / waveCellNum));
+        }
+
+        if (verbose)
+        {
+            std::string waveStr = "";
+            for (int i = 0; i < waveSize; i++)
+                waveStr += typeAndSupplyRatios[wave[i]].first + "(" + std::to_string(typeThreadNums[i]) + " threads) ";
+            print_status("GlobalPlacer: concurrently spreading: " + waveStr);
+        }
+
+#pragma omp parallel for schedule(dynamic, 1) num_threads(std::min(waveSize, nJobs)) if (waveSize > 1)
+        for (int i = 0; i < waveSize; i++)
+        {
+            auto &typeAndSupplyRatio = typeAndSupplyRatios[wave[i]];
+            GeneralSpreader *curSpreader = new GeneralSpreader(placementInfo, JSONCfg, typeAndSupplyRatio.first,
+                                                               currentIteration, typeAndSupplyRatio.second, verbose);
+            curSpreader->setNumThreads(waveSize > 1 ? typeThreadNums[i] : nJobs);
+            curSpreader->setRecordSpreadedLocations(false);
+            curSpreader->spreadPlacementUnits(spreadingForgetRatio);
+            delete curSpreader;
+        }
+
+        // reconcile the anchors for the later waves (forget ratio is based on the last spreaded location)
+        for (auto tmpPU : placementInfo->getPlacementUnits())
+        {
+            tmpPU->recordSpreadLocatin();
+        }
     }
+    omp_set_max_active_levels(prevMaxActiveLevels);
 }
 
 void GlobalPlacer::updatePseudoNetWeight(float &pseudoNetWeight, int curIter)
@@ -706,7 +904,7 @@ void GlobalPlacer::dumpCARRYCoordinate()
             std::stringstream outfile0;
             for (auto curPU : placementInfo->getPlacementUnits())
             {
-                if (auto curUnpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU))
+                if (auto curUnpackedCell = PlacementInfo::asUnpackedCell(curPU))
                 {
                     float cellX = curUnpackedCell->X();
                     float cellY = curUnpackedCell->Y();
@@ -716,7 +914,7 @@ void GlobalPlacer::dumpCARRYCoordinate()
                         outfile0 << cellX << " " << cellY << " " << curCell->getName() << "\n";
                     }
                 }
-                else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curPU))
+                else if (auto curMacro = PlacementInfo::asMacro(curPU))
                 {
                     for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
                     {
@@ -754,7 +952,7 @@ void GlobalPlacer::dumpFFCoordinate()
             std::stringstream outfile0;
             for (auto curPU : placementInfo->getPlacementUnits())
             {
-                if (auto curUnpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU))
+                if (auto curUnpackedCell = PlacementInfo::asUnpackedCell(curPU))
                 {
                     float cellX = curUnpackedCell->X();
                     float cellY = curUnpackedCell->Y();
@@ -764,7 +962,7 @@ void GlobalPlacer::dumpFFCoordinate()
                         outfile0 << cellX << " " << cellY << " " << curCell->getName() << "\n";
                     }
                 }
-                else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curPU))
+                else if (auto curMacro = PlacementInfo::asMacro(curPU))
                 {
                     for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
                     {
@@ -802,14 +1000,14 @@ void GlobalPlacer::dumpAllCellsCoordinate()
             std::stringstream outfile0;
             for (auto curPU : placementInfo->getPlacementUnits())
             {
-                if (auto curUnpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU))
+                if (auto curUnpackedCell = PlacementInfo::asUnpackedCell(curPU))
                 {
                     float cellX = curUnpackedCell->X();
                     float cellY = curUnpackedCell->Y();
                     DesignInfo::DesignCell *curCell = curUnpackedCell->getCell();
                     outfile0 << cellX << " " << cellY << " " << curCell->getName() << "\n";
                 }
-                else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curPU))
+                else if (auto curMacro = PlacementInfo::asMacro(curPU))
                 {
                     for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
                     {
@@ -847,7 +1045,7 @@ void GlobalPlacer::dumpLUTFFCoordinate(bool enforced)
                 std::stringstream outfile0;
                 for (auto curPU : placementInfo->getPlacementUnits())
                 {
-                    if (auto curUnpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU))
+                    if (auto curUnpackedCell = PlacementInfo::asUnpackedCell(curPU))
                     {
                         float cellX = curUnpackedCell->X();
                         float cellY = curUnpackedCell->Y();
@@ -857,7 +1055,7 @@ void GlobalPlacer::dumpLUTFFCoordinate(bool enforced)
                             outfile0 << cellX << " " << cellY << " " << curCell->getName() << "\n";
                         }
                     }
-                    else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curPU))
+                    else if (auto curMacro = PlacementInfo::asMacro(curPU))
                     {
                         for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
                         {
@@ -894,7 +1092,7 @@ void GlobalPlacer::dumpLUTFFCoordinate(bool enforced)
             std::stringstream outfile0;
             for (auto curPU : placementInfo->getPlacementUnits())
             {
-                if (auto curUnpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU))
+                if (auto curUnpackedCell = PlacementInfo::asUnpackedCell(curPU))
                 {
                     float cellX = curUnpackedCell->X();
                     float cellY = curUnpackedCell->Y();
@@ -904,7 +1102,7 @@ void GlobalPlacer::dumpLUTFFCoordinate(bool enforced)
                         outfile0 << cellX << " " << cellY << " " << curCell->getName() << "\n";
                     }
                 }
-                else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curPU))
+                else if (auto curMacro = PlacementInfo::asMacro(curPU))
                 {
                     for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
                     {
@@ -944,7 +1142,7 @@ void GlobalPlacer::dumpDSPCoordinate(bool enforced)
                 std::stringstream outfile0;
                 for (auto curPU : placementInfo->getPlacementUnits())
                 {
-                    if (auto curUnpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU))
+                    if (auto curUnpackedCell = PlacementInfo::asUnpackedCell(curPU))
                     {
                         float cellX = curUnpackedCell->X();
                         float cellY = curUnpackedCell->Y();
@@ -954,7 +1152,7 @@ void GlobalPlacer::dumpDSPCoordinate(bool enforced)
                             outfile0 << cellX << " " << cellY << " " << curCell->getName() << "\n";
                         }
                     }
-                    else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curPU))
+                    else if (auto curMacro = PlacementInfo::asMacro(curPU))
                     {
                         for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
                         {
@@ -990,7 +1188,7 @@ void GlobalPlacer::dumpDSPCoordinate(bool enforced)
             std::stringstream outfile0;
             for (auto curPU : placementInfo->getPlacementUnits())
             {
-                if (auto curUnpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU))
+                if (auto curUnpackedCell = PlacementInfo::asUnpackedCell(curPU))
                 {
                     float cellX = curUnpackedCell->X();
                     float cellY = curUnpackedCell->Y();
@@ -1000,7 +1198,7 @@ void GlobalPlacer::dumpDSPCoordinate(bool enforced)
                         outfile0 << cellX << " " << cellY << " " << curCell->getName() << "\n";
                     }
                 }
-                else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curPU))
+                else if (auto curMacro = PlacementInfo::asMacro(curPU))
                 {
                     for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
                     {
@@ -1040,7 +1238,7 @@ void GlobalPlacer::dumpBRAMCoordinate(bool enforced)
                 std::stringstream outfile0;
                 for (auto curPU : placementInfo->getPlacementUnits())
                 {
-                    if (auto curUnpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU))
+                    if (auto curUnpackedCell = PlacementInfo::asUnpackedCell(curPU))
                     {
                         float cellX = curUnpackedCell->X();
                         float cellY = curUnpackedCell->Y();
@@ -1050,7 +1248,7 @@ void GlobalPlacer::dumpBRAMCoordinate(bool enforced)
                             outfile0 << cellX << " " << cellY << " " << curCell->getName() << "\n";
                         }
                     }
-                    else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curPU))
+                    else if (auto curMacro = PlacementInfo::asMacro(curPU))
                     {
                         for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
                         {
@@ -1086,7 +1284,7 @@ void GlobalPlacer::dumpBRAMCoordinate(bool enforced)
             std::stringstream outfile0;
             for (auto curPU : placementInfo->getPlacementUnits())
             {
-                if (auto curUnpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU))
+                if (auto curUnpackedCell = PlacementInfo::asUnpackedCell(curPU))
                 {
                     float cellX = curUnpackedCell->X();
                     float cellY = curUnpackedCell->Y();
@@ -1096,7 +1294,7 @@ void GlobalPlacer::dumpBRAMCoordinate(bool enforced)
                         outfile0 << cellX << " " << cellY << " " << curCell->getName() << "\n";
                     }
                 }
-                else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curPU))
+                else if (auto curMacro = PlacementInfo::asMacro(curPU))
                 {
                     for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
                     {
@@ -20,6 +20,7 @@
 #include "DeviceInfo.h"
 #include "Eigen/SparseCore"
 #include "GeneralSpreader.h"
+#include "GlobalPlacementBudgetManager.h"
 #include "MacroLegalizer.h"
 #include "PlacementInfo.h"
 #include "PlacementTimingOptimizer.h"
@@ -191,6 +192,45 @@ class GlobalPlacer
      */
     void spreading(int currentIteration, int spreadRegionSizeLimit = 100000000);
 
+    /**
+     * @brief spread LUTs and FFs jointly by a single GeneralSpreader whose SpreadRegion(s) are determined by the
+     * coupled capacity of the SLICE sites shared by LUTs and FFs
+     *
+     * @param currentIteration the current global placement iteration in this round
+     * @param supplyRatio the supply ratio of the LUT/FF resources
+     */
+    void spreadLUTFFJointly(int currentIteration, float supplyRatio);
+
+    /**
+     * @brief spread the given resource types with a dependency-aware concurrent schedule
+     *
+     * Two resource types interact if a PlacementMacro has cells binned in both of their bin grids (e.g., a CARRY macro
+     * containing LUTs and FFs), since spreading one type will move the macro and update the cells in the other bin
+     * grid. Each type is scheduled into the earliest wave after all the earlier (in the given order) types it
+     * interacts with, so the interacting types keep the serial order while the independent ones run concurrently.
+     * After each wave, the spreaded locations of the PlacementUnits are recorded once for the later waves.
+     *
+     * The threads are split among the spreaders of a wave according to the numbers of cells of their types, and each
+     * spreader runs its own parallel loops with its share in a nested parallel region, so a wave dominated by one
+     * type (e.g., LUTs) still uses all the threads.
+     *
+     * @param currentIteration the current global placement iteration in this round
+     * @param typeAndSupplyRatios the resource types to spread (in the serial order) and their supply ratios
+     */
+    void spreadResourceTypesConcurrently(int currentIteration,
+                                         std::vector<std::pair<std::string, float>> &typeAndSupplyRatios);
+
+    /**
+     * @brief Set the budget manager which can terminate the global placement stages early according to the
+     * wall-clock/iteration budget and the convergence trend
+     *
+     * @param _budgetManager the budget manager (nullptr to disable)
+     */
+    inline void setBudgetManager(GlobalPlacementBudgetManager *_budgetManager)
+    {
+        budgetManager = _budgetManager;
+    }
+
   private:
     PlacementInfo *placementInfo;
 
@@ -236,6 +276,40 @@ class GlobalPlacer
      */
     GeneralSpreader *generalSpreader = nullptr;
 
+    /**
+     * @brief spread the resource types concurrently if their bin grids and PlacementUnits do not interact
+     *
+     */
+    bool concurrentSpreading = false;
+    int nJobs = 1;
+
+    /**
+     * @brief shrink the effective capacity of the congested LUT/FF bins according to a routing demand map updated in
+     * each spreading iteration
+     *
+     */
+    bool congestionAwareSpreading = false;
+
+    /**
+     * @brief spread LUTs and FFs by a single spreader with the coupled capacity of the SLICE sites they share
+     *
+     */
+    bool fusedLUTFFSpreading = false;
+
+    /**
+     * @brief the routing demand beyond which a bin is regarded as congested by congestion-aware spreading (set by
+     * "SpreaderCongestionDemandThreshold")
+     *
+     */
+    float congestionDemandThreshold = 80;
+
+    /**
+     * @brief the lower bound of the capacity ratio of a congested bin in congestion-aware spreading (set by
+     * "SpreaderCongestionMinCapacityRatio")
+     *
+     */
+    float congestionMinCapacityRatio = 0.7;
+
     /**
      * @brief legalize multi-site BRAM/DSP elements
      *
@@ -260,6 +334,12 @@ class GlobalPlacer
      */
     CLBLegalizer *lCLBLegalizer = nullptr;
 
+    /**
+     * @brief the budget manager deciding the early termination of global placement stages (not owned)
+     *
+     */
+    GlobalPlacementBudgetManager *budgetManager = nullptr;
+
     /**
      * @brief update pseudo net weight according to placement progress
      *
@@ -0,0 +1,238 @@
+/**
+ * @file SpreaderMemoryPool.h
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This header file contains the definitions of the thread-local memory pools which recycle the short-lived
+ * objects and buffers of cell spreading.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ */
+
+#ifndef _SPREADERMEMORYPOOL
+#define _SPREADERMEMORYPOOL
+
+#include <atomic>
+#include <new>
+#include <vector>
+
+/**
+ * @brief SpreaderObjectPool recycles the memory blocks of the objects of type T with a thread-local free list.
+ *
+ * A class can route its operator new/delete to this pool so the objects created and deleted in every spreading loop
+ * reuse the blocks released by the previous loops instead of going through the heap allocator. A block released by
+ * a thread is recycled by that thread, no matter which thread allocated it. The idle blocks can be dropped by
+ * requestShrink() when the spreading is finished.
+ *
+ * @tparam T the type of the pooled objects
+ */
+template <class T> class SpreaderObjectPool
+{
+  public:
+    static void *allocate(std::size_t size)
+    {
+        if (size != sizeof(T))
+            return ::operator new(size);
+        std::vector<void *> &freeBlocks = getFreeBlocks();
+        if (freeBlocks.empty())
+            return ::operator new(size);
+        void *block = freeBlocks.back();
+        freeBlocks.pop_back();
+        return block;
+    }
+
+    static void deallocate(void *block, std::size_t size)
+    {
+        if (!block)
+            return;
+        std::vector<void *> &freeBlocks = getFreeBlocks();
+        if (size != sizeof(T) || freeBlocks.size() >= maxFreeBlockNum)
+        {
+            ::operator delete(block);
+            return;
+        }
+        freeBlocks.push_back(block);
+    }
+
+    /**
+     * @brief request all the threads to drop their idle blocks. A thread drops them at its next access to the pool
+     * (or applyPendingShrink()).
+     *
+     */
+    static void requestShrink()
+    {
+        getShrinkEpoch().fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief drop the idle blocks of the calling thread if a shrink is requested after its last access to the pool
+     *
+     */
+    static void applyPendingShrink()
+    {
+        getFreeBlocks();
+    }
+
+  private:
+    /**
+     * @brief the maximum number of idle blocks kept by a thread
+     *
+     */
+    static constexpr std::size_t maxFreeBlockNum = 4096;
+
+    struct FreeBlockList
+    {
+        std::vector<void *> blocks;
+        unsigned int shrinkEpoch = 0;
+        void release()
+        {
+            for (auto block : blocks)
+                ::operator delete(block);
+            std::vector<void *>().swap(blocks);
+        }
+        ~FreeBlockList()
+        {
+            release();
+        }
+    };
+
+    static std::atomic<unsigned int> &getShrinkEpoch()
+    {
+        static std::atomic<unsigned int> shrinkEpoch(0);
+        return shrinkEpoch;
+    }
+
+    static std::vector<void *> &getFreeBlocks()
+    {
+        thread_local FreeBlockList freeBlockList;
+        unsigned int curShrinkEpoch = getShrinkEpoch().load(std::memory_order_relaxed);
+        if (freeBlockList.shrinkEpoch != curShrinkEpoch)
+        {
+            freeBlockList.release();
+            freeBlockList.shrinkEpoch = curShrinkEpoch;
+        }
+        return freeBlockList.blocks;
+    }
+};
+
+/**
+ * @brief SpreaderVectorPool recycles the capacity of std::vector buffers with a thread-local free list.
+ *
+ * The vectors of the spreading data structures are swapped with the idle buffers when the structures are created and
+ * swapped back when they are destroyed, so the buffers grow to the working size once and are reused afterwards. The
+ * idle buffers can be dropped by requestShrink() when the spreading is finished.
+ *
+ * @tparam E the element type of the vectors
+ */
+template <class E> class SpreaderVectorPool
+{
+  public:
+    /**
+     * @brief replace the given (empty) vector with an idle buffer of the pool
+     *
+     * @param vec the vector to be filled by the caller
+     */
+    static void acquire(std::vector<E> &vec)
+    {
+        std::vector<std::vector<E>> &freeVectors = getFreeVectors();
+        if (freeVectors.empty())
+            return;
+        vec.swap(freeVectors.back());
+        freeVectors.pop_back();
+        vec.clear();
+    }
+
+    /**
+     * @brief hand the buffer of the given vector to the pool. The vector will be empty afterwards.
+     *
+     * @param vec the vector which is no longer used by the caller
+     */
+    static void release(std::vector<E> &vec)
+    {
+        std::vector<std::vector<E>> &freeVectors = getFreeVectors();
+        if (vec.capacity() == 0 || freeVectors.size() >= maxFreeVectorNum)
+        {
+            std::vector<E>().swap(vec);
+            return;
+        }
+        vec.clear();
+        freeVectors.emplace_back();
+        freeVectors.back().swap(vec);
+    }
+
+    /**
+     * @brief request all the threads to drop their idle buffers. A thread drops them at its next access to the pool
+     * (or applyPendingShrink()).
+     *
+     */
+    static void requestShrink()
+    {
+        getShrinkEpoch().fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief drop the idle buffers of the calling thread if a shrink is requested after its last access to the pool
+     *
+     */
+    static void applyPendingShrink()
+    {
+        getFreeVectors();
+    }
+
+  private:
+    /**
+     * @brief the maximum number of idle buffers kept by a thread
+     *
+     */
+    static constexpr std::size_t maxFreeVectorNum = 1024;
+
+    struct FreeVectorList
+    {
+        std::vector<std::vector<E>> vectors;
+        unsigned int shrinkEpoch = 0;
+    };
+
+    static std::atomic<unsigned int> &getShrinkEpoch()
+    {
+        static std::atomic<unsigned int> shrinkEpoch(0);
+        return shrinkEpoch;
+    }
+
+    static std::vector<std::vector<E>> &getFreeVectors()
+    {
+        thread_local FreeVectorList freeVectorList;
+        unsigned int curShrinkEpoch = getShrinkEpoch().load(std::memory_order_relaxed);
+        if (freeVectorList.shrinkEpoch != curShrinkEpoch)
+        {
+            std::vector<std::vector<E>>().swap(freeVectorList.vectors);
+            freeVectorList.shrinkEpoch = curShrinkEpoch;
+        }
+        return freeVectorList.vectors;
+    }
+};
+
+/**
+ * @brief PooledVector is a scoped temporary vector whose buffer is borrowed from SpreaderVectorPool
+ *
+ * @tparam E the element type of the vector
+ */
+template <class E> class PooledVector
+{
+  public:
+    PooledVector()
+    {
+        SpreaderVectorPool<E>::acquire(vec);
+    }
+    ~PooledVector()
+    {
+        SpreaderVectorPool<E>::release(vec);
+    }
+    PooledVector(const PooledVector &) = delete;
+    PooledVector &operator=(const PooledVector &) = delete;
+
+    std::vector<E> vec;
+};
+
+#endif
@@ -540,17 +540,16 @@ void WirelengthOptimizer::addPseudoNet_SlackBased(float timingWeight, double sla
     if (slackPowFactor < 0 || timingWeight < 0)
         return;
 
-    // float maxEnhanceRatio = 0;
-    auto timingNodes = placementInfo->getTimingInfo()->getSimplePlacementTimingInfo();
+    auto &timingNodes = placementInfo->getTimingInfo()->getSimplePlacementTimingInfo();
     float clockPeriod = placementInfo->getTimingInfo()->getSimplePlacementTimingGraph()->getClockPeriod();
     auto &cellLoc = placementInfo->getCellId2location();
     assert(cellLoc.size() == timingNodes.size());
 
-    // std::ofstream outfile0("timingOptProc.log");
-
-    // auto deviceInfo = placementInfo->getDeviceInfo();
-
-    int enhanceNetCnt = 0;
+    // prepare the candidate nets serially since netPinEnhanceRate is a std::map
+    std::vector<PlacementInfo::PlacementNet *> candidateNets;
+    std::vector<int> candidateDriverPins;
+    candidateNets.reserve(placementInfo->getPlacementNets().size());
+    candidateDriverPins.reserve(placementInfo->getPlacementNets().size());
     for (auto curNet : placementInfo->getPlacementNets())
     {
         auto designNet = curNet->getDesignNet();
@@ -559,7 +558,6 @@ void WirelengthOptimizer::addPseudoNet_SlackBased(float timingWeight, double sla
 
         if (curNet->getDriverUnits().size() != 1 || curNet->getUnits().size() <= 1 || curNet->getUnits().size() >= 4000)
             continue;
-        auto &PUs = curNet->getUnits();
         auto &pins = designNet->getPins();
         int pinNum = pins.size();
 
@@ -578,82 +576,124 @@ void WirelengthOptimizer::addPseudoNet_SlackBased(float timingWeight, double sla
 
         assert(driverPinInNet >= 0);
 
-        // get the srcPin information
-        auto srcCell = pins[driverPinInNet]->getCell();
-        unsigned int srcCellId = srcCell->getCellId();
-        auto srcNode = timingNodes[srcCellId];
-        auto srcLoc = cellLoc[srcCellId];
-        int driverPathLen = timingNodes[srcCellId]->getLongestPathLength();
-
-        float w = 2 * timingWeight / std::pow((float)(pinNum - 1), 0.5);
-
         if (netPinEnhanceRate.find(designNet) == netPinEnhanceRate.end())
         {
             netPinEnhanceRate[designNet] = std::vector<float>(pinNum, 1.0);
         }
+        candidateNets.push_back(curNet);
+        candidateDriverPins.push_back(driverPinInNet);
+    }
 
-        auto &pinEnhanceRate = netPinEnhanceRate[designNet];
-        // iterate the sinkPin for evaluation and enhancement
-        for (int pinBeDriven = 0; pinBeDriven < pinNum; pinBeDriven++)
+    // find the pin2pin connections with negative slack in parallel. The contiguous static partition ensures that the
+    // concatenation of the thread-local buffers keeps the order of the serial implementation.
+    int numCandidateNets = candidateNets.size();
+    int nThreads = omp_get_max_threads();
+    std::vector<std::vector<SlackBasedPin2PinEnhancement>> threadEnhancements(nThreads);
+#pragma omp parallel num_threads(nThreads)
+    {
+        auto &localEnhancements = threadEnhancements[omp_get_thread_num()];
+#pragma omp for schedule(static)
+        for (int netIdInCandidates = 0; netIdInCandidates < numCandidateNets; netIdInCandidates++)
         {
-            if (pinBeDriven == driverPinInNet)
-                continue;
+            auto curNet = candidateNets[netIdInCandidates];
+            int driverPinInNet = candidateDriverPins[netIdInCandidates];
+            auto &pins = curNet->getDesignNet()->getPins();
+            int pinNum = pins.size();
 
-            // get the sinkPin information
-            auto sinkCell = pins[pinBeDriven]->getCell();
-            unsigned int sinkCellId = sinkCell->getCellId();
-            auto sinkNode = timingNodes[sinkCellId];
-            auto sinkLoc = cellLoc[sinkCellId];
-            int succPathLen = sinkNode->getLongestPathLength();
-            float netDelay = timingOptimizer->getDelayByModel(sinkLoc.X, sinkLoc.Y, srcLoc.X, srcLoc.Y);
-            float slack = sinkNode->getRequiredArrivalTime() - srcNode->getLatestArrival() - netDelay;
+            // get the srcPin information
+            unsigned int srcCellId = pins[driverPinInNet]->getCell()->getCellId();
+            auto srcNode = timingNodes[srcCellId];
+            auto srcLoc = cellLoc[srcCellId];
+            int driverPathLen = srcNode->getLongestPathLength();
 
-            if (slack > 0)
-                continue;
-            enhanceNetCnt++;
-            // enhance the net based on the slack
-            float enhanceRatio = std::pow(1 - slack / clockPeriod, slackPowFactor);
-            // * std::pow(netDelay / expectedAvgDelay_driver, 0.6);
+            float w = 2 * timingWeight / std::pow((float)(pinNum - 1), 0.5);
 
-            if (srcNode->checkIsRegister())
-            {
-                if (succPathLen > 0)
-                {
-                    float expectedAvgDelay_succ = clockPeriod / succPathLen;
-                    if (netDelay > expectedAvgDelay_succ)
-                        enhanceRatio =
-                            std::max(enhanceRatio, (float)std::pow((netDelay / expectedAvgDelay_succ), 0.66));
-                }
-            }
-            else
+            // iterate the sinkPin for evaluation
+            for (int pinBeDriven = 0; pinBeDriven < pinNum; pinBeDriven++)
             {
-                if (driverPathLen > 0)
-                {
-                    float expectedAvgDelay_driver = clockPeriod / driverPathLen;
-                    if (netDelay > expectedAvgDelay_driver)
-                        enhanceRatio =
-                            std::max(enhanceRatio, (float)std::pow((netDelay / expectedAvgDelay_driver), 0.66));
-                }
+                if (pinBeDriven == driverPinInNet)
+                    continue;
+
+                // get the sinkPin information
+                unsigned int sinkCellId = pins[pinBeDriven]->getCell()->getCellId();
+                auto sinkNode = timingNodes[sinkCellId];
+                auto sinkLoc = cellLoc[sinkCellId];
+                float netDelay = timingOptimizer->getDelayByModel(sinkLoc.X, sinkLoc.Y, srcLoc.X, srcLoc.Y);
+                float slack = sinkNode->getRequiredArrivalTime() - srcNode->getLatestArrival() - netDelay;
+
+                if (slack > 0)
+                    continue;
+
+                // the path-length-based expectation of the net delay (0 for no expectation)
+                int pathLen = srcNode->checkIsRegister() ? sinkNode->getLongestPathLength() : driverPathLen;
+                float expectedAvgDelay = (pathLen > 0) ? clockPeriod / pathLen : 0;
+
+                localEnhancements.push_back(SlackBasedPin2PinEnhancement{curNet, driverPinInNet, pinBeDriven, w, slack,
+                                                                         netDelay, expectedAvgDelay});
             }
+        }
+    }
 
-            // enhanceRatio = std::pow(enhanceRatio, 0.5) * std::pow(pinEnhanceRate[pinBeDriven], 0.5);
-            // pinEnhanceRate[pinBeDriven] = enhanceRatio;
+    std::vector<SlackBasedPin2PinEnhancement> enhancements;
+    for (auto &localEnhancements : threadEnhancements)
+        enhancements.insert(enhancements.end(), localEnhancements.begin(), localEnhancements.end());
+    int enhanceNetCnt = enhancements.size();
 
-            curNet->addPseudoNet_enhancePin2Pin(
-                xSolver->solverData.objectiveMatrixTripletList, xSolver->solverData.objectiveMatrixDiag,
-                xSolver->solverData.objectiveVector, w * enhanceRatio, y2xRatio, true, false,
-                PUs[driverPinInNet]->getId(), PUs[pinBeDriven]->getId(), driverPinInNet, pinBeDriven);
+    // enhance the nets based on the slack in a flat, vectorizable pass
+    std::vector<float> slacks(enhanceNetCnt), netDelays(enhanceNetCnt), expectedAvgDelays(enhanceNetCnt),
+        enhanceWeights(enhanceNetCnt);
+    for (int i = 0; i < enhanceNetCnt; i++)
+    {
+        slacks[i] = enhancements[i].slack;
+        netDelays[i] = enhancements[i].netDelay;
+        expectedAvgDelays[i] = enhancements[i].expectedAvgDelay;
+        enhanceWeights[i] = enhancements[i].baseWeight;
+    }
+    float slackPowFactor_f = slackPowFactor;
+#pragma omp parallel for simd schedule(static)
+    for (int i = 0; i < enhanceNetCnt; i++)
+    {
+        float enhanceRatio = std::pow(1 - slacks[i] / clockPeriod, slackPowFactor_f);
+        bool delayExceeded = expectedAvgDelays[i] > 0 && netDelays[i] > expectedAvgDelays[i];
+        float delayRatio = delayExceeded ? netDelays[i] / expectedAvgDelays[i] : 1.0f;
+        float delayEnhanceRatio = std::pow(delayRatio, 0.66f);
+        enhanceRatio = (delayExceeded && delayEnhanceRatio > enhanceRatio) ? delayEnhanceRatio : enhanceRatio;
+        enhanceWeights[i] *= enhanceRatio;
+    }
 
-            curNet->addPseudoNet_enhancePin2Pin(
-                ySolver->solverData.objectiveMatrixTripletList, ySolver->solverData.objectiveMatrixDiag,
-                ySolver->solverData.objectiveVector, w * enhanceRatio, y2xRatio, false, true,
-                PUs[driverPinInNet]->getId(), PUs[pinBeDriven]->getId(), driverPinInNet, pinBeDriven);
+    // emit the pin2pin pseudo nets into the X/Y B2B models concurrently since they do not share any data
+#pragma omp parallel sections
+    {
+#pragma omp section
+        {
+            for (int i = 0; i < enhanceNetCnt; i++)
+            {
+                auto &enhancement = enhancements[i];
+                auto &PUs = enhancement.net->getUnits();
+                enhancement.net->addPseudoNet_enhancePin2Pin(
+                    xSolver->solverData.objectiveMatrixTripletList, xSolver->solverData.objectiveMatrixDiag,
+                    xSolver->solverData.objectiveVector, enhanceWeights[i], y2xRatio, true, false,
+                    PUs[enhancement.driverPinInNet]->getId(), PUs[enhancement.sinkPinInNet]->getId(),
+                    enhancement.driverPinInNet, enhancement.sinkPinInNet);
+            }
+        }
+#pragma omp section
+        {
+            for (int i = 0; i < enhanceNetCnt; i++)
+            {
+                auto &enhancement = enhancements[i];
+                auto &PUs = enhancement.net->getUnits();
+                enhancement.net->addPseudoNet_enhancePin2Pin(
+                    ySolver->solverData.objectiveMatrixTripletList, ySolver->solverData.objectiveMatrixDiag,
+                    ySolver->solverData.objectiveVector, enhanceWeights[i], y2xRatio, false, true,
+                    PUs[enhancement.driverPinInNet]->getId(), PUs[enhancement.sinkPinInNet]->getId(),
+                    enhancement.driverPinInNet, enhancement.sinkPinInNet);
+            }
         }
     }
 
     print_status("WirelengthOptimizer: addPseudoNet_SlackBased done (" + std::to_string(enhanceNetCnt) +
                  " pin2pin nets have been enhanced.");
-    // outfile0.close();
 }
 
 void WirelengthOptimizer::addPseudoNet2LoctionForAllPUs(float pesudoNetWeight, bool considerNetNum)
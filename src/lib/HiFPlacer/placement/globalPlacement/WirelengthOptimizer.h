@@ -235,6 +235,9 @@ class WirelengthOptimizer
     /**
      * @brief add pseudo net for timing optimization based on the timing slack of each elements in the design netlist
      *
+     * The critical pin2pin connections are selected in parallel into thread-local buffers, their weights are computed
+     * in a flat vectorizable pass and the pseudo nets for X/Y are emitted into the two QP models concurrently.
+     *
      * @param timingWeight the common weight factor for pseudo nets for timing
      * @param slackPowFactor a factor for the sensitivity of negative timing slack
      * @param timingOptimizer the handler of timing-related analysis
@@ -265,6 +268,32 @@ class WirelengthOptimizer
         return std::abs(x0 - x1) + y2xRatio * std::abs(y0 - y1);
     }
 
+    /**
+     * @brief a timing-critical pin2pin connection found by addPseudoNet_SlackBased, which will be enhanced by a
+     * pseudo net in the quadratic model
+     *
+     */
+    struct SlackBasedPin2PinEnhancement
+    {
+        PlacementInfo::PlacementNet *net;
+        int driverPinInNet;
+        int sinkPinInNet;
+
+        /**
+         * @brief the base weight of the pseudo net before the slack-based enhancement
+         *
+         */
+        float baseWeight;
+        float slack;
+        float netDelay;
+
+        /**
+         * @brief the expected average delay of the nets along the path (0 if the path length is unknown)
+         *
+         */
+        float expectedAvgDelay;
+    };
+
     PlacementInfo *placementInfo;
 
     QPSolverWrapper *xSolver = nullptr;
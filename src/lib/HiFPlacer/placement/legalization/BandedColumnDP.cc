@@ -0,0 +1,153 @@
+/**
+ * @file BandedColumnDP.cc
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This implementation file contains APIs' implementation of BandedColumnDP, the dynamic programming engine which
+ * places the ordered PlacementUnits of a column onto the sites of the column with the minimum total cost.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ */
+
+#include "BandedColumnDP.h"
+
+#include <algorithm>
+
+constexpr float BandedColumnDP::infeasibleCost;
+
+void BandedColumnDP::setColumn(int numSites, const std::vector<int> &PUHeights,
+                               const std::vector<int> &PUTargetSiteIds, int bandWidth)
+{
+    assert(PUHeights.size() == PUTargetSiteIds.size());
+    this->numSites = numSites;
+    numPUs = PUHeights.size();
+    heights = PUHeights;
+    bandLow.resize(numPUs);
+    bandHigh.resize(numPUs);
+    rowBegin.resize(numPUs + 1);
+
+    // the sites below/above the i-th PlacementUnit should be enough for the PlacementUnits below/above it
+    std::vector<int> prefixHeights(numPUs + 1, 0);
+    for (int i = 0; i < numPUs; i++)
+        prefixHeights[i + 1] = prefixHeights[i] + heights[i];
+    int totalHeight = prefixHeights[numPUs];
+
+    // the bottom sites when the PlacementUnits are packed in order from their target sites
+    std::vector<int> packedBottoms(numPUs);
+    if (bandWidth >= 0)
+    {
+        for (int i = 0; i < numPUs; i++)
+        {
+            packedBottoms[i] = PUTargetSiteIds[i];
+            if (i > 0)
+                packedBottoms[i] = std::max(packedBottoms[i], packedBottoms[i - 1] + heights[i - 1]);
+        }
+        for (int i = numPUs - 1; i >= 0; i--)
+        {
+            int maxBottom = (i == numPUs - 1) ? numSites - heights[i] : packedBottoms[i + 1] - heights[i];
+            packedBottoms[i] = std::min(packedBottoms[i], maxBottom);
+        }
+    }
+
+    rowBegin[0] = 0;
+    for (int i = 0; i < numPUs; i++)
+    {
+        bandLow[i] = prefixHeights[i + 1] - 1;
+        bandHigh[i] = numSites - 1 - (totalHeight - prefixHeights[i + 1]);
+        if (bandWidth >= 0)
+        {
+            int lowBottom = std::min(PUTargetSiteIds[i], packedBottoms[i]) - bandWidth;
+            int highBottom = std::max(PUTargetSiteIds[i], packedBottoms[i]) + bandWidth;
+            bandLow[i] = std::max(bandLow[i], lowBottom + heights[i] - 1);
+            bandHigh[i] = std::min(bandHigh[i], highBottom + heights[i] - 1);
+        }
+        rowBegin[i + 1] = rowBegin[i] + std::max(0, bandHigh[i] - bandLow[i] + 1);
+    }
+
+    costs.assign(rowBegin[numPUs], infeasibleCost);
+    f.resize(rowBegin[numPUs]);
+    fChoice.assign(rowBegin[numPUs], 0);
+}
+
+void BandedColumnDP::getFeasibleCosts(std::vector<std::vector<std::pair<int, float>>> &PUCosts)
+{
+    PUCosts.assign(numPUs, std::vector<std::pair<int, float>>(0));
+    for (int i = 0; i < numPUs; i++)
+    {
+        for (int j = bandLow[i], k = rowBegin[i]; j <= bandHigh[i]; j++, k++)
+        {
+            if (costs[k] < infeasibleCost)
+                PUCosts[i].emplace_back(j, costs[k]);
+        }
+    }
+}
+
+bool BandedColumnDP::solve(std::vector<int> &PUBottomSiteIds)
+{
+    PUBottomSiteIds.assign(numPUs, -1);
+    if (!numPUs)
+        return true;
+    for (int i = 0; i < numPUs; i++)
+    {
+        if (bandLow[i] > bandHigh[i])
+            return false;
+    }
+
+    int minLastPUTop = -1;
+
+    // the first PlacementUnit: f[0][j] is the minimum cost of the sites up to j
+    float minHPWLChange = infeasibleCost;
+    for (int j = bandLow[0], k = rowBegin[0]; j <= bandHigh[0]; j++, k++)
+    {
+        if (costs[k] < minHPWLChange)
+        {
+            minHPWLChange = costs[k];
+            fChoice[k] = 1;
+            if (numPUs == 1)
+                minLastPUTop = j;
+        }
+        f[k] = minHPWLChange;
+    }
+
+    for (int i = 1; i < numPUs; i++)
+    {
+        float minVal = 100000000.0;
+        int heightPURow = heights[i];
+        // the entry below the band is never reachable
+        float lastF = 1000000000.0;
+        for (int j = bandLow[i], k = rowBegin[i]; j <= bandHigh[i]; j++, k++)
+        {
+            float newF = getF(i - 1, j - heightPURow) + costs[k];
+            if (lastF > newF)
+            {
+                fChoice[k] = 1;
+                if (i == numPUs - 1 && newF < minVal)
+                {
+                    minVal = newF;
+                    minLastPUTop = j;
+                }
+            }
+            lastF = std::min(lastF, newF);
+            f[k] = lastF;
+        }
+    }
+
+    if (minLastPUTop < 0)
+        return false;
+
+    // trace back from the top PlacementUnit, where the top site of a PlacementUnit is the last improvement of f below
+    // the bottom of the PlacementUnit above it
+    for (int i = numPUs - 1; i >= 0; i--)
+    {
+        minLastPUTop = std::min(minLastPUTop, bandHigh[i]);
+        while (minLastPUTop >= bandLow[i] && !fChoice[rowBegin[i] + minLastPUTop - bandLow[i]])
+            minLastPUTop--;
+        if (minLastPUTop < bandLow[i])
+            return false;
+        PUBottomSiteIds[i] = minLastPUTop - heights[i] + 1;
+        minLastPUTop -= heights[i];
+    }
+    return true;
+}
@@ -0,0 +1,151 @@
+/**
+ * @file BandedColumnDP.h
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This header file contains the definitions of BandedColumnDP class, the dynamic programming engine which
+ * places the ordered PlacementUnits of a column onto the sites of the column with the minimum total cost.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ */
+
+#ifndef _BANDEDCOLUMNDP
+#define _BANDEDCOLUMNDP
+
+#include <assert.h>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief BandedColumnDP solves the column legalization DP of the macro/CLB legalizers
+ *
+ * The PlacementUnits of a column are ordered from bottom to top and the i-th one occupies heights[i] consecutive sites.
+ * With the sites of the column sorted by SiteY, the DP is
+ *
+ * f[i][j] = min(f[i][j-1], f[i-1][j-heights[i]] + cost[i][j])
+ *
+ * where j is the top site of the i-th PlacementUnit and cost[i][j] is the cost to place it at sites
+ * j-heights[i]+1 ... j (infeasibleCost if it cannot be placed there).
+ *
+ * The top site of each PlacementUnit is restricted to a band around its target site and the position it would get by
+ * packing the PlacementUnits in order, so only O(#PlacementUnits x bandWidth) entries are evaluated. The entries
+ * outside the band are regarded as infeasible, so the result is the same as the full DP whenever the optimal solution
+ * of the full DP is within the band. If no solution can be found in the band, the caller can solve the column again
+ * without the band. The tables and costs are stored in flat arrays where the entries of a PlacementUnit are
+ * contiguous.
+ *
+ */
+class BandedColumnDP
+{
+  public:
+    BandedColumnDP()
+    {
+    }
+    ~BandedColumnDP()
+    {
+    }
+
+    /**
+     * @brief the cost of the locations where a PlacementUnit cannot be placed
+     *
+     */
+    static constexpr float infeasibleCost = 1100000000.0;
+
+    /**
+     * @brief set up the problem of a column
+     *
+     * @param numSites the number of sites in the column
+     * @param PUHeights the number of sites required by each PlacementUnit, from bottom to top
+     * @param PUTargetSiteIds the index of the site nearest to the bottom of each PlacementUnit
+     * @param bandWidth the number of sites by which a PlacementUnit can move beyond its target/packed position, or a
+     * negative value to disable the band
+     */
+    void setColumn(int numSites, const std::vector<int> &PUHeights, const std::vector<int> &PUTargetSiteIds,
+                   int bandWidth);
+
+    /**
+     * @brief get the lowest top site of the PlacementUnit in the band
+     *
+     * @param PUId the index of the PlacementUnit in the column
+     * @return int
+     */
+    inline int getBandLow(int PUId)
+    {
+        return bandLow[PUId];
+    }
+
+    /**
+     * @brief get the highest top site of the PlacementUnit in the band
+     *
+     * @param PUId the index of the PlacementUnit in the column
+     * @return int
+     */
+    inline int getBandHigh(int PUId)
+    {
+        return bandHigh[PUId];
+    }
+
+    /**
+     * @brief set the cost to place a PlacementUnit with its top at the given site
+     *
+     * @param PUId the index of the PlacementUnit in the column
+     * @param topSiteId the top site, which should be in the band of the PlacementUnit
+     * @param cost
+     */
+    inline void setCost(int PUId, int topSiteId, float cost)
+    {
+        assert(topSiteId >= bandLow[PUId] && topSiteId <= bandHigh[PUId]);
+        costs[rowBegin[PUId] + topSiteId - bandLow[PUId]] = cost;
+    }
+
+    /**
+     * @brief get the feasible top sites (in the band) and their costs of each PlacementUnit
+     *
+     * @param PUCosts the resultant (top site, cost) pairs of each PlacementUnit
+     */
+    void getFeasibleCosts(std::vector<std::vector<std::pair<int, float>>> &PUCosts);
+
+    /**
+     * @brief solve the DP with the costs
+     *
+     * @param PUBottomSiteIds the resultant bottom site of each PlacementUnit
+     * @return true if a feasible solution is found in the band
+     */
+    bool solve(std::vector<int> &PUBottomSiteIds);
+
+  private:
+    int numSites = 0;
+    int numPUs = 0;
+    std::vector<int> heights;
+    std::vector<int> bandLow;
+    std::vector<int> bandHigh;
+
+    /**
+     * @brief the offset of the entries of each PlacementUnit in the flat arrays
+     *
+     */
+    std::vector<int> rowBegin;
+    std::vector<float> costs;
+    std::vector<float> f;
+    std::vector<unsigned char> fChoice;
+
+    /**
+     * @brief get f[PUId][topSiteId], including the entries outside the band
+     *
+     * @param PUId
+     * @param topSiteId
+     * @return float
+     */
+    inline float getF(int PUId, int topSiteId)
+    {
+        if (topSiteId < bandLow[PUId])
+            return PUId ? 1000000000.0 : infeasibleCost;
+        if (topSiteId > bandHigh[PUId])
+            topSiteId = bandHigh[PUId];
+        return f[rowBegin[PUId] + topSiteId - bandLow[PUId]];
+    }
+};
+
+#endif
@@ -25,7 +25,6 @@ CLBLegalizer::CLBLegalizer(std::string legalizerName, PlacementInfo *placementIn
       cellLoc(placementInfo->getCellId2location()), JSONCfg(JSONCfg)
 {
     PUsToLegalize.clear();
-    PU2Site2HPWLIncrease.clear();
     PU2X.clear();
     PU2Y.clear();
     PU2LegalSites.clear();
@@ -51,6 +50,8 @@ CLBLegalizer::CLBLegalizer(std::string legalizerName, PlacementInfo *placementIn
     {
         y2xRatio = std::stof(JSONCfg["y2xRatio"]);
     }
+    HPWLEvaluator = new HPWLChangeEvaluator(placementInfo, y2xRatio);
+    siteSpatialIndex = new SiteSpatialIndex(y2xRatio);
 
     if (JSONCfg.find("CLBLegalizationVerbose") != JSONCfg.end())
     {
@@ -61,61 +62,130 @@ CLBLegalizer::CLBLegalizer(std::string legalizerName, PlacementInfo *placementIn
     {
         nJobs = std::stoi(JSONCfg["jobs"]);
     }
+    minCostFlowEngine = MinCostBipartiteMatcher::getMinCostFlowEngine(JSONCfg);
+
+    if (JSONCfg.find("IncrementalLegalization") != JSONCfg.end())
+    {
+        incrementalLegalization = JSONCfg["IncrementalLegalization"] == "true";
+    }
+
+    if (JSONCfg.find("LegalizationDPBandWidth") != JSONCfg.end())
+    {
+        DPBandWidth = std::stoi(JSONCfg["LegalizationDPBandWidth"]);
+    }
+
+    if (JSONCfg.find("CLBLegalizationMethod") != JSONCfg.end())
+    {
+        packingLegalization = JSONCfg["CLBLegalizationMethod"] == "packing";
+        assert((packingLegalization || JSONCfg["CLBLegalizationMethod"] == "matching") &&
+               "undefined CLB legalization method.");
+    }
+
+    if (JSONCfg.find("CLBPackingRefineBandWidth") != JSONCfg.end())
+    {
+        packingRefineBandWidth = std::stoi(JSONCfg["CLBPackingRefineBandWidth"]);
+    }
+
+    if (JSONCfg.find("DumpLegalizationInstance") != JSONCfg.end())
+    {
+        legalizationInstance = new LegalizationInstance("CLBLegalizer");
+    }
 }
 
 void CLBLegalizer::legalize(bool exactLegalization)
 {
     if (verbose)
         print_status("CLBLegalizer Started Legalization.");
-    PU2Site2HPWLIncrease.clear();
     resetSettings();
     findSiteType2AvailableSites();
     getPUsToLegalize();
-    roughlyLegalize();
 
-    updatePUMatchingLocation(true, !exactLegalization);
+    bool packed = false;
+    if (packingLegalization)
+    {
+        packed = packingLegalize(exactLegalization);
+        if (packed)
+            dumpMatching(exactLegalization);
+        else
+            print_warning("CLBLegalizer[" + legalizerName +
+                          "] cannot pack the PlacementUnits into the columns and falls back to matching legalization.");
+    }
+    if (!packed)
+    {
+        roughlyLegalize();
 
-    dumpMatching();
+        updatePUMatchingLocation(true, !exactLegalization);
 
-    if (exactLegalization)
-    {
-        if (verbose)
-            print_status("CLBLegalizer Started Fixed-Column Legalization.");
-        resetSettings();
-        fixedColumnLegalize();
-        updatePUMatchingLocation(false, true);
-        finalLegalizeBasedOnDP();
-        dumpMatching(exactLegalization);
+        dumpMatching();
+
+        if (exactLegalization)
+        {
+            if (verbose)
+                print_status("CLBLegalizer Started Fixed-Column Legalization.");
+            resetSettings();
+            fixedColumnLegalize();
+            updatePUMatchingLocation(false, true);
+            finalLegalizeBasedOnDP();
+            dumpMatching(exactLegalization);
+        }
     }
 
     setSitesMapped();
+
+    if (legalizationInstance && !legalizationInstance->empty())
+    {
+        std::string dumpFile = JSONCfg["DumpLegalizationInstance"] + "-CLBLegalizer" +
+                               std::to_string(DumpLegalizationInstanceCnt) + ".gz";
+        print_status("CLBLegalizer: dumping legalization instance to: " + dumpFile);
+        legalizationInstance->dump(dumpFile);
+        legalizationInstance->clear();
+        DumpLegalizationInstanceCnt++;
+    }
+
     if (verbose)
         print_status("CLBLegalizer Finished Legalization.");
 }
 
 void CLBLegalizer::roughlyLegalize()
 {
+    if (incrementalLegalization)
+        roughIncrementalMatcher.startNewProblem();
+
     while (PUsToLegalize.size())
     {
         findPU2SitesInDistance();
         findPossibleLegalLocation(false);
         resetPU2SitesInDistance();
+        if (legalizationInstance)
+            recordMatchingProblem("rough");
 
-        createBipartiteGraph();
-        minCostBipartiteMatcher =
-            new MinCostBipartiteMatcher(PU2Sites.size(), rightSiteIds.size(), PU2Sites.size(), adjList, nJobs, verbose);
-
-        minCostBipartiteMatcher->solve();
-        updateMatchingAndUnmatchedPUs();
+        if (incrementalLegalization)
+        {
+            addCandidatesToIncrementalMatcher(roughIncrementalMatcher);
+            solveIncrementalMatchingAndUpdateUnmatchedPUs(roughIncrementalMatcher);
+        }
+        else
+        {
+            createBipartiteGraph();
+            minCostBipartiteMatcher = new MinCostBipartiteMatcher(PU2Sites.size(), rightSiteIds.size(),
+                                                                  PU2Sites.size(), adjList, nJobs, verbose,
+                                                                  minCostFlowEngine);
+
+            minCostBipartiteMatcher->solve();
+            updateMatchingAndUnmatchedPUs();
+            delete minCostBipartiteMatcher;
+            minCostBipartiteMatcher = nullptr;
+        }
 
         displacementThreshold *= 2;
         if ((int)(maxNumCandidate * 2) > maxNumCandidate + 1)
             maxNumCandidate *= 2;
         else
             maxNumCandidate++;
-        delete minCostBipartiteMatcher;
-        minCostBipartiteMatcher = nullptr;
     }
+
+    if (incrementalLegalization)
+        commitIncrementalMatching(roughIncrementalMatcher);
 }
 
 void CLBLegalizer::fixedColumnLegalize()
@@ -124,27 +194,41 @@ void CLBLegalizer::fixedColumnLegalize()
     resolveOverflowColumns();
 
     PUsToLegalize = initialPUsToLegalize;
+    if (incrementalLegalization)
+        fixedColumnIncrementalMatcher.startNewProblem();
 
     while (PUsToLegalize.size())
     {
-        findPU2SitesInDistance();
         findPossibleLegalLocation(true);
-        resetPU2SitesInDistance();
-        createBipartiteGraph();
-        minCostBipartiteMatcher =
-            new MinCostBipartiteMatcher(PU2Sites.size(), rightSiteIds.size(), PU2Sites.size(), adjList, nJobs, verbose);
-
-        minCostBipartiteMatcher->solve();
-        updateMatchingAndUnmatchedPUs();
+        if (legalizationInstance)
+            recordMatchingProblem("fixedColumn");
+        if (incrementalLegalization)
+        {
+            addCandidatesToIncrementalMatcher(fixedColumnIncrementalMatcher);
+            solveIncrementalMatchingAndUpdateUnmatchedPUs(fixedColumnIncrementalMatcher);
+        }
+        else
+        {
+            createBipartiteGraph();
+            minCostBipartiteMatcher = new MinCostBipartiteMatcher(PU2Sites.size(), rightSiteIds.size(),
+                                                                  PU2Sites.size(), adjList, nJobs, verbose,
+                                                                  minCostFlowEngine);
+
+            minCostBipartiteMatcher->solve();
+            updateMatchingAndUnmatchedPUs();
+            delete minCostBipartiteMatcher;
+            minCostBipartiteMatcher = nullptr;
+        }
 
         displacementThreshold *= 2;
         if ((int)(maxNumCandidate * 2) > maxNumCandidate + 1)
             maxNumCandidate *= 2;
         else
             maxNumCandidate++;
-        delete minCostBipartiteMatcher;
-        minCostBipartiteMatcher = nullptr;
     }
+
+    if (incrementalLegalization)
+        commitIncrementalMatching(fixedColumnIncrementalMatcher);
 }
 
 void CLBLegalizer::finalLegalizeBasedOnDP()
@@ -155,44 +239,39 @@ void CLBLegalizer::finalLegalizeBasedOnDP()
     PU2LegalSites.clear();
 
     float tmpAverageDisplacement = 0.0;
-    tmpAverageDisplacement += DPForMinHPWL(MCLBColumnNum, MCLBColumn2Sites, MCLBColumn2PUs);
-    tmpAverageDisplacement += DPForMinHPWL(LCLBColumnNum, LCLBColumn2Sites, LCLBColumn2PUs);
+    float tmpMaxDisplacement = 0.0;
+    tmpAverageDisplacement +=
+        DPForMinHPWL(MCLBColumnNum, MCLBColumn2Sites, MCLBColumn2PUs, "SLICEM", tmpMaxDisplacement);
+    tmpAverageDisplacement +=
+        DPForMinHPWL(LCLBColumnNum, LCLBColumn2Sites, LCLBColumn2PUs, "SLICEL", tmpMaxDisplacement);
     finalAverageDisplacement = tmpAverageDisplacement / PU2X.size();
+    finalMaxDisplacement = tmpMaxDisplacement;
 
     if (verbose)
         print_info("CLBLegalizer Macro Cell Average Final Legalization Displacement = " +
-                   std::to_string(finalAverageDisplacement));
+                   std::to_string(finalAverageDisplacement) +
+                   " Max Displacement = " + std::to_string(finalMaxDisplacement));
     placementInfo->setPULegalSite(PU2LegalSites);
     placementInfo->setPULegalXY(PU2X, PU2Y);
 }
 
 float CLBLegalizer::DPForMinHPWL(int colNum, std::vector<std::vector<DeviceInfo::DeviceSite *>> &Column2Sites,
-                                 std::vector<std::deque<PlacementInfo::PlacementUnit *>> &Column2PUs)
+                                 std::vector<std::deque<PlacementInfo::PlacementUnit *>> &Column2PUs,
+                                 const std::string &columnType, float &maxDisplacement,
+                                 std::vector<std::vector<int>> *column2PackedSiteIds)
 {
     // final Legalization DP
     // i th macro (start from 0), j th row (start from 0)
     // f[i][j] = min(f[i-1][j-row[i]]+HPWLChange[i][j-row[i]+1],f[i][j-1])
-
-    // std::string dumpFile =
-    //     JSONCfg["DumpCLBLegalization"] + "-Exact-" + std::to_string(DumpCLBLegalizationCnt) + ".gz";
-
-    // print_status("CLBLegalizer: dumping CLBLegalization archieve to: " + dumpFile);
-    // DumpCLBLegalizationCnt++;
-    // std::stringstream outfile0;
+    // the DP is solved by BandedColumnDP within a band around the PUs' locations, and solved again without the band
+    // if no solution is found in the band.
+    // for packing legalization, the band is around the sites where the PUs are packed.
 
     float tmpTotalDisplacement = 0.0;
-    std::map<PlacementInfo::PlacementUnit *, std::vector<DeviceInfo::DeviceSite *>> PU2Sites;
-    PU2Sites.clear();
-    for (auto &PUDeque : Column2PUs)
-    {
-        for (auto tmpPU : PUDeque)
-        {
-            assert(PU2Sites.find(tmpPU) == PU2Sites.end());
-            PU2Sites[tmpPU] = std::vector<DeviceInfo::DeviceSite *>();
-        }
-    }
+    std::vector<std::vector<int>> column2PUBottomSiteIds(colNum);
+    std::vector<LegalizationInstance::ColumnDPProblem> column2DPProblem(legalizationInstance ? colNum : 0);
 
-#pragma omp parallel for
+#pragma omp parallel for schedule(dynamic, 1)
     for (int c = 0; c < colNum; c++)
     {
         int numPUs = Column2PUs[c].size();
@@ -204,114 +283,87 @@ float CLBLegalizer::DPForMinHPWL(int colNum, std::vector<std::vector<DeviceInfo:
 
         sortSitesBySiteY(curColSites);
 
-        // initialize
-
-        std::vector<std::vector<float>> f(numPUs, std::vector<float>(curColSites.size(), 1000000000.0));
-        std::vector<std::vector<bool>> fChoice(
-            numPUs, std::vector<bool>(curColSites.size(), 0)); // used for tracing back macro-site mapping
-
-        int minLastPUTop = -1;
+        int numSites = curColSites.size();
+        std::vector<int> siteYs(numSites);
+        std::vector<float> siteLocYs(numSites);
+        for (int j = 0; j < numSites; j++)
+        {
+            siteYs[j] = curColSites[j]->getSiteY();
+            siteLocYs[j] = curColSites[j]->Y();
+        }
 
-        int totalMacroCellNum = 0;
-        int heightPURow = getPUSiteNum(curColPU[0]);
-        totalMacroCellNum += heightPURow;
-        float minHPWLChange = 1100000000.0;
-        for (unsigned int j = heightPURow - 1; j < curColSites.size(); j++)
+        std::vector<int> PUHeights(numPUs), PUTargetSiteIds(numPUs);
+        for (int i = 0; i < numPUs; i++)
         {
-            float curHPWLChange = getHPWLChange(curColPU[0], curColSites[j - heightPURow + 1]);
-            if (curColSites[j]->getSiteY() - curColSites[j - heightPURow + 1]->getSiteY() != heightPURow - 1)
-            {
-                // we need to ensure that there is no occpupied sites in this range
-                curHPWLChange = 1100000000.0;
-            }
-            if (curHPWLChange < minHPWLChange)
-            {
-                minHPWLChange = curHPWLChange;
-                fChoice[0][j] = 1;
-                if (numPUs == 1)
-                {
-                    minLastPUTop = j;
-                }
-            }
-            f[0][j] = minHPWLChange;
+            PUHeights[i] = getPUSiteNum(curColPU[i]);
+            PUTargetSiteIds[i] =
+                std::lower_bound(siteLocYs.begin(), siteLocYs.end(), curColPU[i]->Y()) - siteLocYs.begin();
         }
 
-        // DP to minimize HPWL
-        for (int i = 1; i < numPUs; i++)
+        // for packing legalization, the band is around the packed sites, which are stored separately so the DP fallback
+        // for the whole column is unaffected
+        std::vector<int> &bandCenterSiteIds = column2PackedSiteIds ? (*column2PackedSiteIds)[c] : PUTargetSiteIds;
+        assert((int)bandCenterSiteIds.size() == numPUs);
+
+        BandedColumnDP columnDP;
+        std::vector<int> &PUBottomSiteIds = column2PUBottomSiteIds[c];
+        bool solved = false;
+        for (int bandWidth : {column2PackedSiteIds ? packingRefineBandWidth : DPBandWidth, -1})
         {
-            float minVal = 100000000.0;
-            int heightPURow = getPUSiteNum(curColPU[i]);
-            totalMacroCellNum += heightPURow;
-            for (unsigned int j = totalMacroCellNum - 1; j < curColSites.size();
-                 j++) // j start from heightPURow because PU0 must occupy 1+ site(s)
+            columnDP.setColumn(numSites, PUHeights, bandCenterSiteIds, bandWidth);
+            for (int i = 0; i < numPUs; i++)
             {
-                float curHPWLChange = getHPWLChange(curColPU[i], curColSites[j - heightPURow + 1]);
-                if (curColSites[j]->getSiteY() - curColSites[j - heightPURow + 1]->getSiteY() != heightPURow - 1)
+                int heightPURow = PUHeights[i];
+                for (int j = columnDP.getBandLow(i); j <= columnDP.getBandHigh(i); j++)
                 {
+                    int bottomSiteId = j - heightPURow + 1;
                     // we need to ensure that there is no occpupied sites in this range
-                    curHPWLChange = 1100000000.0;
-                }
-                if (f[i][j - 1] > f[i - 1][j - heightPURow] + curHPWLChange)
-                {
-                    fChoice[i][j] = 1;
-                    if (i == numPUs - 1)
-                    {
-                        if (f[i - 1][j - heightPURow] + curHPWLChange < minVal)
-                        {
-                            minVal = f[i - 1][j - heightPURow] + curHPWLChange;
-                            minLastPUTop = j;
-                        }
-                    }
+                    if (siteYs[j] - siteYs[bottomSiteId] != heightPURow - 1)
+                        continue;
+                    columnDP.setCost(i, j, getHPWLChange(curColPU[i], curColSites[bottomSiteId]));
                 }
-
-                f[i][j] = std::min(f[i][j - 1], f[i - 1][j - heightPURow] + curHPWLChange);
             }
-        }
-
-        assert(minLastPUTop >= 0);
-
-        std::vector<DeviceInfo::DeviceSite *> PUBottom2Site_reverse(0);
-
-        for (int i = numPUs - 1; i >= 0; i--)
-        {
-            assert(minLastPUTop >= 0);
-            int heightPURow = getPUSiteNum(curColPU[i]);
-            while (!fChoice[i][minLastPUTop])
+            solved = columnDP.solve(PUBottomSiteIds);
+            if (solved || bandWidth < 0)
             {
-                minLastPUTop--;
-                assert(minLastPUTop >= 0);
+                if (legalizationInstance)
+                    LegalizationInstance::fillColumnDPProblem(column2DPProblem[c], columnType, c, curColSites,
+                                                              curColPU, PUHeights, bandCenterSiteIds, bandWidth,
+                                                              columnDP);
+                break;
             }
-            auto curSite = curColSites[minLastPUTop - heightPURow + 1];
-            assert(PU2Sites[curColPU[i]].size() == 0);
-            assert(curSite);
-            PU2Sites[curColPU[i]].push_back(curSite); // CLB PU will only occupy one site
-            minLastPUTop -= heightPURow;
-            // outfile0 << "col#" << c << ": " << curColPU[i]->getName() << " PUY:" << PU2Y[curColPU[i]]
-            //          << " numPUs:" << getPUSiteNum(curColPU[i])
-            //          << " netNum:" << curColPU[i]->getNetsSetPtr()->size() << "\n";
-            // outfile0 << "    macthed with: " << curSite->getName() << " locX:" << curSite->X()
-            //          << " locY:" << curSite->Y() << " HPWLIncrease:" << getHPWLChange(curColPU[i], curSite) << "\n";
         }
+        assert(solved);
+    }
+
+    for (auto &curProblem : column2DPProblem)
+    {
+        if (curProblem.PUHeights.size())
+            legalizationInstance->addColumnDPProblem(curProblem);
     }
 
-    for (auto &PUDeque : Column2PUs)
+    for (int c = 0; c < colNum; c++)
     {
-        for (auto tmpPU : PUDeque)
+        auto &curColSites = Column2Sites[c];
+        auto &curColPU = Column2PUs[c];
+        for (unsigned int i = 0; i < curColPU.size(); i++)
         {
-            assert(PU2Sites.find(tmpPU) != PU2Sites.end());
-            auto curSite = PU2Sites[tmpPU][0];
-            assert(curSite);
+            auto tmpPU = curColPU[i];
+            int bottomSiteId = column2PUBottomSiteIds[c][i];
+            assert(bottomSiteId >= 0);
+            auto curSite = curColSites[bottomSiteId];
             assert(PU2X.find(tmpPU) == PU2X.end());
             PU2X[tmpPU] = curSite->X();
             PU2Y[tmpPU] = curSite->Y();
-            PU2LegalSites[tmpPU] = PU2Sites[tmpPU];
+            // CLB PU will only occupy one site
+            PU2LegalSites[tmpPU] = std::vector<DeviceInfo::DeviceSite *>(1, curSite);
             PULevelMatching.emplace_back(tmpPU, curSite);
-            tmpTotalDisplacement += std::fabs(tmpPU->X() - curSite->X()) + std::fabs(tmpPU->Y() - curSite->Y());
+            float curDisplacement = std::fabs(tmpPU->X() - curSite->X()) + std::fabs(tmpPU->Y() - curSite->Y());
+            tmpTotalDisplacement += curDisplacement;
+            maxDisplacement = std::max(maxDisplacement, curDisplacement);
         }
     }
 
-    // writeStrToGZip(dumpFile, outfile0);
-    // print_status("CLBLegalizer: dumped CLBLegalization archieve to: " + dumpFile);
     return tmpTotalDisplacement;
 }
 
@@ -347,10 +399,7 @@ void CLBLegalizer::getPUsToLegalize()
         }
     }
     initialPUsToLegalize = PUsToLegalize;
-    for (auto curPU : PUsToLegalize)
-    {
-        PU2Site2HPWLIncrease[curPU] = std::map<DeviceInfo::DeviceSite *, float>();
-    }
+    HPWLEvaluator->reset(PUsToLegalize);
 }
 
 void CLBLegalizer::findSiteType2AvailableSites()
@@ -362,7 +411,7 @@ void CLBLegalizer::findSiteType2AvailableSites()
         std::vector<DeviceInfo::DeviceSite *> &sitesInType = deviceInfo->getSitesInType(siteTypeToLegalize);
         for (auto curSite : sitesInType)
         {
-            if (!curSite->isOccupied() && !curSite->isMapped())
+            if (curSite->isAvailable())
             {
                 // if (matchedSites.find(curSite) == matchedSites.end())
                 // {
@@ -379,7 +428,7 @@ void CLBLegalizer::findSiteType2AvailableSites()
             std::vector<DeviceInfo::DeviceSite *> &sitesInType = deviceInfo->getSitesInType(tmpSiteType);
             for (auto curSite : sitesInType)
             {
-                if (!curSite->isOccupied() && !curSite->isMapped())
+                if (curSite->isAvailable())
                 {
                     // if (matchedSites.find(curSite) == matchedSites.end())
                     // {
@@ -449,6 +498,32 @@ void CLBLegalizer::findSiteType2AvailableSites()
             LCLBColumn2Sites[curSite->getSiteX()].push_back(curSite);
         }
     }
+
+    siteSpatialIndex->clear();
+    siteType2SiteGroupId.clear();
+    for (auto curSiteType : siteTypesToLegalize)
+    {
+        siteType2SiteGroupId[curSiteType] = siteSpatialIndex->addSiteGroup(siteType2Sites[curSiteType]);
+    }
+    MCLBColumn2SiteGroupId.clear();
+    if (enableMCLBLegalization)
+        buildColumnSiteGroups(MCLBColumn2Sites, MCLBColumn2SiteGroupId);
+    LCLBColumn2SiteGroupId.clear();
+    if (enableLCLBLegalization)
+        buildColumnSiteGroups(LCLBColumn2Sites, LCLBColumn2SiteGroupId);
+
+    if (enableMCLBLegalization)
+        MCLBColumnAssigner.setColumns(MCLBColumnXs, MCLBColumn2Sites);
+    if (enableLCLBLegalization)
+        LCLBColumnAssigner.setColumns(LCLBColumnXs, LCLBColumn2Sites);
+}
+
+void CLBLegalizer::buildColumnSiteGroups(std::vector<std::vector<DeviceInfo::DeviceSite *>> &column2Sites,
+                                         std::vector<int> &column2SiteGroupId)
+{
+    column2SiteGroupId.resize(column2Sites.size());
+    for (unsigned int colId = 0; colId < column2Sites.size(); colId++)
+        column2SiteGroupId[colId] = siteSpatialIndex->addSiteGroup(column2Sites[colId]);
 }
 
 void CLBLegalizer::findPossibleLegalLocation(bool fixedColumn)
@@ -475,34 +550,36 @@ void CLBLegalizer::findPossibleLegalLocation(bool fixedColumn)
             assert(false && "should be LogicCLB or RAMCLB");
 
         assert(siteType2Sites.find(curSiteType) != siteType2Sites.end());
+        // the candidates from the spatial index are within the displacement threshold and not binded yet
+        std::vector<DeviceInfo::DeviceSite *> columnCandidateSites;
         std::vector<DeviceInfo::DeviceSite *> *candidateSite = nullptr;
         if (fixedColumn)
         {
             int targetSiteX = -1;
-            std::vector<std::vector<DeviceInfo::DeviceSite *>> *column2Sites;
+            std::vector<int> *column2SiteGroupId = nullptr;
             if (curPU->isLCLB())
             {
-                assert(LCLB2Column.find(curPU) != LCLB2Column.end());
-                targetSiteX = LCLB2Column[curPU];
-                column2Sites = &LCLBColumn2Sites;
+                assert(curPU->getId() < LCLB2Column.size());
+                targetSiteX = LCLB2Column[curPU->getId()];
+                column2SiteGroupId = &LCLBColumn2SiteGroupId;
             }
             if (curPU->isMCLB())
             {
-                assert(MCLB2Column.find(curPU) != MCLB2Column.end());
-                targetSiteX = MCLB2Column[curPU];
-                column2Sites = &MCLBColumn2Sites;
+                assert(curPU->getId() < MCLB2Column.size());
+                targetSiteX = MCLB2Column[curPU->getId()];
+                column2SiteGroupId = &MCLBColumn2SiteGroupId;
             }
             assert(targetSiteX >= 0 && "undefine type");
-
-            for (auto &tmpCol : *column2Sites)
-            {
-                if (tmpCol.size() == 0)
-                    continue;
-                if (tmpCol[0]->getSiteX() == targetSiteX)
-                {
-                    candidateSite = &tmpCol;
-                }
-            }
+            assert((unsigned int)targetSiteX < column2SiteGroupId->size());
+
+            // the columns are indexed by the SiteX of their sites. The sites are filtered in the query, so enough
+            // legal candidates are found for the HPWL ranking below.
+            siteSpatialIndex->findNearestFreeSites(
+                (*column2SiteGroupId)[targetSiteX], curPU->X(), curPU->Y(), 2 * displacementThreshold,
+                candidateFactor * maxNumCandidate, columnCandidateSites, [&](DeviceInfo::DeviceSite *curSite) -> bool {
+                    return placementInfo->isLegalLocation(curPU, curSite->X(), curSite->Y());
+                });
+            candidateSite = &columnCandidateSites;
         }
         else
         {
@@ -513,18 +590,8 @@ void CLBLegalizer::findPossibleLegalLocation(bool fixedColumn)
 
         for (auto curSite : *candidateSite)
         {
-            float curDisp = getDisplacement(curPU, curSite);
-            if ((!fixedColumn && curDisp < displacementThreshold) ||
-                (fixedColumn && curDisp < 2 * displacementThreshold))
-            {
-                if (placementInfo->isLegalLocation(curPU, curSite->X(), curSite->Y()))
-                {
-                    if (matchedSites.find(curSite) !=
-                        matchedSites.end()) // the matched sites should not in the candidate set
-                        continue;
-                    PU2Sites[curPU].push_back(curSite);
-                }
-            }
+            if (fixedColumn || placementInfo->isLegalLocation(curPU, curSite->X(), curSite->Y()))
+                PU2Sites[curPU].push_back(curSite);
         }
         if (PU2Sites[curPU].size() > 1)
             quick_sort_WLChange(curPU, PU2Sites[curPU], 0, PU2Sites[curPU].size() - 1);
@@ -579,6 +646,20 @@ void CLBLegalizer::createBipartiteGraph()
     }
 }
 
+void CLBLegalizer::recordMatchingProblem(const std::string &phase)
+{
+    assert(legalizationInstance);
+    createBipartiteGraph();
+    std::vector<std::vector<float>> displacements(adjList.size());
+    for (unsigned int leftCellId = 0; leftCellId < adjList.size(); leftCellId++)
+    {
+        auto curPU = PUsToLegalize[leftCellId];
+        for (auto &rightNodeAndCost : adjList[leftCellId])
+            displacements[leftCellId].push_back(getDisplacement(curPU, siteList[rightNodeAndCost.first]));
+    }
+    legalizationInstance->addMatchingProblem(phase, siteList.size(), adjList, displacements);
+}
+
 void CLBLegalizer::updateMatchingAndUnmatchedPUs()
 {
     for (unsigned int leftCellId = 0; leftCellId < PUsToLegalize.size(); leftCellId++)
@@ -588,9 +669,9 @@ void CLBLegalizer::updateMatchingAndUnmatchedPUs()
         if (rightNode >= 0)
         {
             assert(matchedPUs.find(curPU) == matchedPUs.end());
-            assert(matchedSites.find(siteList[rightNode]) == matchedSites.end());
+            assert(!siteSpatialIndex->isSiteMatched(siteList[rightNode]));
             matchedPUs.insert(curPU);
-            matchedSites.insert(siteList[rightNode]);
+            siteSpatialIndex->setSiteMatched(siteList[rightNode], true);
             PULevelMatching.emplace_back(curPU, siteList[rightNode]);
         }
     }
@@ -607,6 +688,56 @@ void CLBLegalizer::updateMatchingAndUnmatchedPUs()
     PUsToLegalize = newPUsToLegalize;
 }
 
+void CLBLegalizer::addCandidatesToIncrementalMatcher(IncrementalPUMatcher &matcher)
+{
+    // the costs are not compensated to be positive since SSPMinCostFlow handles the negative costs, so the costs of
+    // the edges added in different rounds are consistent
+    for (auto curPU : PUsToLegalize)
+    {
+        int leftId = matcher.addLeftNode(curPU);
+        for (auto curSite : PU2Sites[curPU])
+        {
+            int rightId = matcher.addRightNode(curSite);
+            if (matcher.hasEdge(leftId, rightId))
+                continue;
+            matcher.addEdge(leftId, rightId, getHPWLChange(curPU, curSite));
+        }
+    }
+}
+
+void CLBLegalizer::solveIncrementalMatchingAndUpdateUnmatchedPUs(IncrementalPUMatcher &matcher)
+{
+    matcher.solve(nJobs);
+    if (verbose)
+        print_info("CLBLegalizer[" + legalizerName + "] incremental matching is warm-started with " +
+                   std::to_string(matcher.getNumWarmStartPairs()) + " pairs");
+
+    std::vector<PlacementInfo::PlacementUnit *> newPUsToLegalize;
+    newPUsToLegalize.clear();
+    for (int leftId = 0; leftId < matcher.getNumLeftNodes(); leftId++)
+    {
+        if (matcher.getMatchedRightNode(leftId) < 0)
+            newPUsToLegalize.push_back(matcher.getLeftKey(leftId));
+    }
+    PUsToLegalize = newPUsToLegalize;
+}
+
+void CLBLegalizer::commitIncrementalMatching(IncrementalPUMatcher &matcher)
+{
+    for (int leftId = 0; leftId < matcher.getNumLeftNodes(); leftId++)
+    {
+        int rightNode = matcher.getMatchedRightNode(leftId);
+        assert(rightNode >= 0);
+        auto curPU = matcher.getLeftKey(leftId);
+        auto curSite = matcher.getRightKey(rightNode);
+        assert(matchedPUs.find(curPU) == matchedPUs.end());
+        assert(!siteSpatialIndex->isSiteMatched(curSite));
+        matchedPUs.insert(curPU);
+        siteSpatialIndex->setSiteMatched(curSite, true);
+        PULevelMatching.emplace_back(curPU, curSite);
+    }
+}
+
 void CLBLegalizer::dumpMatching(bool fixedColumn, bool enforce)
 {
     if (JSONCfg.find("DumpCLBLegalization") != JSONCfg.end() || enforce)
@@ -718,6 +849,7 @@ void CLBLegalizer::updatePUMatchingLocation(bool isRoughLegalization, bool updat
     }
 
     float tmpAverageDisplacement = 0.0;
+    float tmpMaxDisplacement = 0.0;
 
     for (auto matchedPair : PULevelMatching)
     {
@@ -745,7 +877,9 @@ void CLBLegalizer::updatePUMatchingLocation(bool isRoughLegalization, bool updat
         actualPUX = matchedSite->X();
         actualPUY = matchedSite->Y();
 
-        tmpAverageDisplacement += std::fabs(curPU->X() - matchedSite->X()) + std::fabs(curPU->Y() - matchedSite->Y());
+        float curDisplacement = std::fabs(curPU->X() - matchedSite->X()) + std::fabs(curPU->Y() - matchedSite->Y());
+        tmpAverageDisplacement += curDisplacement;
+        tmpMaxDisplacement = std::max(tmpMaxDisplacement, curDisplacement);
         assert(isRoughLegalization || PU2SiteX[curPU] == -1 || PU2SiteX[curPU] == matchedSite->getSiteX());
         PU2SiteX[curPU] = matchedSite->getSiteX();
         PU2X[curPU] += actualPUX;
@@ -765,7 +899,10 @@ void CLBLegalizer::updatePUMatchingLocation(bool isRoughLegalization, bool updat
     if (updateDisplacement)
     {
         if (isRoughLegalization)
+        {
             roughAverageDisplacement = tmpAverageDisplacement;
+            roughMaxDisplacement = tmpMaxDisplacement;
+        }
         else
             fixedColumnAverageDisplacement = tmpAverageDisplacement;
     }
@@ -789,183 +926,263 @@ void CLBLegalizer::updatePUMatchingLocation(bool isRoughLegalization, bool updat
     placementInfo->setPULegalXY(PU2X, PU2Y);
 }
 
-void CLBLegalizer::spreadPUs(int columnNum, std::vector<int> &columnUntilization,
-                             std::vector<std::vector<DeviceInfo::DeviceSite *>> &column2Sites,
+void CLBLegalizer::spreadPUs(ColumnAssigner &columnAssigner, std::vector<int> &columnUntilization,
                              std::vector<std::deque<PlacementInfo::PlacementUnit *>> &column2PUs,
-                             std::map<PlacementInfo::PlacementUnit *, int> &cell2Column)
+                             std::vector<int> &PU2Column)
 {
-    while (true)
+    columnAssigner.spreadOverflowColumns(
+        columnUntilization, column2PUs, 1,
+        [this](PlacementInfo::PlacementUnit *curPU) -> int { return getPUSiteNum(curPU); }, false, "CLB");
+
+    PU2Column.assign(placementInfo->getPlacementUnits().size(), -1);
+    for (unsigned int colId = 0; colId < column2PUs.size(); colId++)
     {
-        int overflowColId = -1;
-        std::vector<int> accumulationUtil(columnNum, 0), accumulationCapacity(columnNum, 0);
-        accumulationUtil[0] = columnUntilization[0];
-        accumulationCapacity[0] = column2Sites[0].size();
-        for (int colId = 1; colId < columnNum; colId++)
+        for (auto curPU : column2PUs[colId])
         {
-            accumulationUtil[colId] = accumulationUtil[colId - 1] + columnUntilization[colId];
-            accumulationCapacity[colId] = accumulationCapacity[colId - 1] + column2Sites[colId].size();
+            PU2Column[curPU->getId()] = colId;
         }
+    }
+}
 
-        for (int colId = 0; colId < columnNum; colId++)
+void CLBLegalizer::resolveOverflowColumns()
+{
+    // SLICEM and SLICEL have their own columns so they can be spread concurrently
+#pragma omp parallel sections
+    {
+#pragma omp section
         {
-            if (column2Sites[colId].size() < (unsigned int)columnUntilization[colId])
-            {
-                overflowColId = colId;
-                break;
-            }
+            if (enableMCLBLegalization)
+                spreadPUs(MCLBColumnAssigner, MCLBColumnUntilization, MCLBColumn2PUs, MCLB2Column);
         }
-        if (overflowColId < 0)
+#pragma omp section
         {
-            break;
+            if (enableLCLBLegalization)
+                spreadPUs(LCLBColumnAssigner, LCLBColumnUntilization, LCLBColumn2PUs, LCLB2Column);
         }
-        else
-        {
-            int leftAvaliableCapacity = 0;
-            int rightAvaliableCapacity = 0;
-            int leftUtil = 0;
-            int rightUtil = 0;
-
-            if (overflowColId > 0)
-            {
-                leftAvaliableCapacity += accumulationCapacity[overflowColId - 1];
-                leftUtil += accumulationUtil[overflowColId - 1];
-            }
-            if (overflowColId < columnNum - 1)
-            {
-                rightAvaliableCapacity += accumulationCapacity[columnNum - 1] - accumulationCapacity[overflowColId];
-                rightUtil += accumulationUtil[columnNum - 1] - accumulationUtil[overflowColId];
-            }
-
-            int overflowNum = (unsigned int)columnUntilization[overflowColId] - column2Sites[overflowColId].size();
-            int toLeft = 0;
+    }
+}
 
-            int totalAvailableCapacity = rightAvaliableCapacity + leftAvaliableCapacity - leftUtil - rightUtil;
-            assert(totalAvailableCapacity > 0);
-            float toLeftRatio = (float)(leftAvaliableCapacity - leftUtil) / totalAvailableCapacity;
-            int toLeftNum = int((overflowNum * toLeftRatio) + 0.4999);
-            int toRightNum = overflowNum - toLeft;
+void CLBLegalizer::mapPUsToColumnsOfType(std::set<PlacementInfo::PlacementUnit *> &PUs,
+                                         ColumnAssigner &columnAssigner,
+                                         std::vector<std::deque<PlacementInfo::PlacementUnit *>> &column2PUs,
+                                         std::vector<int> &columnUntilization)
+{
+    int columnNum = columnAssigner.getColumnNum();
+    column2PUs.clear();
+    columnUntilization.clear();
+    if (columnNum <= 0)
+        return;
+    column2PUs.resize(columnNum, std::deque<PlacementInfo::PlacementUnit *>(0));
+    columnUntilization.resize(columnNum, 0);
 
-            if (leftAvaliableCapacity - leftUtil > 0)
-            {
-                while (toLeftNum > 0 && column2PUs[overflowColId].size() > 0)
-                {
-                    column2PUs[overflowColId - 1].push_back(column2PUs[overflowColId][0]);
-                    int macroSize = getPUSiteNum(column2PUs[overflowColId][0]);
-                    columnUntilization[overflowColId - 1] += macroSize;
-                    columnUntilization[overflowColId] -= macroSize;
-                    toLeftNum -= macroSize;
-                    column2PUs[overflowColId].pop_front();
-                }
-            }
-            if (rightAvaliableCapacity - rightUtil > 0)
-            {
-                while (toRightNum > 0 && column2PUs[overflowColId].size() > 0)
-                {
-                    column2PUs[overflowColId + 1].push_front(
-                        column2PUs[overflowColId][column2PUs[overflowColId].size() - 1]);
-                    int macroSize = getPUSiteNum(column2PUs[overflowColId][column2PUs[overflowColId].size() - 1]);
-                    columnUntilization[overflowColId + 1] += macroSize;
-                    columnUntilization[overflowColId] -= macroSize;
-                    toRightNum -= macroSize;
-                    column2PUs[overflowColId].pop_back();
-                }
-            }
-        }
-    }
-    cell2Column.clear();
-    for (unsigned int colId = 0; colId < column2PUs.size(); colId++)
+    for (auto &PUCol_pair : PU2Columns)
     {
-        auto PUs = column2PUs[colId];
-        for (auto curPU : PUs)
+        auto tmpMacroUnit = PUCol_pair.first;
+        if (PUs.find(tmpMacroUnit) != PUs.end())
         {
-            cell2Column[curPU] = colId;
+            int colId = columnAssigner.findMostFrequentColumn(PUCol_pair.second);
+            column2PUs[colId].push_back(tmpMacroUnit);
+            columnUntilization[colId] += getPUSiteNum(tmpMacroUnit);
         }
     }
 }
 
-void CLBLegalizer::resolveOverflowColumns()
+void CLBLegalizer::mapPUsToColumns()
 {
-    if (enableMCLBLegalization)
-    {
-        spreadPUs(MCLBColumnNum, MCLBColumnUntilization, MCLBColumn2Sites, MCLBColumn2PUs, MCLB2Column);
-    }
-    if (enableLCLBLegalization)
+    // SLICEM and SLICEL have their own columns so they can be mapped concurrently
+#pragma omp parallel sections
     {
-        spreadPUs(LCLBColumnNum, LCLBColumnUntilization, LCLBColumn2Sites, LCLBColumn2PUs, LCLB2Column);
+#pragma omp section
+        mapPUsToColumnsOfType(MCLBPUs, MCLBColumnAssigner, MCLBColumn2PUs, MCLBColumnUntilization);
+#pragma omp section
+        mapPUsToColumnsOfType(LCLBPUs, LCLBColumnAssigner, LCLBColumn2PUs, LCLBColumnUntilization);
     }
 }
 
-int CLBLegalizer::findIdMaxWithRecurence(int minId, int maxId, std::vector<int> &ids)
+bool CLBLegalizer::packPUsWithColumnPacker(std::vector<PlacementInfo::PlacementUnit *> &sortedPUs,
+                                           std::vector<float> &columnXs,
+                                           std::vector<std::vector<float>> &column2SiteYs,
+                                           std::vector<std::deque<PlacementInfo::PlacementUnit *>> &column2PUs,
+                                           std::vector<std::vector<int>> &column2PackedSiteIds)
 {
-    int resId = -1;
-    int maxRecurence = 0;
-    assert(ids.size() > 0);
-    for (int i = minId; i <= maxId; i++)
+    column2PUs.clear();
+    column2PUs.resize(columnXs.size(), std::deque<PlacementInfo::PlacementUnit *>(0));
+    ColumnPacker columnPacker(y2xRatio);
+    columnPacker.setColumns(columnXs, column2SiteYs);
+    for (auto curPU : sortedPUs)
     {
-        int cnt = 0;
-        for (auto id : ids)
-        {
-            if (id == i)
-                cnt++;
-        }
-        if (cnt > maxRecurence)
-        {
-            resId = i;
-            maxRecurence = cnt;
-        }
+        int colId = columnPacker.addPU(curPU->X(), curPU->Y(), getPUSiteNum(curPU));
+        if (colId < 0)
+            return false;
+        column2PUs[colId].push_back(curPU);
     }
-    assert(resId >= 0);
-    return resId;
+    columnPacker.getPackedSites(column2PackedSiteIds);
+    return true;
 }
 
-void CLBLegalizer::mapPUsToColumns()
+bool CLBLegalizer::packPUsToColumnsOfType(std::set<PlacementInfo::PlacementUnit *> &PUs, std::vector<float> &columnXs,
+                                          std::vector<std::vector<DeviceInfo::DeviceSite *>> &column2Sites,
+                                          std::vector<std::deque<PlacementInfo::PlacementUnit *>> &column2PUs,
+                                          std::vector<std::vector<int>> &column2PackedSiteIds)
 {
+    int columnNum = column2Sites.size();
+    column2PUs.clear();
+    column2PackedSiteIds.clear();
+    if (columnNum <= 0)
+        return !PUs.size();
+
+    // the sites are indexed in the order used by the column DP
+    std::vector<std::vector<float>> column2SiteYs(columnNum);
+    for (int colId = 0; colId < columnNum; colId++)
+    {
+        sortSitesBySiteY(column2Sites[colId]);
+        for (auto curSite : column2Sites[colId])
+            column2SiteYs[colId].push_back(curSite->Y());
+    }
 
-    MCLBColumn2PUs.clear();
-    MCLBColumnUntilization.clear();
-    if (enableMCLBLegalization)
+    // the PUs are packed from bottom to top
+    std::vector<PlacementInfo::PlacementUnit *> sortedPUs(PUs.begin(), PUs.end());
+    std::sort(sortedPUs.begin(), sortedPUs.end(),
+              [](PlacementInfo::PlacementUnit *a, PlacementInfo::PlacementUnit *b) -> bool {
+                  if (a->Y() != b->Y())
+                      return a->Y() < b->Y();
+                  return a->getId() < b->getId();
+              });
+
+    // the columns are cut into segments by the clock regions and the PUs in different clock regions are packed
+    // concurrently, each into the column segments of its own clock region
+    int clockRegionNumX = deviceInfo->getClockRegionNumX();
+    int clockRegionNumY = deviceInfo->getClockRegionNumY();
+    int clockRegionNum = clockRegionNumX * clockRegionNumY;
+    std::vector<std::vector<int>> region2ColumnIds(clockRegionNum);
+    std::vector<std::vector<int>> region2ColumnFirstSiteIds(clockRegionNum);
+    std::vector<std::vector<float>> region2ColumnXs(clockRegionNum);
+    std::vector<std::vector<std::vector<float>>> region2Column2SiteYs(clockRegionNum);
+    for (int colId = 0; colId < columnNum; colId++)
     {
-        if (MCLBColumnNum > 0)
+        auto &sites = column2Sites[colId];
+        int lastRegionId = -1;
+        for (unsigned int siteId = 0; siteId < sites.size(); siteId++)
         {
-            MCLBColumn2PUs.resize(MCLBColumnNum, std::deque<PlacementInfo::PlacementUnit *>(0));
-            MCLBColumnUntilization.resize(MCLBColumnNum, 0);
-
-            for (auto &PUCol_pair : PU2Columns)
+            int regionId = sites[siteId]->getClockRegionY() * clockRegionNumX + sites[siteId]->getClockRegionX();
+            assert(regionId >= 0 && regionId < clockRegionNum);
+            if (regionId != lastRegionId)
             {
-                auto tmpMacroUnit = PUCol_pair.first;
-                if (MCLBPUs.find(tmpMacroUnit) != MCLBPUs.end())
-                {
-                    int colId = findIdMaxWithRecurence(0, MCLBColumnNum - 1, PUCol_pair.second);
-
-                    MCLBColumn2PUs[colId].push_back(tmpMacroUnit);
-                    MCLBColumnUntilization[colId] += getPUSiteNum(tmpMacroUnit);
-                }
+                region2ColumnIds[regionId].push_back(colId);
+                region2ColumnFirstSiteIds[regionId].push_back(siteId);
+                region2ColumnXs[regionId].push_back(columnXs[colId]);
+                region2Column2SiteYs[regionId].emplace_back();
+                lastRegionId = regionId;
             }
+            region2Column2SiteYs[regionId].back().push_back(column2SiteYs[colId][siteId]);
         }
     }
+    std::vector<std::vector<PlacementInfo::PlacementUnit *>> region2SortedPUs(clockRegionNum);
+    for (auto curPU : sortedPUs)
+    {
+        int regionX, regionY;
+        deviceInfo->getClockRegionByLocation(curPU->X(), curPU->Y(), regionX, regionY);
+        region2SortedPUs[regionY * clockRegionNumX + regionX].push_back(curPU);
+    }
 
-    LCLBColumn2PUs.clear();
-    LCLBColumnUntilization.clear();
-    if (enableLCLBLegalization)
+    std::vector<std::vector<std::deque<PlacementInfo::PlacementUnit *>>> region2Column2PUs(clockRegionNum);
+    std::vector<std::vector<std::vector<int>>> region2Column2PackedSiteIds(clockRegionNum);
+    std::vector<char> regionPacked(clockRegionNum, true);
+#pragma omp parallel for schedule(dynamic, 1) num_threads(nJobs)
+    for (int regionId = 0; regionId < clockRegionNum; regionId++)
     {
-        if (LCLBColumnNum > 0)
-        {
-            LCLBColumn2PUs.resize(LCLBColumnNum, std::deque<PlacementInfo::PlacementUnit *>(0));
-            LCLBColumnUntilization.resize(LCLBColumnNum, 0);
+        if (region2SortedPUs[regionId].size())
+            regionPacked[regionId] = packPUsWithColumnPacker(
+                region2SortedPUs[regionId], region2ColumnXs[regionId], region2Column2SiteYs[regionId],
+                region2Column2PUs[regionId], region2Column2PackedSiteIds[regionId]);
+    }
 
-            for (auto &PUCol_pair : PU2Columns)
-            {
-                auto tmpMacroUnit = PUCol_pair.first;
-                if (LCLBPUs.find(tmpMacroUnit) != LCLBPUs.end())
-                {
-                    int colId = findIdMaxWithRecurence(0, LCLBColumnNum - 1, PUCol_pair.second);
+    // a clock region which cannot hold its PUs is rare, and the PUs are then packed over the whole device serially
+    if (std::find(regionPacked.begin(), regionPacked.end(), false) != regionPacked.end())
+    {
+        if (verbose)
+            print_warning("CLBLegalizer[" + legalizerName +
+                          "] some clock regions cannot hold their PUs and the PUs are packed over the whole device.");
+        return packPUsWithColumnPacker(sortedPUs, columnXs, column2SiteYs, column2PUs, column2PackedSiteIds);
+    }
 
-                    LCLBColumn2PUs[colId].push_back(tmpMacroUnit);
-                    LCLBColumnUntilization[colId] += getPUSiteNum(tmpMacroUnit);
-                }
+    // the segments of a column are visited from bottom to top, so the PUs in each column stay ordered by Y
+    column2PUs.resize(columnNum, std::deque<PlacementInfo::PlacementUnit *>(0));
+    column2PackedSiteIds.resize(columnNum);
+    for (int regionId = 0; regionId < clockRegionNum; regionId++)
+    {
+        for (unsigned int i = 0; i < region2Column2PUs[regionId].size(); i++)
+        {
+            int colId = region2ColumnIds[regionId][i];
+            int firstSiteId = region2ColumnFirstSiteIds[regionId][i];
+            auto &segmentPUs = region2Column2PUs[regionId][i];
+            auto &segmentPackedSiteIds = region2Column2PackedSiteIds[regionId][i];
+            for (unsigned int k = 0; k < segmentPUs.size(); k++)
+            {
+                column2PUs[colId].push_back(segmentPUs[k]);
+                column2PackedSiteIds[colId].push_back(segmentPackedSiteIds[k] + firstSiteId);
             }
         }
     }
+    return true;
+}
+
+bool CLBLegalizer::packPUsToColumns()
+{
+    // only one of SLICEM/SLICEL is legalized by a CLBLegalizer, and its PUs are packed per clock region concurrently
+    if (enableMCLBLegalization)
+        return packPUsToColumnsOfType(MCLBPUs, MCLBColumnXs, MCLBColumn2Sites, MCLBColumn2PUs,
+                                      MCLBColumn2PackedSiteIds);
+    if (enableLCLBLegalization)
+        return packPUsToColumnsOfType(LCLBPUs, LCLBColumnXs, LCLBColumn2Sites, LCLBColumn2PUs,
+                                      LCLBColumn2PackedSiteIds);
+    return true;
+}
+
+bool CLBLegalizer::packingLegalize(bool exactLegalization)
+{
+    if (verbose)
+        print_status("CLBLegalizer[" + legalizerName + "] Started Packing Legalization.");
+
+    if (!packPUsToColumns())
+        return false;
+
+    PU2X.clear();
+    PU2Y.clear();
+    PU2LegalSites.clear();
+
+    float tmpAverageDisplacement = 0.0;
+    float tmpMaxDisplacement = 0.0;
+    if (enableMCLBLegalization)
+        tmpAverageDisplacement += DPForMinHPWL(MCLBColumnNum, MCLBColumn2Sites, MCLBColumn2PUs, "SLICEM",
+                                               tmpMaxDisplacement, &MCLBColumn2PackedSiteIds);
+    if (enableLCLBLegalization)
+        tmpAverageDisplacement += DPForMinHPWL(LCLBColumnNum, LCLBColumn2Sites, LCLBColumn2PUs, "SLICEL",
+                                               tmpMaxDisplacement, &LCLBColumn2PackedSiteIds);
+    if (PU2X.size())
+        tmpAverageDisplacement /= PU2X.size();
+
+    roughAverageDisplacement = tmpAverageDisplacement;
+    roughMaxDisplacement = tmpMaxDisplacement;
+    if (exactLegalization)
+    {
+        fixedColumnAverageDisplacement = tmpAverageDisplacement;
+        finalAverageDisplacement = tmpAverageDisplacement;
+        finalMaxDisplacement = tmpMaxDisplacement;
+        placementInfo->setPULegalSite(PU2LegalSites);
+    }
+    else
+    {
+        // as rough legalization, only the legal locations are provided and the sites are not binded
+        PU2LegalSites.clear();
+    }
+    placementInfo->setPULegalXY(PU2X, PU2Y);
+
+    if (verbose)
+        print_info("CLBLegalizer[" + legalizerName +
+                   "] Packing Legalization Average Displacement = " + std::to_string(tmpAverageDisplacement) +
+                   " Max Displacement = " + std::to_string(tmpMaxDisplacement));
+    return true;
 }
 
 void CLBLegalizer::setSitesMapped()
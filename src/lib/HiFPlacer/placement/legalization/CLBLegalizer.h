@@ -14,10 +14,17 @@
 #ifndef _CLBLEGALIZER
 #define _CLBLEGALIZER
 
+#include "BandedColumnDP.h"
+#include "ColumnAssigner.h"
+#include "ColumnPacker.h"
 #include "DesignInfo.h"
 #include "DeviceInfo.h"
+#include "HPWLChangeEvaluator.h"
+#include "IncrementalBipartiteMatcher.h"
+#include "LegalizationInstance.h"
 #include "MinCostBipartiteMatcher.h"
 #include "PlacementInfo.h"
+#include "SiteSpatialIndex.h"
 #include "dumpZip.h"
 #include "sysInfo.h"
 #include <assert.h>
@@ -45,6 +52,11 @@
  * will conduct exact legalization following rough legalization when the macros are close enough to their potential
  * legal positions.
  *
+ * Alternatively (set "CLBLegalizationMethod" to "packing"), the PlacementUnits are packed into the columns around their
+ * locations from bottom to top (see ColumnPacker), and then their packed positions are refined within a small band by
+ * the column DP, which takes near-linear time and keeps the PlacementUnits close to the global placement solution. If
+ * the PlacementUnits cannot be packed, the bipartite matching flow is used instead.
+ *
  */
 class CLBLegalizer
 {
@@ -64,6 +76,12 @@ class CLBLegalizer
     {
         if (minCostBipartiteMatcher)
             delete minCostBipartiteMatcher;
+        if (HPWLEvaluator)
+            delete HPWLEvaluator;
+        if (siteSpatialIndex)
+            delete siteSpatialIndex;
+        if (legalizationInstance)
+            delete legalizationInstance;
     }
 
     /**
@@ -107,6 +125,26 @@ class CLBLegalizer
         return roughAverageDisplacement;
     }
 
+    /**
+     * @brief Get the maximum displacement of exact legalization for the involved PlacementUnit
+     *
+     * @return float
+     */
+    inline float getMaxDisplacementOfExactLegalization()
+    {
+        return finalMaxDisplacement;
+    }
+
+    /**
+     * @brief Get the maximum displacement of rough legalization for the involved PlacementUnit
+     *
+     * @return float
+     */
+    inline float getMaxDisplacementOfRoughLegalization()
+    {
+        return roughMaxDisplacement;
+    }
+
     /**
      * @brief Set the intitial parameters of the legalizer
      *
@@ -165,6 +203,50 @@ class CLBLegalizer
      */
     MinCostBipartiteMatcher *minCostBipartiteMatcher = nullptr;
 
+    /**
+     * @brief the min-cost flow engine used by the bipartite matching (set by "MinCostFlowEngine")
+     *
+     */
+    MinCostBipartiteMatcher::MinCostFlowEngine minCostFlowEngine = MinCostBipartiteMatcher::MinCostFlowEngine_SPFA;
+
+    typedef IncrementalBipartiteMatcher<PlacementInfo::PlacementUnit *, DeviceInfo::DeviceSite *> IncrementalPUMatcher;
+
+    /**
+     * @brief whether the bipartite matching keeps its graph, matching and potentials across the rounds of a
+     * legalization and across the legalization calls (set by "IncrementalLegalization")
+     *
+     */
+    bool incrementalLegalization = false;
+
+    /**
+     * @brief the number of sites by which a PlacementUnit can move beyond its location/packed position in the final DP
+     * legalization of a column (set by "LegalizationDPBandWidth", negative to solve the DP of the whole column)
+     *
+     */
+    int DPBandWidth = 32;
+
+    /**
+     * @brief whether the PlacementUnits are legalized by column packing instead of bipartite matching (set by
+     * "CLBLegalizationMethod")
+     *
+     */
+    bool packingLegalization = false;
+
+    /**
+     * @brief the number of sites by which a PlacementUnit can move beyond its packed position in the DP refinement of
+     * packing legalization (set by "CLBPackingRefineBandWidth")
+     *
+     */
+    int packingRefineBandWidth = 4;
+
+    /**
+     * @brief the incremental matchers of rough legalization and fixed-column legalization, which are persistent across
+     * the legalization calls
+     *
+     */
+    IncrementalPUMatcher roughIncrementalMatcher;
+    IncrementalPUMatcher fixedColumnIncrementalMatcher;
+
     /**
      * @brief a vector storing the PlacementUnits which have NOT been legalized
      *
@@ -189,6 +271,12 @@ class CLBLegalizer
      */
     std::map<std::string, std::vector<DeviceInfo::DeviceSite *>> siteType2Sites;
 
+    /**
+     * @brief the group of the potential sites of different site types in the spatial index
+     *
+     */
+    std::map<std::string, int> siteType2SiteGroupId;
+
     /**
      * @brief record the mapping from PlacementUnits to the candidate sites which are NOT binded to PUs
      *
@@ -216,22 +304,29 @@ class CLBLegalizer
     std::vector<std::vector<std::pair<int, float>>> adjList;
 
     /**
-     * @brief a map of map recording the HPWL overhead when binding a PlacementUnit to a specific site
+     * @brief the cached evaluator of the HPWL overhead when binding a PlacementUnit to a specific site
      *
      */
-    std::map<PlacementInfo::PlacementUnit *, std::map<DeviceInfo::DeviceSite *, float>> PU2Site2HPWLIncrease;
+    HPWLChangeEvaluator *HPWLEvaluator = nullptr;
 
     /**
-     * @brief a set of PlacementUnits binded to corresponding DeviceSites
+     * @brief the spatial index of the available sites, which also records the sites binded to PlacementUnits
      *
      */
-    std::set<PlacementInfo::PlacementUnit *> matchedPUs;
+    SiteSpatialIndex *siteSpatialIndex = nullptr;
 
     /**
-     * @brief a set of DeviceSites binded to corresponding PlacementUnits
+     * @brief the matching and DP problems solved in a legalize() call, recorded for offline replay when
+     * "DumpLegalizationInstance" is set
      *
      */
-    std::set<DeviceInfo::DeviceSite *> matchedSites;
+    LegalizationInstance *legalizationInstance = nullptr;
+
+    /**
+     * @brief a set of PlacementUnits binded to corresponding DeviceSites
+     *
+     */
+    std::set<PlacementInfo::PlacementUnit *> matchedPUs;
 
     /**
      * @brief record the binding between PlacementUnits and DeviceSites as a vector of pairs
@@ -240,6 +335,7 @@ class CLBLegalizer
     std::vector<std::pair<PlacementInfo::PlacementUnit *, DeviceInfo::DeviceSite *>> PULevelMatching;
 
     int DumpCLBLegalizationCnt = 0;
+    int DumpLegalizationInstanceCnt = 0;
 
     /**
      * @brief displacement threshold to detect potential legal sites
@@ -314,6 +410,21 @@ class CLBLegalizer
      */
     std::vector<std::vector<DeviceInfo::DeviceSite *>> LCLBColumn2Sites;
 
+    /**
+     * @brief the group of the sites in each column of SLICEM/SLICEL in the spatial index
+     *
+     */
+    std::vector<int> MCLBColumn2SiteGroupId;
+    std::vector<int> LCLBColumn2SiteGroupId;
+
+    /**
+     * @brief the column assigners of SLICEM/SLICEL, which find the columns of the PlacementUnits and resolve the
+     * overflow columns
+     *
+     */
+    ColumnAssigner MCLBColumnAssigner;
+    ColumnAssigner LCLBColumnAssigner;
+
     /**
      * @brief record the PlacementUnits in each column of SLICEM
      *
@@ -339,16 +450,30 @@ class CLBLegalizer
     std::vector<int> LCLBColumnUntilization;
 
     /**
-     * @brief record the mapping from SLICEM CLB PlacementUnits to corresponding columns
+     * @brief record the packed bottom site of each PlacementUnit in each column of SLICEM for packing legalization
+     *
+     */
+    std::vector<std::vector<int>> MCLBColumn2PackedSiteIds;
+
+    /**
+     * @brief record the packed bottom site of each PlacementUnit in each column of SLICEL for packing legalization
+     *
+     */
+    std::vector<std::vector<int>> LCLBColumn2PackedSiteIds;
+
+    /**
+     * @brief record the mapping from SLICEM CLB PlacementUnits to corresponding columns (indexed by the
+     * PlacementUnit id, -1 if not mapped)
      *
      */
-    std::map<PlacementInfo::PlacementUnit *, int> MCLB2Column;
+    std::vector<int> MCLB2Column;
 
     /**
-     * @brief record the mapping from SLICEL CLB PlacementUnits to corresponding columns
+     * @brief record the mapping from SLICEL CLB PlacementUnits to corresponding columns (indexed by the
+     * PlacementUnit id, -1 if not mapped)
      *
      */
-    std::map<PlacementInfo::PlacementUnit *, int> LCLB2Column;
+    std::vector<int> LCLB2Column;
 
     /**
      * @brief record the mapping from PlacementUnits to exact DeviceSites
@@ -428,6 +553,13 @@ class CLBLegalizer
      */
     float roughAverageDisplacement = 10000.0;
 
+    /**
+     * @brief the maximum displacement of exact/rough legalization for the involved PlacementUnit
+     *
+     */
+    float finalMaxDisplacement = 10000.0;
+    float roughMaxDisplacement = 10000.0;
+
     /**
      * @brief displacement threshold to detect potential legal sites
      *
@@ -452,6 +584,15 @@ class CLBLegalizer
      */
     void findSiteType2AvailableSites();
 
+    /**
+     * @brief add the sites in each column to the spatial index as a group
+     *
+     * @param column2Sites the sites in each column
+     * @param column2SiteGroupId the resultant group of each column
+     */
+    void buildColumnSiteGroups(std::vector<std::vector<DeviceInfo::DeviceSite *>> &column2Sites,
+                               std::vector<int> &column2SiteGroupId);
+
     /**
      * @brief resolve the overflow columns during fixed column legalization by spreading "outliers" to neighbor columns
      *
@@ -468,15 +609,88 @@ class CLBLegalizer
     /**
      * @brief map PlacementUnit to the columns according to the locations of the cells in it
      *
+     * The SLICEM/SLICEL PlacementUnits are mapped concurrently.
+     *
      */
     void mapPUsToColumns();
 
+    /**
+     * @brief map the PlacementUnits of a specific type to the columns
+     *
+     * @param PUs the PlacementUnits of the type
+     * @param columnAssigner the column assigner of the type
+     * @param column2PUs the resultant PlacementUnits in each column
+     * @param columnUntilization the resultant number of sites required by the PlacementUnits in each column
+     */
+    void mapPUsToColumnsOfType(std::set<PlacementInfo::PlacementUnit *> &PUs, ColumnAssigner &columnAssigner,
+                               std::vector<std::deque<PlacementInfo::PlacementUnit *>> &column2PUs,
+                               std::vector<int> &columnUntilization);
+
+    /**
+     * @brief pack the PlacementUnits into the columns for packing legalization
+     *
+     * @return true if all the PlacementUnits are packed
+     */
+    bool packPUsToColumns();
+
+    /**
+     * @brief pack the PlacementUnits of a specific type into the columns from bottom to top with ColumnPacker, where
+     * each PlacementUnit is added to the column around it with the minimum packing cost
+     *
+     * The columns are cut into segments by the clock regions, and the PlacementUnits of each clock region are packed
+     * into its column segments, with the clock regions handled in parallel. If some clock region cannot hold its
+     * PlacementUnits, all the PlacementUnits are packed over the whole device by a single ColumnPacker.
+     *
+     * @param PUs the PlacementUnits of the type
+     * @param columnXs the X location of each column
+     * @param column2Sites the sites in each column, which are sorted by Y by this function
+     * @param column2PUs the resultant PlacementUnits in each column, ordered by Y
+     * @param column2PackedSiteIds the resultant bottom site of each PlacementUnit in its column
+     * @return true if all the PlacementUnits are packed, false if some PlacementUnit cannot fit in any column
+     */
+    bool packPUsToColumnsOfType(std::set<PlacementInfo::PlacementUnit *> &PUs, std::vector<float> &columnXs,
+                                std::vector<std::vector<DeviceInfo::DeviceSite *>> &column2Sites,
+                                std::vector<std::deque<PlacementInfo::PlacementUnit *>> &column2PUs,
+                                std::vector<std::vector<int>> &column2PackedSiteIds);
+
+    /**
+     * @brief pack the sorted PlacementUnits into the given columns with a ColumnPacker
+     *
+     * @param sortedPUs the PlacementUnits sorted by Y
+     * @param columnXs the X location of each column
+     * @param column2SiteYs the Y locations of the sites in each column, sorted from bottom to top
+     * @param column2PUs the resultant PlacementUnits in each column, ordered by Y
+     * @param column2PackedSiteIds the resultant bottom site of each PlacementUnit in its column
+     * @return true if all the PlacementUnits are packed
+     */
+    bool packPUsWithColumnPacker(std::vector<PlacementInfo::PlacementUnit *> &sortedPUs, std::vector<float> &columnXs,
+                                 std::vector<std::vector<float>> &column2SiteYs,
+                                 std::vector<std::deque<PlacementInfo::PlacementUnit *>> &column2PUs,
+                                 std::vector<std::vector<int>> &column2PackedSiteIds);
+
+    /**
+     * @brief conduct packing legalization, which packs the PlacementUnits into the columns around their locations and
+     * refines the packed positions by the column DP
+     *
+     * @param exactLegalization true to bind the PlacementUnits to the legal sites
+     * @return true if the PlacementUnits are legalized, false if they cannot be packed and nothing is changed
+     */
+    bool packingLegalize(bool exactLegalization);
+
     /**
      * @brief Create a bipartite graph between PlacementUnit and potential DeviceSites
      *
      */
     void createBipartiteGraph();
 
+    /**
+     * @brief record the bipartite matching problem between the PlacementUnits to legalize and their candidate sites
+     * in the legalization instance
+     *
+     * @param phase the phase of legalization, e.g., rough or fixedColumn
+     */
+    void recordMatchingProblem(const std::string &phase);
+
     /**
      * @brief conduct rough legalization.
      *
@@ -519,10 +733,16 @@ class CLBLegalizer
      * @param colNum total number of the column of the target type of PlacementUnit
      * @param Column2Sites a vector record the sites in the columns
      * @param Column2PUs  a vector record the PlacementUnits in the columns
+     * @param columnType the type of the columns for the legalization instance
+     * @param maxDisplacement the maximum displacement of the PlacementUnits, which is updated by this function
+     * @param column2PackedSiteIds the packed bottom sites of the PlacementUnits for packing legalization, around which
+     * the DP band is set (nullptr to set the band around the locations of the PlacementUnits)
      * @return float
      */
     float DPForMinHPWL(int colNum, std::vector<std::vector<DeviceInfo::DeviceSite *>> &Column2Sites,
-                       std::vector<std::deque<PlacementInfo::PlacementUnit *>> &Column2PUs);
+                       std::vector<std::deque<PlacementInfo::PlacementUnit *>> &Column2PUs,
+                       const std::string &columnType, float &maxDisplacement,
+                       std::vector<std::vector<int>> *column2PackedSiteIds = nullptr);
 
     /**
      * @brief record the matching in private list and update the list of PlacementUnits which are not matched by the
@@ -532,28 +752,37 @@ class CLBLegalizer
     void updateMatchingAndUnmatchedPUs();
 
     /**
-     * @brief spread PlacementUnits accross columns to resolve resource overflow
+     * @brief add the candidate sites of the PlacementUnits to be legalized into the incremental matcher. Only the new
+     * edges are evaluated.
      *
-     * @param columnNum the number of columns
-     * @param columnUntilization a vector reording the utilization usage of each column
-     * @param column2Sites a vector reording device sites in each column
-     * @param column2PUs a vector reording PlacementUnits in each column
-     * @param cell2Column a map recording the column id for each PlacementUnit
+     * @param matcher the incremental matcher of the current legalization
      */
-    void spreadPUs(int columnNum, std::vector<int> &columnUntilization,
-                   std::vector<std::vector<DeviceInfo::DeviceSite *>> &column2Sites,
-                   std::vector<std::deque<PlacementInfo::PlacementUnit *>> &column2PUs,
-                   std::map<PlacementInfo::PlacementUnit *, int> &cell2Column);
+    void addCandidatesToIncrementalMatcher(IncrementalPUMatcher &matcher);
 
     /**
-     * @brief find the column which contains the most of cells in a macro in a specific range of columns
+     * @brief solve the incremental matching and update the list of PlacementUnits which are not matched yet
      *
-     * @param minId the begin column
-     * @param maxId the end column
-     * @param ids the column ids of the cells in the macro
-     * @return int
+     * @param matcher the incremental matcher of the current legalization
      */
-    int findIdMaxWithRecurence(int minId, int maxId, std::vector<int> &ids);
+    void solveIncrementalMatchingAndUpdateUnmatchedPUs(IncrementalPUMatcher &matcher);
+
+    /**
+     * @brief record the final incremental matching in private list
+     *
+     * @param matcher the incremental matcher of the current legalization
+     */
+    void commitIncrementalMatching(IncrementalPUMatcher &matcher);
+
+    /**
+     * @brief spread PlacementUnits accross columns to resolve resource overflow
+     *
+     * @param columnAssigner the column assigner of the type of the PlacementUnits
+     * @param columnUntilization a vector reording the utilization usage of each column
+     * @param column2PUs a vector reording PlacementUnits in each column
+     * @param PU2Column a vector recording the column id for each PlacementUnit (indexed by the PlacementUnit id)
+     */
+    void spreadPUs(ColumnAssigner &columnAssigner, std::vector<int> &columnUntilization,
+                   std::vector<std::deque<PlacementInfo::PlacementUnit *>> &column2PUs, std::vector<int> &PU2Column);
 
     /**
      * @brief Set the sites which are binded as mapped so they will not be mapped to other elements in the netlist
@@ -570,7 +799,7 @@ class CLBLegalizer
         displacementThreshold = initialDisplacementThreshold;
         maxNumCandidate = initialMaxNumCandidate;
         matchedPUs.clear();
-        matchedSites.clear();
+        siteSpatialIndex->resetMatchedSites();
         PULevelMatching.clear();
     }
 
@@ -593,20 +822,12 @@ class CLBLegalizer
         for (int i = 0; i < PUsNum; i++)
         {
             PlacementInfo::PlacementUnit *curPU = PUsToLegalize[i];
-            DesignInfo::DesignCell *curCell = nullptr;
-            if (auto unpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU))
-            {
-                curCell = unpackedCell->getCell();
-            }
-            else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curPU))
-            {
-                assert(curMacro->getCells().size() > 0);
-                curCell = curMacro->getCells()[0];
-            }
-            assert(curCell);
-            PU2SitesInDisplacementThreshold[curPU] = placementInfo->findNeiborSiteFromBinGrid(
-                curCell, cellLoc[curCell->getCellId()].X, cellLoc[curCell->getCellId()].Y, displacementThreshold,
-                candidateFactor * maxNumCandidate);
+            auto groupIdIt = siteType2SiteGroupId.find(curPU->isMCLB() ? "SLICEM" : "SLICEL");
+            assert(groupIdIt != siteType2SiteGroupId.end());
+            std::vector<DeviceInfo::DeviceSite *> *candidateSites = new std::vector<DeviceInfo::DeviceSite *>(0);
+            siteSpatialIndex->findNearestFreeSites(groupIdIt->second, curPU->X(), curPU->Y(), displacementThreshold,
+                                                   candidateFactor * maxNumCandidate, *candidateSites);
+            PU2SitesInDisplacementThreshold[curPU] = candidateSites;
         }
     }
 
@@ -662,27 +883,7 @@ class CLBLegalizer
      */
     inline float getHPWLChange(PlacementInfo::PlacementUnit *curPU, DeviceInfo::DeviceSite *curSite)
     {
-        assert(PU2Site2HPWLIncrease.find(curPU) != PU2Site2HPWLIncrease.end());
-        if (PU2Site2HPWLIncrease[curPU].find(curSite) != PU2Site2HPWLIncrease[curPU].end())
-        {
-            return PU2Site2HPWLIncrease[curPU][curSite];
-        }
-        float oriHPWL = 0.0;
-        float newHPWL = 0.0;
-        float PUX = curSite->X();
-        float PUY = curSite->Y();
-        auto nets = placementInfo->getPlacementUnitId2Nets()[curPU->getId()];
-
-        for (auto curNet : nets)
-        {
-            if (curNet->getDesignNet()->getPins().size() > 1000) // it could be clock
-                continue;
-            oriHPWL += curNet->getHPWL(y2xRatio);
-            newHPWL += curNet->getNewHPWLByTrying(curPU, PUX, PUY, y2xRatio);
-        }
-
-        PU2Site2HPWLIncrease[curPU][curSite] = (newHPWL - oriHPWL);
-        return (newHPWL - oriHPWL);
+        return HPWLEvaluator->getHPWLChange(curPU, curSite);
     }
 
     /**
@@ -695,20 +896,7 @@ class CLBLegalizer
      */
     inline float getHPWLChange(PlacementInfo::PlacementUnit *tmpPU, float PUX, float PUY)
     {
-
-        float oriHPWL = 0.0;
-        float newHPWL = 0.0;
-        auto nets = placementInfo->getPlacementUnitId2Nets()[tmpPU->getId()];
-
-        for (auto curNet : nets)
-        {
-            if (curNet->getDesignNet()->getPins().size() > 1000) // it could be clock
-                continue;
-            oriHPWL += curNet->getHPWL(y2xRatio);
-            newHPWL += curNet->getNewHPWLByTrying(tmpPU, PUX, PUY, y2xRatio);
-        }
-
-        return (newHPWL - oriHPWL);
+        return HPWLEvaluator->getHPWLChange(tmpPU, PUX, PUY);
     }
 
     inline void swapSitePtr(DeviceInfo::DeviceSite **siteA, DeviceInfo::DeviceSite **siteB)
@@ -0,0 +1,209 @@
+/**
+ * @file ColumnAssigner.cc
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This implementation file contains APIs' implementation of ColumnAssigner, which maps PlacementUnits to the
+ * columns of a site family (e.g., BRAM/DSP/CARRY/CLB columns) and resolves the overflow columns for fixed-column
+ * legalization.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ */
+
+#include "ColumnAssigner.h"
+#include "strPrint.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+void ColumnAssigner::setColumns(std::vector<float> &columnXs,
+                                std::vector<std::vector<DeviceInfo::DeviceSite *>> &column2Sites)
+{
+    assert(columnXs.size() == column2Sites.size());
+    columnNum = columnXs.size();
+    columnCapacity.resize(columnNum);
+    for (int colId = 0; colId < columnNum; colId++)
+        columnCapacity[colId] = column2Sites[colId].size();
+
+    std::vector<std::pair<float, int>> XAndIds(columnNum);
+    for (int colId = 0; colId < columnNum; colId++)
+        XAndIds[colId] = std::pair<float, int>(columnXs[colId], colId);
+    std::sort(XAndIds.begin(), XAndIds.end());
+    sortedColumnXs.resize(columnNum);
+    sortedColumnIds.resize(columnNum);
+    for (int i = 0; i < columnNum; i++)
+    {
+        sortedColumnXs[i] = XAndIds[i].first;
+        sortedColumnIds[i] = XAndIds[i].second;
+    }
+}
+
+int ColumnAssigner::findNearestColumn(float curX)
+{
+    assert(columnNum > 0);
+    // the first column of the run with the same X has the smallest index in the run
+    int rightPos = std::lower_bound(sortedColumnXs.begin(), sortedColumnXs.end(), curX) - sortedColumnXs.begin();
+    int leftPos = -1;
+    if (rightPos > 0)
+        leftPos = std::lower_bound(sortedColumnXs.begin(), sortedColumnXs.end(), sortedColumnXs[rightPos - 1]) -
+                  sortedColumnXs.begin();
+    if (rightPos >= columnNum)
+        return sortedColumnIds[leftPos];
+    if (leftPos < 0)
+        return sortedColumnIds[rightPos];
+
+    float leftDiff = std::fabs(curX - sortedColumnXs[leftPos]);
+    float rightDiff = std::fabs(curX - sortedColumnXs[rightPos]);
+    if (leftDiff < rightDiff)
+        return sortedColumnIds[leftPos];
+    if (rightDiff < leftDiff)
+        return sortedColumnIds[rightPos];
+    return std::min(sortedColumnIds[leftPos], sortedColumnIds[rightPos]);
+}
+
+int ColumnAssigner::findMostFrequentColumn(std::vector<int> &colIds)
+{
+    assert(colIds.size() > 0);
+    std::vector<int> sortedIds;
+    sortedIds.reserve(colIds.size());
+    for (auto colId : colIds)
+    {
+        if (colId >= 0 && colId < columnNum)
+            sortedIds.push_back(colId);
+    }
+    std::sort(sortedIds.begin(), sortedIds.end());
+
+    int resId = -1;
+    int maxRecurence = 0;
+    for (unsigned int i = 0; i < sortedIds.size();)
+    {
+        unsigned int j = i;
+        while (j < sortedIds.size() && sortedIds[j] == sortedIds[i])
+            j++;
+        if ((int)(j - i) > maxRecurence)
+        {
+            resId = sortedIds[i];
+            maxRecurence = j - i;
+        }
+        i = j;
+    }
+    assert(resId >= 0);
+    return resId;
+}
+
+void ColumnAssigner::spreadOverflowColumns(std::vector<int> &columnUtilization,
+                                           std::vector<std::deque<PlacementInfo::PlacementUnit *>> &column2PUs,
+                                           float budgetRatio,
+                                           const std::function<int(PlacementInfo::PlacementUnit *)> &getPUSiteNum,
+                                           bool verbose, const std::string &familyName)
+{
+    assert((int)columnUtilization.size() == columnNum && (int)column2PUs.size() == columnNum);
+    if (!columnNum)
+        return;
+
+    // the capacities do not change and the utilizations only change around the resolved column
+    std::vector<int> accumulationUtil(columnNum, 0), accumulationCapacity(columnNum, 0);
+    accumulationUtil[0] = columnUtilization[0];
+    accumulationCapacity[0] = columnCapacity[0] * budgetRatio;
+    for (int colId = 1; colId < columnNum; colId++)
+    {
+        accumulationUtil[colId] = accumulationUtil[colId - 1] + columnUtilization[colId];
+        accumulationCapacity[colId] = accumulationCapacity[colId - 1] + columnCapacity[colId] * budgetRatio;
+    }
+
+    auto isOverflow = [&](int colId) -> bool {
+        if (budgetRatio == 1)
+            return (unsigned int)columnCapacity[colId] < (unsigned int)columnUtilization[colId];
+        return columnCapacity[colId] * (budgetRatio + 0.05) < (unsigned int)columnUtilization[colId];
+    };
+
+    // the columns on the left of the left neighbor of the resolved column are unchanged, so the search of the leftmost
+    // overflow column can start from there
+    int searchBegin = 0;
+    while (true)
+    {
+        int overflowColId = -1;
+        for (int colId = searchBegin; colId < columnNum; colId++)
+        {
+            if (isOverflow(colId))
+            {
+                overflowColId = colId;
+                break;
+            }
+        }
+        if (overflowColId < 0)
+            break;
+
+        if (verbose)
+        {
+            std::stringstream outputStream;
+            outputStream << familyName << " column overflow resolving\n";
+            for (int colId = 0; colId < columnNum; colId++)
+            {
+                outputStream << " colId#" << colId << " columnUntilization:" << columnUtilization[colId] << " "
+                             << " siteCap:" << columnCapacity[colId] << "\n";
+            }
+            print_warning(outputStream.str());
+        }
+
+        int leftAvaliableCapacity = 0;
+        int rightAvaliableCapacity = 0;
+        int leftUtil = 0;
+        int rightUtil = 0;
+
+        if (overflowColId > 0)
+        {
+            leftAvaliableCapacity += accumulationCapacity[overflowColId - 1];
+            leftUtil += accumulationUtil[overflowColId - 1];
+        }
+        if (overflowColId < columnNum - 1)
+        {
+            rightAvaliableCapacity += accumulationCapacity[columnNum - 1] - accumulationCapacity[overflowColId];
+            rightUtil += accumulationUtil[columnNum - 1] - accumulationUtil[overflowColId];
+        }
+
+        int overflowNum = (unsigned int)columnUtilization[overflowColId] -
+                          columnCapacity[overflowColId] * budgetRatio; // spread more for redundant space
+
+        int totalAvailableCapacity = rightAvaliableCapacity + leftAvaliableCapacity - leftUtil - rightUtil;
+        assert(totalAvailableCapacity > 0);
+        float toLeftRatio = (float)(leftAvaliableCapacity - leftUtil) / totalAvailableCapacity;
+        int toLeftNum = int((overflowNum * toLeftRatio) + 0.4999);
+        int toRightNum = overflowNum;
+
+        auto &overflowPUs = column2PUs[overflowColId];
+        if (leftAvaliableCapacity - leftUtil > 0)
+        {
+            while (toLeftNum > 0 && overflowPUs.size() > 0)
+            {
+                column2PUs[overflowColId - 1].push_back(overflowPUs.front());
+                int macroSize = getPUSiteNum(overflowPUs.front());
+                columnUtilization[overflowColId - 1] += macroSize;
+                columnUtilization[overflowColId] -= macroSize;
+                toLeftNum -= macroSize;
+                overflowPUs.pop_front();
+            }
+        }
+        if (rightAvaliableCapacity - rightUtil > 0)
+        {
+            while (toRightNum > 0 && overflowPUs.size() > 0)
+            {
+                column2PUs[overflowColId + 1].push_front(overflowPUs.back());
+                int macroSize = getPUSiteNum(overflowPUs.back());
+                columnUtilization[overflowColId + 1] += macroSize;
+                columnUtilization[overflowColId] -= macroSize;
+                toRightNum -= macroSize;
+                overflowPUs.pop_back();
+            }
+        }
+
+        int updateBegin = std::max(0, overflowColId - 1);
+        int updateEnd = std::min(columnNum - 1, overflowColId + 1);
+        for (int colId = updateBegin; colId <= updateEnd; colId++)
+            accumulationUtil[colId] = (colId ? accumulationUtil[colId - 1] : 0) + columnUtilization[colId];
+        searchBegin = updateBegin;
+    }
+}
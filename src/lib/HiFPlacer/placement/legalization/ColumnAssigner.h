@@ -0,0 +1,111 @@
+/**
+ * @file ColumnAssigner.h
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This header file contains the definitions of ColumnAssigner class, which maps PlacementUnits to the columns of
+ * a site family (e.g., BRAM/DSP/CARRY/CLB columns) and resolves the overflow columns for fixed-column legalization.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ */
+
+#ifndef _COLUMNASSIGNER
+#define _COLUMNASSIGNER
+
+#include "DeviceInfo.h"
+#include "PlacementInfo.h"
+#include <assert.h>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief ColumnAssigner maps the PlacementUnits of a site family to its columns and spreads the PlacementUnits in the
+ * overflow columns to their neighbors.
+ *
+ * The columns are indexed by the SiteX of their sites. The nearest column of a location is found by binary search on
+ * the sorted column X locations, and the overflow columns are resolved with the prefix sums of the column
+ * utilizations and capacities, which are updated locally after each shifting step. An assigner only touches the data
+ * of its own family, so the assigners of different families can run concurrently.
+ *
+ */
+class ColumnAssigner
+{
+  public:
+    ColumnAssigner()
+    {
+    }
+    ~ColumnAssigner()
+    {
+    }
+
+    /**
+     * @brief set the columns of the family
+     *
+     * @param columnXs the X location of each column (the columns without site can have any location)
+     * @param column2Sites the sites in each column
+     */
+    void setColumns(std::vector<float> &columnXs, std::vector<std::vector<DeviceInfo::DeviceSite *>> &column2Sites);
+
+    inline int getColumnNum()
+    {
+        return columnNum;
+    }
+
+    /**
+     * @brief find the column whose X location is the nearest to the given X, where the ties are broken by the column
+     * index
+     *
+     * @param curX
+     * @return int
+     */
+    int findNearestColumn(float curX);
+
+    /**
+     * @brief find the column which occurs the most times in a list of column indexes, where the ties are broken by the
+     * column index
+     *
+     * @param colIds the column indexes (those out of the range of the columns are ignored)
+     * @return int
+     */
+    int findMostFrequentColumn(std::vector<int> &colIds);
+
+    /**
+     * @brief spread the PlacementUnits in the overflow columns to their neighbor columns until there is no overflow
+     *
+     * The leftmost overflow column is resolved each time by moving the bottom PlacementUnits to the left neighbor and
+     * the top PlacementUnits to the right neighbor according to the available capacities on both sides.
+     *
+     * @param columnUtilization the number of sites required by the PlacementUnits in each column
+     * @param column2PUs the PlacementUnits in each column
+     * @param budgetRatio the ratio of the sites in a column which can be used
+     * @param getPUSiteNum the number of sites required by a PlacementUnit
+     * @param verbose whether to print the column utilization when an overflow is found
+     * @param familyName the name of the family for the messages
+     */
+    void spreadOverflowColumns(std::vector<int> &columnUtilization,
+                               std::vector<std::deque<PlacementInfo::PlacementUnit *>> &column2PUs, float budgetRatio,
+                               const std::function<int(PlacementInfo::PlacementUnit *)> &getPUSiteNum, bool verbose,
+                               const std::string &familyName);
+
+  private:
+    int columnNum = 0;
+
+    /**
+     * @brief the number of sites in each column
+     *
+     */
+    std::vector<int> columnCapacity;
+
+    /**
+     * @brief the X locations of the columns and the column indexes, sorted by X and then by index
+     *
+     */
+    std::vector<float> sortedColumnXs;
+    std::vector<int> sortedColumnIds;
+};
+
+#endif
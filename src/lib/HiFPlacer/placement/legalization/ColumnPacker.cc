@@ -0,0 +1,182 @@
+/**
+ * @file ColumnPacker.cc
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This implementation file contains APIs' implementation of ColumnPacker, which packs PlacementUnits into the
+ * columns of a site family around their locations (Abacus-style row packing, with the columns as rows).
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ */
+
+#include "ColumnPacker.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+void ColumnPacker::setColumns(const std::vector<float> &columnXs, const std::vector<std::vector<float>> &column2SiteYs)
+{
+    assert(columnXs.size() == column2SiteYs.size());
+    int columnNum = columnXs.size();
+    columns.clear();
+    columns.resize(columnNum);
+    std::vector<std::pair<float, int>> XAndIds;
+    for (int colId = 0; colId < columnNum; colId++)
+    {
+        columns[colId].X = columnXs[colId];
+        columns[colId].siteYs = column2SiteYs[colId];
+        assert(std::is_sorted(columns[colId].siteYs.begin(), columns[colId].siteYs.end()));
+        // the columns without site are never tried
+        if (column2SiteYs[colId].size())
+            XAndIds.emplace_back(columnXs[colId], colId);
+    }
+    std::sort(XAndIds.begin(), XAndIds.end());
+    sortedColumnXs.resize(XAndIds.size());
+    sortedColumnIds.resize(XAndIds.size());
+    for (unsigned int i = 0; i < XAndIds.size(); i++)
+    {
+        sortedColumnXs[i] = XAndIds[i].first;
+        sortedColumnIds[i] = XAndIds[i].second;
+    }
+}
+
+int ColumnPacker::findNearestSite(Column &curColumn, float Y)
+{
+    auto &siteYs = curColumn.siteYs;
+    int siteId = std::lower_bound(siteYs.begin(), siteYs.end(), Y) - siteYs.begin();
+    if (siteId > 0 && (siteId == (int)siteYs.size() || Y - siteYs[siteId - 1] < siteYs[siteId] - Y))
+        siteId--;
+    return siteId;
+}
+
+void ColumnPacker::placeCluster(Column &curColumn, Cluster &curCluster)
+{
+    int maxBottom = (int)curColumn.siteYs.size() - curCluster.height;
+    int bottom = std::lround((double)curCluster.offsetTargetSum / curCluster.numPUs);
+    curCluster.bottomSiteId = std::max(0, std::min(bottom, maxBottom));
+}
+
+int ColumnPacker::tryPU(Column &curColumn, int targetSiteId, int PUHeight, int &PUBottomSiteId)
+{
+    Cluster newCluster = {(int)curColumn.PUHeights.size(), PUHeight, 1, targetSiteId, 0};
+    placeCluster(curColumn, newCluster);
+    int lowestMergedId = curColumn.clusters.size();
+    for (int clusterId = (int)curColumn.clusters.size() - 1; clusterId >= 0; clusterId--)
+    {
+        Cluster &belowCluster = curColumn.clusters[clusterId];
+        if (belowCluster.bottomSiteId + belowCluster.height <= newCluster.bottomSiteId)
+            break;
+        newCluster.offsetTargetSum += belowCluster.offsetTargetSum;
+        newCluster.offsetTargetSum -= (long long)newCluster.numPUs * belowCluster.height;
+        newCluster.numPUs += belowCluster.numPUs;
+        newCluster.height += belowCluster.height;
+        placeCluster(curColumn, newCluster);
+        lowestMergedId = clusterId;
+    }
+    // the new PlacementUnit is at the top of the merged cluster
+    PUBottomSiteId = newCluster.bottomSiteId + newCluster.height - PUHeight;
+
+    // the PlacementUnits in the merged clusters are shifted together
+    int pushedSites = 0;
+    int curBottom = newCluster.bottomSiteId;
+    for (int clusterId = lowestMergedId; clusterId < (int)curColumn.clusters.size(); clusterId++)
+    {
+        Cluster &mergedCluster = curColumn.clusters[clusterId];
+        pushedSites += mergedCluster.numPUs * std::abs(curBottom - mergedCluster.bottomSiteId);
+        curBottom += mergedCluster.height;
+    }
+    return pushedSites;
+}
+
+void ColumnPacker::placePU(Column &curColumn, int targetSiteId, int PUHeight)
+{
+    auto &clusters = curColumn.clusters;
+    clusters.push_back({(int)curColumn.PUHeights.size(), PUHeight, 1, targetSiteId, 0});
+    curColumn.PUHeights.push_back(PUHeight);
+    curColumn.usedHeight += PUHeight;
+    placeCluster(curColumn, clusters.back());
+
+    // merge the top cluster with the clusters below it until they do not overlap
+    while (clusters.size() > 1)
+    {
+        Cluster &topCluster = clusters[clusters.size() - 1];
+        Cluster &belowCluster = clusters[clusters.size() - 2];
+        if (belowCluster.bottomSiteId + belowCluster.height <= topCluster.bottomSiteId)
+            break;
+        belowCluster.offsetTargetSum += topCluster.offsetTargetSum - (long long)topCluster.numPUs * belowCluster.height;
+        belowCluster.numPUs += topCluster.numPUs;
+        belowCluster.height += topCluster.height;
+        clusters.pop_back();
+        placeCluster(curColumn, clusters.back());
+    }
+}
+
+int ColumnPacker::addPU(float PUX, float PUY, int PUHeight)
+{
+    int numSortedColumns = sortedColumnXs.size();
+    if (!numSortedColumns)
+        return -1;
+
+    int bestColId = -1, bestTargetSiteId = -1;
+    float bestCost = std::numeric_limits<float>::max();
+    auto tryColumn = [&](int sortedId) {
+        int colId = sortedColumnIds[sortedId];
+        Column &curColumn = columns[colId];
+        if (curColumn.usedHeight + PUHeight > (int)curColumn.siteYs.size())
+            return;
+        int targetSiteId = std::min(findNearestSite(curColumn, PUY), (int)curColumn.siteYs.size() - PUHeight);
+        int bottomSiteId = -1;
+        int pushedSites = tryPU(curColumn, targetSiteId, PUHeight, bottomSiteId);
+        float cost = std::fabs(PUX - curColumn.X) + y2xRatio * std::fabs(PUY - curColumn.siteYs[bottomSiteId]) +
+                     y2xRatio * pushedSiteCost * pushedSites;
+        if (cost < bestCost)
+        {
+            bestCost = cost;
+            bestColId = colId;
+            bestTargetSiteId = targetSiteId;
+        }
+    };
+
+    // the columns are tried from the nearest one outwards until their X distances exceed the best cost
+    int rightId = std::lower_bound(sortedColumnXs.begin(), sortedColumnXs.end(), PUX) - sortedColumnXs.begin();
+    int leftId = rightId - 1;
+    while (leftId >= 0 || rightId < numSortedColumns)
+    {
+        float leftDist = leftId >= 0 ? PUX - sortedColumnXs[leftId] : std::numeric_limits<float>::max();
+        float rightDist =
+            rightId < numSortedColumns ? sortedColumnXs[rightId] - PUX : std::numeric_limits<float>::max();
+        if (std::min(leftDist, rightDist) >= bestCost)
+            break;
+        if (leftDist <= rightDist)
+            tryColumn(leftId--);
+        else
+            tryColumn(rightId++);
+    }
+
+    if (bestColId >= 0)
+        placePU(columns[bestColId], bestTargetSiteId, PUHeight);
+    return bestColId;
+}
+
+void ColumnPacker::getPackedSites(std::vector<std::vector<int>> &column2PUBottomSiteIds)
+{
+    column2PUBottomSiteIds.resize(columns.size());
+    for (unsigned int colId = 0; colId < columns.size(); colId++)
+    {
+        auto &curColumn = columns[colId];
+        auto &PUBottomSiteIds = column2PUBottomSiteIds[colId];
+        PUBottomSiteIds.assign(curColumn.PUHeights.size(), -1);
+        for (auto &curCluster : curColumn.clusters)
+        {
+            int curBottom = curCluster.bottomSiteId;
+            for (int i = curCluster.firstPUId; i < curCluster.firstPUId + curCluster.numPUs; i++)
+            {
+                PUBottomSiteIds[i] = curBottom;
+                curBottom += curColumn.PUHeights[i];
+            }
+        }
+    }
+}
@@ -0,0 +1,159 @@
+/**
+ * @file ColumnPacker.h
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This header file contains the definitions of ColumnPacker class, which packs PlacementUnits into the columns
+ * of a site family around their locations (Abacus-style row packing, with the columns as rows).
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ */
+
+#ifndef _COLUMNPACKER
+#define _COLUMNPACKER
+
+#include <assert.h>
+#include <vector>
+
+/**
+ * @brief ColumnPacker packs PlacementUnits, which are added from bottom to top (in the order of Y), into the columns
+ * of a site family without overlap.
+ *
+ * In each column, the PlacementUnits are grouped into clusters of consecutive PlacementUnits. A new PlacementUnit
+ * starts as a cluster at its nearest site, and a cluster overlapping the cluster below it is merged with it and placed
+ * at the mean of the targets of its PlacementUnits (offset by their positions in the cluster), which minimizes the
+ * total squared displacement in the column. A PlacementUnit is tried in the columns around it and added to the one
+ * where its own displacement plus the penalty of pushing the PlacementUnits already in the column is the minimum,
+ * and the columns farther than the best cost found are pruned, so only a few columns are tried for each PlacementUnit.
+ * The sites are indexed from bottom to top in each column and the gaps between them are not considered when the
+ * clusters are placed.
+ *
+ */
+class ColumnPacker
+{
+  public:
+    /**
+     * @brief Construct a new ColumnPacker object
+     *
+     * @param y2xRatio the weight of the Y displacement relative to the X displacement
+     */
+    ColumnPacker(float y2xRatio = 1.0) : y2xRatio(y2xRatio)
+    {
+    }
+    ~ColumnPacker()
+    {
+    }
+
+    /**
+     * @brief set the columns of the family
+     *
+     * @param columnXs the X location of each column (the columns without site can have any location)
+     * @param column2SiteYs the Y locations of the sites in each column, sorted from bottom to top
+     */
+    void setColumns(const std::vector<float> &columnXs, const std::vector<std::vector<float>> &column2SiteYs);
+
+    /**
+     * @brief add a PlacementUnit to the column where its displacement is the minimum. The PlacementUnits should be
+     * added in the order of Y.
+     *
+     * @param PUX the X location of the PlacementUnit
+     * @param PUY the Y location of the PlacementUnit
+     * @param PUHeight the number of sites required by the PlacementUnit
+     * @return int the column of the PlacementUnit, -1 if no column has enough sites for it
+     */
+    int addPU(float PUX, float PUY, int PUHeight);
+
+    /**
+     * @brief get the bottom sites of the PlacementUnits in each column, in the order they are added
+     *
+     * @param column2PUBottomSiteIds the resultant bottom sites
+     */
+    void getPackedSites(std::vector<std::vector<int>> &column2PUBottomSiteIds);
+
+  private:
+    /**
+     * @brief a group of consecutive PlacementUnits which are placed next to each other in a column
+     *
+     */
+    struct Cluster
+    {
+        int firstPUId;
+        int height;
+        int numPUs;
+
+        /**
+         * @brief the sum of the target bottom sites of the PlacementUnits, offset by their positions in the cluster
+         *
+         */
+        long long offsetTargetSum;
+        int bottomSiteId;
+    };
+
+    struct Column
+    {
+        float X;
+        std::vector<float> siteYs;
+        std::vector<int> PUHeights;
+        std::vector<Cluster> clusters;
+        int usedHeight = 0;
+    };
+
+    float y2xRatio;
+
+    /**
+     * @brief the cost of pushing a PlacementUnit already in a column by one site, relative to the displacement of the
+     * new PlacementUnit. Without it, the PlacementUnits tend to pile up in the columns around dense regions and push
+     * the PlacementUnits added earlier far away.
+     *
+     */
+    const float pushedSiteCost = 0.25;
+    std::vector<Column> columns;
+
+    /**
+     * @brief the X locations of the columns and the column indexes, sorted by X and then by index
+     *
+     */
+    std::vector<float> sortedColumnXs;
+    std::vector<int> sortedColumnIds;
+
+    /**
+     * @brief find the site in a column whose Y location is the nearest to the given Y
+     *
+     * @param curColumn
+     * @param Y
+     * @return int
+     */
+    int findNearestSite(Column &curColumn, float Y);
+
+    /**
+     * @brief place a cluster at the mean of its targets within the column
+     *
+     * @param curColumn
+     * @param curCluster
+     */
+    void placeCluster(Column &curColumn, Cluster &curCluster);
+
+    /**
+     * @brief get the bottom site of a PlacementUnit if it were added to a column, without changing the column
+     *
+     * @param curColumn
+     * @param targetSiteId the nearest site of the PlacementUnit in the column
+     * @param PUHeight
+     * @param PUBottomSiteId the resultant bottom site of the PlacementUnit
+     * @return int the total number of sites by which the PlacementUnits already in the column are pushed
+     */
+    int tryPU(Column &curColumn, int targetSiteId, int PUHeight, int &PUBottomSiteId);
+
+    /**
+     * @brief add a PlacementUnit to a column and merge the overlapping clusters
+     *
+     * @param curColumn
+     * @param targetSiteId the nearest site of the PlacementUnit in the column
+     * @param PUHeight
+     */
+    void placePU(Column &curColumn, int targetSiteId, int PUHeight);
+};
+
+#endif
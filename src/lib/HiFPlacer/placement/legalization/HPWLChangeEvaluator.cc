@@ -0,0 +1,74 @@
+/**
+ * @file HPWLChangeEvaluator.cc
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This implementation file contains APIs' implementation of HPWLChangeEvaluator, which evaluates and caches the
+ * HPWL changes of the PlacementUnits moved to candidate locations during legalization.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ */
+
+#include "HPWLChangeEvaluator.h"
+
+float HPWLChangeEvaluator::evaluateWithoutCache(PlacementInfo::PlacementUnit *curPU, float PUX, float PUY)
+{
+    float oriHPWL = 0.0;
+    float newHPWL = 0.0;
+    for (auto curNet : placementInfo->getPlacementUnitId2Nets()[curPU->getId()])
+    {
+        if (curNet->getDesignNet()->getPins().size() > 1000) // it could be clock
+            continue;
+        oriHPWL += curNet->getHPWL(y2xRatio);
+        newHPWL += curNet->getNewHPWLByTrying(curPU, PUX, PUY, y2xRatio);
+    }
+    return newHPWL - oriHPWL;
+}
+
+void HPWLChangeEvaluator::preparePU(PlacementInfo::PlacementUnit *curPU, PUCache &curCache)
+{
+    curCache.netBoxes.clear();
+    curCache.pinOffsetX.clear();
+    curCache.pinOffsetY.clear();
+    curCache.oriHPWL = 0.0;
+
+    for (auto curNet : placementInfo->getPlacementUnitId2Nets()[curPU->getId()])
+    {
+        if (curNet->getDesignNet()->getPins().size() > 1000) // it could be clock
+            continue;
+        curCache.oriHPWL += curNet->getHPWL(y2xRatio);
+
+        // the same initial bounds as PlacementNet::getNewHPWLByTrying()
+        NetBox curBox;
+        curBox.leftX = 1e5;
+        curBox.rightX = -1e5;
+        curBox.bottomY = 1e5;
+        curBox.topY = -1e5;
+        curBox.pinBegin = curCache.pinOffsetX.size();
+        auto &unitsOfNetPins = curNet->getUnits();
+        auto &pinOffsetsInUnit = curNet->getPinOffsetsInUnit();
+        for (unsigned int pinId_net = 0; pinId_net < unitsOfNetPins.size(); pinId_net++)
+        {
+            auto tmpPU = unitsOfNetPins[pinId_net];
+            auto &tmpPinOffset = pinOffsetsInUnit[pinId_net];
+            if (tmpPU == curPU)
+            {
+                curCache.pinOffsetX.push_back(tmpPinOffset.x);
+                curCache.pinOffsetY.push_back(tmpPinOffset.y);
+                continue;
+            }
+            float pinX = tmpPU->X() + tmpPinOffset.x;
+            float pinY = tmpPU->Y() + tmpPinOffset.y;
+            curBox.leftX = std::min(curBox.leftX, pinX);
+            curBox.rightX = std::max(curBox.rightX, pinX);
+            curBox.bottomY = std::min(curBox.bottomY, pinY);
+            curBox.topY = std::max(curBox.topY, pinY);
+        }
+        curBox.pinEnd = curCache.pinOffsetX.size();
+        curCache.netBoxes.push_back(curBox);
+    }
+    curCache.location2HPWLChange.clear();
+    curCache.prepared = true;
+}
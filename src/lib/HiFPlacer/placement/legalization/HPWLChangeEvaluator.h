@@ -0,0 +1,209 @@
+/**
+ * @file HPWLChangeEvaluator.h
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This header file contains the definitions of HPWLChangeEvaluator class, which evaluates and caches the HPWL
+ * changes of the PlacementUnits moved to candidate locations during legalization.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ */
+
+#ifndef _HPWLCHANGEEVALUATOR
+#define _HPWLCHANGEEVALUATOR
+
+#include "PlacementInfo.h"
+#include <assert.h>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief HPWLChangeEvaluator evaluates the HPWL change when a PlacementUnit is moved to a given location
+ *
+ * When a PlacementUnit is evaluated for the first time, the bounding box of the other pins of each of its nets (the
+ * pins of the PlacementUnit excluded) and the pin offsets of the PlacementUnit on the nets are recorded in flat arrays.
+ * Afterwards, a candidate location can be scored in O(#pins of the PlacementUnit) by extending the recorded bounding
+ * boxes, without any allocation. The scores are memoized per (PlacementUnit, location), so the repeated queries in
+ * candidate sorting, bipartite matching and DP legalization are only evaluated once.
+ *
+ * The cache assumes that the PlacementUnits do not move, so it should be reset with the PlacementUnits to be legalized
+ * when a legalization is started. The cache of a PlacementUnit is guarded by its own lock, so the queries can be made
+ * by different threads concurrently (e.g., for the cells of a macro). The PlacementUnits which are not given to reset()
+ * are evaluated without caching.
+ *
+ */
+class HPWLChangeEvaluator
+{
+  public:
+    /**
+     * @brief Construct a new HPWLChangeEvaluator object
+     *
+     * @param placementInfo the PlacementInfo for this placer to handle the placement-related information
+     * @param y2xRatio a factor to tune the weights of the net spanning in Y-coordinate relative to the net spanning in
+     * X-coordinate
+     */
+    HPWLChangeEvaluator(PlacementInfo *placementInfo, float y2xRatio)
+        : placementInfo(placementInfo), y2xRatio(y2xRatio)
+    {
+    }
+    ~HPWLChangeEvaluator()
+    {
+    }
+
+    /**
+     * @brief clear the cached nets and scores since the PlacementUnits might have been moved
+     *
+     * @param PUsToEvaluate the PlacementUnits whose HPWL changes will be cached
+     */
+    template <class PUContainer> void reset(PUContainer &PUsToEvaluate)
+    {
+        PUCaches.clear();
+        PUId2CacheId.assign(placementInfo->getPlacementUnits().size(), -1);
+        for (auto curPU : PUsToEvaluate)
+        {
+            assert(curPU->getId() < PUId2CacheId.size());
+            if (PUId2CacheId[curPU->getId()] >= 0)
+                continue;
+            PUId2CacheId[curPU->getId()] = PUCaches.size();
+            PUCaches.emplace_back();
+        }
+    }
+
+    /**
+     * @brief get the HPWL change when the given PlacementUnit moves to the given location
+     *
+     * The nets with more than 1000 pins (which could be clock nets) are ignored.
+     *
+     * @param curPU the given PlacementUnit
+     * @param PUX given location X
+     * @param PUY given location Y
+     * @return float
+     */
+    inline float getHPWLChange(PlacementInfo::PlacementUnit *curPU, float PUX, float PUY)
+    {
+        if (curPU->getId() >= PUId2CacheId.size() || PUId2CacheId[curPU->getId()] < 0)
+            return evaluateWithoutCache(curPU, PUX, PUY);
+        PUCache &curCache = PUCaches[PUId2CacheId[curPU->getId()]];
+        std::lock_guard<std::mutex> lock(curCache.cacheLock);
+        if (!curCache.prepared)
+            preparePU(curPU, curCache);
+
+        uint64_t locKey = getLocationKey(PUX, PUY);
+        auto findRes = curCache.location2HPWLChange.find(locKey);
+        if (findRes != curCache.location2HPWLChange.end())
+            return findRes->second;
+
+        float newHPWL = 0.0;
+        for (auto &curBox : curCache.netBoxes)
+        {
+            float leftX = curBox.leftX, rightX = curBox.rightX;
+            float bottomY = curBox.bottomY, topY = curBox.topY;
+            for (int pinId = curBox.pinBegin; pinId < curBox.pinEnd; pinId++)
+            {
+                float pinX = PUX + curCache.pinOffsetX[pinId];
+                float pinY = PUY + curCache.pinOffsetY[pinId];
+                leftX = std::min(leftX, pinX);
+                rightX = std::max(rightX, pinX);
+                bottomY = std::min(bottomY, pinY);
+                topY = std::max(topY, pinY);
+            }
+            newHPWL += std::fabs(rightX - leftX) + y2xRatio * std::fabs(topY - bottomY);
+        }
+        float HPWLChange = newHPWL - curCache.oriHPWL;
+        curCache.location2HPWLChange[locKey] = HPWLChange;
+        return HPWLChange;
+    }
+
+    /**
+     * @brief get the HPWL change when the given PlacementUnit moves to the given DeviceSite
+     *
+     * @param curPU the given PlacementUnit
+     * @param curSite the given DeviceSite
+     * @return float
+     */
+    inline float getHPWLChange(PlacementInfo::PlacementUnit *curPU, DeviceInfo::DeviceSite *curSite)
+    {
+        return getHPWLChange(curPU, curSite->X(), curSite->Y());
+    }
+
+  private:
+    PlacementInfo *placementInfo;
+    float y2xRatio = 1.0;
+
+    /**
+     * @brief the bounding box of the pins of a net except the pins of the PlacementUnit, and the range of the pin
+     * offsets of the PlacementUnit on the net
+     *
+     */
+    struct NetBox
+    {
+        float leftX;
+        float rightX;
+        float bottomY;
+        float topY;
+        int pinBegin;
+        int pinEnd;
+    };
+
+    /**
+     * @brief the cached nets and scores of a PlacementUnit
+     *
+     */
+    struct PUCache
+    {
+        bool prepared = false;
+        float oriHPWL = 0.0;
+        std::vector<NetBox> netBoxes;
+        std::vector<float> pinOffsetX;
+        std::vector<float> pinOffsetY;
+        std::unordered_map<uint64_t, float> location2HPWLChange;
+        std::mutex cacheLock;
+    };
+
+    /**
+     * @brief the caches of the PlacementUnits given to reset() (a deque since the locks are not movable)
+     *
+     */
+    std::deque<PUCache> PUCaches;
+
+    /**
+     * @brief the index of the cache of each PlacementUnit (indexed by the id of the PlacementUnit), -1 for the
+     * PlacementUnits which are not cached
+     *
+     */
+    std::vector<int> PUId2CacheId;
+
+    /**
+     * @brief record the nets of the PlacementUnit into its cache
+     *
+     * @param curPU the given PlacementUnit
+     * @param curCache the cache of the PlacementUnit
+     */
+    void preparePU(PlacementInfo::PlacementUnit *curPU, PUCache &curCache);
+
+    /**
+     * @brief evaluate the HPWL change of a PlacementUnit which is not cached
+     *
+     * @param curPU the given PlacementUnit
+     * @param PUX given location X
+     * @param PUY given location Y
+     * @return float
+     */
+    float evaluateWithoutCache(PlacementInfo::PlacementUnit *curPU, float PUX, float PUY);
+
+    static inline uint64_t getLocationKey(float PUX, float PUY)
+    {
+        uint32_t xBits, yBits;
+        std::memcpy(&xBits, &PUX, sizeof(float));
+        std::memcpy(&yBits, &PUY, sizeof(float));
+        return ((uint64_t)xBits << 32) | yBits;
+    }
+};
+
+#endif
@@ -0,0 +1,193 @@
+/**
+ * @file LegalizationInstance.cc
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This implementation file contains APIs' implementation of LegalizationInstance, a snapshot of the problems
+ * solved by a legalizer which can be dumped to a file and replayed offline.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ */
+
+#include "LegalizationInstance.h"
+#include "dumpZip.h"
+#include "strPrint.h"
+
+#include <iomanip>
+#include <sstream>
+#include <zlib.h>
+
+void LegalizationInstance::addMatchingProblem(const std::string &phase, int numRightNodes,
+                                              std::vector<std::vector<std::pair<int, float>>> &adjList,
+                                              std::vector<std::vector<float>> &displacements)
+{
+    assert(adjList.size() == displacements.size());
+    MatchingProblem newProblem;
+    newProblem.phase = phase;
+    newProblem.numLeftNodes = adjList.size();
+    newProblem.numRightNodes = numRightNodes;
+    newProblem.adjList = adjList;
+    newProblem.displacements = displacements;
+    matchingProblems.push_back(std::move(newProblem));
+}
+
+void LegalizationInstance::fillColumnDPProblem(ColumnDPProblem &problem, const std::string &columnType, int columnId,
+                                               std::vector<DeviceInfo::DeviceSite *> &sites,
+                                               std::deque<PlacementInfo::PlacementUnit *> &PUs,
+                                               std::vector<int> &PUHeights, std::vector<int> &PUTargetSiteIds,
+                                               int bandWidth, BandedColumnDP &columnDP)
+{
+    assert(PUs.size() == PUHeights.size() && PUs.size() == PUTargetSiteIds.size());
+    problem.columnType = columnType;
+    problem.columnId = columnId;
+    problem.numSites = sites.size();
+    problem.bandWidth = bandWidth;
+    problem.siteXs.resize(sites.size());
+    problem.siteYs.resize(sites.size());
+    for (unsigned int j = 0; j < sites.size(); j++)
+    {
+        problem.siteXs[j] = sites[j]->X();
+        problem.siteYs[j] = sites[j]->Y();
+    }
+    problem.PUHeights = PUHeights;
+    problem.PUTargetSiteIds = PUTargetSiteIds;
+    problem.PUXs.resize(PUs.size());
+    problem.PUYs.resize(PUs.size());
+    for (unsigned int i = 0; i < PUs.size(); i++)
+    {
+        problem.PUXs[i] = PUs[i]->X();
+        problem.PUYs[i] = PUs[i]->Y();
+    }
+    columnDP.getFeasibleCosts(problem.PUCosts);
+}
+
+void LegalizationInstance::dump(std::string fileName)
+{
+    std::stringstream outfile0;
+    outfile0 << std::setprecision(9);
+    outfile0 << "LegalizationInstance " << legalizerName << "\n";
+    for (auto &curProblem : matchingProblems)
+    {
+        outfile0 << "matching " << curProblem.phase << " " << curProblem.numLeftNodes << " "
+                 << curProblem.numRightNodes << "\n";
+        for (int leftId = 0; leftId < curProblem.numLeftNodes; leftId++)
+        {
+            auto &curEdges = curProblem.adjList[leftId];
+            outfile0 << curEdges.size();
+            for (unsigned int edgeId = 0; edgeId < curEdges.size(); edgeId++)
+                outfile0 << " " << curEdges[edgeId].first << " " << curEdges[edgeId].second << " "
+                         << curProblem.displacements[leftId][edgeId];
+            outfile0 << "\n";
+        }
+    }
+    for (auto &curProblem : columnDPProblems)
+    {
+        int numPUs = curProblem.PUHeights.size();
+        outfile0 << "columnDP " << curProblem.columnType << " " << curProblem.columnId << " " << curProblem.numSites
+                 << " " << numPUs << " " << curProblem.bandWidth << "\n";
+        for (int j = 0; j < curProblem.numSites; j++)
+            outfile0 << (j ? " " : "") << curProblem.siteXs[j] << " " << curProblem.siteYs[j];
+        outfile0 << "\n";
+        for (int i = 0; i < numPUs; i++)
+        {
+            outfile0 << curProblem.PUHeights[i] << " " << curProblem.PUTargetSiteIds[i] << " " << curProblem.PUXs[i]
+                     << " " << curProblem.PUYs[i] << " " << curProblem.PUCosts[i].size();
+            for (auto &topSiteAndCost : curProblem.PUCosts[i])
+                outfile0 << " " << topSiteAndCost.first << " " << topSiteAndCost.second;
+            outfile0 << "\n";
+        }
+    }
+    outfile0 << "end\n";
+    writeStrToGZip(fileName, outfile0);
+}
+
+bool LegalizationInstance::load(std::string fileName)
+{
+    clear();
+    gzFile gz_file = gzopen(fileName.c_str(), "rb");
+    if (gz_file == Z_NULL)
+    {
+        print_error("LegalizationInstance: cannot open " + fileName);
+        return false;
+    }
+    std::string content;
+    char buffer[65536];
+    int size;
+    while ((size = gzread(gz_file, buffer, sizeof(buffer))) > 0)
+        content.append(buffer, size);
+    gzclose(gz_file);
+
+    std::istringstream infile(content);
+    std::string keyword;
+    if (!(infile >> keyword >> legalizerName) || keyword != "LegalizationInstance")
+    {
+        print_error("LegalizationInstance: " + fileName + " is not a legalization instance");
+        return false;
+    }
+
+    while (infile >> keyword)
+    {
+        if (keyword == "end")
+            return true;
+        if (keyword == "matching")
+        {
+            MatchingProblem newProblem;
+            infile >> newProblem.phase >> newProblem.numLeftNodes >> newProblem.numRightNodes;
+            newProblem.adjList.resize(newProblem.numLeftNodes);
+            newProblem.displacements.resize(newProblem.numLeftNodes);
+            for (int leftId = 0; leftId < newProblem.numLeftNodes; leftId++)
+            {
+                int numEdges = 0;
+                infile >> numEdges;
+                for (int edgeId = 0; edgeId < numEdges; edgeId++)
+                {
+                    int rightId;
+                    float cost, displacement;
+                    infile >> rightId >> cost >> displacement;
+                    newProblem.adjList[leftId].emplace_back(rightId, cost);
+                    newProblem.displacements[leftId].push_back(displacement);
+                }
+            }
+            matchingProblems.push_back(std::move(newProblem));
+        }
+        else if (keyword == "columnDP")
+        {
+            ColumnDPProblem newProblem;
+            int numPUs = 0;
+            infile >> newProblem.columnType >> newProblem.columnId >> newProblem.numSites >> numPUs >>
+                newProblem.bandWidth;
+            newProblem.siteXs.resize(newProblem.numSites);
+            newProblem.siteYs.resize(newProblem.numSites);
+            for (int j = 0; j < newProblem.numSites; j++)
+                infile >> newProblem.siteXs[j] >> newProblem.siteYs[j];
+            newProblem.PUHeights.resize(numPUs);
+            newProblem.PUTargetSiteIds.resize(numPUs);
+            newProblem.PUXs.resize(numPUs);
+            newProblem.PUYs.resize(numPUs);
+            newProblem.PUCosts.resize(numPUs);
+            for (int i = 0; i < numPUs; i++)
+            {
+                int numCosts = 0;
+                infile >> newProblem.PUHeights[i] >> newProblem.PUTargetSiteIds[i] >> newProblem.PUXs[i] >>
+                    newProblem.PUYs[i] >> numCosts;
+                for (int k = 0; k < numCosts; k++)
+                {
+                    int topSiteId;
+                    float cost;
+                    infile >> topSiteId >> cost;
+                    newProblem.PUCosts[i].emplace_back(topSiteId, cost);
+                }
+            }
+            columnDPProblems.push_back(std::move(newProblem));
+        }
+        else
+            break;
+        if (!infile)
+            break;
+    }
+    print_error("LegalizationInstance: " + fileName + " is truncated or corrupted");
+    clear();
+    return false;
+}
@@ -0,0 +1,195 @@
+/**
+ * @file LegalizationInstance.h
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This header file contains the definitions of LegalizationInstance class, a snapshot of the problems solved by
+ * a legalizer which can be dumped to a file and replayed offline.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ */
+
+#ifndef _LEGALIZATIONINSTANCE
+#define _LEGALIZATIONINSTANCE
+
+#include "BandedColumnDP.h"
+#include "DeviceInfo.h"
+#include "PlacementInfo.h"
+#include <assert.h>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief LegalizationInstance records the bipartite matching problems (rough and fixed-column legalization) and the
+ * column DP problems (final legalization) of a legalizer call, so the solvers can be evaluated without running the
+ * whole placement flow.
+ *
+ * The problems are recorded with the ids of the nodes/sites only, together with the costs and the displacements, i.e.,
+ * exactly the inputs of MinCostBipartiteMatcher and BandedColumnDP. The column DP costs are recorded within the band
+ * used by the legalizer only. The steps producing the problems (candidate search, column mapping and spreading, the
+ * iterations of the rough legalization) are not recorded, so only the solver calls can be replayed. An instance is
+ * dumped as a gzipped text file and can be loaded by the LegalizationReplay tool.
+ *
+ */
+class LegalizationInstance
+{
+  public:
+    /**
+     * @brief a bipartite matching problem between the elements to legalize and their candidate sites
+     *
+     */
+    struct MatchingProblem
+    {
+        /**
+         * @brief the phase of legalization, e.g., rough or fixedColumn
+         *
+         */
+        std::string phase;
+        int numLeftNodes = 0;
+        int numRightNodes = 0;
+
+        /**
+         * @brief the right nodes and the costs of the edges of each left node, the input of MinCostBipartiteMatcher
+         *
+         */
+        std::vector<std::vector<std::pair<int, float>>> adjList;
+
+        /**
+         * @brief the displacement of each edge, in the order of adjList
+         *
+         */
+        std::vector<std::vector<float>> displacements;
+    };
+
+    /**
+     * @brief the DP problem of a column in the final legalization
+     *
+     */
+    struct ColumnDPProblem
+    {
+        /**
+         * @brief the type of the column, e.g., BRAM, DSP, CARRY or CLB
+         *
+         */
+        std::string columnType;
+        int columnId = -1;
+        int numSites = 0;
+
+        /**
+         * @brief the band width with which the costs are evaluated (negative for the whole column)
+         *
+         */
+        int bandWidth = -1;
+        std::vector<float> siteXs;
+        std::vector<float> siteYs;
+        std::vector<int> PUHeights;
+        std::vector<int> PUTargetSiteIds;
+        std::vector<float> PUXs;
+        std::vector<float> PUYs;
+
+        /**
+         * @brief the feasible top sites and their costs of each PlacementUnit
+         *
+         */
+        std::vector<std::vector<std::pair<int, float>>> PUCosts;
+    };
+
+    LegalizationInstance(std::string legalizerName) : legalizerName(legalizerName)
+    {
+    }
+    ~LegalizationInstance()
+    {
+    }
+
+    inline const std::string &getLegalizerName()
+    {
+        return legalizerName;
+    }
+
+    inline bool empty()
+    {
+        return matchingProblems.empty() && columnDPProblems.empty();
+    }
+
+    inline void clear()
+    {
+        matchingProblems.clear();
+        columnDPProblems.clear();
+    }
+
+    inline std::vector<MatchingProblem> &getMatchingProblems()
+    {
+        return matchingProblems;
+    }
+
+    inline std::vector<ColumnDPProblem> &getColumnDPProblems()
+    {
+        return columnDPProblems;
+    }
+
+    /**
+     * @brief record a bipartite matching problem
+     *
+     * @param phase the phase of legalization
+     * @param numRightNodes the number of right nodes
+     * @param adjList the right nodes and the costs of the edges of each left node
+     * @param displacements the displacement of each edge, in the order of adjList
+     */
+    void addMatchingProblem(const std::string &phase, int numRightNodes,
+                            std::vector<std::vector<std::pair<int, float>>> &adjList,
+                            std::vector<std::vector<float>> &displacements);
+
+    /**
+     * @brief record a column DP problem
+     *
+     * @param problem the problem, which is moved into the instance
+     */
+    inline void addColumnDPProblem(ColumnDPProblem &problem)
+    {
+        columnDPProblems.push_back(std::move(problem));
+    }
+
+    /**
+     * @brief fill a column DP problem with the column and the costs set in a BandedColumnDP
+     *
+     * @param problem the resultant problem
+     * @param columnType the type of the column
+     * @param columnId the id of the column
+     * @param sites the sites in the column sorted by SiteY
+     * @param PUs the PlacementUnits in the column from bottom to top
+     * @param PUHeights the number of sites required by each PlacementUnit
+     * @param PUTargetSiteIds the target site of each PlacementUnit
+     * @param bandWidth the band width with which the costs are set
+     * @param columnDP the DP engine with the costs
+     */
+    static void fillColumnDPProblem(ColumnDPProblem &problem, const std::string &columnType, int columnId,
+                                    std::vector<DeviceInfo::DeviceSite *> &sites,
+                                    std::deque<PlacementInfo::PlacementUnit *> &PUs, std::vector<int> &PUHeights,
+                                    std::vector<int> &PUTargetSiteIds, int bandWidth, BandedColumnDP &columnDP);
+
+    /**
+     * @brief dump the instance to a gzipped text file
+     *
+     * @param fileName
+     */
+    void dump(std::string fileName);
+
+    /**
+     * @brief load an instance dumped by dump()
+     *
+     * @param fileName
+     * @return true if the file is loaded successfully
+     */
+    bool load(std::string fileName);
+
+  private:
+    std::string legalizerName;
+    std::vector<MatchingProblem> matchingProblems;
+    std::vector<ColumnDPProblem> columnDPProblems;
+};
+
+#endif
@@ -17,6 +17,7 @@
 #include <cstdlib>
 #include <ctime>
 #include <iostream>
+#include <limits>
 
 MacroLegalizer::MacroLegalizer(std::string legalizerName, PlacementInfo *placementInfo, DeviceInfo *deviceInfo,
                                std::vector<DesignInfo::DesignCellType> &macroTypesToLegalize,
@@ -34,6 +35,8 @@ MacroLegalizer::MacroLegalizer(std::string legalizerName, PlacementInfo *placeme
     {
         y2xRatio = std::stof(JSONCfg["y2xRatio"]);
     }
+    HPWLEvaluator = new HPWLChangeEvaluator(placementInfo, y2xRatio);
+    siteSpatialIndex = new SiteSpatialIndex(y2xRatio);
 
     if (JSONCfg.find("MacroLegalizationVerbose") != JSONCfg.end())
     {
@@ -44,11 +47,27 @@ MacroLegalizer::MacroLegalizer(std::string legalizerName, PlacementInfo *placeme
     {
         nJobs = std::stoi(JSONCfg["jobs"]);
     }
+    minCostFlowEngine = MinCostBipartiteMatcher::getMinCostFlowEngine(JSONCfg);
+
+    if (JSONCfg.find("IncrementalLegalization") != JSONCfg.end())
+    {
+        incrementalLegalization = JSONCfg["IncrementalLegalization"] == "true";
+    }
+
+    if (JSONCfg.find("LegalizationDPBandWidth") != JSONCfg.end())
+    {
+        DPBandWidth = std::stoi(JSONCfg["LegalizationDPBandWidth"]);
+    }
 
     if (legalizerName.find("CARRY") != std::string::npos)
     {
         clockRegionAware = true;
     }
+
+    if (JSONCfg.find("DumpLegalizationInstance") != JSONCfg.end())
+    {
+        legalizationInstance = new LegalizationInstance(legalizerName);
+    }
 }
 
 void MacroLegalizer::legalize(bool exactLegalization, bool directLegalization)
@@ -80,33 +99,61 @@ void MacroLegalizer::legalize(bool exactLegalization, bool directLegalization)
     }
 
     setSitesMapped();
+
+    if (legalizationInstance && !legalizationInstance->empty())
+    {
+        std::string dumpFile = JSONCfg["DumpLegalizationInstance"] + "-" + legalizerName +
+                               std::to_string(DumpLegalizationInstanceCnt) + ".gz";
+        print_status("MacroLegalizer: dumping legalization instance to: " + dumpFile);
+        legalizationInstance->dump(dumpFile);
+        legalizationInstance->clear();
+        DumpLegalizationInstanceCnt++;
+    }
+
     if (verbose)
         print_status("MacroLegalizer[" + legalizerName + "] Finished Legalization.");
 }
 
 void MacroLegalizer::roughlyLegalize()
 {
+    if (incrementalLegalization)
+        roughIncrementalMatcher.startNewProblem();
+
     while (macroCellsToLegalize.size())
     {
         findMacroCell2SitesInDistance();
         findPossibleLegalLocation(false);
         resetMacroCell2SitesInDistance();
+        if (legalizationInstance)
+            recordMatchingProblem("rough");
 
-        createBipartiteGraph();
-        minCostBipartiteMatcher = new MinCostBipartiteMatcher(macro2Sites.size(), rightSiteIds.size(),
-                                                              macro2Sites.size(), adjList, nJobs, verbose);
-
-        minCostBipartiteMatcher->solve();
-        updateMatchingAndUnmatchedMacroCells();
+        if (incrementalLegalization)
+        {
+            addCandidatesToIncrementalMatcher(roughIncrementalMatcher);
+            solveIncrementalMatchingAndUpdateUnmatchedMacroCells(roughIncrementalMatcher);
+        }
+        else
+        {
+            createBipartiteGraph();
+            minCostBipartiteMatcher = new MinCostBipartiteMatcher(macro2Sites.size(), rightSiteIds.size(),
+                                                                  macro2Sites.size(), adjList, nJobs, verbose,
+                                                                  minCostFlowEngine);
+
+            minCostBipartiteMatcher->solve();
+            updateMatchingAndUnmatchedMacroCells();
+            delete minCostBipartiteMatcher;
+            minCostBipartiteMatcher = nullptr;
+        }
 
         displacementThreshold *= 2;
         if ((int)(maxNumCandidate * 2) > maxNumCandidate + 1)
             maxNumCandidate *= 2;
         else
             maxNumCandidate++;
-        delete minCostBipartiteMatcher;
-        minCostBipartiteMatcher = nullptr;
     }
+
+    if (incrementalLegalization)
+        commitIncrementalMatching(roughIncrementalMatcher);
 }
 
 void MacroLegalizer::fixedColumnLegalize(bool directLegalization)
@@ -115,18 +162,31 @@ void MacroLegalizer::fixedColumnLegalize(bool directLegalization)
     resolveOverflowColumns();
 
     macroCellsToLegalize = initialMacrosToLegalize;
+    if (incrementalLegalization)
+        fixedColumnIncrementalMatcher.startNewProblem();
 
     while (macroCellsToLegalize.size())
     {
-        findMacroCell2SitesInDistance();
         findPossibleLegalLocation(true);
-        resetMacroCell2SitesInDistance();
-        createBipartiteGraph();
-        minCostBipartiteMatcher = new MinCostBipartiteMatcher(macro2Sites.size(), rightSiteIds.size(),
-                                                              macro2Sites.size(), adjList, nJobs, verbose);
-
-        minCostBipartiteMatcher->solve();
-        updateMatchingAndUnmatchedMacroCells();
+        if (legalizationInstance)
+            recordMatchingProblem("fixedColumn");
+        if (incrementalLegalization)
+        {
+            addCandidatesToIncrementalMatcher(fixedColumnIncrementalMatcher);
+            solveIncrementalMatchingAndUpdateUnmatchedMacroCells(fixedColumnIncrementalMatcher);
+        }
+        else
+        {
+            createBipartiteGraph();
+            minCostBipartiteMatcher = new MinCostBipartiteMatcher(macro2Sites.size(), rightSiteIds.size(),
+                                                                  macro2Sites.size(), adjList, nJobs, verbose,
+                                                                  minCostFlowEngine);
+
+            minCostBipartiteMatcher->solve();
+            updateMatchingAndUnmatchedMacroCells();
+            delete minCostBipartiteMatcher;
+            minCostBipartiteMatcher = nullptr;
+        }
 
         displacementThreshold *= 2;
         maxNumCandidate *= 2;
@@ -135,10 +195,10 @@ void MacroLegalizer::fixedColumnLegalize(bool directLegalization)
             maxNumCandidate *= 2;
         else
             maxNumCandidate++;
-
-        delete minCostBipartiteMatcher;
-        minCostBipartiteMatcher = nullptr;
     }
+
+    if (incrementalLegalization)
+        commitIncrementalMatching(fixedColumnIncrementalMatcher);
 }
 
 void MacroLegalizer::finalLegalizeBasedOnDP()
@@ -150,9 +210,9 @@ void MacroLegalizer::finalLegalizeBasedOnDP()
     float tmpAverageDisplacement = 0.0;
     if (verbose)
         print_status("MacroLegalizer[" + legalizerName + "] Start finalLegalizeBasedOnDP");
-    tmpAverageDisplacement += DPForMinHPWL(BRAMColumnNum, BRAMColumn2Sites, BRAMColumn2PUs);
-    tmpAverageDisplacement += DPForMinHPWL(DSPColumnNum, DSPColumn2Sites, DSPColumn2PUs);
-    tmpAverageDisplacement += DPForMinHPWL(CARRYColumnNum, CARRYColumn2Sites, CARRYColumn2PUs);
+    tmpAverageDisplacement += DPForMinHPWL(BRAMColumnNum, BRAMColumn2Sites, BRAMColumn2PUs, "BRAM");
+    tmpAverageDisplacement += DPForMinHPWL(DSPColumnNum, DSPColumn2Sites, DSPColumn2PUs, "DSP");
+    tmpAverageDisplacement += DPForMinHPWL(CARRYColumnNum, CARRYColumn2Sites, CARRYColumn2PUs, "CARRY");
     finalAverageDisplacement = tmpAverageDisplacement / PU2X.size();
     if (verbose)
         print_status("MacroLegalizer[" + legalizerName +
@@ -164,32 +224,20 @@ void MacroLegalizer::finalLegalizeBasedOnDP()
 }
 
 float MacroLegalizer::DPForMinHPWL(int colNum, std::vector<std::vector<DeviceInfo::DeviceSite *>> &Column2Sites,
-                                   std::vector<std::deque<PlacementInfo::PlacementUnit *>> &Column2PUs)
+                                   std::vector<std::deque<PlacementInfo::PlacementUnit *>> &Column2PUs,
+                                   const std::string &columnType)
 {
     // final Legalization DP
     // i th macro (start from 0), j th row (start from 0)
     // f[i][j] = min(f[i-1][j-row[i]]+HPWLChange[i][j-row[i]+1],f[i][j-1])
-
-    // std::string dumpFile =
-    //     JSONCfg["DumpMacroLegalization"] + "-Exact-" + std::to_string(DumpMacroLegalizationCnt) + ".gz";
-
-    // print_status("MacroLegalizer: dumping MacroLegalization archieve to: " + dumpFile);
-    // DumpMacroLegalizationCnt++;
-    // std::stringstream outfile0;
+    // the DP is solved by BandedColumnDP within a band around the macros' locations, and solved again without the band
+    // if no solution is found in the band.
 
     float tmpTotalDisplacement = 0.0;
-    std::map<PlacementInfo::PlacementUnit *, std::vector<DeviceInfo::DeviceSite *>> PU2Sites;
-    PU2Sites.clear();
-    for (auto &PUDeque : Column2PUs)
-    {
-        for (auto tmpPU : PUDeque)
-        {
-            assert(PU2Sites.find(tmpPU) == PU2Sites.end());
-            PU2Sites[tmpPU] = std::vector<DeviceInfo::DeviceSite *>();
-        }
-    }
+    std::vector<std::vector<int>> column2PUBottomSiteIds(colNum);
+    std::vector<LegalizationInstance::ColumnDPProblem> column2DPProblem(legalizationInstance ? colNum : 0);
 
-#pragma omp parallel for
+#pragma omp parallel for schedule(dynamic, 1)
     for (int c = 0; c < colNum; c++)
     {
         int numPUs = Column2PUs[c].size();
@@ -201,130 +249,83 @@ float MacroLegalizer::DPForMinHPWL(int colNum, std::vector<std::vector<DeviceInf
 
         sortSitesBySiteY(curColSites);
 
-        // initialize
-
-        std::vector<std::vector<float>> f(numPUs, std::vector<float>(curColSites.size(), 1000000000.0));
-        std::vector<std::vector<bool>> fChoice(
-            numPUs, std::vector<bool>(curColSites.size(), 0)); // used for tracing back macro-site mapping
-
-        int minLastPUTop = -1;
+        int numSites = curColSites.size();
+        std::vector<int> siteYs(numSites);
+        std::vector<float> siteLocYs(numSites);
+        for (int j = 0; j < numSites; j++)
+        {
+            siteYs[j] = curColSites[j]->getSiteY();
+            siteLocYs[j] = curColSites[j]->Y();
+        }
 
-        int totalMacroCellNum = 0;
-        int heightPURow = getMarcroCellNum(curColPU[0]);
-        totalMacroCellNum += heightPURow;
-        float minHPWLChange = 1100000000.0;
-        for (unsigned int j = totalMacroCellNum - 1; j < curColSites.size(); j++)
+        std::vector<int> PUHeights(numPUs), PUTargetSiteIds(numPUs);
+        std::vector<unsigned char> evenSiteYRequired(numPUs, 0);
+        for (int i = 0; i < numPUs; i++)
         {
-            float curHPWLChange = getHPWLChange(curColPU[0], curColSites[j - heightPURow + 1]);
-            if (curColSites[j]->getSiteY() - curColSites[j - heightPURow + 1]->getSiteY() != heightPURow - 1)
+            PUHeights[i] = getMarcroCellNum(curColPU[i]);
+            PUTargetSiteIds[i] =
+                std::lower_bound(siteLocYs.begin(), siteLocYs.end(), curColPU[i]->Y()) - siteLocYs.begin();
+            if (auto curMacro = PlacementInfo::asMacro(curColPU[i]))
             {
-                // we need to ensure that there is no occpupied sites in this range
-                curHPWLChange = 1100000000.0;
+                // we need to ensure BRAM macros starts from site with even siteY
+                evenSiteYRequired[i] =
+                    curMacro->getMacroType() == PlacementInfo::PlacementMacro::PlacementMacroType_BRAM &&
+                    curMacro->getCells().size() > 1;
             }
-            if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curColPU[0]))
-            {
-                if (curMacro->getMacroType() == PlacementInfo::PlacementMacro::PlacementMacroType_BRAM)
-                {
-                    // we need to ensure BRAM macros starts from site with even siteY
-                    if (curMacro->getCells().size() > 1 && curColSites[j - heightPURow + 1]->getSiteY() % 2 != 0)
-                    {
-                        curHPWLChange = 1100000000.0;
-                    }
-                }
-            }
-            if (curHPWLChange < minHPWLChange)
-            {
-                minHPWLChange = curHPWLChange;
-                fChoice[0][j] = 1;
-                if (numPUs == 1)
-                {
-                    minLastPUTop = j;
-                }
-            }
-            f[0][j] = minHPWLChange;
         }
 
-        // DP to minimize HPWL
-        for (int i = 1; i < numPUs; i++)
+        BandedColumnDP columnDP;
+        std::vector<int> &PUBottomSiteIds = column2PUBottomSiteIds[c];
+        bool solved = false;
+        for (int bandWidth : {DPBandWidth, -1})
         {
-            float minVal = 100000000.0;
-            int heightPURow = getMarcroCellNum(curColPU[i]);
-            totalMacroCellNum += heightPURow;
-            for (unsigned int j = totalMacroCellNum - 1; j < curColSites.size();
-                 j++) // j start from heightPURow because PU0 must occupy 1+ site(s)
+            columnDP.setColumn(numSites, PUHeights, PUTargetSiteIds, bandWidth);
+            for (int i = 0; i < numPUs; i++)
             {
-                float curHPWLChange = getHPWLChange(curColPU[i], curColSites[j - heightPURow + 1]);
-                if (curColSites[j]->getSiteY() - curColSites[j - heightPURow + 1]->getSiteY() != heightPURow - 1)
+                int heightPURow = PUHeights[i];
+                for (int j = columnDP.getBandLow(i); j <= columnDP.getBandHigh(i); j++)
                 {
+                    int bottomSiteId = j - heightPURow + 1;
                     // we need to ensure that there is no occpupied sites in this range
-                    curHPWLChange = 1100000000.0;
-                }
-                if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curColPU[i]))
-                {
-                    if (curMacro->getMacroType() == PlacementInfo::PlacementMacro::PlacementMacroType_BRAM)
-                    {
-                        // we need to ensure BRAM macros starts from site with even siteY
-                        if (curMacro->getCells().size() > 1 && curColSites[j - heightPURow + 1]->getSiteY() % 2 != 0)
-                        {
-                            curHPWLChange = 1100000000.0;
-                        }
-                    }
-                }
-                if (f[i][j - 1] > f[i - 1][j - heightPURow] + curHPWLChange)
-                {
-                    fChoice[i][j] = 1;
-                    if (i == numPUs - 1)
-                    {
-                        if (f[i - 1][j - heightPURow] + curHPWLChange < minVal)
-                        {
-                            minVal = f[i - 1][j - heightPURow] + curHPWLChange;
-                            minLastPUTop = j;
-                        }
-                    }
+                    if (siteYs[j] - siteYs[bottomSiteId] != heightPURow - 1)
+                        continue;
+                    if (evenSiteYRequired[i] && siteYs[bottomSiteId] % 2 != 0)
+                        continue;
+                    columnDP.setCost(i, j, getHPWLChange(curColPU[i], curColSites[bottomSiteId]));
                 }
-
-                f[i][j] = std::min(f[i][j - 1], f[i - 1][j - heightPURow] + curHPWLChange);
-            }
-        }
-
-        assert(minLastPUTop >= 0);
-
-        std::vector<DeviceInfo::DeviceSite *> PUBottom2Site_reverse(0);
-
-        for (int i = numPUs - 1; i >= 0; i--)
-        {
-            assert(minLastPUTop >= 0);
-            int heightPURow = getMarcroCellNum(curColPU[i]);
-            while (!fChoice[i][minLastPUTop])
-            {
-                minLastPUTop--;
-                assert(minLastPUTop >= 0);
             }
-            auto curSite = curColSites[minLastPUTop - heightPURow + 1];
-            assert(PU2Sites[curColPU[i]].size() == 0);
-            assert(curSite);
-            for (int curColSiteId = minLastPUTop - heightPURow + 1; curColSiteId <= minLastPUTop; curColSiteId++)
+            solved = columnDP.solve(PUBottomSiteIds);
+            if (solved || bandWidth < 0)
             {
-                PU2Sites[curColPU[i]].push_back(curColSites[curColSiteId]);
+                if (legalizationInstance)
+                    LegalizationInstance::fillColumnDPProblem(column2DPProblem[c], columnType, c, curColSites,
+                                                              curColPU, PUHeights, PUTargetSiteIds, bandWidth,
+                                                              columnDP);
+                break;
             }
-            minLastPUTop -= heightPURow;
-            // outfile0 << "col#" << c << ": " << curColPU[i]->getName() << " PUY:" << PU2Y[curColPU[i]]
-            //          << " numPUs:" << getMarcroCellNum(curColPU[i])
-            //          << " netNum:" << curColPU[i]->getNetsSetPtr()->size() << "\n";
-            // outfile0 << "    macthed with: " << curSite->getName() << " locX:" << curSite->X()
-            //          << " locY:" << curSite->Y() << " HPWLIncrease:" << getHPWLChange(curColPU[i], curSite) << "\n";
         }
+        assert(solved);
     }
-    // writeStrToGZip(dumpFile, outfile0);
-    // print_status("dumped MacroLegalization archieve to: " + dumpFile);
-    for (auto &PUDeque : Column2PUs)
+
+    for (auto &curProblem : column2DPProblem)
+    {
+        if (curProblem.PUHeights.size())
+            legalizationInstance->addColumnDPProblem(curProblem);
+    }
+
+    for (int c = 0; c < colNum; c++)
     {
-        for (auto tmpPU : PUDeque)
+        auto &curColSites = Column2Sites[c];
+        auto &curColPU = Column2PUs[c];
+        for (unsigned int i = 0; i < curColPU.size(); i++)
         {
-            assert(PU2Sites.find(tmpPU) != PU2Sites.end());
-            auto &curSites = PU2Sites[tmpPU];
-            assert(curSites.size());
+            auto tmpPU = curColPU[i];
+            int bottomSiteId = column2PUBottomSiteIds[c][i];
+            assert(bottomSiteId >= 0);
             assert(PU2X.find(tmpPU) == PU2X.end());
+            std::vector<DeviceInfo::DeviceSite *> curSites(curColSites.begin() + bottomSiteId,
+                                                           curColSites.begin() + bottomSiteId +
+                                                               getMarcroCellNum(tmpPU));
             auto curSite = curSites[0];
             PU2LegalSites[tmpPU] = curSites;
             PU2X[tmpPU] = curSite->X();
@@ -372,6 +373,26 @@ void MacroLegalizer::getMacrosToLegalize()
         }
     }
     initialMacrosToLegalize = macroCellsToLegalize;
+    HPWLEvaluator->reset(macroUnitsToLegalizeSet);
+
+    macro2LegalizedCellOffsetYSpan.clear();
+    for (auto curPU : macroUnitsToLegalizeSet)
+    {
+        auto curMacro = PlacementInfo::asMacro(curPU);
+        if (!curMacro)
+            continue;
+        float minOffsetY = std::numeric_limits<float>::max();
+        float maxOffsetY = std::numeric_limits<float>::lowest();
+        for (auto curCell : curMacro->getCells())
+        {
+            if (std::find(macroTypesToLegalize.begin(), macroTypesToLegalize.end(), curCell->getCellType()) ==
+                macroTypesToLegalize.end())
+                continue;
+            minOffsetY = std::min(minOffsetY, curMacro->getCellOffsetYInMacro(curCell));
+            maxOffsetY = std::max(maxOffsetY, curMacro->getCellOffsetYInMacro(curCell));
+        }
+        macro2LegalizedCellOffsetYSpan[curPU] = std::pair<float, float>(minOffsetY, maxOffsetY);
+    }
 }
 
 void MacroLegalizer::findMacroType2AvailableSites()
@@ -388,7 +409,7 @@ void MacroLegalizer::findMacroType2AvailableSites()
             std::vector<DeviceInfo::DeviceSite *> &sitesInType = deviceInfo->getSitesInType(targetSiteType);
             for (auto curSite : sitesInType)
             {
-                if (!curSite->isOccupied() && !curSite->isMapped())
+                if (curSite->isAvailable())
                 {
                     // if (matchedSites.find(curSite) == matchedSites.end())
                     // {
@@ -507,6 +528,37 @@ void MacroLegalizer::findMacroType2AvailableSites()
             }
         }
     }
+
+    siteSpatialIndex->clear();
+    macroType2SiteGroupId.clear();
+    for (auto curCellType : macroTypesToLegalize)
+    {
+        macroType2SiteGroupId[curCellType] = siteSpatialIndex->addSiteGroup(macroType2Sites[curCellType]);
+    }
+    BRAMColumn2SiteGroupId.clear();
+    if (enableBRAMLegalization)
+        buildColumnSiteGroups(BRAMColumn2Sites, BRAMColumn2SiteGroupId);
+    DSPColumn2SiteGroupId.clear();
+    if (enableDSPLegalization)
+        buildColumnSiteGroups(DSPColumn2Sites, DSPColumn2SiteGroupId);
+    CARRYColumn2SiteGroupId.clear();
+    if (enableCARRYLegalization)
+        buildColumnSiteGroups(CARRYColumn2Sites, CARRYColumn2SiteGroupId);
+
+    if (enableBRAMLegalization)
+        BRAMColumnAssigner.setColumns(BRAMColumnXs, BRAMColumn2Sites);
+    if (enableDSPLegalization)
+        DSPColumnAssigner.setColumns(DSPColumnXs, DSPColumn2Sites);
+    if (enableCARRYLegalization)
+        CARRYColumnAssigner.setColumns(CARRYColumnXs, CARRYColumn2Sites);
+}
+
+void MacroLegalizer::buildColumnSiteGroups(std::vector<std::vector<DeviceInfo::DeviceSite *>> &column2Sites,
+                                           std::vector<int> &column2SiteGroupId)
+{
+    column2SiteGroupId.resize(column2Sites.size());
+    for (unsigned int colId = 0; colId < column2Sites.size(); colId++)
+        column2SiteGroupId[colId] = siteSpatialIndex->addSiteGroup(column2Sites[colId]);
 }
 
 void MacroLegalizer::findPossibleLegalLocation(bool fixedColumn)
@@ -532,53 +584,54 @@ void MacroLegalizer::findPossibleLegalLocation(bool fixedColumn)
         auto curCellType = curCell->getCellType();
         assert(macroType2Sites.find(curCellType) != macroType2Sites.end());
 
+        auto isCandidateSite = [&](DeviceInfo::DeviceSite *curSite) -> bool {
+            // since the cell in a macro, we need to ensure the other parts of the macro can be legalized if the
+            // cell is placed to the site
+            if (!isMacroSpanAvailable(curCell, curSite) && displacementThreshold <= 2 * initialDisplacementThreshold)
+                return false;
+            if ((curCellType == DesignInfo::CellType_RAMB36E2 || curCellType == DesignInfo::CellType_FIFO36E2) &&
+                curSite->getSiteY() % 2 != 0)
+                return false;
+            if ((curCellType == DesignInfo::CellType_RAMB18E2 || curCellType == DesignInfo::CellType_FIFO18E2) &&
+                curCell->isVirtualCell() && curSite->getSiteY() % 2 != 1)
+                return false;
+            return true;
+        };
+
+        // the candidates from the spatial index are within the displacement threshold and not binded yet
+        std::vector<DeviceInfo::DeviceSite *> columnCandidateSites;
         std::vector<DeviceInfo::DeviceSite *> *candidateSite = nullptr;
         if (fixedColumn)
         {
             int targetSiteX = -1;
+            std::vector<int> *column2SiteGroupId = nullptr;
             if (curCell->isDSP())
             {
-                assert(DSPCell2Column.find(curCell) != DSPCell2Column.end());
-                targetSiteX = DSPCell2Column[curCell];
+                assert(curCell->getCellId() < (int)DSPCell2Column.size());
+                targetSiteX = DSPCell2Column[curCell->getCellId()];
+                column2SiteGroupId = &DSPColumn2SiteGroupId;
             }
             if (curCell->isCarry())
             {
-                assert(CARRYCell2Column.find(curCell) != CARRYCell2Column.end());
-                targetSiteX = CARRYCell2Column[curCell];
+                assert(curCell->getCellId() < (int)CARRYCell2Column.size());
+                targetSiteX = CARRYCell2Column[curCell->getCellId()];
+                column2SiteGroupId = &CARRYColumn2SiteGroupId;
             }
             if (curCell->isBRAM())
             {
-                assert(BRAMCell2Column.find(curCell) != BRAMCell2Column.end());
-                targetSiteX = BRAMCell2Column[curCell];
-            }
-            assert(targetSiteX >= 0);
-
-            std::vector<std::vector<DeviceInfo::DeviceSite *>> *column2Sites;
-            if (DesignInfo::isCarry(curCellType))
-            {
-                column2Sites = &CARRYColumn2Sites;
-            }
-            else if (DesignInfo::isDSP(curCellType))
-            {
-                column2Sites = &DSPColumn2Sites;
-            }
-            else if (DesignInfo::isBRAM(curCellType))
-            {
-                column2Sites = &BRAMColumn2Sites;
-            }
-            else
-            {
-                assert(false && "undefine type");
-            }
-            for (auto &tmpCol : *column2Sites)
-            {
-                if (tmpCol.size() == 0)
-                    continue;
-                if (tmpCol[0]->getSiteX() == targetSiteX)
-                {
-                    candidateSite = &tmpCol;
-                }
+                assert(curCell->getCellId() < (int)BRAMCell2Column.size());
+                targetSiteX = BRAMCell2Column[curCell->getCellId()];
+                column2SiteGroupId = &BRAMColumn2SiteGroupId;
             }
+            assert(column2SiteGroupId && "undefine type");
+            assert(targetSiteX >= 0 && (unsigned int)targetSiteX < column2SiteGroupId->size());
+
+            // the columns are indexed by the SiteX of their sites. The sites are filtered in the query, so enough
+            // valid candidates are found for the HPWL ranking below.
+            siteSpatialIndex->findNearestFreeSites(
+                (*column2SiteGroupId)[targetSiteX], cellLoc[curCell->getCellId()].X, cellLoc[curCell->getCellId()].Y,
+                2 * displacementThreshold, candidateFactor * maxNumCandidate, columnCandidateSites, isCandidateSite);
+            candidateSite = &columnCandidateSites;
         }
         else
         {
@@ -589,30 +642,8 @@ void MacroLegalizer::findPossibleLegalLocation(bool fixedColumn)
 
         for (auto curSite : *candidateSite)
         {
-            float curDisp = getDisplacement(cellLoc[curCell->getCellId()], curSite);
-            if ((!fixedColumn && curDisp < displacementThreshold) ||
-                (fixedColumn && curDisp < 2 * displacementThreshold))
-            {
-                // since the cell in a macro, we need to ensure the other parts of the macro can be legalized if the
-                // cell is placed to the site
-                if (placementInfo->isLegalLocation(curCell, curSite->X(), curSite->Y()) ||
-                    displacementThreshold > 2 * initialDisplacementThreshold)
-                {
-                    if (matchedSites.find(curSite) != matchedSites.end())
-                        continue;
-
-                    if ((curCellType == DesignInfo::CellType_RAMB36E2 ||
-                         curCellType == DesignInfo::CellType_FIFO36E2) &&
-                        curSite->getSiteY() % 2 != 0)
-                        continue;
-                    if ((curCellType == DesignInfo::CellType_RAMB18E2 ||
-                         curCellType == DesignInfo::CellType_FIFO18E2) &&
-                        curCell->isVirtualCell() && curSite->getSiteY() % 2 != 1)
-                        continue;
-
-                    macro2Sites[curCell].push_back(curSite);
-                }
-            }
+            if (fixedColumn || isCandidateSite(curSite))
+                macro2Sites[curCell].push_back(curSite);
         }
         if (macro2Sites[curCell].size() > 1)
             quick_sort_WLChange(curCell, macro2Sites[curCell], 0, macro2Sites[curCell].size() - 1,
@@ -625,6 +656,19 @@ void MacroLegalizer::findPossibleLegalLocation(bool fixedColumn)
     // print_info("#total macro candidate site (might be duplicated) = " + std::to_string(totalSiteNum));
 }
 
+bool MacroLegalizer::isMacroSpanAvailable(DesignInfo::DesignCell *curCell, DeviceInfo::DeviceSite *curSite)
+{
+    auto curPU = placementInfo->getPlacementUnitByCell(curCell);
+    auto spanIt = macro2LegalizedCellOffsetYSpan.find(curPU);
+    auto occupancyColumn = curSite->getOccupancyColumn();
+    if (spanIt == macro2LegalizedCellOffsetYSpan.end() || !occupancyColumn)
+        return placementInfo->isLegalLocation(curCell, curSite->X(), curSite->Y());
+    auto curMacro = PlacementInfo::asMacro(curPU);
+    assert(curMacro);
+    float anchorY = curSite->Y() - curMacro->getCellOffsetYInMacro(curCell);
+    return occupancyColumn->isSpanAvailable(anchorY + spanIt->second.first, anchorY + spanIt->second.second);
+}
+
 void MacroLegalizer::createBipartiteGraph()
 {
     rightSiteIds.clear();
@@ -669,6 +713,21 @@ void MacroLegalizer::createBipartiteGraph()
     }
 }
 
+void MacroLegalizer::recordMatchingProblem(const std::string &phase)
+{
+    assert(legalizationInstance);
+    createBipartiteGraph();
+    std::vector<std::vector<float>> displacements(adjList.size());
+    for (unsigned int leftCellId = 0; leftCellId < adjList.size(); leftCellId++)
+    {
+        auto curCell = macroCellsToLegalize[leftCellId];
+        for (auto &rightNodeAndCost : adjList[leftCellId])
+            displacements[leftCellId].push_back(
+                getDisplacement(cellLoc[curCell->getCellId()], siteList[rightNodeAndCost.first]));
+    }
+    legalizationInstance->addMatchingProblem(phase, siteList.size(), adjList, displacements);
+}
+
 void MacroLegalizer::updateMatchingAndUnmatchedMacroCells()
 {
 
@@ -679,9 +738,9 @@ void MacroLegalizer::updateMatchingAndUnmatchedMacroCells()
         if (rightNode >= 0)
         {
             assert(matchedMacroCells.find(curCell) == matchedMacroCells.end());
-            assert(matchedSites.find(siteList[rightNode]) == matchedSites.end());
+            assert(!siteSpatialIndex->isSiteMatched(siteList[rightNode]));
             matchedMacroCells.insert(curCell);
-            matchedSites.insert(siteList[rightNode]);
+            siteSpatialIndex->setSiteMatched(siteList[rightNode], true);
             cellLevelMatching.emplace_back(curCell, siteList[rightNode]);
         }
     }
@@ -698,6 +757,56 @@ void MacroLegalizer::updateMatchingAndUnmatchedMacroCells()
     macroCellsToLegalize = newMacrosToLegalize;
 }
 
+void MacroLegalizer::addCandidatesToIncrementalMatcher(IncrementalMacroMatcher &matcher)
+{
+    // the costs are not compensated to be positive since SSPMinCostFlow handles the negative costs, so the costs of
+    // the edges added in different rounds are consistent
+    for (auto curCell : macroCellsToLegalize)
+    {
+        int leftId = matcher.addLeftNode(curCell);
+        for (auto curSite : macro2Sites[curCell])
+        {
+            int rightId = matcher.addRightNode(curSite);
+            if (matcher.hasEdge(leftId, rightId))
+                continue;
+            matcher.addEdge(leftId, rightId, getHPWLChange(curCell, curSite));
+        }
+    }
+}
+
+void MacroLegalizer::solveIncrementalMatchingAndUpdateUnmatchedMacroCells(IncrementalMacroMatcher &matcher)
+{
+    matcher.solve(nJobs);
+    if (verbose)
+        print_info("MacroLegalizer[" + legalizerName + "] incremental matching is warm-started with " +
+                   std::to_string(matcher.getNumWarmStartPairs()) + " pairs");
+
+    std::vector<DesignInfo::DesignCell *> newMacrosToLegalize;
+    newMacrosToLegalize.clear();
+    for (int leftId = 0; leftId < matcher.getNumLeftNodes(); leftId++)
+    {
+        if (matcher.getMatchedRightNode(leftId) < 0)
+            newMacrosToLegalize.push_back(matcher.getLeftKey(leftId));
+    }
+    macroCellsToLegalize = newMacrosToLegalize;
+}
+
+void MacroLegalizer::commitIncrementalMatching(IncrementalMacroMatcher &matcher)
+{
+    for (int leftId = 0; leftId < matcher.getNumLeftNodes(); leftId++)
+    {
+        int rightNode = matcher.getMatchedRightNode(leftId);
+        assert(rightNode >= 0);
+        auto curCell = matcher.getLeftKey(leftId);
+        auto curSite = matcher.getRightKey(rightNode);
+        assert(matchedMacroCells.find(curCell) == matchedMacroCells.end());
+        assert(!siteSpatialIndex->isSiteMatched(curSite));
+        matchedMacroCells.insert(curCell);
+        siteSpatialIndex->setSiteMatched(curSite, true);
+        cellLevelMatching.emplace_back(curCell, curSite);
+    }
+}
+
 void MacroLegalizer::dumpMatching(bool fixedColumn, bool enforce)
 {
     if (JSONCfg.find("DumpMacroLegalization") != JSONCfg.end() || enforce)
@@ -954,123 +1063,29 @@ void MacroLegalizer::updatePUMatchingLocation(bool isRoughLegalization, bool upd
     placementInfo->setPULegalXY(PU2X, PU2Y);
 }
 
-void MacroLegalizer::spreadMacros(int columnNum, std::vector<int> &columnUntilization,
-                                  std::vector<std::vector<DeviceInfo::DeviceSite *>> &column2Sites,
+void MacroLegalizer::spreadMacros(ColumnAssigner &columnAssigner, std::vector<int> &columnUntilization,
                                   std::vector<std::deque<PlacementInfo::PlacementUnit *>> &column2PUs,
-                                  std::map<DesignInfo::DesignCell *, int> &cell2Column, float budgeRatio)
+                                  std::vector<int> &cell2Column, const std::string &familyName, float budgeRatio)
 {
-    while (true)
-    {
-        int overflowColId = -1;
-        std::vector<int> accumulationUtil(columnNum, 0), accumulationCapacity(columnNum, 0);
-        accumulationUtil[0] = columnUntilization[0];
-        accumulationCapacity[0] = column2Sites[0].size() * budgeRatio;
-        for (int colId = 1; colId < columnNum; colId++)
-        {
-            accumulationUtil[colId] = accumulationUtil[colId - 1] + columnUntilization[colId];
-            accumulationCapacity[colId] = accumulationCapacity[colId - 1] + column2Sites[colId].size() * budgeRatio;
-        }
+    columnAssigner.spreadOverflowColumns(
+        columnUntilization, column2PUs, budgeRatio,
+        [this](PlacementInfo::PlacementUnit *curPU) -> int { return getMarcroCellNum(curPU); }, true, familyName);
 
-        for (int colId = 0; colId < columnNum; colId++)
-        {
-            if (budgeRatio == 1)
-            {
-                if (column2Sites[colId].size() < (unsigned int)columnUntilization[colId])
-                {
-                    overflowColId = colId;
-                    break;
-                }
-            }
-            else
-            {
-                if (column2Sites[colId].size() * (budgeRatio + 0.05) < (unsigned int)columnUntilization[colId])
-                {
-                    overflowColId = colId;
-                    break;
-                }
-            }
-        }
-        if (overflowColId < 0)
-        {
-            break;
-        }
-        else
-        {
-            print_warning("column overflow resolving");
-            for (int colId = 0; colId < columnNum; colId++)
-            {
-                std::cout << " colId#" << colId << " columnUntilization:" << columnUntilization[colId] << " "
-                          << " siteCap:" << column2Sites[colId].size() << "\n";
-            }
-            int leftAvaliableCapacity = 0;
-            int rightAvaliableCapacity = 0;
-            int leftUtil = 0;
-            int rightUtil = 0;
-
-            if (overflowColId > 0)
-            {
-                leftAvaliableCapacity += accumulationCapacity[overflowColId - 1];
-                leftUtil += accumulationUtil[overflowColId - 1];
-            }
-            if (overflowColId < columnNum - 1)
-            {
-                rightAvaliableCapacity += accumulationCapacity[columnNum - 1] - accumulationCapacity[overflowColId];
-                rightUtil += accumulationUtil[columnNum - 1] - accumulationUtil[overflowColId];
-            }
-
-            int overflowNum = (unsigned int)columnUntilization[overflowColId] -
-                              column2Sites[overflowColId].size() * budgeRatio; // spread more for redundant space
-            int toLeft = 0;
-
-            int totalAvailableCapacity = rightAvaliableCapacity + leftAvaliableCapacity - leftUtil - rightUtil;
-            assert(totalAvailableCapacity > 0);
-            float toLeftRatio = (float)(leftAvaliableCapacity - leftUtil) / totalAvailableCapacity;
-            int toLeftNum = int((overflowNum * toLeftRatio) + 0.4999);
-            int toRightNum = overflowNum - toLeft;
-
-            if (leftAvaliableCapacity - leftUtil > 0)
-            {
-                while (toLeftNum > 0 && column2PUs[overflowColId].size() > 0)
-                {
-                    column2PUs[overflowColId - 1].push_back(column2PUs[overflowColId][0]);
-                    int macroSize = getMarcroCellNum(column2PUs[overflowColId][0]);
-                    columnUntilization[overflowColId - 1] += macroSize;
-                    columnUntilization[overflowColId] -= macroSize;
-                    toLeftNum -= macroSize;
-                    column2PUs[overflowColId].pop_front();
-                }
-            }
-            if (rightAvaliableCapacity - rightUtil > 0)
-            {
-                while (toRightNum > 0 && column2PUs[overflowColId].size() > 0)
-                {
-                    column2PUs[overflowColId + 1].push_front(
-                        column2PUs[overflowColId][column2PUs[overflowColId].size() - 1]);
-                    int macroSize = getMarcroCellNum(column2PUs[overflowColId][column2PUs[overflowColId].size() - 1]);
-                    columnUntilization[overflowColId + 1] += macroSize;
-                    columnUntilization[overflowColId] -= macroSize;
-                    toRightNum -= macroSize;
-                    column2PUs[overflowColId].pop_back();
-                }
-            }
-        }
-    }
-    cell2Column.clear();
+    cell2Column.assign(placementInfo->getCells().size(), -1);
     for (unsigned int colId = 0; colId < column2PUs.size(); colId++)
     {
-        auto PUs = column2PUs[colId];
-        for (auto curPU : PUs)
+        for (auto curPU : column2PUs[colId])
         {
             if (auto unpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU))
             {
                 auto curCell = unpackedCell->getCell();
-                cell2Column[curCell] = colId;
+                cell2Column[curCell->getCellId()] = colId;
             }
             else if (auto macroPU = dynamic_cast<PlacementInfo::PlacementMacro *>(curPU))
             {
                 for (auto curCell : macroPU->getCells())
                 {
-                    cell2Column[curCell] = colId;
+                    cell2Column[curCell->getCellId()] = colId;
                 }
             }
         }
@@ -1079,168 +1094,79 @@ void MacroLegalizer::spreadMacros(int columnNum, std::vector<int> &columnUntiliz
 
 void MacroLegalizer::resolveOverflowColumns()
 {
-    if (enableBRAMLegalization)
-    {
-        spreadMacros(BRAMColumnNum, BRAMColumnUntilization, BRAMColumn2Sites, BRAMColumn2PUs, BRAMCell2Column, 0.9);
-    }
-    if (enableDSPLegalization)
-    {
-        spreadMacros(DSPColumnNum, DSPColumnUntilization, DSPColumn2Sites, DSPColumn2PUs, DSPCell2Column);
-    }
-    if (enableCARRYLegalization)
-    {
-        spreadMacros(CARRYColumnNum, CARRYColumnUntilization, CARRYColumn2Sites, CARRYColumn2PUs, CARRYCell2Column,
-                     0.9);
-    }
-}
-
-int MacroLegalizer::findIdMaxWithRecurence(int minId, int maxId, std::vector<int> &ids)
-{
-    int resId = -1;
-    int maxRecurence = 0;
-    assert(ids.size() > 0);
-    for (int i = minId; i <= maxId; i++)
+    // the types have their own columns so they can be spread concurrently
+#pragma omp parallel sections
     {
-        int cnt = 0;
-        for (auto id : ids)
+#pragma omp section
         {
-            if (id == i)
-                cnt++;
+            if (enableBRAMLegalization)
+                spreadMacros(BRAMColumnAssigner, BRAMColumnUntilization, BRAMColumn2PUs, BRAMCell2Column, "BRAM",
+                             0.9);
         }
-        if (cnt > maxRecurence)
+#pragma omp section
         {
-            resId = i;
-            maxRecurence = cnt;
+            if (enableDSPLegalization)
+                spreadMacros(DSPColumnAssigner, DSPColumnUntilization, DSPColumn2PUs, DSPCell2Column, "DSP");
         }
-    }
-    assert(resId >= 0);
-    return resId;
-}
-
-int MacroLegalizer::findCorrespondingColumn(float curX, std::vector<float> &Xs)
-{
-    int resId = -1;
-    float closeDiff = 100000000;
-
-    for (unsigned int i = 0; i < Xs.size(); i++)
-    {
-        if (std::fabs(curX - Xs[i]) < closeDiff)
+#pragma omp section
         {
-            closeDiff = std::fabs(curX - Xs[i]);
-            resId = i;
+            if (enableCARRYLegalization)
+                spreadMacros(CARRYColumnAssigner, CARRYColumnUntilization, CARRYColumn2PUs, CARRYCell2Column, "CARRY",
+                             0.9);
         }
     }
-
-    assert(resId >= 0);
-    return resId;
 }
 
-void MacroLegalizer::mapMacrosToColumns(bool directLegalization)
+void MacroLegalizer::mapMacrosToColumnsOfType(bool directLegalization, std::set<PlacementInfo::PlacementUnit *> &PUs,
+                                              ColumnAssigner &columnAssigner,
+                                              std::vector<std::deque<PlacementInfo::PlacementUnit *>> &column2PUs,
+                                              std::vector<int> &columnUntilization)
 {
-    BRAMColumn2PUs.clear();
-    BRAMColumnUntilization.clear();
-    if (BRAMColumnNum > 0)
-    {
-        BRAMColumn2PUs.resize(BRAMColumnNum, std::deque<PlacementInfo::PlacementUnit *>(0));
-        BRAMColumnUntilization.resize(BRAMColumnNum, 0);
+    int columnNum = columnAssigner.getColumnNum();
+    column2PUs.clear();
+    columnUntilization.clear();
+    if (columnNum <= 0)
+        return;
+    column2PUs.resize(columnNum, std::deque<PlacementInfo::PlacementUnit *>(0));
+    columnUntilization.resize(columnNum, 0);
 
-        if (directLegalization)
-        {
-            for (auto &tmpMacroUnit : BRAMPUs)
-            {
-                if (BRAMPUs.find(tmpMacroUnit) != BRAMPUs.end())
-                {
-                    int colId = findCorrespondingColumn(tmpMacroUnit->X(), BRAMColumnXs);
-                    BRAMColumn2PUs[colId].push_back(tmpMacroUnit);
-                    BRAMColumnUntilization[colId] += getMarcroCellNum(tmpMacroUnit);
-                }
-            }
-        }
-        else
+    if (directLegalization)
+    {
+        for (auto tmpMacroUnit : PUs)
         {
-            for (auto &PUCol_pair : PU2Columns)
-            {
-                auto tmpMacroUnit = PUCol_pair.first;
-                if (BRAMPUs.find(tmpMacroUnit) != BRAMPUs.end())
-                {
-                    int colId = findIdMaxWithRecurence(0, BRAMColumnNum - 1, PUCol_pair.second);
-
-                    BRAMColumn2PUs[colId].push_back(tmpMacroUnit);
-                    BRAMColumnUntilization[colId] += getMarcroCellNum(tmpMacroUnit);
-                }
-            }
+            int colId = columnAssigner.findNearestColumn(tmpMacroUnit->X());
+            column2PUs[colId].push_back(tmpMacroUnit);
+            columnUntilization[colId] += getMarcroCellNum(tmpMacroUnit);
         }
     }
-
-    DSPColumn2PUs.clear();
-    DSPColumnUntilization.clear();
-    if (DSPColumnNum > 0)
+    else
     {
-        DSPColumn2PUs.resize(DSPColumnNum, std::deque<PlacementInfo::PlacementUnit *>(0));
-        DSPColumnUntilization.resize(DSPColumnNum, 0);
-
-        if (directLegalization)
+        for (auto &PUCol_pair : PU2Columns)
         {
-            for (auto tmpMacroUnit : DSPPUs)
+            auto tmpMacroUnit = PUCol_pair.first;
+            if (PUs.find(tmpMacroUnit) != PUs.end())
             {
-                if (DSPPUs.find(tmpMacroUnit) != DSPPUs.end())
-                {
-                    int colId = findCorrespondingColumn(tmpMacroUnit->X(), DSPColumnXs);
-
-                    DSPColumn2PUs[colId].push_back(tmpMacroUnit);
-                    DSPColumnUntilization[colId] += getMarcroCellNum(tmpMacroUnit);
-                }
-            }
-        }
-        else
-        {
-            for (auto &PUCol_pair : PU2Columns)
-            {
-                auto tmpMacroUnit = PUCol_pair.first;
-                if (DSPPUs.find(tmpMacroUnit) != DSPPUs.end())
-                {
-                    int colId = findIdMaxWithRecurence(0, DSPColumnNum - 1, PUCol_pair.second);
-
-                    DSPColumn2PUs[colId].push_back(tmpMacroUnit);
-                    DSPColumnUntilization[colId] += getMarcroCellNum(tmpMacroUnit);
-                }
+                int colId = columnAssigner.findMostFrequentColumn(PUCol_pair.second);
+                column2PUs[colId].push_back(tmpMacroUnit);
+                columnUntilization[colId] += getMarcroCellNum(tmpMacroUnit);
             }
         }
     }
+}
 
-    CARRYColumn2PUs.clear();
-    CARRYColumnUntilization.clear();
-    if (CARRYColumnNum > 0)
+void MacroLegalizer::mapMacrosToColumns(bool directLegalization)
+{
+    // the types have their own columns so they can be mapped concurrently
+#pragma omp parallel sections
     {
-        CARRYColumn2PUs.resize(CARRYColumnNum, std::deque<PlacementInfo::PlacementUnit *>(0));
-        CARRYColumnUntilization.resize(CARRYColumnNum, 0);
-        if (directLegalization)
-        {
-            for (auto tmpMacroUnit : CARRYPUs)
-            {
-                if (CARRYPUs.find(tmpMacroUnit) != CARRYPUs.end())
-                {
-                    int colId = findCorrespondingColumn(tmpMacroUnit->X(), CARRYColumnXs);
-
-                    CARRYColumn2PUs[colId].push_back(tmpMacroUnit);
-                    CARRYColumnUntilization[colId] += getMarcroCellNum(tmpMacroUnit);
-                }
-            }
-        }
-        else
-        {
-            for (auto &PUCol_pair : PU2Columns)
-            {
-                auto tmpMacroUnit = PUCol_pair.first;
-                if (CARRYPUs.find(tmpMacroUnit) != CARRYPUs.end())
-                {
-                    int colId = findIdMaxWithRecurence(0, CARRYColumnNum - 1, PUCol_pair.second);
-
-                    CARRYColumn2PUs[colId].push_back(tmpMacroUnit);
-                    CARRYColumnUntilization[colId] += getMarcroCellNum(tmpMacroUnit);
-                }
-            }
-        }
+#pragma omp section
+        mapMacrosToColumnsOfType(directLegalization, BRAMPUs, BRAMColumnAssigner, BRAMColumn2PUs,
+                                 BRAMColumnUntilization);
+#pragma omp section
+        mapMacrosToColumnsOfType(directLegalization, DSPPUs, DSPColumnAssigner, DSPColumn2PUs, DSPColumnUntilization);
+#pragma omp section
+        mapMacrosToColumnsOfType(directLegalization, CARRYPUs, CARRYColumnAssigner, CARRYColumn2PUs,
+                                 CARRYColumnUntilization);
     }
 }
 
@@ -14,10 +14,16 @@
 #ifndef _MACROLEGALIZER
 #define _MACROLEGALIZER
 
+#include "BandedColumnDP.h"
+#include "ColumnAssigner.h"
 #include "DesignInfo.h"
 #include "DeviceInfo.h"
+#include "HPWLChangeEvaluator.h"
+#include "IncrementalBipartiteMatcher.h"
+#include "LegalizationInstance.h"
 #include "MinCostBipartiteMatcher.h"
 #include "PlacementInfo.h"
+#include "SiteSpatialIndex.h"
 #include "dumpZip.h"
 #include "sysInfo.h"
 #include <assert.h>
@@ -62,6 +68,12 @@ class MacroLegalizer
     {
         if (minCostBipartiteMatcher)
             delete minCostBipartiteMatcher;
+        if (HPWLEvaluator)
+            delete HPWLEvaluator;
+        if (siteSpatialIndex)
+            delete siteSpatialIndex;
+        if (legalizationInstance)
+            delete legalizationInstance;
     }
 
     /**
@@ -165,6 +177,58 @@ class MacroLegalizer
      */
     MinCostBipartiteMatcher *minCostBipartiteMatcher = nullptr;
 
+    /**
+     * @brief the cached evaluator of the HPWL overhead when moving a macro to a specific location
+     *
+     */
+    HPWLChangeEvaluator *HPWLEvaluator = nullptr;
+
+    /**
+     * @brief the spatial index of the available sites, which also records the sites binded to PlacementUnits
+     *
+     */
+    SiteSpatialIndex *siteSpatialIndex = nullptr;
+
+    /**
+     * @brief the matching and DP problems solved in a legalize() call, recorded for offline replay when
+     * "DumpLegalizationInstance" is set
+     *
+     */
+    LegalizationInstance *legalizationInstance = nullptr;
+
+    /**
+     * @brief the min-cost flow engine used by the bipartite matching (set by "MinCostFlowEngine")
+     *
+     */
+    MinCostBipartiteMatcher::MinCostFlowEngine minCostFlowEngine = MinCostBipartiteMatcher::MinCostFlowEngine_SPFA;
+
+    typedef IncrementalBipartiteMatcher<DesignInfo::DesignCell *, DeviceInfo::DeviceSite *> IncrementalMacroMatcher;
+
+    /**
+     * @brief whether the bipartite matching keeps its graph, matching and potentials across the rounds of a
+     * legalization and across the legalization calls (set by "IncrementalLegalization")
+     *
+     * In the incremental mode, a round only adds the widened candidates of the unmatched cells to the graph and the
+     * matching of the previous round (or the previous call) warm-starts the solver.
+     *
+     */
+    bool incrementalLegalization = false;
+
+    /**
+     * @brief the number of sites by which a macro can move beyond its location/packed position in the final DP
+     * legalization of a column (set by "LegalizationDPBandWidth", negative to solve the DP of the whole column)
+     *
+     */
+    int DPBandWidth = 32;
+
+    /**
+     * @brief the incremental matchers of rough legalization and fixed-column legalization, which are persistent across
+     * the legalization calls
+     *
+     */
+    IncrementalMacroMatcher roughIncrementalMatcher;
+    IncrementalMacroMatcher fixedColumnIncrementalMatcher;
+
     /**
      * @brief a vector storing the Design cells which have NOT been legalized
      *
@@ -183,12 +247,27 @@ class MacroLegalizer
      */
     std::set<PlacementInfo::PlacementUnit *> macroUnitsToLegalizeSet;
 
+    /**
+     * @brief the span of the Y offsets of the cells (with the types handled by this legalizer) in each macro
+     *
+     * It is used to check whether the sites occupied by the other cells of a macro are available when a cell of the
+     * macro is placed at a candidate site.
+     *
+     */
+    std::map<PlacementInfo::PlacementUnit *, std::pair<float, float>> macro2LegalizedCellOffsetYSpan;
+
     /**
      * @brief a map record the potential sites of different site types
      *
      */
     std::map<DesignInfo::DesignCellType, std::vector<DeviceInfo::DeviceSite *>> macroType2Sites;
 
+    /**
+     * @brief the group of the potential sites of different site types in the spatial index
+     *
+     */
+    std::map<DesignInfo::DesignCellType, int> macroType2SiteGroupId;
+
     /**
      * @brief record the mapping from cells to the candidate sites which are NOT binded to other cells
      *
@@ -227,12 +306,6 @@ class MacroLegalizer
      */
     std::set<DesignInfo::DesignCell *> matchedMacroCells;
 
-    /**
-     * @brief a set of DeviceSites binded to corresponding PlacementUnits
-     *
-     */
-    std::set<DeviceInfo::DeviceSite *> matchedSites;
-
     /**
      * @brief record the binding between design standard cells and DeviceSites as a vector of pairs
      *
@@ -246,6 +319,7 @@ class MacroLegalizer
     std::vector<std::pair<PlacementInfo::PlacementUnit *, DeviceInfo::DeviceSite *>> PULevelMatching;
 
     int DumpMacroLegalizationCnt = 0;
+    int DumpLegalizationInstanceCnt = 0;
 
     /**
      * @brief displacement threshold to detect potential legal sites
@@ -331,6 +405,23 @@ class MacroLegalizer
      */
     std::vector<std::vector<DeviceInfo::DeviceSite *>> CARRYColumn2Sites;
 
+    /**
+     * @brief the group of the sites in each column of BRAM/DSP/CARRY in the spatial index
+     *
+     */
+    std::vector<int> BRAMColumn2SiteGroupId;
+    std::vector<int> DSPColumn2SiteGroupId;
+    std::vector<int> CARRYColumn2SiteGroupId;
+
+    /**
+     * @brief the column assigners of BRAM/DSP/CARRY, which find the columns of the macros and resolve the overflow
+     * columns
+     *
+     */
+    ColumnAssigner BRAMColumnAssigner;
+    ColumnAssigner DSPColumnAssigner;
+    ColumnAssigner CARRYColumnAssigner;
+
     /**
      * @brief record the PlacementUnits in each column of BRAM Sites
      *
@@ -368,22 +459,22 @@ class MacroLegalizer
     std::vector<int> CARRYColumnUntilization;
 
     /**
-     * @brief record the PlacementUnits in each column of BRAM site
+     * @brief record the column of each cell (indexed by the cell id, -1 if not mapped) in BRAM sites
      *
      */
-    std::map<DesignInfo::DesignCell *, int> BRAMCell2Column;
+    std::vector<int> BRAMCell2Column;
 
     /**
-     * @brief record the PlacementUnits in each column of DSP site
+     * @brief record the column of each cell (indexed by the cell id, -1 if not mapped) in DSP sites
      *
      */
-    std::map<DesignInfo::DesignCell *, int> DSPCell2Column;
+    std::vector<int> DSPCell2Column;
 
     /**
-     * @brief record the PlacementUnits in each column of CARRY site
+     * @brief record the column of each cell (indexed by the cell id, -1 if not mapped) in CARRY sites
      *
      */
-    std::map<DesignInfo::DesignCell *, int> CARRYCell2Column;
+    std::vector<int> CARRYCell2Column;
 
     std::map<PlacementInfo::PlacementUnit *, std::vector<DeviceInfo::DeviceSite *>> PU2LegalSites;
 
@@ -499,6 +590,15 @@ class MacroLegalizer
      */
     void findMacroType2AvailableSites();
 
+    /**
+     * @brief add the sites in each column to the spatial index as a group
+     *
+     * @param column2Sites the sites in each column
+     * @param column2SiteGroupId the resultant group of each column
+     */
+    void buildColumnSiteGroups(std::vector<std::vector<DeviceInfo::DeviceSite *>> &column2Sites,
+                               std::vector<int> &column2SiteGroupId);
+
     /**
      * @brief resolve the overflow columns during fixed column legalization by spreading "outliers" to neighbor columns
      *
@@ -512,21 +612,43 @@ class MacroLegalizer
      */
     void findPossibleLegalLocation(bool fixedColumn = false);
 
+    /**
+     * @brief check whether a macro can be legalized if its cell is placed at a candidate site, i.e., the sites in the
+     * column of the candidate site which will be occupied by the macro exist and are available
+     *
+     * The check is made with the occupancy column of the site in O(log(#sites in the column)), where the sites
+     * occupied by fixed elements or mapped by the other legalizers are unavailable. Since the span of the macro must be
+     * within the column, it also ensures that the macro is within the device. The cells without occupancy column or
+     * not in a macro are checked by PlacementInfo::isLegalLocation.
+     *
+     * @param curCell the cell to legalize
+     * @param curSite the candidate site
+     * @return true if the macro can be legalized at the site
+     */
+    bool isMacroSpanAvailable(DesignInfo::DesignCell *curCell, DeviceInfo::DeviceSite *curSite);
+
     /**
      * @brief map the macros to the columns according to the locations of the cells in it
      *
+     * The BRAM/DSP/CARRY macros are mapped concurrently.
+     *
      * @param directLegalization direct legalize the macros without rough legalization phase
      */
     void mapMacrosToColumns(bool directLegalization);
 
     /**
-     * @brief find the closest column for a given location X
+     * @brief map the macros of a specific type to the columns
      *
-     * @param curX given location X
-     * @param Xs the location X for the resource columns
-     * @return int
+     * @param directLegalization direct legalize the macros without rough legalization phase
+     * @param PUs the macros of the type
+     * @param columnAssigner the column assigner of the type
+     * @param column2PUs the resultant macros in each column
+     * @param columnUntilization the resultant number of sites required by the macros in each column
      */
-    int findCorrespondingColumn(float curX, std::vector<float> &Xs);
+    void mapMacrosToColumnsOfType(bool directLegalization, std::set<PlacementInfo::PlacementUnit *> &PUs,
+                                  ColumnAssigner &columnAssigner,
+                                  std::vector<std::deque<PlacementInfo::PlacementUnit *>> &column2PUs,
+                                  std::vector<int> &columnUntilization);
 
     /**
      * @brief Create a bipartite graph between PlacementUnit and potential DeviceSites
@@ -534,6 +656,14 @@ class MacroLegalizer
      */
     void createBipartiteGraph();
 
+    /**
+     * @brief record the bipartite matching problem between the macro cells to legalize and their candidate sites in
+     * the legalization instance
+     *
+     * @param phase the phase of legalization, e.g., rough or fixedColumn
+     */
+    void recordMatchingProblem(const std::string &phase);
+
     /**
      * @brief conduct rough legalization.
      *
@@ -577,10 +707,12 @@ class MacroLegalizer
      * @param colNum total number of the column of the target type of PlacementUnit
      * @param Column2Sites a vector record the sites in the columns
      * @param Column2PUs  a vector record the macros in the columns
+     * @param columnType the type of the columns for the legalization instance
      * @return float
      */
     float DPForMinHPWL(int colNum, std::vector<std::vector<DeviceInfo::DeviceSite *>> &Column2Sites,
-                       std::vector<std::deque<PlacementInfo::PlacementUnit *>> &Column2PUs);
+                       std::vector<std::deque<PlacementInfo::PlacementUnit *>> &Column2PUs,
+                       const std::string &columnType);
 
     /**
      * @brief record the matching in private list and update the list of cells which are not matched by the
@@ -590,28 +722,41 @@ class MacroLegalizer
     void updateMatchingAndUnmatchedMacroCells();
 
     /**
-     * @brief spread PlacementUnits accross columns to resolve resource overflow
+     * @brief add the candidate sites of the cells to be legalized into the incremental matcher. Only the new edges
+     * are evaluated.
      *
-     * @param columnNum the number of columns
-     * @param columnUntilization a vector reording the utilization usage of each column
-     * @param column2Sites a vector reording device sites in each column
-     * @param column2PUs a vector reording PlacementUnits in each column
-     * @param cell2Column a map recording the column id for each PlacementUnit
+     * @param matcher the incremental matcher of the current legalization
      */
-    void spreadMacros(int columnNum, std::vector<int> &columnUntilization,
-                      std::vector<std::vector<DeviceInfo::DeviceSite *>> &column2Sites,
-                      std::vector<std::deque<PlacementInfo::PlacementUnit *>> &column2PUs,
-                      std::map<DesignInfo::DesignCell *, int> &cell2Column, float budgeRatio = 1);
+    void addCandidatesToIncrementalMatcher(IncrementalMacroMatcher &matcher);
 
     /**
-     * @brief find the column which contains the most of cells in a macro in a specific range of columns
+     * @brief solve the incremental matching and update the list of cells which are not matched yet. The matching is
+     * not recorded until commitIncrementalMatching() since the later rounds can re-assign the matched cells.
      *
-     * @param minId the begin column
-     * @param maxId the end column
-     * @param ids the column ids of the cells in the macro
-     * @return int
+     * @param matcher the incremental matcher of the current legalization
+     */
+    void solveIncrementalMatchingAndUpdateUnmatchedMacroCells(IncrementalMacroMatcher &matcher);
+
+    /**
+     * @brief record the final incremental matching in private list
+     *
+     * @param matcher the incremental matcher of the current legalization
      */
-    int findIdMaxWithRecurence(int minId, int maxId, std::vector<int> &ids);
+    void commitIncrementalMatching(IncrementalMacroMatcher &matcher);
+
+    /**
+     * @brief spread PlacementUnits accross columns to resolve resource overflow
+     *
+     * @param columnAssigner the column assigner of the type of the PlacementUnits
+     * @param columnUntilization a vector reording the utilization usage of each column
+     * @param column2PUs a vector reording PlacementUnits in each column
+     * @param cell2Column a vector recording the column id for each cell (indexed by the cell id)
+     * @param familyName the name of the type for the messages
+     * @param budgeRatio the ratio of the sites in a column which can be used
+     */
+    void spreadMacros(ColumnAssigner &columnAssigner, std::vector<int> &columnUntilization,
+                      std::vector<std::deque<PlacementInfo::PlacementUnit *>> &column2PUs,
+                      std::vector<int> &cell2Column, const std::string &familyName, float budgeRatio = 1);
 
     /**
      * @brief Set the sites which are binded as mapped so they will not be mapped to other elements in the netlist
@@ -638,9 +783,13 @@ class MacroLegalizer
         for (int i = 0; i < macrosNum; i++)
         {
             DesignInfo::DesignCell *curCell = macroCellsToLegalize[i];
-            macro2SitesInDisplacementThreshold[curCell] = placementInfo->findNeiborSiteFromBinGrid(
-                curCell, cellLoc[curCell->getCellId()].X, cellLoc[curCell->getCellId()].Y, displacementThreshold,
-                candidateFactor * maxNumCandidate);
+            auto groupIdIt = macroType2SiteGroupId.find(curCell->getCellType());
+            assert(groupIdIt != macroType2SiteGroupId.end());
+            std::vector<DeviceInfo::DeviceSite *> *candidateSites = new std::vector<DeviceInfo::DeviceSite *>(0);
+            siteSpatialIndex->findNearestFreeSites(groupIdIt->second, cellLoc[curCell->getCellId()].X,
+                                                   cellLoc[curCell->getCellId()].Y, displacementThreshold,
+                                                   candidateFactor * maxNumCandidate, *candidateSites);
+            macro2SitesInDisplacementThreshold[curCell] = candidateSites;
         }
     }
 
@@ -667,7 +816,7 @@ class MacroLegalizer
         displacementThreshold = initialDisplacementThreshold;
         maxNumCandidate = initialMaxNumCandidate;
         matchedMacroCells.clear();
-        matchedSites.clear();
+        siteSpatialIndex->resetMatchedSites();
         cellLevelMatching.clear();
         PULevelMatching.clear();
     }
@@ -710,35 +859,16 @@ class MacroLegalizer
      */
     inline float getHPWLChange(DesignInfo::DesignCell *curCell, DeviceInfo::DeviceSite *curSite)
     {
-        float oriHPWL = 0.0;
-        float newHPWL = 0.0;
         auto tmpPU = placementInfo->getPlacementUnitByCell(curCell);
-        float PUX = 0.0, PUY = 0.0;
-        auto nets = placementInfo->getPlacementUnitId2Nets()[tmpPU->getId()];
+        float PUX = curSite->X(), PUY = curSite->Y();
         float numCellsInMacro = 1.0;
-        if (dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(tmpPU))
-        {
-            PUX = curSite->X();
-            PUY = curSite->Y();
-        }
-        else if (PlacementInfo::PlacementMacro *tmpMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(tmpPU))
+        if (PlacementInfo::PlacementMacro *tmpMacro = PlacementInfo::asMacro(tmpPU))
         {
-
             PUX = curSite->X() - tmpMacro->getCellOffsetXInMacro(curCell);
             PUY = curSite->Y() - tmpMacro->getCellOffsetYInMacro(curCell);
             numCellsInMacro = tmpMacro->getCells().size();
         }
-
-        for (auto curNet : nets)
-        {
-            if (curNet->getDesignNet()->getPins().size() > 1000) // it could be clock
-                continue;
-            oriHPWL += curNet->getHPWL(y2xRatio);
-            newHPWL += curNet->getNewHPWLByTrying(tmpPU, PUX, PUY, y2xRatio);
-        }
-        return (newHPWL - oriHPWL) / numCellsInMacro;
-        // return std::fabs(macroLoc.X - curSite->X()) + std::fabs(macroLoc.Y - curSite->Y());
-        // placementInfo->getPlacementUnitByCell(curCell);
+        return HPWLEvaluator->getHPWLChange(tmpPU, PUX, PUY) / numCellsInMacro;
     }
 
     /**
@@ -750,23 +880,7 @@ class MacroLegalizer
      */
     inline float getHPWLChange(PlacementInfo::PlacementUnit *tmpPU, DeviceInfo::DeviceSite *curSite)
     {
-        float oriHPWL = 0.0;
-        float newHPWL = 0.0;
-        float PUX = 0.0, PUY = 0.0;
-        auto nets = placementInfo->getPlacementUnitId2Nets()[tmpPU->getId()];
-
-        PUX = curSite->X();
-        PUY = curSite->Y();
-
-        for (auto curNet : nets)
-        {
-            if (curNet->getDesignNet()->getPins().size() > 1000) // it could be clock
-                continue;
-            oriHPWL += curNet->getHPWL(y2xRatio);
-            newHPWL += curNet->getNewHPWLByTrying(tmpPU, PUX, PUY, y2xRatio);
-        }
-
-        return (newHPWL - oriHPWL);
+        return HPWLEvaluator->getHPWLChange(tmpPU, curSite);
     }
 
     /**
@@ -779,20 +893,7 @@ class MacroLegalizer
      */
     inline float getHPWLChange(PlacementInfo::PlacementUnit *tmpPU, float PUX, float PUY)
     {
-
-        float oriHPWL = 0.0;
-        float newHPWL = 0.0;
-        auto nets = placementInfo->getPlacementUnitId2Nets()[tmpPU->getId()];
-
-        for (auto curNet : nets)
-        {
-            if (curNet->getDesignNet()->getPins().size() > 1000) // it could be clock
-                continue;
-            oriHPWL += curNet->getHPWL(y2xRatio);
-            newHPWL += curNet->getNewHPWLByTrying(tmpPU, PUX, PUY, y2xRatio);
-        }
-
-        return (newHPWL - oriHPWL);
+        return HPWLEvaluator->getHPWLChange(tmpPU, PUX, PUY);
     }
 
     inline void swapSitePtr(DeviceInfo::DeviceSite **siteA, DeviceInfo::DeviceSite **siteB)
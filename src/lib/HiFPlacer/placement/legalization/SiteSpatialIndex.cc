@@ -0,0 +1,182 @@
+/**
+ * @file SiteSpatialIndex.cc
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This implementation file contains APIs' implementation of SiteSpatialIndex, a bucket-grid index of DeviceSites
+ * which finds the nearest free candidate sites for legalization.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ */
+
+#include "SiteSpatialIndex.h"
+
+#include <algorithm>
+#include <limits>
+#include <queue>
+
+void SiteSpatialIndex::clear()
+{
+    siteGroups.clear();
+    site2SlotId.clear();
+    slotSites.clear();
+    slotX.clear();
+    slotY.clear();
+    slotMatched.clear();
+}
+
+void SiteSpatialIndex::resetMatchedSites()
+{
+    std::fill(slotMatched.begin(), slotMatched.end(), 0);
+}
+
+int SiteSpatialIndex::addSiteGroup(std::vector<DeviceInfo::DeviceSite *> &sites)
+{
+    SiteGroup newGroup;
+    newGroup.minX = newGroup.minY = std::numeric_limits<float>::max();
+    newGroup.maxX = newGroup.maxY = std::numeric_limits<float>::lowest();
+
+    std::vector<int> siteSlots;
+    siteSlots.reserve(sites.size());
+    for (auto curSite : sites)
+    {
+        auto insertRes = site2SlotId.emplace(curSite, (int)slotSites.size());
+        if (insertRes.second)
+        {
+            slotSites.push_back(curSite);
+            slotX.push_back(curSite->X());
+            slotY.push_back(curSite->Y());
+            slotMatched.push_back(0);
+        }
+        siteSlots.push_back(insertRes.first->second);
+        newGroup.minX = std::min(newGroup.minX, curSite->X());
+        newGroup.minY = std::min(newGroup.minY, curSite->Y());
+        newGroup.maxX = std::max(newGroup.maxX, curSite->X());
+        newGroup.maxY = std::max(newGroup.maxY, curSite->Y());
+    }
+
+    // about 4 sites per bucket, where the buckets are square in the weighted displacement. The groups with a
+    // degenerated bounding box (e.g., the sites in a column) are divided in one dimension only.
+    int numSites = siteSlots.size();
+    int targetNumBuckets = std::max(1, numSites / 4);
+    float width = numSites ? newGroup.maxX - newGroup.minX : 0;
+    float height = numSites ? (newGroup.maxY - newGroup.minY) * y2xRatio : 0;
+    newGroup.numBucketX = 1;
+    newGroup.numBucketY = 1;
+    if (width > 1e-3 && height > 1e-3)
+    {
+        float bucketSide = std::sqrt(width * height / targetNumBuckets);
+        newGroup.numBucketX = std::min(targetNumBuckets, std::max(1, (int)std::ceil(width / bucketSide)));
+        newGroup.numBucketY = std::min(targetNumBuckets, std::max(1, (int)std::ceil(height / bucketSide)));
+    }
+    else if (width > 1e-3)
+        newGroup.numBucketX = targetNumBuckets;
+    else if (height > 1e-3)
+        newGroup.numBucketY = targetNumBuckets;
+    newGroup.bucketW = width > 1e-3 ? (newGroup.maxX - newGroup.minX) / newGroup.numBucketX : 1.0;
+    newGroup.bucketH = height > 1e-3 ? (newGroup.maxY - newGroup.minY) / newGroup.numBucketY : 1.0;
+
+    // counting sort of the slots into the buckets
+    int numBuckets = newGroup.numBucketX * newGroup.numBucketY;
+    std::vector<int> slotBucketIds(numSites);
+    newGroup.bucketBegin.assign(numBuckets + 1, 0);
+    for (int i = 0; i < numSites; i++)
+    {
+        int slotId = siteSlots[i];
+        int bucketX = std::min(newGroup.numBucketX - 1, (int)((slotX[slotId] - newGroup.minX) / newGroup.bucketW));
+        int bucketY = std::min(newGroup.numBucketY - 1, (int)((slotY[slotId] - newGroup.minY) / newGroup.bucketH));
+        slotBucketIds[i] = bucketY * newGroup.numBucketX + bucketX;
+        newGroup.bucketBegin[slotBucketIds[i] + 1]++;
+    }
+    for (int bucketId = 0; bucketId < numBuckets; bucketId++)
+        newGroup.bucketBegin[bucketId + 1] += newGroup.bucketBegin[bucketId];
+    newGroup.bucketSlots.resize(numSites);
+    std::vector<int> nextPos(newGroup.bucketBegin.begin(), newGroup.bucketBegin.end() - 1);
+    for (int i = 0; i < numSites; i++)
+        newGroup.bucketSlots[nextPos[slotBucketIds[i]]++] = siteSlots[i];
+
+    siteGroups.push_back(std::move(newGroup));
+    return siteGroups.size() - 1;
+}
+
+void SiteSpatialIndex::findNearestFreeSites(int groupId, float targetX, float targetY, float radius, int k,
+                                            std::vector<DeviceInfo::DeviceSite *> &resSites,
+                                            const std::function<bool(DeviceInfo::DeviceSite *)> &isCandidate) const
+{
+    assert(groupId >= 0 && groupId < (int)siteGroups.size());
+    resSites.clear();
+    auto &curGroup = siteGroups[groupId];
+    if (k <= 0 || curGroup.bucketSlots.empty())
+        return;
+
+    // the bucket of the target location clamped into the bounding box, and the distance from the target to the
+    // clamped location only makes the sites in further rings further.
+    int centerX = std::min(curGroup.numBucketX - 1,
+                           std::max(0, (int)std::floor((targetX - curGroup.minX) / curGroup.bucketW)));
+    int centerY = std::min(curGroup.numBucketY - 1,
+                           std::max(0, (int)std::floor((targetY - curGroup.minY) / curGroup.bucketH)));
+    int maxRing = std::max(curGroup.numBucketX, curGroup.numBucketY);
+
+    // max-heap of the k nearest candidates, where the ties are broken by the slot ids so the results are deterministic
+    typedef std::pair<float, int> dispAndSlot;
+    std::priority_queue<dispAndSlot> nearestSlots;
+    auto tryBucket = [&](int bucketX, int bucketY) {
+        int bucketId = bucketY * curGroup.numBucketX + bucketX;
+        for (int i = curGroup.bucketBegin[bucketId]; i < curGroup.bucketBegin[bucketId + 1]; i++)
+        {
+            int slotId = curGroup.bucketSlots[i];
+            if (slotMatched[slotId])
+                continue;
+            float disp = getDisplacement(targetX, targetY, slotId);
+            if (disp >= radius)
+                continue;
+            dispAndSlot curPair(disp, slotId);
+            bool isNearer = (int)nearestSlots.size() < k || curPair < nearestSlots.top();
+            if (!isNearer || (isCandidate && !isCandidate(slotSites[slotId])))
+                continue;
+            if ((int)nearestSlots.size() >= k)
+                nearestSlots.pop();
+            nearestSlots.push(curPair);
+        }
+    };
+
+    for (int ring = 0; ring < maxRing; ring++)
+    {
+        // any site in this ring is at least (ring-1) buckets away from the target in X or Y
+        const float inf = std::numeric_limits<float>::max();
+        float lowerBoundX = ring < curGroup.numBucketX ? (ring - 1) * curGroup.bucketW : inf;
+        float lowerBoundY = ring < curGroup.numBucketY ? (ring - 1) * curGroup.bucketH * y2xRatio : inf;
+        float lowerBound = std::max(0.0f, std::min(lowerBoundX, lowerBoundY));
+        if (lowerBound >= radius)
+            break;
+        if ((int)nearestSlots.size() >= k && lowerBound > nearestSlots.top().first)
+            break;
+
+        int lowY = std::max(0, centerY - ring), highY = std::min(curGroup.numBucketY - 1, centerY + ring);
+        int lowX = std::max(0, centerX - ring), highX = std::min(curGroup.numBucketX - 1, centerX + ring);
+        for (int bucketY = lowY; bucketY <= highY; bucketY++)
+        {
+            if (bucketY == centerY - ring || bucketY == centerY + ring)
+            {
+                for (int bucketX = lowX; bucketX <= highX; bucketX++)
+                    tryBucket(bucketX, bucketY);
+            }
+            else
+            {
+                if (centerX - ring >= 0)
+                    tryBucket(centerX - ring, bucketY);
+                if (ring > 0 && centerX + ring < curGroup.numBucketX)
+                    tryBucket(centerX + ring, bucketY);
+            }
+        }
+    }
+
+    resSites.resize(nearestSlots.size());
+    for (int i = nearestSlots.size() - 1; i >= 0; i--)
+    {
+        resSites[i] = slotSites[nearestSlots.top().second];
+        nearestSlots.pop();
+    }
+}
@@ -0,0 +1,157 @@
+/**
+ * @file SiteSpatialIndex.h
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This header file contains the definitions of SiteSpatialIndex class, a bucket-grid index of DeviceSites which
+ * finds the nearest free candidate sites for legalization.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ */
+
+#ifndef _SITESPATIALINDEX
+#define _SITESPATIALINDEX
+
+#include "DeviceInfo.h"
+#include <assert.h>
+#include <cmath>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief SiteSpatialIndex indexes groups of DeviceSites (e.g., the available sites of a cell type, or the sites in a
+ * column) with uniform bucket grids and keeps a matched bitmap of the sites.
+ *
+ * A query returns the k nearest sites of a group which are not matched and within a displacement radius, in the order
+ * of the displacement (|dx| + y2xRatio * |dy|). The buckets are scanned ring by ring around the target location and the
+ * search stops once the next ring cannot contain a site closer than the k-th found one, so a query only touches the
+ * buckets near the target instead of scanning the whole site list.
+ *
+ * A site can be in multiple groups and its matched flag is shared by the groups. The matched flags are set serially by
+ * the legalizer while the queries can be made by multiple threads concurrently.
+ *
+ */
+class SiteSpatialIndex
+{
+  public:
+    /**
+     * @brief Construct a new SiteSpatialIndex object
+     *
+     * @param y2xRatio a factor to tune the weights of the displacement in Y-coordinate relative to X-coordinate
+     */
+    SiteSpatialIndex(float y2xRatio) : y2xRatio(y2xRatio)
+    {
+    }
+    ~SiteSpatialIndex()
+    {
+    }
+
+    /**
+     * @brief remove all the groups and sites
+     *
+     */
+    void clear();
+
+    /**
+     * @brief build the bucket grid of a group of sites
+     *
+     * @param sites the sites in the group
+     * @return int the id of the group
+     */
+    int addSiteGroup(std::vector<DeviceInfo::DeviceSite *> &sites);
+
+    /**
+     * @brief set whether a site is matched. Matched sites will not be returned by the queries.
+     *
+     * @param curSite the site (it is ignored if it is not in any group)
+     * @param matched
+     */
+    inline void setSiteMatched(DeviceInfo::DeviceSite *curSite, bool matched)
+    {
+        auto findRes = site2SlotId.find(curSite);
+        if (findRes == site2SlotId.end())
+            return;
+        slotMatched[findRes->second] = matched;
+    }
+
+    /**
+     * @brief check whether a site is matched
+     *
+     * @param curSite the site
+     * @return true if the site is in a group and it is matched
+     */
+    inline bool isSiteMatched(DeviceInfo::DeviceSite *curSite) const
+    {
+        auto findRes = site2SlotId.find(curSite);
+        return findRes != site2SlotId.end() && slotMatched[findRes->second];
+    }
+
+    /**
+     * @brief clear the matched flags of all the sites
+     *
+     */
+    void resetMatchedSites();
+
+    /**
+     * @brief find the k nearest sites of a group which are not matched and whose displacement to the target location is
+     * less than the radius
+     *
+     * If a filter is given, only the sites accepted by the filter are counted, so the search goes on until k accepted
+     * sites are found or the radius is exhausted.
+     *
+     * @param groupId the id of the group
+     * @param targetX target location X
+     * @param targetY target location Y
+     * @param radius the displacement threshold
+     * @param k the maximum number of sites to be returned
+     * @param resSites the resultant sites, sorted by the displacement
+     * @param isCandidate the filter of the sites (e.g., legality checks), which can be called by multiple threads
+     */
+    void findNearestFreeSites(int groupId, float targetX, float targetY, float radius, int k,
+                              std::vector<DeviceInfo::DeviceSite *> &resSites,
+                              const std::function<bool(DeviceInfo::DeviceSite *)> &isCandidate = nullptr) const;
+
+  private:
+    float y2xRatio = 1.0;
+
+    /**
+     * @brief the bucket grid of a group of sites. The slots of the sites in the buckets are stored in compressed
+     * sparse rows.
+     *
+     */
+    struct SiteGroup
+    {
+        float minX;
+        float minY;
+        float maxX;
+        float maxY;
+        float bucketW;
+        float bucketH;
+        int numBucketX;
+        int numBucketY;
+        std::vector<int> bucketBegin;
+        std::vector<int> bucketSlots;
+    };
+
+    std::vector<SiteGroup> siteGroups;
+
+    /**
+     * @brief the unique slots of the indexed sites, shared by the groups
+     *
+     */
+    std::unordered_map<DeviceInfo::DeviceSite *, int> site2SlotId;
+    std::vector<DeviceInfo::DeviceSite *> slotSites;
+    std::vector<float> slotX;
+    std::vector<float> slotY;
+    std::vector<unsigned char> slotMatched;
+
+    inline float getDisplacement(float fX, float fY, int slotId) const
+    {
+        return std::fabs(fX - slotX[slotId]) + y2xRatio * std::fabs(fY - slotY[slotId]);
+    }
+};
+
+#endif
@@ -93,8 +93,8 @@ void IncrementalBELPacker::LUTFFPairing(float disThreshold)
                             placementMacros.push_back(curMacro);
                             placementUnits.push_back(curMacro);
 
-                            cellId2PlacementUnit[curCell->getCellId()] = curMacro;
-                            cellId2PlacementUnit[FFBeDriven->getCellId()] = curMacro;
+                            placementInfo->setPlacementUnitOfCell(curCell->getCellId(), curMacro);
+                            placementInfo->setPlacementUnitOfCell(FFBeDriven->getCellId(), curMacro);
 
                             cellInMacros.insert(curCell);
                             cellInMacros.insert(FFBeDriven);
@@ -166,8 +166,8 @@ void IncrementalBELPacker::LUTFFPairing(float disThreshold)
                                 placementMacros.push_back(curMacro);
                                 placementUnits.push_back(curMacro);
 
-                                cellId2PlacementUnit[curCell->getCellId()] = curMacro;
-                                cellId2PlacementUnit[FFToPack->getCellId()] = curMacro;
+                                placementInfo->setPlacementUnitOfCell(curCell->getCellId(), curMacro);
+                                placementInfo->setPlacementUnitOfCell(FFToPack->getCellId(), curMacro);
 
                                 cellInMacros.insert(curCell);
                                 cellInMacros.insert(FFToPack);
@@ -259,7 +259,7 @@ void IncrementalBELPacker::FFPairing(float disThreshold)
 
         for (auto curFF : FFs)
         {
-            auto tmpPU = cellId2PlacementUnit[curFF->getCellId()];
+            auto tmpPU = placementInfo->getPlacementUnitByCell(curFF);
             if (auto unpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(tmpPU))
             {
                 FFpoints.emplace_back(unpackedCell);
@@ -335,8 +335,8 @@ void IncrementalBELPacker::FFPairing(float disThreshold)
                 placementMacros.push_back(curMacro);
                 placementUnits.push_back(curMacro);
 
-                cellId2PlacementUnit[FFCell0->getCellId()] = curMacro;
-                cellId2PlacementUnit[FFCell1->getCellId()] = curMacro;
+                placementInfo->setPlacementUnitOfCell(FFCell0->getCellId(), curMacro);
+                placementInfo->setPlacementUnitOfCell(FFCell1->getCellId(), curMacro);
 
                 assert(cellInMacros.find(FFCell0) == cellInMacros.end());
                 assert(cellInMacros.find(FFCell1) == cellInMacros.end());
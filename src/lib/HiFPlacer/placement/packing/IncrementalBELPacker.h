@@ -52,7 +52,6 @@ class IncrementalBELPacker
           placementUnpackedCells(placementInfo->getPlacementUnpackedCells()),
           placementMacros(placementInfo->getPlacementMacros()),
           fixedPlacementUnits(placementInfo->getFixedPlacementUnits()), cellInMacros(placementInfo->getCellInMacros()),
-          cellId2PlacementUnit(placementInfo->getCellId2PlacementUnit()),
           cellId2PlacementUnitVec(placementInfo->getCellId2PlacementUnitVec()), JSONCfg(JSONCfg)
     {
         if (JSONCfg.find("y2xRatio") != JSONCfg.end())
@@ -131,7 +130,6 @@ class IncrementalBELPacker
     std::vector<PlacementInfo::PlacementMacro *> &placementMacros;
     std::vector<PlacementInfo::PlacementUnit *> &fixedPlacementUnits;
     std::set<DesignInfo::DesignCell *> &cellInMacros;
-    std::map<int, PlacementInfo::PlacementUnit *> &cellId2PlacementUnit;
     std::vector<PlacementInfo::PlacementUnit *> &cellId2PlacementUnitVec;
     std::map<std::string, std::string> &JSONCfg;
     std::vector<int> placementNetId2LUTPlacementUnitId;
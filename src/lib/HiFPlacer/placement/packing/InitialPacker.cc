@@ -21,7 +21,7 @@
 
 void InitialPacker::pack()
 {
-    cellId2PlacementUnit.clear();
+    placementInfo->clearPlacementUnitsOfCells();
     placementUnits.clear();
     placementMacros.clear();
     cellInMacros.clear();
@@ -261,7 +261,7 @@ void InitialPacker::findDSPMacros()
         for (auto tmpCell : curMacro->getCells())
         {
             assert(cellInMacros.find(tmpCell) == cellInMacros.end());
-            cellId2PlacementUnit[tmpCell->getElementIdInType()] = curMacro;
+            placementInfo->setPlacementUnitOfCell(tmpCell->getElementIdInType(), curMacro);
             cellInMacros.insert(tmpCell);
             totalWeight += compatiblePlacementTable->cellType2sharedBELTypeOccupation[tmpCell->getCellType()];
         }
@@ -309,7 +309,7 @@ void InitialPacker::findLUTRAMMacros()
         curMacro->addCell(curCell, curCell->getCellType(), 0, 0);
         assert(cellInMacros.find(curCell) == cellInMacros.end());
         cellInMacros.insert(curCell);
-        cellId2PlacementUnit[curCell->getElementIdInType()] = curMacro;
+        placementInfo->setPlacementUnitOfCell(curCell->getElementIdInType(), curMacro);
         curMacro->setWeight(16);
         res.push_back(curMacro);
         placementMacros.push_back(curMacro);
@@ -411,7 +411,7 @@ void InitialPacker::findBRAMMacros()
         for (auto tmpCell : curMacro->getCells())
         {
             assert(cellInMacros.find(tmpCell) == cellInMacros.end());
-            cellId2PlacementUnit[tmpCell->getElementIdInType()] = curMacro;
+            placementInfo->setPlacementUnitOfCell(tmpCell->getElementIdInType(), curMacro);
             cellInMacros.insert(tmpCell);
             totalWeight += compatiblePlacementTable->cellType2sharedBELTypeOccupation[tmpCell->getCellType()];
         }
@@ -1104,7 +1104,7 @@ void InitialPacker::findCARRYMacros()
         for (auto tmpCell : curMacro->getCells())
         {
             assert(cellInMacros.find(tmpCell) == cellInMacros.end());
-            cellId2PlacementUnit[tmpCell->getElementIdInType()] = curMacro;
+            placementInfo->setPlacementUnitOfCell(tmpCell->getElementIdInType(), curMacro);
             cellInMacros.insert(tmpCell);
             if (tmpCell->isCarry())
                 totalWeight += 8;
@@ -1275,7 +1275,7 @@ void InitialPacker::findMuxMacros()
         for (auto tmpCell : curMacro->getCells())
         {
             assert(cellInMacros.find(tmpCell) == cellInMacros.end());
-            cellId2PlacementUnit[tmpCell->getElementIdInType()] = curMacro;
+            placementInfo->setPlacementUnitOfCell(tmpCell->getElementIdInType(), curMacro);
             cellInMacros.insert(tmpCell);
             totalWeight += compatiblePlacementTable->cellType2sharedBELTypeOccupation[tmpCell->getCellType()];
         }
@@ -1352,7 +1352,7 @@ void InitialPacker::findMuxMacros()
         for (auto tmpCell : curMacro->getCells())
         {
             assert(cellInMacros.find(tmpCell) == cellInMacros.end());
-            cellId2PlacementUnit[tmpCell->getElementIdInType()] = curMacro;
+            placementInfo->setPlacementUnitOfCell(tmpCell->getElementIdInType(), curMacro);
             cellInMacros.insert(tmpCell);
             totalWeight += compatiblePlacementTable->cellType2sharedBELTypeOccupation[tmpCell->getCellType()];
         }
@@ -1468,7 +1468,7 @@ void InitialPacker::loadOtherCLBMacros(std::string RAMMacroListFromVivadoFileNam
         for (auto tmpCell : curMacro->getCells())
         {
             assert(cellInMacros.find(tmpCell) == cellInMacros.end());
-            cellId2PlacementUnit[tmpCell->getElementIdInType()] = curMacro;
+            placementInfo->setPlacementUnitOfCell(tmpCell->getElementIdInType(), curMacro);
             cellInMacros.insert(tmpCell);
             totalWeight += compatiblePlacementTable->cellType2sharedBELTypeOccupation[tmpCell->getCellType()];
         }
@@ -1542,8 +1542,8 @@ void InitialPacker::LUTFFPairing()
                         placementMacros.push_back(curMacro);
                         placementUnits.push_back(curMacro);
 
-                        cellId2PlacementUnit[curCell->getCellId()] = curMacro;
-                        cellId2PlacementUnit[FFBeDriven->getCellId()] = curMacro;
+                        placementInfo->setPlacementUnitOfCell(curCell->getCellId(), curMacro);
+                        placementInfo->setPlacementUnitOfCell(FFBeDriven->getCellId(), curMacro);
 
                         cellInMacros.insert(curCell);
                         cellInMacros.insert(FFBeDriven);
@@ -1576,7 +1576,7 @@ void InitialPacker::findUnpackedUnits()
                 new PlacementInfo::PlacementUnpackedCell(cell->getName(), placementUnits.size(), cell);
             curUnpackedCell->setWeight(compatiblePlacementTable->cellType2sharedBELTypeOccupation[cell->getCellType()]);
 
-            cellId2PlacementUnit[cell->getElementIdInType()] = curUnpackedCell;
+            placementInfo->setPlacementUnitOfCell(cell->getElementIdInType(), curUnpackedCell);
             placementUnits.push_back(curUnpackedCell);
             placementUnpackedCells.push_back(curUnpackedCell);
         }
@@ -1614,13 +1614,13 @@ void InitialPacker::loadFixedPlacementUnits(std::string fixedPlacementUnitsFromV
         {
             auto curCell = designInfo->getCell(cellName);
             if (PlacementInfo::PlacementUnpackedCell *unpackedPU = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(
-                    cellId2PlacementUnit[curCell->getElementIdInType()]))
+                    cellId2PlacementUnitVec[curCell->getElementIdInType()]))
             {
                 unpackedPU->setLockedAt(siteName, BELName, deviceInfo);
                 fixedPlacementUnits.push_back(unpackedPU);
             }
             else if (PlacementInfo::PlacementMacro *curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(
-                         cellId2PlacementUnit[curCell->getElementIdInType()]))
+                         cellId2PlacementUnitVec[curCell->getElementIdInType()]))
             {
                 // We can only handle BRAM36 currently
                 assert(curCell->getCellType() == DesignInfo::CellType_RAMB36E2);
@@ -49,7 +49,6 @@ class InitialPacker
           placementUnpackedCells(placementInfo->getPlacementUnpackedCells()),
           placementMacros(placementInfo->getPlacementMacros()),
           fixedPlacementUnits(placementInfo->getFixedPlacementUnits()), cellInMacros(placementInfo->getCellInMacros()),
-          cellId2PlacementUnit(placementInfo->getCellId2PlacementUnit()),
           cellId2PlacementUnitVec(placementInfo->getCellId2PlacementUnitVec()), JSONCfg(JSONCfg)
     {
     }
@@ -333,7 +332,6 @@ class InitialPacker
     std::vector<PlacementInfo::PlacementUnit *> &fixedPlacementUnits;
 
     std::set<DesignInfo::DesignCell *> &cellInMacros;
-    std::map<int, PlacementInfo::PlacementUnit *> &cellId2PlacementUnit;
     std::vector<PlacementInfo::PlacementUnit *> &cellId2PlacementUnitVec;
     std::map<std::string, std::string> &JSONCfg;
 
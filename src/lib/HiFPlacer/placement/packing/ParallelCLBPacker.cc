@@ -50,8 +50,7 @@ ParallelCLBPacker::ParallelCLBPacker(DesignInfo *designInfo, DeviceInfo *deviceI
       PUId2PackingCLBSiteCandidate(placementInfo->getPlacementUnits().size(), nullptr),
       placementUnits(placementInfo->getPlacementUnits()),
       placementUnpackedCells(placementInfo->getPlacementUnpackedCells()),
-      placementMacros(placementInfo->getPlacementMacros()), cellInMacros(placementInfo->getCellInMacros()),
-      cellId2PlacementUnit(placementInfo->getCellId2PlacementUnit())
+      placementMacros(placementInfo->getPlacementMacros()), cellInMacros(placementInfo->getCellInMacros())
 {
     if (JSONCfg.find("y2xRatio") != JSONCfg.end())
     {
@@ -1062,7 +1061,7 @@ void ParallelCLBPacker::updatePackedMacro(bool setPUPseudoNetToCLBSite, bool set
                         cellLoc[cellsToAdd[tmpId]->getCellId()].X = packingSite->getCLBSite()->X();
                         cellLoc[cellsToAdd[tmpId]->getCellId()].Y = packingSite->getCLBSite()->Y();
 
-                        cellId2PlacementUnit[cellsToAdd[tmpId]->getCellId()] = curMacro;
+                        placementInfo->setPlacementUnitOfCell(cellsToAdd[tmpId]->getCellId(), curMacro);
                         cellInMacros.insert(cellsToAdd[tmpId]);
                         totalWeight += placementInfo->getCompatiblePlacementTable()
                                            ->cellType2sharedBELTypeOccupation[cellsToAdd_cellType[tmpId]];
@@ -2124,7 +2124,6 @@ class ParallelCLBPacker
     std::vector<PlacementInfo::PlacementUnpackedCell *> &placementUnpackedCells;
     std::vector<PlacementInfo::PlacementMacro *> &placementMacros;
     std::set<DesignInfo::DesignCell *> &cellInMacros;
-    std::map<int, PlacementInfo::PlacementUnit *> &cellId2PlacementUnit;
 
     std::map<DeviceInfo::DeviceSite *, PackingCLBSite *> deviceSite2PackingSite;
     std::set<PlacementInfo::PlacementUnit *, Packing_PUcompare> packedPUs;
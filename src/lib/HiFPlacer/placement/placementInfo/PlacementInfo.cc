@@ -311,6 +311,11 @@ void PlacementInfo::createGridBins(float _binWidth, float _binHeight)
     eps = 1e-6;
     binWidth = _binWidth;
     binHeight = _binHeight;
+    elementBinGridBuilt = false;
+    for (auto binPyramid : binPyramids)
+        delete binPyramid;
+    binPyramids.clear();
+    binPyramidValid.clear();
 
     if (SharedBELTypeBinGrid.size())
     {
@@ -357,6 +362,7 @@ void PlacementInfo::createGridBins(float _binWidth, float _binHeight)
             {
                 PlacementBinInfo *newBin = new PlacementBinInfo(sharedBELStr, curLeftX, curLeftX + binWidth, curBottomY,
                                                                 curBottomY + binHeight, i, j, compatiblePlacementTable);
+                newBin->setCellSlotTable(&cellId2SharedBELTypeBinSlot);
                 tmpBELGridRow.push_back(newBin);
             }
             tmpSharedBELGrid.push_back(tmpBELGridRow);
@@ -381,6 +387,8 @@ void PlacementInfo::createGridBins(float _binWidth, float _binHeight)
             PlacementBinInfo *globalNewBin =
                 new PlacementBinInfo("globalInfo_BECAREFUL", curLeftX, curLeftX + binWidth, curBottomY,
                                      curBottomY + binHeight, i, j, compatiblePlacementTable);
+            newBin->setCellSlotTable(&cellId2LUTFFBinSlot);
+            globalNewBin->setCellSlotTable(&cellId2GlobalBinSlot);
             tmpBELGridRow.push_back(newBin);
             tmpGlobalBELGridRow.push_back(globalNewBin);
         }
@@ -816,9 +824,9 @@ std::ostream &operator<<(std::ostream &os, PlacementInfo::PlacementUnpackedCell
 
 std::ostream &operator<<(std::ostream &os, PlacementInfo::PlacementUnit *curPU)
 {
-    if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curPU))
+    if (auto curMacro = PlacementInfo::asMacro(curPU))
         os << curMacro;
-    else if (auto curCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU))
+    else if (auto curCell = PlacementInfo::asUnpackedCell(curPU))
         os << curCell;
     else
         assert(false && "placement unit type error.");
@@ -831,158 +839,206 @@ void PlacementInfo::resetElementBinGrid()
         for (auto &curRow : typeGrid)
             for (auto curBin : curRow)
                 curBin->reset();
+    for (auto &curRow : globalBinGrid)
+        for (auto curBin : curRow)
+            curBin->reset();
+    for (auto &curCellBinInfo : cellId2CellBinInfo)
+        curCellBinInfo = CellBinInfo();
+    cellId2BinGridVisitOrder.clear();
+    elementBinGridBuilt = false;
 }
 
-void PlacementInfo::updateElementBinGrid()
+void PlacementInfo::addCellIntoElementBinGrid(DesignInfo::DesignCell *curCell, float cellX, float cellY, int binIdX,
+                                              int binIdY)
 {
-    resetElementBinGrid();
-    cellId2location.resize(designInfo->getNumCells());
+    float num_cellOccupationBELs = getActualOccupation(curCell);
+    assert(num_cellOccupationBELs >= 0);
 
-    for (auto curPU : placementUnits)
+    for (int SharedBELID : getPotentialBELTypeIDs(curCell))
     {
-        if (auto curUnpackedCell = dynamic_cast<PlacementUnpackedCell *>(curPU))
+        assert(binIdY >= 0);
+        assert(binIdX >= 0);
+        assert((unsigned int)binIdY < getBinGrid(SharedBELID).size());
+        assert((unsigned int)binIdX < getBinGrid(SharedBELID)[binIdY].size());
+        assert(getBinGrid(SharedBELID)[binIdY][binIdX]->inRange(cellX, cellY));
+        if (getBinGrid(SharedBELID)[binIdY][binIdX]->canAddMore(num_cellOccupationBELs))
         {
-            int binIdX, binIdY;
-            float cellX = curUnpackedCell->X();
-            float cellY = curUnpackedCell->Y();
-            DesignInfo::DesignCell *curCell = curUnpackedCell->getCell();
-            cellId2location[curCell->getCellId()].X = cellX;
-            cellId2location[curCell->getCellId()].Y = cellY;
+            getBinGrid(SharedBELID)[binIdY][binIdX]->addCell(curCell, num_cellOccupationBELs);
+            setCellBinInfo(curCell->getCellId(), SharedBELID, binIdX, binIdY, num_cellOccupationBELs);
+            return;
+        }
+    }
 
-            getGridXY(cellX, cellY, binIdX, binIdY);
+    getBinGrid(getPotentialBELTypeIDs(curCell)[0])[binIdY][binIdX]->addCell(curCell, num_cellOccupationBELs);
+    setCellBinInfo(curCell->getCellId(), getPotentialBELTypeIDs(curCell)[0], binIdX, binIdY, num_cellOccupationBELs);
+}
 
-            float num_cellOccupationBELs = getActualOccupation(curCell);
-            assert(num_cellOccupationBELs >= 0);
+void PlacementInfo::updateElementBinGrid()
+{
+    int numCells = designInfo->getNumCells();
+    cellId2location.resize(numCells);
+    cellId2CellBinInfo.resize(numCells);
+    resizeCellSlotTables();
+
+    bool incrementalUpdate = elementBinGridBuilt;
+    if (!incrementalUpdate)
+        resetElementBinGrid();
+    elementBinGridBuilt = true;
+    binGridNumX = globalBinGrid.size() ? globalBinGrid[0].size() : 0;
+    binGridLocationChanged.resize(globalBinGrid.size() * binGridNumX, 0);
+    if (!incrementalUpdate)
+        std::fill(binGridLocationChanged.begin(), binGridLocationChanged.end(), 1);
+    cellId2BinGridVisitOrder.resize(numCells, -1);
+
+    // the cells are visited in the order of PlacementUnits, which is the order they are added to the bins
+    std::vector<DesignInfo::DesignCell *> visitedCells;
+    std::vector<std::pair<int, int>> visitedCellBinIds;
+    std::vector<int> cellId2VisitOrder(numCells, -1);
+    visitedCells.reserve(numCells);
+    visitedCellBinIds.reserve(numCells);
+    auto visitCell = [&](DesignInfo::DesignCell *curCell, float cellX, float cellY) {
+        int cellId = curCell->getCellId();
+        cellId2location[cellId].X = cellX;
+        cellId2location[cellId].Y = cellY;
+        int binIdX, binIdY;
+        getGridXY(cellX, cellY, binIdX, binIdY);
+        int visitOrder = visitedCells.size();
+        cellId2VisitOrder[cellId] = visitOrder;
+        visitedCells.push_back(curCell);
+        visitedCellBinIds.emplace_back(binIdX, binIdY);
+
+        CellBinInfo &curCellBinInfo = cellId2CellBinInfo[cellId];
+        if (curCellBinInfo.sharedTypeId < 0)
+        {
+            markBinGridLocationChanged(binIdX, binIdY);
+        }
+        else if (curCellBinInfo.X != binIdX || curCellBinInfo.Y != binIdY ||
+                 curCellBinInfo.occupation != getActualOccupation(curCell) ||
+                 cellId2BinGridVisitOrder[cellId] != visitOrder)
+        {
+            markBinGridLocationChanged(curCellBinInfo.X, curCellBinInfo.Y);
+            markBinGridLocationChanged(binIdX, binIdY);
+        }
+        if (curCellBinInfo.globalX >= 0 && (curCellBinInfo.globalX != binIdX || curCellBinInfo.globalY != binIdY))
+            markBinGridLocationChanged(curCellBinInfo.globalX, curCellBinInfo.globalY);
+    };
 
-            bool nonOverflow = false;
-            for (int SharedBELID : getPotentialBELTypeIDs(curCell))
-            {
-                assert(binIdY >= 0);
-                assert(binIdX >= 0);
-                assert((unsigned int)binIdY < getBinGrid(SharedBELID).size());
-                assert((unsigned int)binIdX < getBinGrid(SharedBELID)[binIdY].size());
-                assert(getBinGrid(SharedBELID)[binIdY][binIdX]->inRange(cellX, cellY));
-                if (getBinGrid(SharedBELID)[binIdY][binIdX]->canAddMore(num_cellOccupationBELs))
-                {
-                    getBinGrid(SharedBELID)[binIdY][binIdX]->addCell(curCell, num_cellOccupationBELs);
-                    setCellBinInfo(curCell->getCellId(), SharedBELID, binIdX, binIdY, num_cellOccupationBELs);
-                    nonOverflow = true;
-                    break;
-                }
-            }
-            if (!nonOverflow)
-            {
-                getBinGrid(getPotentialBELTypeIDs(curCell)[0])[binIdY][binIdX]->addCell(curCell,
-                                                                                        num_cellOccupationBELs);
-                setCellBinInfo(curCell->getCellId(), getPotentialBELTypeIDs(curCell)[0], binIdX, binIdY,
-                               num_cellOccupationBELs);
-            }
+    for (auto curPU : placementUnits)
+    {
+        if (curPU->getType() == PlacementUnitType_UnpackedCell)
+        {
+            auto curUnpackedCell = static_cast<PlacementUnpackedCell *>(curPU);
+            visitCell(curUnpackedCell->getCell(), curUnpackedCell->X(), curUnpackedCell->Y());
         }
-        else if (auto curMacro = dynamic_cast<PlacementMacro *>(curPU))
+        else if (curPU->getType() == PlacementUnitType_Macro)
         {
+            auto curMacro = static_cast<PlacementMacro *>(curPU);
             for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
             {
                 float offsetX_InMacro, offsetY_InMacro;
                 DesignInfo::DesignCellType cellType;
                 curMacro->getVirtualCellInfo(vId, offsetX_InMacro, offsetY_InMacro, cellType);
-                DesignInfo::DesignCell *curCell = curMacro->getCell(vId);
-
-                int binIdX, binIdY;
-                float cellX = curMacro->X() + offsetX_InMacro;
-                float cellY = curMacro->Y() + offsetY_InMacro;
-
-                getGridXY(cellX, cellY, binIdX, binIdY);
-
-                float num_cellOccupationBELs = getActualOccupation(curCell);
-                assert(num_cellOccupationBELs >= 0);
-                bool nonOverflow = false;
-
-                cellId2location[curCell->getCellId()].X = cellX;
-                cellId2location[curCell->getCellId()].Y = cellY;
-
-                for (int SharedBELID : getPotentialBELTypeIDs(curCell))
-                {
-                    assert(binIdY >= 0);
-                    assert(binIdX >= 0);
-                    assert((unsigned int)binIdY < getBinGrid(SharedBELID).size());
-                    assert((unsigned int)binIdX < getBinGrid(SharedBELID)[binIdY].size());
-                    assert(getBinGrid(SharedBELID)[binIdY][binIdX]->inRange(cellX, cellY));
-                    if (getBinGrid(SharedBELID)[binIdY][binIdX]->canAddMore(num_cellOccupationBELs))
-                    {
+                visitCell(curMacro->getCell(vId), curMacro->X() + offsetX_InMacro, curMacro->Y() + offsetY_InMacro);
+            }
+        }
+    }
 
-                        getBinGrid(SharedBELID)[binIdY][binIdX]->addCell(curCell, num_cellOccupationBELs);
-                        setCellBinInfo(curCell->getCellId(), SharedBELID, binIdX, binIdY, num_cellOccupationBELs);
-                        nonOverflow = true;
-                        break;
-                    }
-                }
+    // the cells which are not in the PlacementUnits anymore leave their bins
+    for (int cellId = 0; cellId < numCells; cellId++)
+    {
+        if (cellId2VisitOrder[cellId] >= 0)
+            continue;
+        CellBinInfo &curCellBinInfo = cellId2CellBinInfo[cellId];
+        if (curCellBinInfo.sharedTypeId >= 0)
+            markBinGridLocationChanged(curCellBinInfo.X, curCellBinInfo.Y);
+        if (curCellBinInfo.globalX >= 0)
+            markBinGridLocationChanged(curCellBinInfo.globalX, curCellBinInfo.globalY);
+    }
 
-                if (!nonOverflow)
-                {
-                    getBinGrid(getPotentialBELTypeIDs(curCell)[0])[binIdY][binIdX]->addCell(curCell,
-                                                                                            num_cellOccupationBELs);
-                    setCellBinInfo(curCell->getCellId(), getPotentialBELTypeIDs(curCell)[0], binIdX, binIdY,
-                                   num_cellOccupationBELs);
-                }
+    // empty the bins at the changed locations, while the other bins keep their cells
+    for (unsigned int binIdY = 0; binIdY < globalBinGrid.size(); binIdY++)
+    {
+        for (int binIdX = 0; binIdX < binGridNumX; binIdX++)
+        {
+            unsigned char &locationChanged = binGridLocationChanged[binIdY * binGridNumX + binIdX];
+            for (auto &typeGrid : SharedBELTypeBinGrid)
+            {
+                if (typeGrid[binIdY][binIdX]->isRequiredBinShrinkRatioChanged())
+                    locationChanged = 1;
+            }
+            if (!locationChanged)
+            {
+                for (auto &typeGrid : SharedBELTypeBinGrid)
+                    typeGrid[binIdY][binIdX]->resetStatistics();
+                globalBinGrid[binIdY][binIdX]->resetStatistics();
+                continue;
+            }
+            for (auto &typeGrid : SharedBELTypeBinGrid)
+            {
+                auto curBin = typeGrid[binIdY][binIdX];
+                for (auto curCell : curBin->getCells())
+                    setCellBinInfo(curCell->getCellId(), -1, -1, -1, -1);
+                curBin->reset();
             }
+            auto globalBin = globalBinGrid[binIdY][binIdX];
+            for (auto curCell : globalBin->getCells())
+            {
+                cellId2CellBinInfo[curCell->getCellId()].globalX = -1;
+                cellId2CellBinInfo[curCell->getCellId()].globalY = -1;
+            }
+            globalBin->reset();
         }
     }
 
-    for (auto &tmpRow : globalBinGrid)
+    // refill the emptied bins in the visiting order
+    for (unsigned int visitOrder = 0; visitOrder < visitedCells.size(); visitOrder++)
     {
-        for (auto &curBin : tmpRow)
+        DesignInfo::DesignCell *curCell = visitedCells[visitOrder];
+        int binIdX = visitedCellBinIds[visitOrder].first;
+        int binIdY = visitedCellBinIds[visitOrder].second;
+        if (!binGridLocationChanged[binIdY * binGridNumX + binIdX])
+            continue;
+        float cellX = cellId2location[curCell->getCellId()].X;
+        float cellY = cellId2location[curCell->getCellId()].Y;
+        addCellIntoElementBinGrid(curCell, cellX, cellY, binIdX, binIdY);
+
+        if (curCell->isLUT() || curCell->isFF()) // currently we only resize LUT/FF
         {
-            assert(curBin);
-            curBin->reset();
+            assert(binIdY >= 0);
+            assert(binIdX >= 0);
+            assert((unsigned int)binIdY < globalBinGrid.size());
+            assert((unsigned int)binIdX < globalBinGrid[binIdY].size());
+            assert(globalBinGrid[binIdY][binIdX]->inRange(cellX, cellY));
+            globalBinGrid[binIdY][binIdX]->addCell(curCell, 0);
+            cellId2CellBinInfo[curCell->getCellId()].globalX = binIdX;
+            cellId2CellBinInfo[curCell->getCellId()].globalY = binIdY;
         }
     }
 
-    for (auto curPU : placementUnits)
+    // the pyramids are rebuilt after a full build, otherwise only the refilled bins are propagated up the levels
+    if (!incrementalUpdate || binPyramids.size() != SharedBELTypeBinGrid.size())
     {
-        if (auto curUnpackedCell = dynamic_cast<PlacementUnpackedCell *>(curPU))
+        invalidateBinPyramids();
+    }
+    else
+    {
+        std::vector<int> changedBinIds;
+        for (unsigned int binId = 0; binId < binGridLocationChanged.size(); binId++)
         {
-            int binIdX, binIdY;
-            float cellX = curUnpackedCell->X();
-            float cellY = curUnpackedCell->Y();
-            DesignInfo::DesignCell *curCell = curUnpackedCell->getCell();
-
-            if (curCell->isLUT() || curCell->isFF()) // currently we only resize LUT/FF
-            {
-                getGridXY(cellX, cellY, binIdX, binIdY);
-                assert(globalBinGrid[binIdY][binIdX]->inRange(cellX, cellY));
-                assert(binIdY >= 0);
-                assert(binIdX >= 0);
-                assert((unsigned int)binIdY < globalBinGrid.size());
-                assert((unsigned int)binIdX < globalBinGrid[binIdY].size());
-                globalBinGrid[binIdY][binIdX]->addCell(curCell, 0);
-            }
+            if (binGridLocationChanged[binId])
+                changedBinIds.push_back(binId);
         }
-        else if (auto curMacro = dynamic_cast<PlacementMacro *>(curPU))
+        for (unsigned int sharedTypeId = 0; sharedTypeId < SharedBELTypeBinGrid.size(); sharedTypeId++)
         {
-            for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
-            {
-                float offsetX_InMacro, offsetY_InMacro;
-                DesignInfo::DesignCellType cellType;
-                curMacro->getVirtualCellInfo(vId, offsetX_InMacro, offsetY_InMacro, cellType);
-                DesignInfo::DesignCell *curCell = curMacro->getCell(vId);
-                if (curCell->isLUT() || curCell->isFF()) // currently we only resize LUT/FF
-                {
-                    int binIdX, binIdY;
-                    float cellX = curMacro->X() + offsetX_InMacro;
-                    float cellY = curMacro->Y() + offsetY_InMacro;
-
-                    getGridXY(cellX, cellY, binIdX, binIdY);
-                    assert(globalBinGrid[binIdY][binIdX]->inRange(cellX, cellY));
-
-                    assert(binIdY >= 0);
-                    assert(binIdX >= 0);
-                    assert((unsigned int)binIdY < globalBinGrid.size());
-                    assert((unsigned int)binIdX < globalBinGrid[binIdY].size());
-                    globalBinGrid[binIdY][binIdX]->addCell(curCell, 0);
-                }
-            }
+            // the statistics of all the bins are reset, so none of them is touched by the spreader now
+            if (binPyramidValid[sharedTypeId])
+                binPyramids[sharedTypeId]->clearTouchedBins();
+            updateBinPyramid(sharedTypeId, changedBinIds);
         }
     }
+
+    std::fill(binGridLocationChanged.begin(), binGridLocationChanged.end(), 0);
+    cellId2BinGridVisitOrder.swap(cellId2VisitOrder);
 }
 
 void PlacementInfo::adjustLUTFFUtilization_Packablity(float neighborDisplacementUpperbound, bool enfore)
@@ -1004,13 +1060,14 @@ void PlacementInfo::adjustLUTFFUtilization_Packablity(float neighborDisplacement
     lastProgressWhenLUTFFUtilAdjust = getProgress();
 
     print_status("PlacementInfo: adjusting LUT/FF utilization based on Packablity");
+    resizeCellSlotTables();
     for (auto &curRow : LUTFFBinGrid)
         for (auto curBin : curRow)
             curBin->reset();
     // assign LUT/FF to bin grid to find their neighbors easily
     for (auto curPU : placementUnits)
     {
-        if (auto curUnpackedCell = dynamic_cast<PlacementUnpackedCell *>(curPU))
+        if (auto curUnpackedCell = asUnpackedCell(curPU))
         {
             int binIdX, binIdY;
             float cellX = curUnpackedCell->X();
@@ -1031,7 +1088,7 @@ void PlacementInfo::adjustLUTFFUtilization_Packablity(float neighborDisplacement
                 cellId2location[curCell->getCellId()].Y = cellY;
             }
         }
-        else if (auto curMacro = dynamic_cast<PlacementMacro *>(curPU))
+        else if (auto curMacro = asMacro(curPU))
         {
             for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
             {
@@ -1207,23 +1264,7 @@ void PlacementInfo::adjustLUTFFUtilization_Routability(bool enfore)
         assert((unsigned int)topBinY < globalBinGrid.size());
         assert((unsigned int)rightBinX < globalBinGrid[topBinY].size());
 
-        float totW = tmpNet->getHPWL(y2xRatio) + 0.5;
-        unsigned int nPins = tmpNet->getPinOffsetsInUnit().size();
-        if (nPins < 10)
-            totW *= 1.06;
-        else if (nPins < 20)
-            totW *= 1.2;
-        else if (nPins < 30)
-            totW *= 1.4;
-        else if (nPins < 50)
-            totW *= 1.6;
-        else if (nPins < 100)
-            totW *= 1.8;
-        else if (nPins < 200)
-            totW *= 2.1;
-        else
-            totW *= 3.0;
-
+        float totW = getNetRoutingDemand(tmpNet);
         int numGCell = (rightBinX - leftBinX + 1) * (topBinY - bottomBinY + 1) * binHeight * binWidth;
         float indW = totW / numGCell;
         for (int x = leftBinX; x <= rightBinX; ++x)
@@ -1403,6 +1444,182 @@ void PlacementInfo::adjustLUTFFUtilization_Routability_Reset()
     print_status("PlacementInfo: Routability-oriented area adjustion is reset.");
 }
 
+float PlacementInfo::getNetRoutingDemand(PlacementNet *net)
+{
+    float totW = net->getHPWL(y2xRatio) + 0.5;
+    unsigned int nPins = net->getPinOffsetsInUnit().size();
+    if (nPins < 10)
+        totW *= 1.06;
+    else if (nPins < 20)
+        totW *= 1.2;
+    else if (nPins < 30)
+        totW *= 1.4;
+    else if (nPins < 50)
+        totW *= 1.6;
+    else if (nPins < 100)
+        totW *= 1.8;
+    else if (nPins < 200)
+        totW *= 2.1;
+    else
+        totW *= 3.0;
+    return totW;
+}
+
+void PlacementInfo::updateRoutingDemandMap()
+{
+    int numY = globalBinGrid.size();
+    int numX = (numY > 0) ? globalBinGrid[0].size() : 0;
+    int numNets = placementNets.size();
+
+    // the map is rebuilt from scratch when the grid, the PlacementUnits or the nets are changed
+    bool rebuild = numX != routingDemandMapNumX || numY != routingDemandMapNumY ||
+                   (int)netId2RoutingDemandFootprint.size() != numNets || routingDemandMapPUs != placementUnits ||
+                   routingDemandMapNets != placementNets;
+    if (rebuild)
+    {
+        routingDemandMapNumX = numX;
+        routingDemandMapNumY = numY;
+        routingDemandDiff.assign((numY + 1) * (numX + 1), 0.0);
+        netId2RoutingDemandFootprint.assign(numNets, NetRoutingDemandFootprint());
+        routingDemandMapPUs = placementUnits;
+        routingDemandMapNets = placementNets;
+        routingDemandMapPULocs.assign(placementUnits.size(), std::pair<float, float>(0, 0));
+    }
+    if (numX == 0 || numY == 0)
+    {
+        routingDemandMap.clear();
+        return;
+    }
+
+    // only the nets connected to the moved PlacementUnits are re-evaluated
+    routingDemandNetMarks.assign(numNets, rebuild);
+    for (unsigned int PUId = 0; PUId < placementUnits.size(); PUId++)
+    {
+        auto curPU = placementUnits[PUId];
+        auto &lastLoc = routingDemandMapPULocs[PUId];
+        if (!rebuild && lastLoc.first == curPU->X() && lastLoc.second == curPU->Y())
+            continue;
+        lastLoc = std::pair<float, float>(curPU->X(), curPU->Y());
+        for (auto tmpNet : *curPU->getNetsSetPtr())
+            routingDemandNetMarks[tmpNet->getId()] = true;
+    }
+    routingDemandNetIdsToUpdate.clear();
+    for (int netId = 0; netId < numNets; netId++)
+    {
+        if (routingDemandNetMarks[netId])
+            routingDemandNetIdsToUpdate.push_back(netId);
+    }
+    int numNetsToUpdate = routingDemandNetIdsToUpdate.size();
+
+    newNetRoutingDemandFootprints.resize(numNets);
+#pragma omp parallel for schedule(dynamic, 256)
+    for (int i = 0; i < numNetsToUpdate; i++)
+    {
+        int netId = routingDemandNetIdsToUpdate[i];
+        auto tmpNet = placementNets[netId];
+        NetRoutingDemandFootprint &footprint = newNetRoutingDemandFootprints[netId];
+        footprint = NetRoutingDemandFootprint();
+        tmpNet->updateNetBounds(true, true);
+        if (tmpNet->getHPWL(y2xRatio) < eps)
+            continue;
+        getGridXY(tmpNet->getLeftPinX(), tmpNet->getBottomPinY(), footprint.leftBinX, footprint.bottomBinY);
+        getGridXY(tmpNet->getRightPinX(), tmpNet->getTopPinY(), footprint.rightBinX, footprint.topBinY);
+        footprint.leftBinX = std::max(0, std::min(footprint.leftBinX, numX - 1));
+        footprint.rightBinX = std::max(0, std::min(footprint.rightBinX, numX - 1));
+        footprint.bottomBinY = std::max(0, std::min(footprint.bottomBinY, numY - 1));
+        footprint.topBinY = std::max(0, std::min(footprint.topBinY, numY - 1));
+        float numGCell = (footprint.rightBinX - footprint.leftBinX + 1) *
+                         (footprint.topBinY - footprint.bottomBinY + 1) * binHeight * binWidth;
+        footprint.demandPerBin = getNetRoutingDemand(tmpNet) / numGCell;
+    }
+
+    // apply the changes in net order so the map is deterministic
+    int changedNetCnt = 0;
+    for (int netId : routingDemandNetIdsToUpdate)
+    {
+        if (netId2RoutingDemandFootprint[netId] == newNetRoutingDemandFootprints[netId])
+            continue;
+        applyNetRoutingDemandFootprint(netId2RoutingDemandFootprint[netId], -1.0);
+        applyNetRoutingDemandFootprint(newNetRoutingDemandFootprints[netId], 1.0);
+        netId2RoutingDemandFootprint[netId] = newNetRoutingDemandFootprints[netId];
+        changedNetCnt++;
+    }
+
+    routingDemandMap.assign(numY * numX, 0);
+    std::vector<double> columnSums(numX, 0.0);
+    for (int y = 0; y < numY; y++)
+    {
+        double rowSum = 0;
+        for (int x = 0; x < numX; x++)
+        {
+            rowSum += routingDemandDiff[y * (numX + 1) + x];
+            columnSums[x] += rowSum;
+            routingDemandMap[y * numX + x] = std::max(0.0, columnSums[x]);
+        }
+    }
+
+    print_info("PlacementInfo: routing demand map is updated with " + std::to_string(changedNetCnt) + "/" +
+               std::to_string(numNetsToUpdate) + "/" + std::to_string(numNets) + " changed/re-evaluated/all nets.");
+}
+
+void PlacementInfo::applyRoutingDemandToBinCapacity(float demandThreshold, float minCapacityRatio)
+{
+    auto LUTTypeBELIds = getPotentialBELTypeIDs(DesignInfo::CellType_LUT6);
+    std::vector<std::vector<PlacementInfo::PlacementBinInfo *>> &LUTBinGrid = getBinGrid(LUTTypeBELIds[0]);
+    auto FFTypeBELIds = getPotentialBELTypeIDs(DesignInfo::CellType_FDCE);
+    std::vector<std::vector<PlacementInfo::PlacementBinInfo *>> &FFBinGrid = getBinGrid(FFTypeBELIds[0]);
+
+    int congestedBinCnt = 0;
+    std::vector<int> changedBinIds;
+    for (int y = 0; y < routingDemandMapNumY && y < (int)LUTBinGrid.size(); y++)
+    {
+        for (int x = 0; x < routingDemandMapNumX && x < (int)LUTBinGrid[y].size(); x++)
+        {
+            float demand = getRoutingDemand(x, y);
+            float ratio = 1.0;
+            if (demand > demandThreshold)
+            {
+                ratio = std::max(minCapacityRatio, demandThreshold / demand);
+                congestedBinCnt++;
+            }
+            if (LUTBinGrid[y][x]->getCongestionCapacityRatio() == ratio &&
+                FFBinGrid[y][x]->getCongestionCapacityRatio() == ratio)
+                continue;
+            LUTBinGrid[y][x]->setCongestionCapacityRatio(ratio);
+            FFBinGrid[y][x]->setCongestionCapacityRatio(ratio);
+            changedBinIds.push_back(y * LUTBinGrid[y].size() + x);
+        }
+    }
+    updateBinPyramid(LUTTypeBELIds[0], changedBinIds);
+    updateBinPyramid(FFTypeBELIds[0], changedBinIds);
+    print_info("PlacementInfo: " + std::to_string(congestedBinCnt) +
+               " LUT/FF bins are shrunk according to the routing demand map.");
+}
+
+void PlacementInfo::resetCongestionCapacityRatios()
+{
+    auto LUTTypeBELIds = getPotentialBELTypeIDs(DesignInfo::CellType_LUT6);
+    auto FFTypeBELIds = getPotentialBELTypeIDs(DesignInfo::CellType_FDCE);
+    for (auto sharedTypeId : {LUTTypeBELIds[0], FFTypeBELIds[0]})
+    {
+        std::vector<int> changedBinIds;
+        auto &curBinGrid = getBinGrid(sharedTypeId);
+        for (unsigned int y = 0; y < curBinGrid.size(); y++)
+        {
+            for (unsigned int x = 0; x < curBinGrid[y].size(); x++)
+            {
+                auto curBin = curBinGrid[y][x];
+                assert(curBin);
+                if (curBin->getCongestionCapacityRatio() == 1)
+                    continue;
+                curBin->setCongestionCapacityRatio(1);
+                changedBinIds.push_back(y * curBinGrid[y].size() + x);
+            }
+        }
+        updateBinPyramid(sharedTypeId, changedBinIds);
+    }
+}
+
 void PlacementInfo::adjustLUTFFUtilization(float neighborDisplacementUpperbound, bool enfore)
 {
     if (neighborDisplacementUpperbound > 0)
@@ -1646,9 +1863,7 @@ void PlacementInfo::loadPlacementUnitInformation(std::string locFile)
     placementMacros.clear();
     cellInMacros.clear();
     placementUnpackedCells.clear();
-    cellId2PlacementUnitVec.clear();
-    cellId2PlacementUnitVec.resize(getCells().size(), nullptr);
-    cellId2PlacementUnit.clear();
+    clearPlacementUnitsOfCells();
     PU2LegalSites.clear();
     LUTFFUtilizationAdjusted = false;
 
@@ -1761,9 +1976,7 @@ void PlacementInfo::loadPlacementUnitInformation(std::string locFile)
                 totalWeight +=
                     getCompatiblePlacementTable()
                         ->cellType2sharedBELTypeOccupation[static_cast<DesignInfo::DesignCellType>(virtualCellTypeId)];
-                cellId2PlacementUnit[cellId] = tmpPU;
-                assert(cellId < cellId2PlacementUnitVec.size());
-                cellId2PlacementUnitVec[cellId] = tmpPU;
+                setPlacementUnitOfCell(cellId, tmpPU);
                 cellInMacros.insert(getCells()[cellId]);
             }
             tmpPU->setWeight(totalWeight);
@@ -1803,8 +2016,7 @@ void PlacementInfo::loadPlacementUnitInformation(std::string locFile)
                 getCompatiblePlacementTable()->cellType2sharedBELTypeOccupation[getCells()[cellId]->getCellType()]);
             placementUnits.push_back(tmpPU);
             placementUnpackedCells.push_back(tmpPU);
-            cellId2PlacementUnitVec[cellId] = tmpPU;
-            cellId2PlacementUnit[cellId] = tmpPU;
+            setPlacementUnitOfCell(cellId, tmpPU);
 
             std::getline(infile, line);
             iss = std::istringstream(line);
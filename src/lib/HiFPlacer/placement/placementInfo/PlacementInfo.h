@@ -20,9 +20,11 @@
 #include "Eigen/Core"
 #include "Eigen/SparseCore"
 #include "dumpZip.h"
+#include <algorithm>
 #include <assert.h>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <mutex>
 #include <queue>
@@ -457,8 +459,13 @@ class PlacementInfo
         inline void addCell(DesignInfo::DesignCell *cell, int occupationAdded)
         {
             mtx.lock();
-            assert(cells.find(cell) == cells.end());
-            cells.insert(cell);
+            assert(!containsWithoutLock(cell));
+            if (cellId2SlotInBin)
+            {
+                assert((unsigned int)cell->getCellId() < cellId2SlotInBin->size());
+                (*cellId2SlotInBin)[cell->getCellId()] = cells.size();
+            }
+            cells.push_back(cell);
             assert(occupationAdded >= 0);
             utilization += occupationAdded;
             mtx.unlock();
@@ -477,8 +484,21 @@ class PlacementInfo
         {
             // if (cell)
             mtx.lock();
-            assert(cells.find(cell) != cells.end());
-            cells.erase(cell);
+            assert(containsWithoutLock(cell));
+            int slot;
+            if (cellId2SlotInBin)
+                slot = (*cellId2SlotInBin)[cell->getCellId()];
+            else
+                slot = std::find(cells.begin(), cells.end(), cell) - cells.begin();
+            // the order of cells in a bin is not important, so we swap it with the last one and pop
+            DesignInfo::DesignCell *lastCell = cells.back();
+            cells[slot] = lastCell;
+            cells.pop_back();
+            if (cellId2SlotInBin)
+            {
+                (*cellId2SlotInBin)[lastCell->getCellId()] = slot;
+                (*cellId2SlotInBin)[cell->getCellId()] = -1;
+            }
             utilization -= occupationAdded;
             assert(utilization >= 0);
             mtx.unlock();
@@ -487,13 +507,50 @@ class PlacementInfo
         inline bool contains(DesignInfo::DesignCell *cell)
         {
             // if (cell)
-            return cells.find(cell) != cells.end();
+            return containsWithoutLock(cell);
+        }
+
+        /**
+         * @brief Set the table recording the slot of each cell in the cell vector of its bin
+         *
+         * The table is shared by all the bins in a bin grid (a cell can be in only one bin of the grid), so the
+         * cells can be removed from the bins in O(1) time. Without the table, the cell will be searched linearly.
+         *
+         * @param _cellId2SlotInBin the table owned by PlacementInfo, indexed by cell Id
+         */
+        inline void setCellSlotTable(std::vector<int> *_cellId2SlotInBin)
+        {
+            cellId2SlotInBin = _cellId2SlotInBin;
         }
 
         inline void reset()
         {
             cells.clear();
             utilization = 0;
+            filledShrinkRatio = requiredBinShrinkRatio;
+            resetStatistics();
+        }
+
+        /**
+         * @brief check whether the required shrink ratio is changed since the bin is reset and filled, in which case
+         * the first-fit of the cells into the bins might be different
+         *
+         * @return true if the required shrink ratio is changed
+         */
+        inline bool isRequiredBinShrinkRatioChanged()
+        {
+            return filledShrinkRatio != requiredBinShrinkRatio;
+        }
+
+        /**
+         * @brief reset the shrink ratio, the overflow counters and the routing demand/supply of the bin but keep the
+         * cells in it
+         *
+         * It is used by the incremental update of the bin grid, where only the cells moved to other bins are updated.
+         *
+         */
+        inline void resetStatistics()
+        {
             binShrinkRatio = requiredBinShrinkRatio;
             overflowCnt = 0;
             noOverflowCnt = 0;
@@ -544,11 +601,11 @@ class PlacementInfo
         }
 
         /**
-         * @brief Get the reference of the set of cells in the bin
+         * @brief Get the reference of the cells in the bin
          *
-         * @return std::set<DesignInfo::DesignCell *>&
+         * @return std::vector<DesignInfo::DesignCell *>&
          */
-        inline std::set<DesignInfo::DesignCell *> &getCells()
+        inline std::vector<DesignInfo::DesignCell *> &getCells()
         {
             return cells;
         }
@@ -559,7 +616,24 @@ class PlacementInfo
         }
 
         /**
-         * @brief Get the Utilization Rate: utilization / (capacity * binShrinkRatio)
+         * @brief Set the ratio of the resource capacity left for the cells according to the routing demand of the bin
+         *
+         * It is set by congestion-aware spreading so the spreader sees the congested bins as smaller ones.
+         *
+         * @param r
+         */
+        inline void setCongestionCapacityRatio(float r)
+        {
+            congestionCapacityRatio = r;
+        }
+
+        inline float getCongestionCapacityRatio()
+        {
+            return congestionCapacityRatio;
+        }
+
+        /**
+         * @brief Get the Utilization Rate: utilization / (capacity * binShrinkRatio * congestionCapacityRatio)
          *
          * @return float
          */
@@ -568,7 +642,7 @@ class PlacementInfo
             if (capacity == 0)
                 return utilization / 0.01;
             assert(capacity != 0);
-            return (float)utilization / (capacity * binShrinkRatio);
+            return (float)utilization / (capacity * binShrinkRatio * congestionCapacityRatio);
         }
 
         /**
@@ -614,7 +688,17 @@ class PlacementInfo
 
         inline float getCapacity()
         {
-            return (float)capacity * binShrinkRatio;
+            return (float)capacity * binShrinkRatio * congestionCapacityRatio;
+        }
+
+        /**
+         * @brief get the resource capacity of the bin without the shrink ratio, which is used by isOverflow()
+         *
+         * @return float
+         */
+        inline float getUnshrunkCapacity()
+        {
+            return (float)capacity * congestionCapacityRatio;
         }
 
         /**
@@ -635,7 +719,7 @@ class PlacementInfo
             }
             assert(utilization >= 0);
             assert(capacity != 0);
-            return ((float)utilization / (capacity)) > overflowThreshold + eps;
+            return ((float)utilization / (capacity * congestionCapacityRatio)) > overflowThreshold + eps;
             // return ((float)utilization / (binShrinkRatio * capacity)) > overflowThreshold + eps;
         }
 
@@ -812,13 +896,50 @@ class PlacementInfo
         std::string sharedCellType;
         std::vector<DeviceInfo::DeviceSite *> correspondingSites;
         CompatiblePlacementTable *compatiblePlacementTable;
-        std::set<DesignInfo::DesignCell *> cells;
+
+        /**
+         * @brief the cells in the bin
+         *
+         * a flat vector is cheaper than a std::set for the frequent insertion/removal/iteration of the small set of
+         * cells in a bin
+         */
+        std::vector<DesignInfo::DesignCell *> cells;
+
+        /**
+         * @brief the slot of each cell in the cell vector of its bin (shared by the bins in a bin grid)
+         *
+         */
+        std::vector<int> *cellId2SlotInBin = nullptr;
+
+        inline bool containsWithoutLock(DesignInfo::DesignCell *cell)
+        {
+            if (cellId2SlotInBin)
+            {
+                if ((unsigned int)cell->getCellId() >= cellId2SlotInBin->size())
+                    return false;
+                int slot = (*cellId2SlotInBin)[cell->getCellId()];
+                return slot >= 0 && (unsigned int)slot < cells.size() && cells[slot] == cell;
+            }
+            return std::find(cells.begin(), cells.end(), cell) != cells.end();
+        }
 
         int capacity = 0;
         int utilization = 0;
         float binShrinkRatio = 1.0;
         float requiredBinShrinkRatio = 1.0;
 
+        /**
+         * @brief the required shrink ratio when the bin is reset and filled by updateElementBinGrid()
+         *
+         */
+        float filledShrinkRatio = 1.0;
+
+        /**
+         * @brief the ratio of the capacity left for the cells due to the routing demand (1 if it is not congested)
+         *
+         */
+        float congestionCapacityRatio = 1.0;
+
         const float leftX;
         const float rightX;
         const float topY;
@@ -838,11 +959,316 @@ class PlacementInfo
         int clockRegionX = -1;
     };
 
+    /**
+     * @brief PlacementBinPyramid is a multi-resolution view of the bin grid of a shared BEL type
+     *
+     * Level 0 mirrors the bins in the grid and each node of level k (k>0) merges the 2x2 nodes of level k-1, so the
+     * node (x, y) of level k covers the bins whose grid coordinates are (x<<k ... , y<<k ...). Each node records the
+     * total capacity and utilization of its bins and the maximum utilization rate among its bins. The pyramid can be
+     * updated incrementally when a bin changes, so overflow bins can be located by descending only into the coarse
+     * nodes containing overflow instead of scanning the whole grid. Each node also records whether some of its bins
+     * have been touched (e.g., their overflow counters are updated by the spreader), so the touched bins can be found
+     * and reset in the same way.
+     *
+     * The pyramid only aggregates the capacity and utilization of the bins. The search of the neighbor LUTs/FFs of a
+     * cell (findNeiborLUTFFsFromBinGrid()) needs the cells and their attributes (pins, control sets) within a
+     * distance, so it still walks the bins around the cell.
+     *
+     */
+    class PlacementBinPyramid
+    {
+      public:
+        PlacementBinPyramid(std::vector<std::vector<PlacementBinInfo *>> &binGrid) : binGrid(binGrid)
+        {
+            int numX = binGrid.size() ? binGrid[0].size() : 0;
+            int numY = binGrid.size();
+            while (true)
+            {
+                levels.emplace_back();
+                PyramidLevel &curLevel = levels.back();
+                curLevel.numX = numX;
+                curLevel.numY = numY;
+                curLevel.capacity.resize(numX * numY, 0);
+                curLevel.utilization.resize(numX * numY, 0);
+                curLevel.maxBinUtilizationRate.resize(numX * numY, 0);
+                curLevel.touched.resize(numX * numY, 0);
+                if (numX <= 1 && numY <= 1)
+                    break;
+                numX = (numX + 1) / 2;
+                numY = (numY + 1) / 2;
+            }
+        }
+
+        ~PlacementBinPyramid()
+        {
+        }
+
+        /**
+         * @brief rebuild all the levels of the pyramid from the bins
+         *
+         */
+        void rebuild()
+        {
+            clearTouchedBins();
+            PyramidLevel &binLevel = levels[0];
+            for (int y = 0; y < binLevel.numY; y++)
+                for (int x = 0; x < binLevel.numX; x++)
+                    loadBin(x, y);
+            for (unsigned int level = 1; level < levels.size(); level++)
+                for (int y = 0; y < levels[level].numY; y++)
+                    for (int x = 0; x < levels[level].numX; x++)
+                        mergeChildren(level, x, y);
+        }
+
+        /**
+         * @brief update the nodes covering a bin whose utilization has been changed
+         *
+         * @param binX the column of the bin in the grid
+         * @param binY the row of the bin in the grid
+         */
+        void updateBin(int binX, int binY)
+        {
+            loadBin(binX, binY);
+            for (unsigned int level = 1; level < levels.size(); level++)
+            {
+                binX >>= 1;
+                binY >>= 1;
+                mergeChildren(level, binX, binY);
+            }
+        }
+
+        /**
+         * @brief update the nodes covering a set of bins whose capacity/utilization have been changed
+         *
+         * The changed bins are loaded and then the changes are propagated up level by level, where each changed node
+         * is merged only once even if several of its children are changed.
+         *
+         * @param binIds the changed bins (binY * numX + binX), which will be overwritten
+         */
+        void updateBins(std::vector<int> &binIds)
+        {
+            for (auto binId : binIds)
+                loadBin(binId % levels[0].numX, binId / levels[0].numX);
+            std::vector<int> parentIds;
+            for (unsigned int level = 1; level < levels.size() && binIds.size(); level++)
+            {
+                parentIds.clear();
+                for (auto nodeId : binIds)
+                {
+                    int parentX = (nodeId % levels[level - 1].numX) >> 1;
+                    int parentY = (nodeId / levels[level - 1].numX) >> 1;
+                    parentIds.push_back(parentY * levels[level].numX + parentX);
+                }
+                std::sort(parentIds.begin(), parentIds.end());
+                parentIds.erase(std::unique(parentIds.begin(), parentIds.end()), parentIds.end());
+                for (auto nodeId : parentIds)
+                    mergeChildren(level, nodeId % levels[level].numX, nodeId / levels[level].numX);
+                binIds.swap(parentIds);
+            }
+        }
+
+        /**
+         * @brief mark a bin as touched, together with the nodes covering it
+         *
+         * @param binX the column of the bin in the grid
+         * @param binY the row of the bin in the grid
+         */
+        void markBinTouched(int binX, int binY)
+        {
+            for (unsigned int level = 0; level < levels.size(); level++, binX >>= 1, binY >>= 1)
+            {
+                unsigned char &touched = levels[level].touched[binY * levels[level].numX + binX];
+                if (touched)
+                    break;
+                touched = 1;
+            }
+        }
+
+        /**
+         * @brief clear the touched marks of all the bins
+         *
+         */
+        void clearTouchedBins()
+        {
+            for (auto &curLevel : levels)
+                std::fill(curLevel.touched.begin(), curLevel.touched.end(), 0);
+        }
+
+        /**
+         * @brief find the touched bins by descending from the top level into the touched nodes, and clear the marks
+         *
+         * @param touchedBins the found touched bins
+         */
+        void collectAndClearTouchedBins(std::vector<PlacementBinInfo *> &touchedBins)
+        {
+            touchedBins.clear();
+            if (levels.back().touched.empty())
+                return;
+            collectAndClearTouchedBins(levels.size() - 1, 0, 0, touchedBins);
+        }
+
+        /**
+         * @brief find the overflow bins by descending from the top level into the nodes containing overflow bins
+         *
+         * The bins are returned in the order of the depth-first descent.
+         *
+         * @param overflowThreshold the threshold of PlacementBinInfo::isOverflow()
+         * @param overflowBins the found overflow bins
+         */
+        void collectOverflowBins(float overflowThreshold, std::vector<PlacementBinInfo *> &overflowBins)
+        {
+            overflowBins.clear();
+            if (levels.back().capacity.empty())
+                return;
+            collectOverflowBins(levels.size() - 1, 0, 0, overflowThreshold, overflowBins);
+        }
+
+        inline int getLevelNum()
+        {
+            return levels.size();
+        }
+
+        inline int getNumX(int level)
+        {
+            return levels[level].numX;
+        }
+
+        inline int getNumY(int level)
+        {
+            return levels[level].numY;
+        }
+
+        /**
+         * @brief get the total capacity of the bins covered by a node
+         *
+         * @param level the level of the node
+         * @param x the column of the node in the level
+         * @param y the row of the node in the level
+         * @return float
+         */
+        inline float getCapacity(int level, int x, int y)
+        {
+            return levels[level].capacity[y * levels[level].numX + x];
+        }
+
+        /**
+         * @brief get the total utilization of the bins covered by a node
+         *
+         * @param level the level of the node
+         * @param x the column of the node in the level
+         * @param y the row of the node in the level
+         * @return float
+         */
+        inline float getUtilization(int level, int x, int y)
+        {
+            return levels[level].utilization[y * levels[level].numX + x];
+        }
+
+        /**
+         * @brief get the maximum utilization rate (utilization/capacity) among the bins covered by a node
+         *
+         * @param level the level of the node
+         * @param x the column of the node in the level
+         * @param y the row of the node in the level
+         * @return float
+         */
+        inline float getMaxBinUtilizationRate(int level, int x, int y)
+        {
+            return levels[level].maxBinUtilizationRate[y * levels[level].numX + x];
+        }
+
+      private:
+        struct PyramidLevel
+        {
+            int numX = 0;
+            int numY = 0;
+            std::vector<float> capacity;
+            std::vector<float> utilization;
+            std::vector<float> maxBinUtilizationRate;
+            std::vector<unsigned char> touched;
+        };
+
+        inline void loadBin(int binX, int binY)
+        {
+            PyramidLevel &binLevel = levels[0];
+            PlacementBinInfo *curBin = binGrid[binY][binX];
+            int nodeId = binY * binLevel.numX + binX;
+            float capacity = curBin->getUnshrunkCapacity();
+            float utilization = curBin->getUtilization();
+            binLevel.capacity[nodeId] = capacity;
+            binLevel.utilization[nodeId] = utilization;
+            if (capacity == 0)
+                binLevel.maxBinUtilizationRate[nodeId] = (utilization == 0) ? 0 : std::numeric_limits<float>::max();
+            else
+                binLevel.maxBinUtilizationRate[nodeId] = utilization / capacity;
+        }
+
+        inline void mergeChildren(int level, int x, int y)
+        {
+            PyramidLevel &curLevel = levels[level];
+            PyramidLevel &childLevel = levels[level - 1];
+            int nodeId = y * curLevel.numX + x;
+            float capacity = 0, utilization = 0, maxRate = 0;
+            for (int childY = 2 * y; childY <= 2 * y + 1 && childY < childLevel.numY; childY++)
+            {
+                for (int childX = 2 * x; childX <= 2 * x + 1 && childX < childLevel.numX; childX++)
+                {
+                    int childId = childY * childLevel.numX + childX;
+                    capacity += childLevel.capacity[childId];
+                    utilization += childLevel.utilization[childId];
+                    maxRate = std::max(maxRate, childLevel.maxBinUtilizationRate[childId]);
+                }
+            }
+            curLevel.capacity[nodeId] = capacity;
+            curLevel.utilization[nodeId] = utilization;
+            curLevel.maxBinUtilizationRate[nodeId] = maxRate;
+        }
+
+        void collectOverflowBins(int level, int x, int y, float overflowThreshold,
+                                 std::vector<PlacementBinInfo *> &overflowBins)
+        {
+            PyramidLevel &curLevel = levels[level];
+            if (curLevel.maxBinUtilizationRate[y * curLevel.numX + x] <= overflowThreshold)
+                return;
+            if (level == 0)
+            {
+                if (binGrid[y][x]->isOverflow(overflowThreshold))
+                    overflowBins.push_back(binGrid[y][x]);
+                return;
+            }
+            PyramidLevel &childLevel = levels[level - 1];
+            for (int childY = 2 * y; childY <= 2 * y + 1 && childY < childLevel.numY; childY++)
+                for (int childX = 2 * x; childX <= 2 * x + 1 && childX < childLevel.numX; childX++)
+                    collectOverflowBins(level - 1, childX, childY, overflowThreshold, overflowBins);
+        }
+
+        void collectAndClearTouchedBins(int level, int x, int y, std::vector<PlacementBinInfo *> &touchedBins)
+        {
+            unsigned char &touched = levels[level].touched[y * levels[level].numX + x];
+            if (!touched)
+                return;
+            touched = 0;
+            if (level == 0)
+            {
+                touchedBins.push_back(binGrid[y][x]);
+                return;
+            }
+            PyramidLevel &childLevel = levels[level - 1];
+            for (int childY = 2 * y; childY <= 2 * y + 1 && childY < childLevel.numY; childY++)
+                for (int childX = 2 * x; childX <= 2 * x + 1 && childX < childLevel.numX; childX++)
+                    collectAndClearTouchedBins(level - 1, childX, childY, touchedBins);
+        }
+
+        std::vector<std::vector<PlacementBinInfo *>> &binGrid;
+        std::vector<PyramidLevel> levels;
+    };
+
     /**
      * @brief BEL bin for global placement for multiple specific shared BEL types
      *
-     * This bin class is not for a specific cell type.
-     * It is not used in the current implementation.
+     * This bin class is not for a specific cell type. It merges the bins of several shared BEL types at the same
+     * location of their bin grids (e.g., LUT and FF, which share the SLICE sites) so their capacity can be considered
+     * jointly, e.g., by the fused LUT/FF spreading of GeneralSpreader.
      */
     class PlacementHybridBinInfo
     {
@@ -873,25 +1299,140 @@ class PlacementInfo
             return (y <= topY && y > bottomY);
         }
 
+        /**
+         * @brief merge the bin of another shared BEL type at the same location into this hybrid bin
+         *
+         * @param curBin
+         */
+        inline void mergeBin(PlacementBinInfo *curBin)
+        {
+            assert(curBin->X() == column && curBin->Y() == row);
+            mergedBins.push_back(curBin);
+        }
+
+        inline std::vector<PlacementBinInfo *> &getMergedBins()
+        {
+            return mergedBins;
+        }
+
+        /**
+         * @brief get the coupled capacity of the merged bins, which is measured in the unit of the first merged bin
+         *
+         * @return float
+         */
+        inline float getCoupledCapacity()
+        {
+            return mergedBins[0]->getCapacity();
+        }
+
+        /**
+         * @brief get the coupled utilization of the merged bins in the unit of the first merged bin
+         *
+         * The merged bins share the same sites so the sites are as occupied as the most utilized resource type: the
+         * utilization of each merged bin is scaled to the capacity of the first one and the maximum is taken.
+         *
+         * @return float
+         */
+        inline float getCoupledUtilization()
+        {
+            float coupledCapacity = mergedBins[0]->getCapacity();
+            float coupledUtilization = mergedBins[0]->getUtilization();
+            for (unsigned int binId = 1; binId < mergedBins.size(); binId++)
+            {
+                float binCapacity = mergedBins[binId]->getCapacity();
+                float scaledUtilization = mergedBins[binId]->getUtilization();
+                if (binCapacity > eps)
+                    scaledUtilization *= coupledCapacity / binCapacity;
+                coupledUtilization = std::max(coupledUtilization, scaledUtilization);
+            }
+            return coupledUtilization;
+        }
+
+        /**
+         * @brief get the utilization rate of the most utilized merged bin
+         *
+         * @return float
+         */
+        inline float getCoupledUtilizationRate()
+        {
+            float rate = 0;
+            for (auto curBin : mergedBins)
+                rate = std::max(rate, curBin->getUtilizationRate());
+            return rate;
+        }
+
+        /**
+         * @brief check whether any of the merged bins is overflowed
+         *
+         * @param overflowThreshold the threshold of PlacementBinInfo::isOverflow()
+         * @return true if some resource type in the hybrid bin is overflowed
+         */
+        inline bool isCoupledOverflow(float overflowThreshold)
+        {
+            for (auto curBin : mergedBins)
+                if (curBin->isOverflow(overflowThreshold))
+                    return true;
+            return false;
+        }
+
         inline void addCell(DesignInfo::DesignCell *cell, int occupationAdded)
         {
             // if (cell)
-            cells.insert(cell);
+            assert(!contains(cell));
+            if (cellId2SlotInBin)
+            {
+                assert((unsigned int)cell->getCellId() < cellId2SlotInBin->size());
+                (*cellId2SlotInBin)[cell->getCellId()] = cells.size();
+            }
+            cells.push_back(cell);
             utilization += occupationAdded;
         }
 
         inline void removeCell(DesignInfo::DesignCell *cell, int occupationAdded)
         {
             // if (cell)
-            assert(cells.find(cell) != cells.end());
-            cells.erase(cell);
+            assert(contains(cell));
+            int slot;
+            if (cellId2SlotInBin)
+                slot = (*cellId2SlotInBin)[cell->getCellId()];
+            else
+                slot = std::find(cells.begin(), cells.end(), cell) - cells.begin();
+            // the order of cells in a bin is not important, so we swap it with the last one and pop
+            DesignInfo::DesignCell *lastCell = cells.back();
+            cells[slot] = lastCell;
+            cells.pop_back();
+            if (cellId2SlotInBin)
+            {
+                (*cellId2SlotInBin)[lastCell->getCellId()] = slot;
+                (*cellId2SlotInBin)[cell->getCellId()] = -1;
+            }
             utilization -= occupationAdded;
         }
 
         inline bool contains(DesignInfo::DesignCell *cell)
         {
             // if (cell)
-            return cells.find(cell) != cells.end();
+            if (cellId2SlotInBin)
+            {
+                if ((unsigned int)cell->getCellId() >= cellId2SlotInBin->size())
+                    return false;
+                int slot = (*cellId2SlotInBin)[cell->getCellId()];
+                return slot >= 0 && (unsigned int)slot < cells.size() && cells[slot] == cell;
+            }
+            return std::find(cells.begin(), cells.end(), cell) != cells.end();
+        }
+
+        /**
+         * @brief Set the table recording the slot of each cell in the cell vector of its hybrid bin
+         *
+         * As PlacementBinInfo::setCellSlotTable(), the table is shared by all the hybrid bins in a grid, so the cells
+         * can be found and removed in O(1) time. Without the table, the cell will be searched linearly.
+         *
+         * @param _cellId2SlotInBin the table owned by the creator of the hybrid bins, indexed by cell Id
+         */
+        inline void setCellSlotTable(std::vector<int> *_cellId2SlotInBin)
+        {
+            cellId2SlotInBin = _cellId2SlotInBin;
         }
 
         inline void reset()
@@ -900,7 +1441,7 @@ class PlacementInfo
             utilization = 0;
         }
 
-        inline std::set<DesignInfo::DesignCell *> &getCells()
+        inline std::vector<DesignInfo::DesignCell *> &getCells()
         {
             return cells;
         }
@@ -977,7 +1518,13 @@ class PlacementInfo
       private:
         std::vector<DeviceInfo::DeviceSite *> correspondingSites;
         std::vector<PlacementBinInfo *> mergedBins;
-        std::set<DesignInfo::DesignCell *> cells;
+        std::vector<DesignInfo::DesignCell *> cells;
+
+        /**
+         * @brief the slot of each cell in the cell vector of its hybrid bin (shared by the hybrid bins in a grid)
+         *
+         */
+        std::vector<int> *cellId2SlotInBin = nullptr;
         int capacity = 0;
         int utilization = 0;
         float binShrinkRatio = 1.0;
@@ -1788,6 +2335,33 @@ class PlacementInfo
         PlacementMacroType macroType;
     };
 
+    /**
+     * @brief cast a PlacementUnit to PlacementUnpackedCell according to its type tag
+     *
+     * It is a cheaper replacement of dynamic_cast in the hot loops of spreading and bin grid updating.
+     *
+     * @param curPU a non-null PlacementUnit
+     * @return PlacementUnpackedCell* nullptr if the PlacementUnit is not an unpacked cell
+     */
+    static inline PlacementUnpackedCell *asUnpackedCell(PlacementUnit *curPU)
+    {
+        assert(curPU);
+        return (curPU->getType() == PlacementUnitType_UnpackedCell) ? static_cast<PlacementUnpackedCell *>(curPU)
+                                                                    : nullptr;
+    }
+
+    /**
+     * @brief cast a PlacementUnit to PlacementMacro according to its type tag
+     *
+     * @param curPU a non-null PlacementUnit
+     * @return PlacementMacro* nullptr if the PlacementUnit is not a macro
+     */
+    static inline PlacementMacro *asMacro(PlacementUnit *curPU)
+    {
+        assert(curPU);
+        return (curPU->getType() == PlacementUnitType_Macro) ? static_cast<PlacementMacro *>(curPU) : nullptr;
+    }
+
     /**
      * @brief Placement net, compared to design net, includes information related to placement.
      *
@@ -1837,7 +2411,7 @@ class PlacementInfo
                 }
                 else if (tmpPU->getType() == PlacementUnitType_Macro)
                 {
-                    PlacementMacro *tmpM = dynamic_cast<PlacementMacro *>(tmpPU);
+                    PlacementMacro *tmpM = asMacro(tmpPU);
                     assert(tmpM);
                     pinOffset tmpPinOffset =
                         pinOffset(curPin->getOffsetXInCell() + tmpM->getCellOffsetXInMacro(curPin->getCell()),
@@ -2630,6 +3204,8 @@ class PlacementInfo
                 delete curBin;
         for (auto pn : placementNets)
             delete pn;
+        for (auto binPyramid : binPyramids)
+            delete binPyramid;
     }
 
     void printStat(bool verbose = false);
@@ -3026,6 +3602,60 @@ class PlacementInfo
         return SharedBELTypeBinGrid[BELTypeId];
     }
 
+    /**
+     * @brief Get the multi-resolution view of the bin grid of a shared BEL type
+     *
+     * The pyramid is rebuilt lazily after the bin grid is built from scratch. Then the changes of the bins are
+     * propagated up the levels incrementally, when cells are transferred between bins by transferCellBinInfo(), when
+     * the bins at some locations are refilled by updateElementBinGrid() and when the capacity of the bins is changed
+     * according to the routing demand.
+     *
+     * @param BELTypeId the shared BEL type id
+     * @return PlacementBinPyramid*
+     */
+    inline PlacementBinPyramid *getBinPyramid(unsigned int BELTypeId)
+    {
+        assert(BELTypeId < SharedBELTypeBinGrid.size());
+        if (binPyramids.size() != SharedBELTypeBinGrid.size())
+            invalidateBinPyramids();
+        if (!binPyramidValid[BELTypeId])
+        {
+            binPyramids[BELTypeId]->rebuild();
+            binPyramidValid[BELTypeId] = 1;
+        }
+        return binPyramids[BELTypeId];
+    }
+
+    /**
+     * @brief propagate the changes of some bins of a shared BEL type up its pyramid, if the pyramid is valid
+     *
+     * @param BELTypeId the shared BEL type id
+     * @param binIds the changed bins (binY * numX + binX)
+     */
+    inline void updateBinPyramid(unsigned int BELTypeId, std::vector<int> binIds)
+    {
+        if (BELTypeId < binPyramidValid.size() && binPyramidValid[BELTypeId] && binIds.size())
+            binPyramids[BELTypeId]->updateBins(binIds);
+    }
+
+    /**
+     * @brief mark all the bin pyramids to be rebuilt when they are used next time
+     *
+     * The pyramids are created here, so the spreaders of different shared BEL types can rebuild their own pyramids
+     * concurrently later.
+     *
+     */
+    inline void invalidateBinPyramids()
+    {
+        binPyramids.resize(SharedBELTypeBinGrid.size(), nullptr);
+        binPyramidValid.assign(SharedBELTypeBinGrid.size(), 0);
+        for (unsigned int BELTypeId = 0; BELTypeId < SharedBELTypeBinGrid.size(); BELTypeId++)
+        {
+            if (!binPyramids[BELTypeId])
+                binPyramids[BELTypeId] = new PlacementBinPyramid(SharedBELTypeBinGrid[BELTypeId]);
+        }
+    }
+
     /**
      * @brief Get the Bin Grid object for all types of BEL
      *
@@ -3055,6 +3685,34 @@ class PlacementInfo
         return cellId2PlacementUnitVec[cellId];
     }
 
+    /**
+     * @brief bind a cell to a PlacementUnit in both the cellId-to-PlacementUnit map and the flat lookup table
+     *
+     * The packers should use it when they regenerate PlacementUnit(s) so getPlacementUnitByCell() keeps consistent.
+     *
+     * @param cellId the id of the cell
+     * @param curPU the PlacementUnit containing the cell
+     */
+    inline void setPlacementUnitOfCell(int cellId, PlacementUnit *curPU)
+    {
+        assert(cellId >= 0);
+        cellId2PlacementUnit[cellId] = curPU;
+        if ((unsigned int)cellId >= cellId2PlacementUnitVec.size())
+            cellId2PlacementUnitVec.resize(std::max(cellId + 1, designInfo->getNumCells()), nullptr);
+        cellId2PlacementUnitVec[cellId] = curPU;
+    }
+
+    /**
+     * @brief unbind all the cells from their PlacementUnits in both the cellId-to-PlacementUnit map and the flat lookup
+     * table, e.g., before the PlacementUnits are regenerated
+     *
+     */
+    inline void clearPlacementUnitsOfCells()
+    {
+        cellId2PlacementUnit.clear();
+        cellId2PlacementUnitVec.assign(designInfo->getNumCells(), nullptr);
+    }
+
     /**
      * @brief directly set weight in the quadratic Matrix and vector according to given request.
      *
@@ -3170,6 +3828,16 @@ class PlacementInfo
     /**
      * @brief map design cells to the bins in the bin grid.
      *
+     * The bin grid is maintained incrementally. A full build adds the cells to the bins in the order of the
+     * PlacementUnits, and each cell goes to the first potential shared BEL type whose bin can accommodate it, so the
+     * bins at a grid location only depend on the sequence of cells at the location. Once the grid is built, a location
+     * is marked as changed when a cell enters or leaves it (moved, transferred by transferCellBinInfo(), or removed
+     * from the PlacementUnits), when the resource demand or the visiting order of a cell in it is changed, or when the
+     * required shrink ratio of its bins is changed. Only the bins at the changed locations are emptied and refilled in
+     * the visiting order, so the bins (including the order of the cells in them) are the same as those of a full build
+     * while the unchanged locations are not touched. The changes of the refilled bins are then propagated up the bin
+     * pyramids instead of rebuilding them.
+     *
      */
     void updateElementBinGrid();
 
@@ -3186,6 +3854,50 @@ class PlacementInfo
      */
     void adjustLUTFFUtilization_Routability_Reset();
 
+    /**
+     * @brief update the routing demand map of the global bin grid according to the current bounding boxes of nets
+     *
+     * The estimation is the same as adjustLUTFFUtilization_Routability(): the weighted HPWL of a net is evenly
+     * distributed to the bins covered by its bounding box. Only the bounding boxes of the nets connected to the
+     * PlacementUnits moved since the previous update are re-evaluated (in parallel), and only the nets whose covered
+     * bins or weights are changed are applied to the map (via a 2D difference array), so the map can be refreshed in
+     * every global placement iteration. All the nets are re-evaluated when the grid, the PlacementUnits or the nets
+     * are changed.
+     *
+     */
+    void updateRoutingDemandMap();
+
+    /**
+     * @brief shrink the effective capacity of the LUT/FF bins according to the routing demand map
+     *
+     * The congestion capacity ratio of a bin is demandThreshold / demand (but not lower than minCapacityRatio) when
+     * its routing demand is higher than demandThreshold, so GeneralSpreader sees the congested bins as overflowed.
+     *
+     * @param demandThreshold the routing demand beyond which a bin is regarded as congested
+     * @param minCapacityRatio the lower bound of the congestion capacity ratio
+     */
+    void applyRoutingDemandToBinCapacity(float demandThreshold, float minCapacityRatio);
+
+    /**
+     * @brief recover the effective capacity of the LUT/FF bins changed by applyRoutingDemandToBinCapacity()
+     *
+     */
+    void resetCongestionCapacityRatios();
+
+    /**
+     * @brief get the routing demand of a bin in the global bin grid recorded in the routing demand map
+     *
+     * @param binIdX
+     * @param binIdY
+     * @return float
+     */
+    inline float getRoutingDemand(int binIdX, int binIdY)
+    {
+        if (binIdX < 0 || binIdY < 0 || binIdX >= routingDemandMapNumX || binIdY >= routingDemandMapNumY)
+            return 0;
+        return routingDemandMap[binIdY * routingDemandMapNumX + binIdX];
+    }
+
     /**
      * @brief adjust the resource demand of LUTs/FFs according to packing feasibility
      *
@@ -3209,11 +3921,37 @@ class PlacementInfo
     void adjustLUTFFUtilization_Clocking();
 
     /**
-     * @brief clean the information in bin grid
+     * @brief clean the information in bin grid, so the bin grid will be rebuilt from scratch in the next update
      *
      */
     void resetElementBinGrid();
 
+    /**
+     * @brief add a design cell into the bin grid of the first potential shared BEL type which can accommodate it
+     *
+     * @param curCell the design cell
+     * @param cellX the X coordinate of the cell
+     * @param cellY the Y coordinate of the cell
+     * @param binIdX the column of the bin covering the cell
+     * @param binIdY the row of the bin covering the cell
+     */
+    void addCellIntoElementBinGrid(DesignInfo::DesignCell *curCell, float cellX, float cellY, int binIdX, int binIdY);
+
+    /**
+     * @brief mark the bins (of all the shared BEL types and the global bin grid) at a location of the grid as changed,
+     * so they will be refilled by the next updateElementBinGrid()
+     *
+     * @param binIdX
+     * @param binIdY
+     */
+    inline void markBinGridLocationChanged(int binIdX, int binIdY)
+    {
+        assert(binIdX >= 0 && binIdY >= 0);
+        unsigned int locationId = binIdY * binGridNumX + binIdX;
+        if (locationId < binGridLocationChanged.size())
+            binGridLocationChanged[locationId] = 1;
+    }
+
     void updateSiteBinGrid();
 
     void resetSiteBinGrid();
@@ -3268,6 +4006,22 @@ class PlacementInfo
         binIdY = static_cast<int>((coord_offsetY) / binHeight);
     }
 
+    /**
+     * @brief Get the node coordinate in a level of the bin pyramid for a given location
+     *
+     * @param cellX given location X
+     * @param cellY given location Y
+     * @param nodeIdX the column of the node in the level
+     * @param nodeIdY the row of the node in the level
+     * @param level the level in the bin pyramid (0 refers to the bin grid)
+     */
+    inline void getGridXY(float cellX, float cellY, int &nodeIdX, int &nodeIdY, int level)
+    {
+        getGridXY(cellX, cellY, nodeIdX, nodeIdY);
+        nodeIdX >>= level;
+        nodeIdY >>= level;
+    }
+
     /**
      * @brief move the PlacementUnit to ensure the cells in it are within the device area.
      *
@@ -3282,7 +4036,7 @@ class PlacementInfo
             fX = std::max(globalMinX + eps, (std::min(fX, globalMaxX - eps)));
             fY = std::max(globalMinY + eps, (std::min(fY, globalMaxY - eps)));
         }
-        else if (auto curMacro = dynamic_cast<PlacementMacro *>(curPU))
+        else if (auto curMacro = asMacro(curPU))
         {
             if (fY + curMacro->getTopOffset() > globalMaxY - eps)
             {
@@ -3322,7 +4076,7 @@ class PlacementInfo
             fX = std::max(globalMinX + eps, (std::min(fX, globalMaxX - eps)));
             fY = std::max(globalMinY + eps, (std::min(fY, globalMaxY - eps)));
         }
-        else if (auto curMacro = dynamic_cast<PlacementMacro *>(curPU))
+        else if (auto curMacro = asMacro(curPU))
         {
             if (fY + curMacro->getTopOffset() > globalMaxY - eps)
             {
@@ -3365,7 +4119,7 @@ class PlacementInfo
      */
     inline bool isLegalLocation(DesignInfo::DesignCell *curCell, float targetX, float targetY)
     {
-        auto curPU = cellId2PlacementUnit[curCell->getCellId()];
+        auto curPU = getPlacementUnitByCell(curCell);
 
         if (curPU->getType() == PlacementUnitType_UnpackedCell)
         {
@@ -3375,7 +4129,7 @@ class PlacementInfo
             fY = std::max(globalMinY + eps, (std::min(fY, globalMaxY - eps)));
             return (std::fabs(fX - targetX) + std::fabs(fY - targetY)) < eps;
         }
-        else if (auto curMacro = dynamic_cast<PlacementMacro *>(curPU))
+        else if (auto curMacro = asMacro(curPU))
         {
             float offsetX = curMacro->getCellOffsetXInMacro(curCell);
             float offsetY = curMacro->getCellOffsetYInMacro(curCell);
@@ -3427,7 +4181,7 @@ class PlacementInfo
             fY = std::max(globalMinY + eps, (std::min(fY, globalMaxY - eps)));
             return (std::fabs(fX - targetX) + std::fabs(fY - targetY)) < eps;
         }
-        else if (auto curMacro = dynamic_cast<PlacementMacro *>(curPU))
+        else if (auto curMacro = asMacro(curPU))
         {
             float fX = targetX;
             float fY = targetY;
@@ -3460,7 +4214,7 @@ class PlacementInfo
     inline void getPULocationByCellLocation(DesignInfo::DesignCell *curCell, float targetX, float targetY, float &PUX,
                                             float &PUY)
     {
-        auto curPU = cellId2PlacementUnit[curCell->getCellId()];
+        auto curPU = getPlacementUnitByCell(curCell);
 
         if (curPU->getType() == PlacementUnitType_UnpackedCell)
         {
@@ -3471,7 +4225,7 @@ class PlacementInfo
             PUX = fX;
             PUY = fY;
         }
-        else if (auto curMacro = dynamic_cast<PlacementMacro *>(curPU))
+        else if (auto curMacro = asMacro(curPU))
         {
             float offsetX = curMacro->getCellOffsetXInMacro(curCell);
             float offsetY = curMacro->getCellOffsetYInMacro(curCell);
@@ -3551,6 +4305,13 @@ class PlacementInfo
         int X = -1;
         int Y = -1;
         float occupation = -1;
+
+        /**
+         * @brief the bin in the global bin grid (only for LUT/FF, -1 if the cell is not in the global bin grid)
+         *
+         */
+        int globalX = -1;
+        int globalY = -1;
     } CellBinInfo;
 
     /**
@@ -3673,6 +4434,8 @@ class PlacementInfo
         assert((unsigned int)binIdX < SharedBELTypeBinGrid[cellId2CellBinInfo[cellId].sharedTypeId][binIdY].size());
         if (cellId2CellBinInfo[cellId].X == binIdX && cellId2CellBinInfo[cellId].Y == binIdY)
             return;
+        markBinGridLocationChanged(cellId2CellBinInfo[cellId].X, cellId2CellBinInfo[cellId].Y);
+        markBinGridLocationChanged(binIdX, binIdY);
 
         assert(cellId2CellBinInfo[cellId].occupation >= 0);
         SharedBELTypeBinGrid[cellId2CellBinInfo[cellId].sharedTypeId][cellId2CellBinInfo[cellId].Y]
@@ -3680,6 +4443,12 @@ class PlacementInfo
                                 ->removeCell(designInfo->getCells()[cellId], cellId2CellBinInfo[cellId].occupation);
         SharedBELTypeBinGrid[cellId2CellBinInfo[cellId].sharedTypeId][binIdY][binIdX]->addCell(
             designInfo->getCells()[cellId], cellId2CellBinInfo[cellId].occupation);
+        int sharedTypeId = cellId2CellBinInfo[cellId].sharedTypeId;
+        if ((unsigned int)sharedTypeId < binPyramidValid.size() && binPyramidValid[sharedTypeId])
+        {
+            binPyramids[sharedTypeId]->updateBin(cellId2CellBinInfo[cellId].X, cellId2CellBinInfo[cellId].Y);
+            binPyramids[sharedTypeId]->updateBin(binIdX, binIdY);
+        }
         cellId2CellBinInfo[cellId].X = binIdX;
         cellId2CellBinInfo[cellId].Y = binIdY;
     }
@@ -4258,6 +5027,161 @@ class PlacementInfo
     std::map<int, PlacementUnit *> cellId2PlacementUnit;
     std::vector<PlacementUnit *> cellId2PlacementUnitVec;
     std::vector<CellBinInfo> cellId2CellBinInfo;
+
+    /**
+     * @brief the slots of the cells in the cell vectors of their bins, for the bin grids of shared BEL types, the
+     * global bin grid and the LUTFF bin grid respectively
+     *
+     * A cell can be in only one bin of each kind of bin grid, so the bins of a kind can share one table.
+     */
+    std::vector<int> cellId2SharedBELTypeBinSlot;
+    std::vector<int> cellId2GlobalBinSlot;
+    std::vector<int> cellId2LUTFFBinSlot;
+
+    /**
+     * @brief resize the cell slot tables of the bin grids if new cells are added to the design
+     *
+     */
+    inline void resizeCellSlotTables()
+    {
+        unsigned int numCells = designInfo->getNumCells();
+        if (cellId2SharedBELTypeBinSlot.size() < numCells)
+        {
+            cellId2SharedBELTypeBinSlot.resize(numCells, -1);
+            cellId2GlobalBinSlot.resize(numCells, -1);
+            cellId2LUTFFBinSlot.resize(numCells, -1);
+        }
+    }
+
+    /**
+     * @brief whether the bin grids are consistent with cellId2CellBinInfo so they can be updated incrementally
+     *
+     */
+    bool elementBinGridBuilt = false;
+
+    /**
+     * @brief the multi-resolution views of the bin grids of shared BEL types (created on demand)
+     *
+     */
+    std::vector<PlacementBinPyramid *> binPyramids;
+
+    /**
+     * @brief whether the bin pyramid of a shared BEL type is consistent with its bin grid
+     *
+     */
+    std::vector<unsigned char> binPyramidValid;
+
+    /**
+     * @brief the bins covered by the bounding box of a net and the routing demand it adds to each of these bins
+     *
+     */
+    struct NetRoutingDemandFootprint
+    {
+        int leftBinX = 0;
+        int rightBinX = -1;
+        int bottomBinY = 0;
+        int topBinY = -1;
+        float demandPerBin = 0;
+
+        inline bool operator==(const NetRoutingDemandFootprint &other) const
+        {
+            return leftBinX == other.leftBinX && rightBinX == other.rightBinX && bottomBinY == other.bottomBinY &&
+                   topBinY == other.topBinY && demandPerBin == other.demandPerBin;
+        }
+    };
+
+    /**
+     * @brief get the weighted HPWL of a net, which is the total routing demand of the net
+     *
+     * @param net
+     * @return float
+     */
+    float getNetRoutingDemand(PlacementNet *net);
+
+    /**
+     * @brief add (or remove with a negative sign) the routing demand of a net to the 2D difference array
+     *
+     * @param footprint the covered bins and the per-bin demand of the net
+     * @param sign 1 to add and -1 to remove
+     */
+    inline void applyNetRoutingDemandFootprint(const NetRoutingDemandFootprint &footprint, double sign)
+    {
+        if (footprint.rightBinX < footprint.leftBinX || footprint.topBinY < footprint.bottomBinY)
+            return;
+        int stride = routingDemandMapNumX + 1;
+        double w = sign * footprint.demandPerBin;
+        routingDemandDiff[footprint.bottomBinY * stride + footprint.leftBinX] += w;
+        routingDemandDiff[footprint.bottomBinY * stride + footprint.rightBinX + 1] -= w;
+        routingDemandDiff[(footprint.topBinY + 1) * stride + footprint.leftBinX] -= w;
+        routingDemandDiff[(footprint.topBinY + 1) * stride + footprint.rightBinX + 1] += w;
+    }
+
+    /**
+     * @brief the routing demand footprint of each net applied to the routing demand map
+     *
+     */
+    std::vector<NetRoutingDemandFootprint> netId2RoutingDemandFootprint;
+
+    /**
+     * @brief the newly evaluated routing demand footprint of each net (reused across updates)
+     *
+     */
+    std::vector<NetRoutingDemandFootprint> newNetRoutingDemandFootprints;
+
+    /**
+     * @brief the PlacementUnits and their locations when the routing demand map is updated last time, used to find
+     * the nets connected to the moved PlacementUnits
+     *
+     */
+    std::vector<PlacementUnit *> routingDemandMapPUs;
+    std::vector<std::pair<float, float>> routingDemandMapPULocs;
+
+    /**
+     * @brief the nets in the routing demand map when it is updated last time
+     *
+     */
+    std::vector<PlacementNet *> routingDemandMapNets;
+
+    /**
+     * @brief mark the nets whose footprints should be re-evaluated in the current update
+     *
+     */
+    std::vector<char> routingDemandNetMarks;
+
+    /**
+     * @brief the nets whose footprints are re-evaluated in the current update
+     *
+     */
+    std::vector<int> routingDemandNetIdsToUpdate;
+
+    /**
+     * @brief the 2D difference array ((numY+1)*(numX+1)) of the routing demand map
+     *
+     */
+    std::vector<double> routingDemandDiff;
+
+    /**
+     * @brief the routing demand of each bin in the global bin grid (row-major)
+     *
+     */
+    std::vector<float> routingDemandMap;
+
+    int routingDemandMapNumX = 0;
+    int routingDemandMapNumY = 0;
+
+    /**
+     * @brief the order in which each cell is visited by the last updateElementBinGrid() (-1 if it is not visited)
+     *
+     */
+    std::vector<int> cellId2BinGridVisitOrder;
+
+    /**
+     * @brief whether the bins at each location (binIdY * binGridNumX + binIdX) are changed since the last
+     * updateElementBinGrid()
+     *
+     */
+    std::vector<unsigned char> binGridLocationChanged;
+    int binGridNumX = 0;
     std::vector<Location> cellId2location;
     std::vector<Location> pinId2location;
     DesignInfo *designInfo;
@@ -0,0 +1,455 @@
+/**
+ * @file IncrementalBipartiteMatcher.h
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This header file contains the definitions of IncrementalBipartiteMatcher class, a min-cost bipartite matcher
+ * which keeps its graph, matching and dual potentials between solves so similar problems can be warm-started.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ */
+
+#ifndef _IncrementalBipartiteMatcher
+#define _IncrementalBipartiteMatcher
+
+#include "SSPMinCostFlow.h"
+#include <algorithm>
+#include <assert.h>
+#include <numeric>
+#include <omp.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @brief IncrementalBipartiteMatcher finds the min-cost maximum matching of a bipartite graph which can grow between
+ * solves
+ *
+ * The left and right nodes are identified by keys (e.g., the pointers of the cells and the sites), so the matching and
+ * the dual potentials of a solve can be used as the warm start of the next one:
+ *
+ * 1. Within a problem, nodes and edges can be added after solve() (e.g., the widened candidates of the unmatched
+ * nodes), and the next solve() continues from the current matching instead of starting from zero.
+ *
+ * 2. startNewProblem() clears the graph but keeps the matching and the potentials as hints, so a later problem with
+ * similar nodes and edges (e.g., the next legalization of the same macros) re-uses the pairs which are still edges.
+ *
+ * Each connected component of the graph is a flow network (left nodes, right nodes, source, sink) solved by
+ * SSPMinCostFlow. The warm-start matching is set as the initial flow and the potentials are repaired (with the
+ * negative cycles canceled) by SSPMinCostFlow, so the result is a min-cost maximum matching of the current graph no
+ * matter how good the hints are.
+ *
+ * @tparam LeftKey the key type of the left nodes
+ * @tparam RightKey the key type of the right nodes
+ */
+template <class LeftKey, class RightKey> class IncrementalBipartiteMatcher
+{
+  public:
+    IncrementalBipartiteMatcher()
+    {
+    }
+    ~IncrementalBipartiteMatcher()
+    {
+    }
+
+    /**
+     * @brief clear the graph of the current problem while keeping its matching and potentials as the hints of the next
+     * problem
+     *
+     */
+    void startNewProblem()
+    {
+        leftKeys.clear();
+        rightKeys.clear();
+        leftKey2Id.clear();
+        rightKey2Id.clear();
+        adjList.clear();
+        leftAdjSet.clear();
+        left2right.clear();
+        right2left.clear();
+    }
+
+    /**
+     * @brief drop the hints so the next problem is solved from scratch
+     *
+     */
+    void clearHints()
+    {
+        hintLeft2Right.clear();
+        hintLeftPotential.clear();
+        hintRightPotential.clear();
+    }
+
+    /**
+     * @brief get the id of a left node, which is added if it is not in the graph
+     *
+     * @param key the key of the left node
+     * @return int
+     */
+    int addLeftNode(const LeftKey &key)
+    {
+        auto findRes = leftKey2Id.find(key);
+        if (findRes != leftKey2Id.end())
+            return findRes->second;
+        int newId = leftKeys.size();
+        leftKey2Id[key] = newId;
+        leftKeys.push_back(key);
+        adjList.emplace_back();
+        leftAdjSet.emplace_back();
+        left2right.push_back(-1);
+        return newId;
+    }
+
+    /**
+     * @brief get the id of a right node, which is added if it is not in the graph
+     *
+     * @param key the key of the right node
+     * @return int
+     */
+    int addRightNode(const RightKey &key)
+    {
+        auto findRes = rightKey2Id.find(key);
+        if (findRes != rightKey2Id.end())
+            return findRes->second;
+        int newId = rightKeys.size();
+        rightKey2Id[key] = newId;
+        rightKeys.push_back(key);
+        right2left.push_back(-1);
+        return newId;
+    }
+
+    /**
+     * @brief check whether there is an edge between the given nodes
+     *
+     * @param leftId
+     * @param rightId
+     * @return true if the edge has been added
+     */
+    inline bool hasEdge(int leftId, int rightId)
+    {
+        return leftAdjSet[leftId].find(rightId) != leftAdjSet[leftId].end();
+    }
+
+    /**
+     * @brief add an edge between the given nodes if it is not in the graph
+     *
+     * @param leftId
+     * @param rightId
+     * @param cost the cost of the edge (it can be negative)
+     */
+    void addEdge(int leftId, int rightId, float cost)
+    {
+        assert(leftId >= 0 && leftId < (int)leftKeys.size());
+        assert(rightId >= 0 && rightId < (int)rightKeys.size());
+        if (!leftAdjSet[leftId].insert(rightId).second)
+            return;
+        adjList[leftId].emplace_back(rightId, cost);
+    }
+
+    /**
+     * @brief find the min-cost maximum matching of the current graph, warm-started by the current matching or the hints
+     *
+     * The connected components of the graph are independent, so each of them is warm-started and solved by its own
+     * flow network and the components are distributed to the threads, the largest first.
+     *
+     * @param maxThreadNum the number of threads
+     */
+    void solve(int maxThreadNum = 1)
+    {
+        findConnectedComponents();
+        int numLeftNodes = leftKeys.size();
+        int numRightNodes = rightKeys.size();
+        std::fill(left2right.begin(), left2right.end(), -1);
+        std::fill(right2left.begin(), right2left.end(), -1);
+        leftPotentials.assign(numLeftNodes, 0.0);
+        rightPotentials.assign(numRightNodes, 0.0);
+
+        int numComponents = components.size();
+        std::vector<int> componentWarmStartPairs(numComponents, 0);
+#pragma omp parallel for schedule(dynamic, 1) num_threads(maxThreadNum) if (maxThreadNum > 1 && numComponents > 1)
+        for (int componentId = 0; componentId < numComponents; componentId++)
+            componentWarmStartPairs[componentId] = solveComponent(components[componentId]);
+        numWarmStartPairs = std::accumulate(componentWarmStartPairs.begin(), componentWarmStartPairs.end(), 0);
+
+        // the hints are rebuilt from the nodes of the current graph, so they do not accumulate the nodes of the
+        // earlier problems
+        hintLeft2Right.clear();
+        hintLeftPotential.clear();
+        hintRightPotential.clear();
+        for (auto &curComponent : components)
+        {
+            for (auto leftId : curComponent.leftIds)
+            {
+                hintLeftPotential[leftKeys[leftId]] = leftPotentials[leftId];
+                if (left2right[leftId] >= 0)
+                    hintLeft2Right[leftKeys[leftId]] = rightKeys[left2right[leftId]];
+            }
+            for (auto rightId : curComponent.rightIds)
+                hintRightPotential[rightKeys[rightId]] = rightPotentials[rightId];
+        }
+    }
+
+    inline int getMatchedRightNode(int leftId)
+    {
+        return left2right[leftId];
+    }
+
+    inline int getNumLeftNodes()
+    {
+        return leftKeys.size();
+    }
+
+    inline LeftKey &getLeftKey(int leftId)
+    {
+        return leftKeys[leftId];
+    }
+
+    inline RightKey &getRightKey(int rightId)
+    {
+        return rightKeys[rightId];
+    }
+
+    /**
+     * @brief get the number of pairs in the warm-start matching of the latest solve
+     *
+     * @return int
+     */
+    inline int getNumWarmStartPairs()
+    {
+        return numWarmStartPairs;
+    }
+
+  private:
+    std::vector<LeftKey> leftKeys;
+    std::vector<RightKey> rightKeys;
+    std::unordered_map<LeftKey, int> leftKey2Id;
+    std::unordered_map<RightKey, int> rightKey2Id;
+    std::vector<std::vector<std::pair<int, float>>> adjList;
+    std::vector<std::unordered_set<int>> leftAdjSet;
+    std::vector<int> left2right;
+    std::vector<int> right2left;
+    int numWarmStartPairs = 0;
+
+    /**
+     * @brief the matching and the potentials of the latest solve, recorded by the keys of the nodes. The potentials
+     * are relative to the source of the component of the node.
+     *
+     */
+    std::unordered_map<LeftKey, RightKey> hintLeft2Right;
+    std::unordered_map<LeftKey, double> hintLeftPotential;
+    std::unordered_map<RightKey, double> hintRightPotential;
+
+    /**
+     * @brief the potentials of the nodes found by the latest solve
+     *
+     */
+    std::vector<double> leftPotentials;
+    std::vector<double> rightPotentials;
+
+    /**
+     * @brief a connected component of the graph, whose nodes are numbered locally in its flow network: the left
+     * nodes, the right nodes, the source and the sink
+     *
+     */
+    struct Component
+    {
+        std::vector<int> leftIds;
+        std::vector<int> rightIds;
+        int numEdges = 0;
+
+        inline int getSrcNode() const
+        {
+            return leftIds.size() + rightIds.size();
+        }
+
+        inline int getSinkNode() const
+        {
+            return leftIds.size() + rightIds.size() + 1;
+        }
+    };
+
+    /**
+     * @brief the connected components (containing edges) of the current graph sorted by size, the largest first
+     *
+     */
+    std::vector<Component> components;
+
+    /**
+     * @brief the index of each right node in the right nodes of its component
+     *
+     */
+    std::vector<int> rightId2LocalId;
+
+    /**
+     * @brief find the connected components of the current graph with a union-find over the left and right nodes
+     *
+     */
+    void findConnectedComponents()
+    {
+        int numLeftNodes = leftKeys.size();
+        int numRightNodes = rightKeys.size();
+
+        // the left nodes are [0, numLeftNodes) and the right nodes are [numLeftNodes, numLeftNodes + numRightNodes)
+        std::vector<int> parent(numLeftNodes + numRightNodes);
+        std::iota(parent.begin(), parent.end(), 0);
+        auto findRoot = [&parent](int x) -> int {
+            while (parent[x] != x)
+            {
+                parent[x] = parent[parent[x]];
+                x = parent[x];
+            }
+            return x;
+        };
+        for (int leftId = 0; leftId < numLeftNodes; leftId++)
+        {
+            for (auto &tmpPair : adjList[leftId])
+            {
+                int rootA = findRoot(leftId);
+                int rootB = findRoot(tmpPair.first + numLeftNodes);
+                if (rootA != rootB)
+                    parent[std::max(rootA, rootB)] = std::min(rootA, rootB);
+            }
+        }
+
+        std::vector<int> root2ComponentId(numLeftNodes + numRightNodes, -1);
+        components.clear();
+        for (int leftId = 0; leftId < numLeftNodes; leftId++)
+        {
+            if (adjList[leftId].empty())
+                continue;
+            int root = findRoot(leftId);
+            if (root2ComponentId[root] < 0)
+            {
+                root2ComponentId[root] = components.size();
+                components.emplace_back();
+            }
+            Component &curComponent = components[root2ComponentId[root]];
+            curComponent.leftIds.push_back(leftId);
+            curComponent.numEdges += adjList[leftId].size();
+        }
+        rightId2LocalId.assign(numRightNodes, -1);
+        for (int rightId = 0; rightId < numRightNodes; rightId++)
+        {
+            int componentId = root2ComponentId[findRoot(rightId + numLeftNodes)];
+            if (componentId < 0)
+                continue;
+            rightId2LocalId[rightId] = components[componentId].rightIds.size();
+            components[componentId].rightIds.push_back(rightId);
+        }
+
+        std::stable_sort(components.begin(), components.end(), [](const Component &a, const Component &b) -> bool {
+            return a.numEdges + a.leftIds.size() + a.rightIds.size() >
+                   b.numEdges + b.leftIds.size() + b.rightIds.size();
+        });
+    }
+
+    /**
+     * @brief warm-start a component with the hints and find its min-cost maximum matching
+     *
+     * Only the matching and the potentials of the nodes in the component are written, so the components can be solved
+     * concurrently.
+     *
+     * @param curComponent
+     * @return int the number of pairs in the warm-start matching of the component
+     */
+    int solveComponent(Component &curComponent)
+    {
+        int numLocalLeftNodes = curComponent.leftIds.size();
+        int numLocalRightNodes = curComponent.rightIds.size();
+        int srcNode = curComponent.getSrcNode();
+        int sinkNode = curComponent.getSinkNode();
+        SSPMinCostFlow solver(numLocalLeftNodes + numLocalRightNodes + 2);
+
+        std::vector<int> srcEdgeIds(numLocalLeftNodes), sinkEdgeIds(numLocalRightNodes);
+        std::vector<std::vector<int>> localLeftId2EdgeIds(numLocalLeftNodes);
+        for (int localLeftId = 0; localLeftId < numLocalLeftNodes; localLeftId++)
+        {
+            int leftId = curComponent.leftIds[localLeftId];
+            srcEdgeIds[localLeftId] = solver.addEdge(srcNode, localLeftId, 1, 0);
+            localLeftId2EdgeIds[localLeftId].reserve(adjList[leftId].size());
+            for (auto &tmpPair : adjList[leftId])
+                localLeftId2EdgeIds[localLeftId].push_back(solver.addEdge(
+                    localLeftId, numLocalLeftNodes + rightId2LocalId[tmpPair.first], 1, tmpPair.second));
+        }
+        for (int localRightId = 0; localRightId < numLocalRightNodes; localRightId++)
+            sinkEdgeIds[localRightId] = solver.addEdge(numLocalLeftNodes + localRightId, sinkNode, 1, 0);
+
+        // the hints are the matching and the potentials of the latest solve, which might be a previous problem. The
+        // source is at potential 0 and the sink starts at the highest potential of the warm-started right nodes.
+        std::vector<double> initialPotential(numLocalLeftNodes + numLocalRightNodes + 2, 0.0);
+        for (int localRightId = 0; localRightId < numLocalRightNodes; localRightId++)
+        {
+            auto findRes = hintRightPotential.find(rightKeys[curComponent.rightIds[localRightId]]);
+            if (findRes != hintRightPotential.end())
+                initialPotential[numLocalLeftNodes + localRightId] = findRes->second;
+        }
+        int numLocalWarmStartPairs = 0;
+        for (int localLeftId = 0; localLeftId < numLocalLeftNodes; localLeftId++)
+        {
+            int leftId = curComponent.leftIds[localLeftId];
+            auto findPotential = hintLeftPotential.find(leftKeys[leftId]);
+            if (findPotential != hintLeftPotential.end())
+                initialPotential[localLeftId] = findPotential->second;
+
+            auto findPartner = hintLeft2Right.find(leftKeys[leftId]);
+            if (findPartner == hintLeft2Right.end())
+                continue;
+            auto findRight = rightKey2Id.find(findPartner->second);
+            if (findRight == rightKey2Id.end())
+                continue;
+            // the partner is checked only if it is in the component, where no other thread writes
+            int rightId = findRight->second;
+            for (unsigned int j = 0; j < adjList[leftId].size(); j++)
+            {
+                if (adjList[leftId][j].first == rightId)
+                {
+                    if (right2left[rightId] >= 0)
+                        break;
+                    int localRightId = rightId2LocalId[rightId];
+                    solver.setInitialFlow(srcEdgeIds[localLeftId], 1);
+                    solver.setInitialFlow(localLeftId2EdgeIds[localLeftId][j], 1);
+                    solver.setInitialFlow(sinkEdgeIds[localRightId], 1);
+                    right2left[rightId] = leftId;
+                    if (!numLocalWarmStartPairs ||
+                        initialPotential[sinkNode] < initialPotential[numLocalLeftNodes + localRightId])
+                        initialPotential[sinkNode] = initialPotential[numLocalLeftNodes + localRightId];
+                    numLocalWarmStartPairs++;
+                    break;
+                }
+            }
+        }
+        solver.setInitialPotentials(initialPotential);
+
+        solver.calcMinCostFlow(srcNode, sinkNode, numLocalLeftNodes);
+
+        for (auto rightId : curComponent.rightIds)
+            right2left[rightId] = -1;
+        for (int localLeftId = 0; localLeftId < numLocalLeftNodes; localLeftId++)
+        {
+            int leftId = curComponent.leftIds[localLeftId];
+            for (unsigned int j = 0; j < adjList[leftId].size(); j++)
+            {
+                if (solver.getFlow(localLeftId2EdgeIds[localLeftId][j]) > 0)
+                {
+                    int rightId = adjList[leftId][j].first;
+                    assert(left2right[leftId] < 0);
+                    left2right[leftId] = rightId;
+                    assert(right2left[rightId] < 0);
+                    right2left[rightId] = leftId;
+                }
+            }
+        }
+
+        double srcPotential = solver.getPotential(srcNode);
+        for (int localLeftId = 0; localLeftId < numLocalLeftNodes; localLeftId++)
+            leftPotentials[curComponent.leftIds[localLeftId]] = solver.getPotential(localLeftId) - srcPotential;
+        for (int localRightId = 0; localRightId < numLocalRightNodes; localRightId++)
+            rightPotentials[curComponent.rightIds[localRightId]] =
+                solver.getPotential(numLocalLeftNodes + localRightId) - srcPotential;
+        return numLocalWarmStartPairs;
+    }
+};
+
+#endif
@@ -11,28 +11,60 @@
  */
 
 #include "MinCostBipartiteMatcher.h"
+#include <numeric>
 #include <omp.h>
 
 void MinCostBipartiteMatcher::solve()
 {
-    int numSolvers = minCostFlowSolvers.size();
-#pragma omp parallel for schedule(dynamic)
-    for (int solverId = 0; solverId < numSolvers; solverId++)
+    // the components are sorted by size so the largest ones start first and each component is a scheduling unit
+    int numComponents = components.size();
+#pragma omp parallel for schedule(dynamic, 1) num_threads(maxThreadNum) if (maxThreadNum > 1 && numComponents > 1)
+    for (int componentId = 0; componentId < numComponents; componentId++)
     {
-        minCostFlowSolvers[solverId]->calcMinCostFlow(srcNode, sinkNode, numExpectedMatches);
-        for (int i = 0; i < numLeftNodes; i++)
+        Component &curComponent = components[componentId];
+        int requiredFlow = std::min(numExpectedMatches, (int)curComponent.leftIds.size());
+        int numLocalLeftNodes = curComponent.leftIds.size();
+        if (engine == MinCostFlowEngine_Dijkstra)
         {
-            for (unsigned int j = 0; j < minCostFlowSolvers[solverId]->resGraph.adj[i].size(); j++)
+            SSPMinCostFlow *curSolver = SSPSolvers[componentId];
+            curSolver->calcMinCostFlow(curComponent.getSrcNode(), curComponent.getSinkNode(), requiredFlow);
+            for (int localLeftId = 0; localLeftId < numLocalLeftNodes; localLeftId++)
             {
-                int destination = minCostFlowSolvers[solverId]->resGraph.adj[i][j]->destination;
-                if (destination >= numLeftNodes && destination < numLeftNodes + numRightNodes)
+                int leftId = curComponent.leftIds[localLeftId];
+                for (unsigned int j = 0; j < adjList[leftId].size(); j++)
                 {
-                    if (minCostFlowSolvers[solverId]->resGraph.adj[i][j]->residualFlow == 0)
+                    if (curSolver->getFlow(leftId2EdgeIds[leftId][j]) > 0)
                     {
-                        assert(left2right[i] < 0);
-                        left2right[i] = destination - numLeftNodes;
-                        assert(right2left[destination - numLeftNodes] < 0);
-                        right2left[destination - numLeftNodes] = i;
+                        int rightId = adjList[leftId][j].first;
+                        assert(left2right[leftId] < 0);
+                        left2right[leftId] = rightId;
+                        assert(right2left[rightId] < 0);
+                        right2left[rightId] = leftId;
+                    }
+                }
+            }
+        }
+        else
+        {
+            MinCostFlow *curSolver = minCostFlowSolvers[componentId];
+            curSolver->calcMinCostFlow(curComponent.getSrcNode(), curComponent.getSinkNode(), requiredFlow);
+            int numLocalNodes = curComponent.leftIds.size() + curComponent.rightIds.size();
+            for (int localLeftId = 0; localLeftId < numLocalLeftNodes; localLeftId++)
+            {
+                for (auto curEdge : curSolver->resGraph.adj[localLeftId])
+                {
+                    int destination = curEdge->destination;
+                    if (destination >= numLocalLeftNodes && destination < numLocalNodes)
+                    {
+                        if (curEdge->residualFlow == 0)
+                        {
+                            int leftId = curComponent.leftIds[localLeftId];
+                            int rightId = curComponent.rightIds[destination - numLocalLeftNodes];
+                            assert(left2right[leftId] < 0);
+                            left2right[leftId] = rightId;
+                            assert(right2left[rightId] < 0);
+                            right2left[rightId] = leftId;
+                        }
                     }
                 }
             }
@@ -40,58 +72,124 @@ void MinCostBipartiteMatcher::solve()
     }
 }
 
-void MinCostBipartiteMatcher::getConnectedSubgraphAdjList(std::vector<std::vector<std::pair<int, float>>> &adjList,
-                                                          std::vector<int> &leftId2ConnectedSubgraphId,
-                                                          int &numConnectedSubgraphs, int maxThreadNum)
+void MinCostBipartiteMatcher::findConnectedComponents()
 {
-    std::vector<std::vector<int>> inv_adjList;
-    inv_adjList.resize(numRightNodes, std::vector<int>());
-    for (int i = 0; i < numLeftNodes; i++)
+    // the left nodes are [0, numLeftNodes) and the right nodes are [numLeftNodes, numLeftNodes + numRightNodes)
+    std::vector<int> parent(numLeftNodes + numRightNodes);
+    std::iota(parent.begin(), parent.end(), 0);
+    auto findRoot = [&parent](int x) -> int {
+        while (parent[x] != x)
+        {
+            parent[x] = parent[parent[x]];
+            x = parent[x];
+        }
+        return x;
+    };
+    for (int leftId = 0; leftId < numLeftNodes; leftId++)
     {
-        for (unsigned int j = 0; j < adjList[i].size(); j++)
+        for (auto &tmpPair : adjList[leftId])
         {
-            unsigned int v = adjList[i][j].first;
-            assert(v < inv_adjList.size());
-            inv_adjList[v].push_back(i);
+            assert(tmpPair.first >= 0 && tmpPair.first < numRightNodes);
+            int rootA = findRoot(leftId);
+            int rootB = findRoot(tmpPair.first + numLeftNodes);
+            if (rootA != rootB)
+                parent[std::max(rootA, rootB)] = std::min(rootA, rootB);
         }
     }
 
-    numConnectedSubgraphs = 0;
-    for (unsigned int leftNodeId = 0; leftNodeId < adjList.size(); leftNodeId++)
+    // the components are numbered in the order of their first left nodes, and the nodes in a component are in the
+    // order of their ids, so the flow networks are deterministic
+    std::vector<int> root2ComponentId(numLeftNodes + numRightNodes, -1);
+    components.clear();
+    for (int leftId = 0; leftId < numLeftNodes; leftId++)
     {
-        if (leftId2ConnectedSubgraphId[leftNodeId] >= 0)
+        if (adjList[leftId].empty())
             continue;
-        int curNode = leftNodeId;
+        int root = findRoot(leftId);
+        if (root2ComponentId[root] < 0)
+        {
+            root2ComponentId[root] = components.size();
+            components.emplace_back();
+        }
+        Component &curComponent = components[root2ComponentId[root]];
+        curComponent.leftIds.push_back(leftId);
+        curComponent.numEdges += adjList[leftId].size();
+    }
+    rightId2LocalId.assign(numRightNodes, -1);
+    for (int rightId = 0; rightId < numRightNodes; rightId++)
+    {
+        int componentId = root2ComponentId[findRoot(rightId + numLeftNodes)];
+        if (componentId < 0)
+            continue;
+        rightId2LocalId[rightId] = components[componentId].rightIds.size();
+        components[componentId].rightIds.push_back(rightId);
+    }
+
+    // the largest components are solved first to balance the load of the threads
+    std::stable_sort(components.begin(), components.end(), [](const Component &a, const Component &b) -> bool {
+        return a.numEdges + a.leftIds.size() + a.rightIds.size() > b.numEdges + b.leftIds.size() + b.rightIds.size();
+    });
+}
 
-        bool reachedRight[numRightNodes];
-        memset(reachedRight, 0, sizeof(reachedRight));
-        std::queue<int> leftNodeInQ;
-        leftNodeInQ.push(curNode);
-        leftId2ConnectedSubgraphId[curNode] = numConnectedSubgraphs % maxThreadNum;
-        while (leftNodeInQ.size())
+void MinCostBipartiteMatcher::buildSolvers()
+{
+    int numComponents = components.size();
+    if (engine == MinCostFlowEngine_Dijkstra)
+    {
+        SSPSolvers.resize(numComponents, nullptr);
+        leftId2EdgeIds.resize(numLeftNodes);
+    }
+    else
+    {
+        minCostFlowSolvers.resize(numComponents, nullptr);
+    }
+
+    for (int componentId = 0; componentId < numComponents; componentId++)
+    {
+        Component &curComponent = components[componentId];
+        int numLocalLeftNodes = curComponent.leftIds.size();
+        int numLocalRightNodes = curComponent.rightIds.size();
+        int numLocalNodes = numLocalLeftNodes + numLocalRightNodes + 2;
+        int srcNode = curComponent.getSrcNode();
+        int sinkNode = curComponent.getSinkNode();
+
+        if (engine == MinCostFlowEngine_Dijkstra)
         {
-            curNode = leftNodeInQ.front();
-            leftNodeInQ.pop();
-            for (auto tmpPair : adjList[curNode])
+            SSPMinCostFlow *curSolver = new SSPMinCostFlow(numLocalNodes);
+            SSPSolvers[componentId] = curSolver;
+            for (int localLeftId = 0; localLeftId < numLocalLeftNodes; localLeftId++)
             {
-                int rightNode = tmpPair.first;
-                if (reachedRight[rightNode])
-                    continue;
-                reachedRight[rightNode] = 1;
-                for (int nextLeftId : inv_adjList[rightNode])
+                int leftId = curComponent.leftIds[localLeftId];
+                leftId2EdgeIds[leftId].reserve(adjList[leftId].size());
+                for (auto &tmpPair : adjList[leftId])
                 {
-                    if (leftId2ConnectedSubgraphId[nextLeftId] < 0)
-                    {
-                        leftId2ConnectedSubgraphId[nextLeftId] = numConnectedSubgraphs % maxThreadNum;
-                        leftNodeInQ.push(nextLeftId);
-                    }
+                    assert(tmpPair.second > 0.00001);
+                    int v = numLocalLeftNodes + rightId2LocalId[tmpPair.first];
+                    leftId2EdgeIds[leftId].push_back(curSolver->addEdge(localLeftId, v, 1, tmpPair.second));
                 }
+                curSolver->addEdge(srcNode, localLeftId, 1, 0);
             }
+            for (int localRightId = 0; localRightId < numLocalRightNodes; localRightId++)
+                curSolver->addEdge(numLocalLeftNodes + localRightId, sinkNode, 1, 0);
+        }
+        else
+        {
+            MinCostFlow *curSolver = new MinCostFlow(numLocalNodes, numLocalLeftNodes, srcNode, sinkNode);
+            minCostFlowSolvers[componentId] = curSolver;
+            for (int localLeftId = 0; localLeftId < numLocalLeftNodes; localLeftId++)
+            {
+                int leftId = curComponent.leftIds[localLeftId];
+                for (auto &tmpPair : adjList[leftId])
+                {
+                    assert(tmpPair.second > 0.00001);
+                    int v = numLocalLeftNodes + rightId2LocalId[tmpPair.first];
+                    curSolver->addEdge(localLeftId, v, 1, tmpPair.second);
+                }
+            }
+            for (int localLeftId = 0; localLeftId < numLocalLeftNodes; localLeftId++)
+                curSolver->addEdge(srcNode, localLeftId, 1, 0);
+            for (int localRightId = 0; localRightId < numLocalRightNodes; localRightId++)
+                curSolver->addEdge(numLocalLeftNodes + localRightId, sinkNode, 1, 0);
         }
-
-        numConnectedSubgraphs++;
     }
-
-    // print_info("MinCostBipartiteMatcher finds " + std::to_string(numConnectedSubgraphs) +
-    //            " connected subgraphs in the input bipartie graph");
-}
\ No newline at end of file
+}
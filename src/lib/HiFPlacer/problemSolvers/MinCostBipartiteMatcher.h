@@ -14,9 +14,11 @@
 #define _MinCostBipartiteMatcher
 
 #include "PlacementInfo.h"
+#include "SSPMinCostFlow.h"
 #include "minCostFlow/MinCostFlow.h"
 #include "sysInfo.h"
 #include <assert.h>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
 #include <map>
@@ -31,75 +33,91 @@
 class MinCostBipartiteMatcher
 {
   public:
+    /**
+     * @brief the min-cost flow engines which can be used to solve the matching
+     *
+     * MinCostFlowEngine_SPFA: the SPFA-based MinCostFlow in 3rdParty
+     *
+     * MinCostFlowEngine_Dijkstra: SSPMinCostFlow, successive shortest paths with Johnson potentials over a CSR
+     * residual graph
+     *
+     */
+    enum MinCostFlowEngine
+    {
+        MinCostFlowEngine_SPFA = 0,
+        MinCostFlowEngine_Dijkstra
+    };
+
+    /**
+     * @brief get the min-cost flow engine set by "MinCostFlowEngine" ("SPFA" or "Dijkstra") in the placement
+     * configuration
+     *
+     * @param JSONCfg the user-defined placement configuration
+     * @return MinCostFlowEngine (MinCostFlowEngine_SPFA by default). The placer exits if the engine is undefined.
+     */
+    static MinCostFlowEngine getMinCostFlowEngine(std::map<std::string, std::string> &JSONCfg)
+    {
+        if (JSONCfg.find("MinCostFlowEngine") != JSONCfg.end())
+        {
+            if (JSONCfg["MinCostFlowEngine"] == "Dijkstra")
+                return MinCostFlowEngine_Dijkstra;
+            if (JSONCfg["MinCostFlowEngine"] != "SPFA")
+            {
+                print_error("undefined min-cost flow engine: " + JSONCfg["MinCostFlowEngine"] +
+                            " (MinCostFlowEngine should be SPFA or Dijkstra)");
+                exit(1);
+            }
+        }
+        return MinCostFlowEngine_SPFA;
+    }
+
+    /**
+     * @brief Construct a new MinCostBipartiteMatcher object
+     *
+     * The connected components of the bipartite graph are found by a union-find and each component is solved by its
+     * own min-cost flow solver which only contains the nodes of the component.
+     *
+     * @param numLeftNodes the number of left nodes
+     * @param numRightNodes the number of right nodes
+     * @param numExpectedMatches the expected number of matches
+     * @param adjList the right nodes and the costs of the edges of each left node
+     * @param maxThreadNum the maximum number of threads to solve the components
+     * @param verbose whether to print the information of the matching problem
+     * @param engine the min-cost flow engine
+     */
     MinCostBipartiteMatcher(int numLeftNodes, int numRightNodes, int numExpectedMatches,
-                            std::vector<std::vector<std::pair<int, float>>> &adjList, int maxThreadNum, bool verbose)
+                            std::vector<std::vector<std::pair<int, float>>> &adjList, int maxThreadNum, bool verbose,
+                            MinCostFlowEngine engine = MinCostFlowEngine_SPFA)
         : numLeftNodes(numLeftNodes), numRightNodes(numRightNodes), numExpectedMatches(numExpectedMatches),
-          adjList(adjList), maxThreadNum(maxThreadNum), verbose(verbose)
+          adjList(adjList), maxThreadNum(maxThreadNum), verbose(verbose), engine(engine)
     {
-
-        std::vector<int> leftId2ConnectedSubgraphId(0);
-        leftId2ConnectedSubgraphId.resize(numLeftNodes, -1);
-        int numConnectedSubgraphs = -1;
-        getConnectedSubgraphAdjList(adjList, leftId2ConnectedSubgraphId, numConnectedSubgraphs, maxThreadNum);
-        if (maxThreadNum < numConnectedSubgraphs)
-            threadNum = maxThreadNum;
-        else
-            threadNum = numConnectedSubgraphs;
-        minCostFlowSolvers.clear();
-        minCostFlowSolvers.resize(threadNum, nullptr);
-
-        int totalNumEdges = 0;
-        for (auto &curList : adjList)
-            totalNumEdges += curList.size();
-        totalNumEdges += numLeftNodes + numRightNodes;
-
-        srcNode = numLeftNodes + numRightNodes;
-        sinkNode = srcNode + 1;
-        for (int i = 0; i < threadNum; i++)
-            minCostFlowSolvers[i] = new MinCostFlow(numLeftNodes + numRightNodes + 2, numLeftNodes, srcNode, sinkNode);
+        assert(adjList.size() == (unsigned int)numLeftNodes);
+        findConnectedComponents();
 
         if (verbose)
         {
-            print_info("#ConnectedSubgraphs: " + std::to_string(numConnectedSubgraphs));
+            print_info("#ConnectedSubgraphs: " + std::to_string(components.size()));
+            if (components.size())
+                print_info("#nodesInLargestSubgraph: " + std::to_string(components[0].leftIds.size() +
+                                                                       components[0].rightIds.size()));
             print_info("#leftNodes: " + std::to_string(numLeftNodes));
             print_info("#rightNodes: " + std::to_string(numRightNodes));
         }
 
-        assert(adjList.size() == (unsigned int)numLeftNodes);
-        for (int i = 0; i < numLeftNodes; i++)
-        {
-            for (unsigned int j = 0; j < adjList[i].size(); j++)
-            {
-                assert(leftId2ConnectedSubgraphId[i] >= 0);
-                int v = adjList[i][j].first + numLeftNodes;
-                float w = adjList[i][j].second;
-                assert(w > 0.00001);
-                minCostFlowSolvers[leftId2ConnectedSubgraphId[i]]->addEdge(i, v, 1, w);
-            }
-        }
-
-        for (int solverId = 0; solverId < threadNum; solverId++)
-        {
-            for (int i = 0; i < numLeftNodes; i++)
-            {
-                minCostFlowSolvers[solverId]->addEdge(srcNode, i, 1, 0);
-            }
-            for (int i = numLeftNodes; i < numLeftNodes + numRightNodes; i++)
-            {
-                minCostFlowSolvers[solverId]->addEdge(i, sinkNode, 1, 0);
-            }
-        }
-
         left2right.clear();
         right2left.clear();
         left2right.resize(numLeftNodes, -1);
         right2left.resize(numRightNodes, -1);
+
+        buildSolvers();
     }
 
     ~MinCostBipartiteMatcher()
     {
         for (auto minCostFlowSolver : minCostFlowSolvers)
             delete minCostFlowSolver;
+        for (auto SSPSolver : SSPSolvers)
+            delete SSPSolver;
     }
 
     void solve();
@@ -114,17 +132,76 @@ class MinCostBipartiteMatcher
     int numRightNodes;
     int numExpectedMatches;
     std::vector<std::vector<std::pair<int, float>>> &adjList;
-    std::vector<std::vector<std::vector<std::pair<int, float>>>> connectedSubgraphAdjList;
-    void getConnectedSubgraphAdjList(std::vector<std::vector<std::pair<int, float>>> &adjList,
-                                     std::vector<int> &leftId2ConnectedSubgraphId, int &numConnectedSubgraphs,
-                                     int maxThreadNum);
     int maxThreadNum;
-    int threadNum = 1;
     bool verbose;
+    MinCostFlowEngine engine;
+
+    /**
+     * @brief a connected component of the bipartite graph
+     *
+     * In the flow network of the component, the left nodes are numbered from 0, followed by the right nodes, the
+     * source and the sink.
+     *
+     */
+    struct Component
+    {
+        std::vector<int> leftIds;
+        std::vector<int> rightIds;
+        int numEdges = 0;
 
+        inline int getSrcNode() const
+        {
+            return leftIds.size() + rightIds.size();
+        }
+
+        inline int getSinkNode() const
+        {
+            return leftIds.size() + rightIds.size() + 1;
+        }
+    };
+
+    /**
+     * @brief the connected components (containing edges) sorted by size, the largest first
+     *
+     */
+    std::vector<Component> components;
+
+    /**
+     * @brief the index of each right node in the right nodes of its component
+     *
+     */
+    std::vector<int> rightId2LocalId;
+
+    /**
+     * @brief find the connected components of the bipartite graph with a union-find over the left and right nodes
+     *
+     */
+    void findConnectedComponents();
+
+    /**
+     * @brief build the min-cost flow solver of each component with the selected engine
+     *
+     */
+    void buildSolvers();
+
+    /**
+     * @brief the solvers of MinCostFlowEngine_SPFA (one for each component)
+     *
+     */
     std::vector<MinCostFlow *> minCostFlowSolvers;
-    int srcNode;
-    int sinkNode;
+
+    /**
+     * @brief the solvers of MinCostFlowEngine_Dijkstra (one for each component)
+     *
+     */
+    std::vector<SSPMinCostFlow *> SSPSolvers;
+
+    /**
+     * @brief the ids of the edges of each left node in its solver, in the order of adjList (MinCostFlowEngine_Dijkstra)
+     *
+     */
+    std::vector<std::vector<int>> leftId2EdgeIds;
+
     std::vector<int> left2right;
     std::vector<int> right2left;
 };
@@ -0,0 +1,311 @@
+/**
+ * @file SSPMinCostFlow.cc
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This implementation file contains APIs' implementation of SSPMinCostFlow, a min-cost flow solver based on
+ * successive shortest paths with Johnson potentials.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ */
+
+#include "SSPMinCostFlow.h"
+
+#include <algorithm>
+#include <cmath>
+
+int SSPMinCostFlow::addEdge(int u, int v, int capacity, float cost)
+{
+    assert(!built && "the edges should be added before solving.");
+    assert(u >= 0 && u < numVertices && v >= 0 && v < numVertices);
+    if (cost < 0)
+        potentialRepairRequired = true;
+    pendingEdges.push_back(PendingEdge{u, v, capacity, cost, 0});
+    return pendingEdges.size() - 1;
+}
+
+void SSPMinCostFlow::setInitialFlow(int edgeId, int flow)
+{
+    assert(!built && "the initial flows should be set before solving.");
+    assert(edgeId >= 0 && edgeId < (int)pendingEdges.size());
+    assert(flow >= 0 && flow <= pendingEdges[edgeId].capacity);
+    pendingEdges[edgeId].flow = flow;
+    if (flow > 0)
+        potentialRepairRequired = true;
+}
+
+void SSPMinCostFlow::setInitialPotentials(const std::vector<double> &initialPotential)
+{
+    assert(!built && "the initial potentials should be set before solving.");
+    assert((int)initialPotential.size() == numVertices);
+    this->initialPotential = initialPotential;
+    potentialRepairRequired = true;
+}
+
+void SSPMinCostFlow::buildResidualGraph()
+{
+    int numEdges = pendingEdges.size();
+    vertexArcBegin.assign(numVertices + 1, 0);
+    for (auto &curEdge : pendingEdges)
+    {
+        vertexArcBegin[curEdge.u + 1]++;
+        vertexArcBegin[curEdge.v + 1]++;
+    }
+    for (int vertexId = 0; vertexId < numVertices; vertexId++)
+        vertexArcBegin[vertexId + 1] += vertexArcBegin[vertexId];
+
+    arcHead.resize(2 * numEdges);
+    arcResidual.resize(2 * numEdges);
+    arcCost.resize(2 * numEdges);
+    arcForward.resize(2 * numEdges);
+    arcRev.resize(2 * numEdges);
+    edgeId2Arc.resize(numEdges);
+    std::vector<int> nextArc(vertexArcBegin.begin(), vertexArcBegin.end() - 1);
+    for (int edgeId = 0; edgeId < numEdges; edgeId++)
+    {
+        auto &curEdge = pendingEdges[edgeId];
+        int forwardArc = nextArc[curEdge.u]++;
+        int backwardArc = nextArc[curEdge.v]++;
+        arcHead[forwardArc] = curEdge.v;
+        arcResidual[forwardArc] = curEdge.capacity - curEdge.flow;
+        arcCost[forwardArc] = curEdge.cost;
+        arcForward[forwardArc] = 1;
+        arcRev[forwardArc] = backwardArc;
+        arcHead[backwardArc] = curEdge.u;
+        arcResidual[backwardArc] = curEdge.flow;
+        arcCost[backwardArc] = -curEdge.cost;
+        arcForward[backwardArc] = 0;
+        arcRev[backwardArc] = forwardArc;
+        edgeId2Arc[edgeId] = forwardArc;
+    }
+    std::vector<PendingEdge>().swap(pendingEdges);
+
+    // without initial flows/potentials and negative costs, the zero potentials are feasible
+    if (initialPotential.size())
+        potential = initialPotential;
+    else
+        potential.assign(numVertices, 0.0);
+    std::vector<double>().swap(initialPotential);
+    distance.resize(numVertices);
+    parentArc.resize(numVertices);
+    settled.resize(numVertices);
+    built = true;
+
+    if (potentialRepairRequired)
+        repairPotentials();
+}
+
+void SSPMinCostFlow::repairPotentials()
+{
+    // Bellman-Ford passes where the labels start from the current potentials, which is equivalent to the shortest
+    // distances from a virtual source connected to every vertex. Only the vertices updated in the previous pass are
+    // scanned in the next pass.
+    const double eps = 1e-9;
+    std::vector<unsigned char> active(numVertices, 1), nextActive(numVertices, 0);
+    int numPasses = 0;
+    int numCanceledCycles = 0;
+    bool coldStarted = false;
+    std::fill(parentArc.begin(), parentArc.end(), -1);
+    while (true)
+    {
+        int lastUpdatedVertex = -1;
+        for (int u = 0; u < numVertices; u++)
+        {
+            if (!active[u])
+                continue;
+            for (int arcId = vertexArcBegin[u]; arcId < vertexArcBegin[u + 1]; arcId++)
+            {
+                if (arcResidual[arcId] <= 0)
+                    continue;
+                int v = arcHead[arcId];
+                double newPotential = potential[u] + arcCost[arcId];
+                if (newPotential < potential[v] - eps * std::max(1.0, std::fabs(potential[v])))
+                {
+                    potential[v] = newPotential;
+                    parentArc[v] = arcId;
+                    nextActive[v] = 1;
+                    lastUpdatedVertex = v;
+                }
+            }
+        }
+        if (lastUpdatedVertex < 0)
+            break;
+        active.swap(nextActive);
+        std::fill(nextActive.begin(), nextActive.end(), 0);
+        numPasses++;
+
+        // a cycle of the parent arcs is a negative cycle in the residual graph, which is canceled so the flow gets
+        // cheaper. If the labels are still changing after |V|+1 passes but no cycle can be found, the warm start is
+        // dropped.
+        bool cycleCanceled = numCanceledCycles < numVertices && cancelNegativeCycle(lastUpdatedVertex);
+        if (cycleCanceled)
+            numCanceledCycles++;
+        if (cycleCanceled || numPasses > numVertices)
+        {
+            if (!cycleCanceled)
+            {
+                if (coldStarted)
+                    break;
+                resetToColdStart();
+                coldStarted = true;
+            }
+            numPasses = 0;
+            std::fill(active.begin(), active.end(), 1);
+            std::fill(parentArc.begin(), parentArc.end(), -1);
+        }
+    }
+    potentialRepairRequired = false;
+}
+
+bool SSPMinCostFlow::cancelNegativeCycle(int fromVertex)
+{
+    // walk back along the parent arcs until a vertex is visited twice
+    if (visitStamp.size() != (unsigned int)numVertices)
+        visitStamp.assign(numVertices, 0);
+    curVisitStamp++;
+    int v = fromVertex;
+    while (visitStamp[v] != curVisitStamp)
+    {
+        visitStamp[v] = curVisitStamp;
+        if (parentArc[v] < 0)
+            return false;
+        v = arcHead[arcRev[parentArc[v]]];
+    }
+
+    std::vector<int> cycleArcs;
+    int cycleStart = v;
+    double cycleCost = 0;
+    int cycleFlow = std::numeric_limits<int>::max();
+    do
+    {
+        int arcId = parentArc[v];
+        cycleArcs.push_back(arcId);
+        cycleCost += arcCost[arcId];
+        cycleFlow = std::min(cycleFlow, arcResidual[arcId]);
+        v = arcHead[arcRev[arcId]];
+    } while (v != cycleStart);
+    if (cycleCost > -1e-7 || cycleFlow <= 0)
+        return false;
+
+    for (auto arcId : cycleArcs)
+    {
+        arcResidual[arcId] -= cycleFlow;
+        arcResidual[arcRev[arcId]] += cycleFlow;
+    }
+    return true;
+}
+
+void SSPMinCostFlow::resetToColdStart()
+{
+    for (unsigned int arcId = 0; arcId < arcHead.size(); arcId++)
+    {
+        if (!arcForward[arcId])
+            continue;
+        arcResidual[arcId] += arcResidual[arcRev[arcId]];
+        arcResidual[arcRev[arcId]] = 0;
+    }
+    // the residual graph only contains the forward arcs now, which has no negative cycle if the input network has no
+    // negative cycle, so the Bellman-Ford passes from zero labels will converge
+    potential.assign(numVertices, 0.0);
+}
+
+int SSPMinCostFlow::getOutflow(int vertexId)
+{
+    int outflow = 0;
+    for (int arcId = vertexArcBegin[vertexId]; arcId < vertexArcBegin[vertexId + 1]; arcId++)
+    {
+        // the residual of a counter arc is the flow on its edge
+        if (arcForward[arcId])
+            outflow += arcResidual[arcRev[arcId]];
+        else
+            outflow -= arcResidual[arcId];
+    }
+    return outflow;
+}
+
+bool SSPMinCostFlow::dijkstra(int s, int t)
+{
+    const double inf = std::numeric_limits<double>::infinity();
+    std::fill(distance.begin(), distance.end(), inf);
+    std::fill(parentArc.begin(), parentArc.end(), -1);
+    std::fill(settled.begin(), settled.end(), 0);
+
+    typedef std::pair<double, int> distAndVertex;
+    std::priority_queue<distAndVertex, std::vector<distAndVertex>, std::greater<distAndVertex>> vertexQ;
+    distance[s] = 0;
+    vertexQ.emplace(0.0, s);
+    while (!vertexQ.empty())
+    {
+        auto curPair = vertexQ.top();
+        vertexQ.pop();
+        int u = curPair.second;
+        if (settled[u])
+            continue;
+        settled[u] = 1;
+        if (u == t)
+            break;
+        for (int arcId = vertexArcBegin[u]; arcId < vertexArcBegin[u + 1]; arcId++)
+        {
+            if (arcResidual[arcId] <= 0)
+                continue;
+            int v = arcHead[arcId];
+            if (settled[v])
+                continue;
+            // the reduced costs are non-negative in theory, while the rounding errors are clamped
+            double reducedCost = std::max(0.0, arcCost[arcId] + potential[u] - potential[v]);
+            double newDistance = curPair.first + reducedCost;
+            if (newDistance < distance[v])
+            {
+                distance[v] = newDistance;
+                parentArc[v] = arcId;
+                vertexQ.emplace(newDistance, v);
+            }
+        }
+    }
+
+    if (!settled[t])
+        return false;
+
+    // the unsettled vertices are at least as far as the sink, so the truncated distances keep the reduced costs
+    // non-negative
+    double sinkDistance = distance[t];
+    for (int vertexId = 0; vertexId < numVertices; vertexId++)
+        potential[vertexId] += std::min(distance[vertexId], sinkDistance);
+    return true;
+}
+
+float SSPMinCostFlow::calcMinCostFlow(int s, int t, int requiredFlow)
+{
+    if (!built)
+        buildResidualGraph();
+
+    totalFlow = getOutflow(s);
+    while (totalFlow < requiredFlow && dijkstra(s, t))
+    {
+        int pathFlow = requiredFlow - totalFlow;
+        for (int v = t; v != s; v = arcHead[arcRev[parentArc[v]]])
+            pathFlow = std::min(pathFlow, arcResidual[parentArc[v]]);
+        assert(pathFlow > 0);
+        for (int v = t; v != s; v = arcHead[arcRev[parentArc[v]]])
+        {
+            int arcId = parentArc[v];
+            arcResidual[arcId] -= pathFlow;
+            arcResidual[arcRev[arcId]] += pathFlow;
+        }
+        totalFlow += pathFlow;
+    }
+
+    if (totalFlow >= requiredFlow)
+    {
+        double totalCost = 0;
+        for (unsigned int arcId = 0; arcId < arcHead.size(); arcId++)
+        {
+            if (arcForward[arcId])
+                totalCost += arcResidual[arcRev[arcId]] * arcCost[arcId];
+        }
+        return totalCost;
+    }
+    return MAX_VAL;
+}
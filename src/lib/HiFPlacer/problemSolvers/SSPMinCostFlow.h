@@ -0,0 +1,245 @@
+/**
+ * @file SSPMinCostFlow.h
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This header file contains the definitions of SSPMinCostFlow class, a min-cost flow solver based on successive
+ * shortest paths with Johnson potentials over a compact CSR residual graph.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ */
+
+#ifndef _SSPMinCostFlow
+#define _SSPMinCostFlow
+
+#include <assert.h>
+#include <limits>
+#include <queue>
+#include <vector>
+
+/**
+ * @brief SSPMinCostFlow solves min-cost flow problems with successive shortest paths
+ *
+ * The residual graph is stored in compressed sparse rows (CSR) and every edge has its residual counter arc in the
+ * arrays, so there is no per-edge heap allocation. The shortest augmenting paths are found by Dijkstra's algorithm on
+ * the reduced costs (cost + potential[u] - potential[v]) which stay non-negative once the potentials are updated with
+ * the distances of the previous search (Johnson's technique). The search stops as soon as the sink is settled and
+ * the distances of the unsettled vertices are truncated to the distance of the sink when the potentials are updated.
+ *
+ * It is an alternative engine to the SPFA-based MinCostFlow in 3rdParty. It can also be warm-started with an initial
+ * flow and initial potentials (e.g., from a previous solution of a similar problem). In that case, or when some edges
+ * have negative costs, the potentials are repaired by Bellman-Ford passes before the augmentations, and the negative
+ * cycles found in the residual graph (i.e., the initial flow is not a min-cost flow) are canceled.
+ *
+ */
+class SSPMinCostFlow
+{
+  public:
+    /**
+     * @brief Construct a new SSPMinCostFlow object
+     *
+     * @param numVertices the number of vertices in the flow network
+     */
+    SSPMinCostFlow(int numVertices) : numVertices(numVertices)
+    {
+    }
+    ~SSPMinCostFlow()
+    {
+    }
+
+    /**
+     * @brief add a directed edge into the flow network (before calcMinCostFlow())
+     *
+     * @param u the tail vertex
+     * @param v the head vertex
+     * @param capacity the capacity of the edge
+     * @param cost the cost per unit flow of the edge
+     * @return int the id of the edge, which can be used to query the flow on it
+     */
+    int addEdge(int u, int v, int capacity, float cost);
+
+    /**
+     * @brief set the initial flow on an edge (before calcMinCostFlow()) to warm-start the solver
+     *
+     * The caller should ensure that the initial flows satisfy the flow conservation.
+     *
+     * @param edgeId the id returned by addEdge()
+     * @param flow the initial flow, which should not exceed the capacity of the edge
+     */
+    void setInitialFlow(int edgeId, int flow);
+
+    /**
+     * @brief set the initial potentials of the vertices (before calcMinCostFlow()) to warm-start the solver
+     *
+     * The potentials will be repaired if they do not lead to non-negative reduced costs, so they can be the potentials
+     * of a previous solution of a similar problem.
+     *
+     * @param initialPotential the potential of each vertex
+     */
+    void setInitialPotentials(const std::vector<double> &initialPotential);
+
+    /**
+     * @brief get the potential of a vertex after calcMinCostFlow(), which can be used to warm-start similar problems
+     *
+     * @param vertexId
+     * @return double
+     */
+    inline double getPotential(int vertexId)
+    {
+        assert(built);
+        return potential[vertexId];
+    }
+
+    /**
+     * @brief calculate the min-cost flow from s to t
+     *
+     * The augmentation stops when the required flow (including the initial flow) is reached or there is no augmenting
+     * path.
+     *
+     * @param s source
+     * @param t sink
+     * @param requiredFlow the amount of flow to be routed
+     * @return float the cost of the flow, or MAX_VAL if the required flow cannot be reached
+     */
+    float calcMinCostFlow(int s, int t, int requiredFlow);
+
+    /**
+     * @brief get the flow on an edge after calcMinCostFlow()
+     *
+     * @param edgeId the id returned by addEdge()
+     * @return int
+     */
+    inline int getFlow(int edgeId)
+    {
+        assert(built);
+        return arcResidual[arcRev[edgeId2Arc[edgeId]]];
+    }
+
+    /**
+     * @brief get the amount of flow routed by the last calcMinCostFlow()
+     *
+     * @return int
+     */
+    inline int getTotalFlow()
+    {
+        return totalFlow;
+    }
+
+  private:
+    int numVertices;
+    int totalFlow = 0;
+    int MAX_VAL = 200000000;
+    bool built = false;
+
+    /**
+     * @brief the edges added before the CSR residual graph is built
+     *
+     */
+    struct PendingEdge
+    {
+        int u;
+        int v;
+        int capacity;
+        float cost;
+        int flow;
+    };
+    std::vector<PendingEdge> pendingEdges;
+
+    /**
+     * @brief the first arc of each vertex in the CSR arrays (numVertices+1 entries)
+     *
+     */
+    std::vector<int> vertexArcBegin;
+    std::vector<int> arcHead;
+    std::vector<int> arcResidual;
+    std::vector<double> arcCost;
+
+    /**
+     * @brief whether an arc is the forward arc of an edge (otherwise it is the residual counter arc)
+     *
+     */
+    std::vector<unsigned char> arcForward;
+
+    /**
+     * @brief the index of the counter arc of each arc
+     *
+     */
+    std::vector<int> arcRev;
+
+    /**
+     * @brief the forward arc of each edge added by addEdge()
+     *
+     */
+    std::vector<int> edgeId2Arc;
+
+    /**
+     * @brief whether the graph has initial flows, initial potentials or negative costs, so the potentials should be
+     * repaired before Dijkstra's algorithm can be used
+     *
+     */
+    bool potentialRepairRequired = false;
+    std::vector<double> initialPotential;
+
+    std::vector<double> potential;
+    std::vector<double> distance;
+    std::vector<int> parentArc;
+    std::vector<unsigned char> settled;
+
+    /**
+     * @brief the stamps of the vertices visited by the latest walk along the parent arcs in cancelNegativeCycle()
+     *
+     */
+    std::vector<int> visitStamp;
+    int curVisitStamp = 0;
+
+    /**
+     * @brief build the CSR residual graph from the pending edges
+     *
+     */
+    void buildResidualGraph();
+
+    /**
+     * @brief find the shortest augmenting path from s to t w.r.t. the reduced costs and update the potentials
+     *
+     * @param s source
+     * @param t sink
+     * @return true if there is an augmenting path (recorded in parentArc)
+     */
+    bool dijkstra(int s, int t);
+
+    /**
+     * @brief make the reduced costs of the residual arcs non-negative by Bellman-Ford passes from the current potentials
+     *
+     * A negative cycle in the residual graph is canceled by pushing flow along it, so the flow becomes a min-cost flow
+     * of its value. If no cycle can be extracted from the parent arcs, the flow is reset to zero (a cold start).
+     *
+     */
+    void repairPotentials();
+
+    /**
+     * @brief find a cycle in the parent arcs of Bellman-Ford from the given vertex and push flow along it if it is
+     * negative
+     *
+     * @param fromVertex a vertex which is updated in the last Bellman-Ford pass
+     * @return true if a negative cycle is canceled
+     */
+    bool cancelNegativeCycle(int fromVertex);
+
+    /**
+     * @brief reset the flow to zero and the potentials to the shortest distances from a virtual source
+     *
+     */
+    void resetToColdStart();
+
+    /**
+     * @brief get the amount of flow leaving the given vertex
+     *
+     * @param vertexId
+     * @return int
+     */
+    int getOutflow(int vertexId);
+};
+
+#endif